@@ -0,0 +1,124 @@
+#include "../src/core/assets.hpp"
+#include "../src/core/mesh-optimizer.hpp"
+#include "../src/core/mesh-simplifier.hpp"
+#include "../src/core/sdl-wrapper.hpp"
+#include "../src/core/texture-encoder.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+/*
+ * The asset baker is an offline tool which converts our source assets into formats that can
+ * be loaded at runtime without any parsing. It is not part of the application itself and is
+ * invoked by the 'bake_assets.sh' script for each asset that needs baking.
+ *
+ * Usage: a-simple-triangle-asset-baker <input .obj file> <output .mesh file>
+ *        a-simple-triangle-asset-baker <input image file> <output .ktx2 file> <bc | etc2 | rgba8>
+ *
+ * Textures are baked into one of three families of formats. The 'bc' and 'etc2' families pick
+ * the variant with or without alpha depending on whether the image has any transparency.
+ */
+namespace
+{
+    std::string formatVertexCacheStatistics(const ast::VertexCacheStatistics& statistics)
+    {
+        return "ACMR " + std::to_string(statistics.acmr) + ", ATVR " + std::to_string(statistics.atvr);
+    }
+
+    void bakeStaticMesh(const std::string& inputPath, const std::string& outputPath)
+    {
+        // Parse the source .obj file the slow way, once, then generate its levels of detail,
+        // reorder them all for the GPU and save the result in our baked format.
+        const ast::Mesh sourceMesh{ast::assets::loadOBJFile(inputPath)};
+        const ast::Mesh mesh{ast::meshes::optimize(ast::meshes::createLevelsOfDetail(sourceMesh),
+                                                   ast::meshes::defaultOverdrawThreshold)};
+        ast::assets::saveMeshFile(outputPath, mesh);
+
+        const ast::VertexCacheStatistics before{ast::meshes::analyzeVertexCache(sourceMesh, ast::meshes::vertexCacheSize)};
+        const ast::VertexCacheStatistics after{ast::meshes::analyzeVertexCache(mesh, ast::meshes::vertexCacheSize)};
+
+        std::cout << "Baked " << inputPath << " into " << outputPath
+                  << " (" << mesh.getNumVertices() << " vertices, "
+                  << mesh.getNumIndices() << " indices, "
+                  << mesh.getLevels().size() << " levels of detail)" << std::endl;
+
+        std::cout << "Optimised vertex cache from " << ::formatVertexCacheStatistics(before)
+                  << " to " << ::formatVertexCacheStatistics(after) << std::endl;
+
+        for (size_t i = 0; i < mesh.getLevels().size(); i++)
+        {
+            const ast::MeshLevelOfDetail& level{mesh.getLevels()[i]};
+
+            std::cout << "Level of detail " << i << ": " << level.numIndices / 3
+                      << " triangles, error " << level.error << std::endl;
+        }
+    }
+
+    ast::TextureFormat getTextureFormat(const std::string& family, const ast::Bitmap& bitmap)
+    {
+        const bool transparent{ast::textures::hasTransparency(bitmap)};
+
+        if (family == "bc")
+        {
+            return transparent ? ast::TextureFormat::BC3 : ast::TextureFormat::BC1;
+        }
+
+        if (family == "etc2")
+        {
+            return transparent ? ast::TextureFormat::ETC2RGBA8 : ast::TextureFormat::ETC2RGB8;
+        }
+
+        if (family == "rgba8")
+        {
+            return ast::TextureFormat::RGBA8;
+        }
+
+        throw std::runtime_error("Unknown texture format family: " + family);
+    }
+
+    void bakeTexture(const std::string& inputPath, const std::string& outputPath, const std::string& family)
+    {
+        // Decode the source image, then build and compress its whole mip chain up front so
+        // the renderer can upload it without doing any work of its own.
+        const ast::Bitmap bitmap{ast::assets::loadBitmap(inputPath)};
+        const ast::TextureData textureData{ast::textures::encode(bitmap, ::getTextureFormat(family, bitmap))};
+        ast::assets::saveKTX2File(outputPath, textureData);
+
+        std::cout << "Baked " << inputPath << " into " << outputPath
+                  << " (" << ast::textures::getFormatName(textureData.getFormat()) << ", "
+                  << textureData.getMipLevels().size() << " mip levels, "
+                  << textureData.getSize() << " bytes)" << std::endl;
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3 && argc != 4)
+    {
+        std::cerr << "Usage: a-simple-triangle-asset-baker <input .obj file> <output .mesh file>" << std::endl;
+        std::cerr << "       a-simple-triangle-asset-baker <input image file> <output .ktx2 file> <bc | etc2 | rgba8>" << std::endl;
+        return 1;
+    }
+
+    const std::string inputPath{argv[1]};
+    const std::string outputPath{argv[2]};
+
+    try
+    {
+        if (argc == 4)
+        {
+            ::bakeTexture(inputPath, outputPath, argv[3]);
+        }
+        else
+        {
+            ::bakeStaticMesh(inputPath, outputPath);
+        }
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "Failed to bake " << inputPath << ": " << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,30 @@
+#!/bin/sh
+
+echo "Baking assets ..."
+
+# Grab all the .obj files in our models asset folder and iterate them one at a time,
+# invoking the asset baker to produce a .mesh file next to each of them.
+for FILE_PATH in ../assets/models/*.obj; do
+    OUTPUT_PATH="${FILE_PATH%.obj}.mesh"
+
+    echo "Baking static mesh: $(basename $FILE_PATH)"
+
+    ../../console/out/a-simple-triangle-asset-baker \
+        ${FILE_PATH} \
+        ${OUTPUT_PATH}
+done
+
+# Bake every texture into each family of GPU formats, so at runtime each renderer can pick the
+# most compact one its device supports. The uncompressed version works everywhere.
+for FILE_PATH in ../assets/textures/*.png; do
+    for FORMAT in bc etc2 rgba8; do
+        OUTPUT_PATH="${FILE_PATH%.png}.${FORMAT}.ktx2"
+
+        echo "Baking texture: $(basename $FILE_PATH) ($FORMAT)"
+
+        ../../console/out/a-simple-triangle-asset-baker \
+            ${FILE_PATH} \
+            ${OUTPUT_PATH} \
+            ${FORMAT}
+    done
+done
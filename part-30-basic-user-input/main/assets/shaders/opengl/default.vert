@@ -1,5 +1,10 @@
 uniform mat4 u_mvp;
 
+// Per mesh transform which recovers the original vertex attributes from their compact form.
+uniform vec3 u_positionScale;
+uniform vec3 u_positionOffset;
+uniform vec4 u_texCoordScaleOffset;
+
 attribute vec3 a_vertexPosition;
 attribute vec2 a_texCoord;
 
@@ -7,6 +12,6 @@ varying vec2 v_texCoord;
 
 void main()
 {
-    gl_Position = u_mvp * vec4(a_vertexPosition, 1.0);
-    v_texCoord = a_texCoord;
+    gl_Position = u_mvp * vec4(a_vertexPosition * u_positionScale + u_positionOffset, 1.0);
+    v_texCoord = a_texCoord * u_texCoordScaleOffset.xy + u_texCoordScaleOffset.zw;
 }
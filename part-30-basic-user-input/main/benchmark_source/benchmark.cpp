@@ -0,0 +1,334 @@
+#define TINYOBJLOADER_IMPLEMENTATION
+
+#include "../src/core/obj-parser.hpp"
+#include "../src/core/static-mesh-instance.hpp"
+#include "../src/core/transform-batch.hpp"
+#include "../src/core/vertex-deduplicator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tiny_obj_loader.h>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * The benchmark is an offline tool which measures the performance of isolated core systems,
+ * so that optimisations to them can be compared against the code they replace.
+ *
+ * Usage: a-simple-triangle-benchmark
+ */
+namespace
+{
+    struct InstanceData
+    {
+        glm::vec3 position;
+        glm::vec3 scale;
+        glm::vec3 rotationAxis;
+        float rotationDegrees;
+    };
+
+    std::vector<InstanceData> createInstanceData(const size_t& count)
+    {
+        // A fixed seed keeps the generated data identical between runs.
+        std::mt19937 generator{1234};
+        std::uniform_real_distribution<float> distribution{-1.0f, 1.0f};
+
+        std::vector<InstanceData> result;
+        result.reserve(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            result.push_back(InstanceData{
+                glm::vec3{distribution(generator) * 10.0f, distribution(generator) * 10.0f, distribution(generator) * 10.0f},
+                glm::vec3{std::abs(distribution(generator)) + 0.1f, std::abs(distribution(generator)) + 0.1f, std::abs(distribution(generator)) + 0.1f},
+                glm::vec3{distribution(generator), distribution(generator), std::abs(distribution(generator)) + 0.1f},
+                distribution(generator) * 180.0f});
+        }
+
+        return result;
+    }
+
+    glm::mat4 createProjectionViewMatrix()
+    {
+        glm::mat4 result{1.0f};
+
+        for (int column = 0; column < 4; column++)
+        {
+            for (int row = 0; row < 4; row++)
+            {
+                result[column][row] += 0.1f * static_cast<float>(column + row);
+            }
+        }
+
+        return result;
+    }
+
+    template <typename Work>
+    double measureMillisecondsPerFrame(const size_t& frames, Work work)
+    {
+        const auto start{std::chrono::high_resolution_clock::now()};
+
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            work();
+        }
+
+        const std::chrono::duration<double, std::milli> elapsed{std::chrono::high_resolution_clock::now() - start};
+
+        return elapsed.count() / static_cast<double>(frames);
+    }
+
+    void benchmarkTransforms(const size_t& count)
+    {
+        const std::vector<InstanceData> data{::createInstanceData(count)};
+        const glm::mat4 projectionView{::createProjectionViewMatrix()};
+
+        // Run enough frames that each measurement covers a similar total amount of work.
+        const size_t frames{std::max<size_t>(10, 10000000 / count)};
+
+        std::vector<ast::StaticMeshInstance> instances;
+        instances.reserve(count);
+        ast::TransformBatch batch;
+
+        for (const auto& item : data)
+        {
+            instances.push_back(ast::StaticMeshInstance{ast::assets::StaticMesh::Crate,
+                                                        ast::assets::Texture::Crate,
+                                                        item.position,
+                                                        item.scale,
+                                                        item.rotationAxis,
+                                                        item.rotationDegrees});
+
+            batch.add(item.position, item.scale, item.rotationAxis, item.rotationDegrees);
+        }
+
+        const double instanceMilliseconds{::measureMillisecondsPerFrame(frames, [&]() {
+            for (auto& instance : instances)
+            {
+                instance.update(projectionView);
+            }
+        })};
+
+        const double batchMilliseconds{::measureMillisecondsPerFrame(frames, [&]() {
+            batch.update(projectionView);
+        })};
+
+        // Make sure both approaches actually produce the same matrices.
+        float maxDifference{0.0f};
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const glm::mat4 expected{instances[i].getTransformMatrix()};
+            const glm::mat4& actual{batch.getTransformMatrix(static_cast<uint32_t>(i))};
+
+            for (int column = 0; column < 4; column++)
+            {
+                for (int row = 0; row < 4; row++)
+                {
+                    maxDifference = std::max(maxDifference, std::abs(expected[column][row] - actual[column][row]));
+                }
+            }
+        }
+
+        std::cout << count << " instances: "
+                  << "per instance " << instanceMilliseconds << " ms, "
+                  << "batch " << batchMilliseconds << " ms, "
+                  << "speed up " << instanceMilliseconds / batchMilliseconds << "x, "
+                  << "max difference " << maxDifference << std::endl;
+    }
+
+    // The vertex hash we used to have, which combines the glm hashes of each component.
+    struct LegacyVertexHash
+    {
+        size_t operator()(const ast::Vertex& vertex) const
+        {
+            return ((std::hash<glm::vec3>()(vertex.position) ^ (std::hash<glm::vec2>()(vertex.texCoord) << 1)) >> 1);
+        }
+    };
+
+    // Produce the vertex for one corner of one triangle of a flat grid mesh, in the same way
+    // an .obj file of the grid would be imported - every interior vertex is seen six times.
+    ast::Vertex createGridVertex(const uint32_t& gridSize, const size_t& corner)
+    {
+        static const uint32_t cornerOffsets[6][2]{{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}};
+
+        const size_t cell{corner / 6};
+        const uint32_t column{static_cast<uint32_t>(cell % gridSize) + cornerOffsets[corner % 6][0]};
+        const uint32_t row{static_cast<uint32_t>(cell / gridSize) + cornerOffsets[corner % 6][1]};
+
+        return ast::Vertex{
+            glm::vec3{static_cast<float>(column) * 0.01f, 0.0f, static_cast<float>(row) * 0.01f},
+            glm::vec2{static_cast<float>(column) / gridSize, static_cast<float>(row) / gridSize}};
+    }
+
+    void benchmarkVertexDeduplication(const uint32_t& gridSize)
+    {
+        const size_t numCorners{static_cast<size_t>(gridSize) * gridSize * 6};
+        const size_t expectedVertices{static_cast<size_t>(gridSize + 1) * (gridSize + 1)};
+
+        std::vector<ast::Vertex> legacyVertices;
+        std::vector<uint32_t> legacyIndices;
+        legacyIndices.reserve(numCorners);
+
+        const double legacyMilliseconds{::measureMillisecondsPerFrame(1, [&]() {
+            std::unordered_map<ast::Vertex, uint32_t, ::LegacyVertexHash> uniqueVertices;
+
+            for (size_t corner = 0; corner < numCorners; corner++)
+            {
+                const ast::Vertex vertex{::createGridVertex(gridSize, corner)};
+
+                if (uniqueVertices.count(vertex) == 0)
+                {
+                    uniqueVertices[vertex] = static_cast<uint32_t>(legacyVertices.size());
+                    legacyVertices.push_back(vertex);
+                }
+
+                legacyIndices.push_back(uniqueVertices[vertex]);
+            }
+        })};
+
+        std::vector<ast::Vertex> vertices;
+        std::vector<uint32_t> indices;
+        indices.reserve(numCorners);
+
+        const double deduplicatorMilliseconds{::measureMillisecondsPerFrame(1, [&]() {
+            ast::VertexDeduplicator uniqueVertices(vertices, expectedVertices);
+
+            for (size_t corner = 0; corner < numCorners; corner++)
+            {
+                indices.push_back(uniqueVertices.add(::createGridVertex(gridSize, corner)));
+            }
+        })};
+
+        // Both approaches number the vertices in the order they are first seen, so they must
+        // produce exactly the same results.
+        const bool identical{vertices == legacyVertices && indices == legacyIndices};
+
+        std::cout << numCorners / 3 << " triangles: "
+                  << "unordered_map " << legacyMilliseconds << " ms, "
+                  << "deduplicator " << deduplicatorMilliseconds << " ms, "
+                  << "speed up " << legacyMilliseconds / deduplicatorMilliseconds << "x, "
+                  << vertices.size() << " unique vertices, "
+                  << (identical ? "results match" : "RESULTS DIFFER") << std::endl;
+    }
+
+    // Write out the text of an .obj file for a flat grid mesh, with two triangles per cell.
+    std::string createGridOBJ(const uint32_t& gridSize)
+    {
+        std::string result;
+        char line[128];
+
+        for (uint32_t row = 0; row <= gridSize; row++)
+        {
+            for (uint32_t column = 0; column <= gridSize; column++)
+            {
+                std::snprintf(line, sizeof(line), "v %f %f %f\nvt %f %f\n",
+                              static_cast<float>(column) * 0.01f, 0.0f, static_cast<float>(row) * 0.01f,
+                              static_cast<float>(column) / gridSize, static_cast<float>(row) / gridSize);
+                result += line;
+            }
+        }
+
+        for (uint32_t row = 0; row < gridSize; row++)
+        {
+            for (uint32_t column = 0; column < gridSize; column++)
+            {
+                const uint32_t a{row * (gridSize + 1) + column + 1};
+                const uint32_t b{a + 1};
+                const uint32_t c{a + gridSize + 2};
+                const uint32_t d{a + gridSize + 1};
+
+                std::snprintf(line, sizeof(line), "f %u/%u %u/%u %u/%u\nf %u/%u %u/%u %u/%u\n",
+                              a, a, b, b, c, c, a, a, c, c, d, d);
+                result += line;
+            }
+        }
+
+        return result;
+    }
+
+    void benchmarkOBJParsing(const uint32_t& gridSize)
+    {
+        const std::string source{::createGridOBJ(gridSize)};
+
+        // The way we used to import .obj files - tinyobj reading through a stream, followed by
+        // deduplicating every face corner.
+        std::vector<ast::Vertex> legacyVertices;
+        std::vector<uint32_t> legacyIndices;
+
+        const double legacyMilliseconds{::measureMillisecondsPerFrame(1, [&]() {
+            std::istringstream sourceStream(source);
+            tinyobj::attrib_t attributes;
+            std::vector<tinyobj::shape_t> shapes;
+            std::vector<tinyobj::material_t> materials;
+            std::string warning;
+            std::string error;
+
+            tinyobj::LoadObj(&attributes, &shapes, &materials, &warning, &error, &sourceStream);
+
+            ast::VertexDeduplicator uniqueVertices(legacyVertices, attributes.vertices.size() / 3);
+
+            for (const auto& shape : shapes)
+            {
+                for (const auto& index : shape.mesh.indices)
+                {
+                    legacyIndices.push_back(uniqueVertices.add(ast::Vertex{
+                        glm::vec3{attributes.vertices[3 * index.vertex_index + 0],
+                                  attributes.vertices[3 * index.vertex_index + 1],
+                                  attributes.vertices[3 * index.vertex_index + 2]},
+                        glm::vec2{attributes.texcoords[2 * index.texcoord_index + 0],
+                                  1.0f - attributes.texcoords[2 * index.texcoord_index + 1]}}));
+                }
+            }
+        })};
+
+        std::vector<ast::Vertex> vertices;
+        std::vector<uint32_t> indices;
+
+        const double parserMilliseconds{::measureMillisecondsPerFrame(1, [&]() {
+            const ast::Mesh mesh{ast::obj::parse(source.data(), source.size())};
+            vertices = mesh.getVertices();
+            indices = mesh.getIndices();
+        })};
+
+        const bool identical{vertices == legacyVertices && indices == legacyIndices};
+        const double megabytes{static_cast<double>(source.size()) / (1024.0 * 1024.0)};
+
+        std::cout << indices.size() / 3 << " triangles (" << megabytes << " MB): "
+                  << "tinyobj " << legacyMilliseconds << " ms, "
+                  << "parser " << parserMilliseconds << " ms (" << megabytes * 1000.0 / parserMilliseconds << " MB/s), "
+                  << "speed up " << legacyMilliseconds / parserMilliseconds << "x, "
+                  << (identical ? "results match" : "RESULTS DIFFER") << std::endl;
+    }
+} // namespace
+
+int main(int, char*[])
+{
+    std::cout << "Transform update, milliseconds per frame:" << std::endl;
+
+    for (const size_t count : {1000, 10000, 100000})
+    {
+        ::benchmarkTransforms(count);
+    }
+
+    std::cout << "Vertex deduplication, milliseconds per mesh:" << std::endl;
+
+    for (const uint32_t gridSize : {250, 1000, 2000})
+    {
+        ::benchmarkVertexDeduplication(gridSize);
+    }
+
+    std::cout << "OBJ parsing, milliseconds per file:" << std::endl;
+
+    for (const uint32_t gridSize : {250, 1000})
+    {
+        ::benchmarkOBJParsing(gridSize);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include <emscripten.h>
 #endif
 
+#include "../core/headless.hpp"
+#include "../core/profiler.hpp"
 #include "../core/sdl-wrapper.hpp"
 #include "application.hpp"
 
@@ -20,12 +22,16 @@ namespace
 struct Application::Internal
 {
     const float performanceFrequency;
+    const uint32_t frameLimit;
     uint64_t currentTime;
     uint64_t previousTime;
+    uint32_t frameCount;
 
     Internal() : performanceFrequency(static_cast<float>(SDL_GetPerformanceFrequency())),
+                 frameLimit(ast::headless::isEnabled() ? ast::headless::getFrameLimit() : 0),
                  currentTime(SDL_GetPerformanceCounter()),
-                 previousTime(currentTime) {}
+                 previousTime(currentTime),
+                 frameCount(0) {}
 
     float timeStep()
     {
@@ -51,8 +57,14 @@ void Application::startApplication()
 
 bool Application::runMainLoop()
 {
+    AST_PROFILE_ZONE("Application::runMainLoop");
+
     SDL_Event event;
 
+    // Dragging a window edge can produce many resize events between frames, but only the
+    // final size matters, so they are collapsed into a single resize after polling.
+    bool windowResized{false};
+
     // Each loop we will process any events that are waiting for us.
     while (SDL_PollEvent(&event))
     {
@@ -61,7 +73,7 @@ bool Application::runMainLoop()
             case SDL_WINDOWEVENT:
                 if (event.window.event == SDL_WINDOWEVENT_RESIZED)
                 {
-                    onWindowResized();
+                    windowResized = true;
                 }
                 break;
 
@@ -79,12 +91,24 @@ bool Application::runMainLoop()
         }
     }
 
+    if (windowResized)
+    {
+        onWindowResized();
+    }
+
     // Perform our updating for this frame.
     update(internal->timeStep());
 
     // Perform our rendering for this frame.
     render();
 
+    // Headless runs can be given a fixed number of frames to render before quitting, as
+    // there is no window for anyone to close.
+    if (internal->frameLimit > 0 && ++internal->frameCount >= internal->frameLimit)
+    {
+        return false;
+    }
+
     return true;
 }
 
@@ -1,15 +1,40 @@
 #include "opengl-application.hpp"
 #include "../../core/graphics-wrapper.hpp"
+#include "../../core/headless.hpp"
 #include "../../core/log.hpp"
+#include "../../core/profiler.hpp"
 #include "../../core/sdl-window.hpp"
 #include "../../scene/scene-main.hpp"
 #include "opengl-asset-manager.hpp"
+#include "opengl-gpu-timer.hpp"
+#include "opengl-offscreen-target.hpp"
 #include "opengl-renderer.hpp"
 
 using ast::OpenGLApplication;
 
 namespace
 {
+    uint32_t getWindowFlags()
+    {
+        // Rendering headless the window is never shown, it is only needed to own the OpenGL context.
+        if (ast::headless::isEnabled())
+        {
+            return SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN;
+        }
+
+        return SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI;
+    }
+
+    ast::WindowSize getFrameSize(const ast::SDLWindow& window)
+    {
+        if (ast::headless::isEnabled())
+        {
+            return ast::headless::getFrameSize();
+        }
+
+        return ast::sdl::getWindowSize(window.getWindow());
+    }
+
     void updateViewport(SDL_Window* window)
     {
         static const std::string logTag{"ast::OpenGLApplication::updateViewport"};
@@ -42,19 +67,35 @@ namespace
         return context;
     }
 
+    std::unique_ptr<ast::OpenGLOffscreenTarget> createOffscreenTarget()
+    {
+        if (!ast::headless::isEnabled())
+        {
+            return nullptr;
+        }
+
+        return std::make_unique<ast::OpenGLOffscreenTarget>(ast::headless::getFrameSize());
+    }
+
     std::shared_ptr<ast::OpenGLAssetManager> createAssetManager()
     {
         return std::make_shared<ast::OpenGLAssetManager>(ast::OpenGLAssetManager());
     }
 
-    ast::OpenGLRenderer createRenderer(std::shared_ptr<ast::OpenGLAssetManager> assetManager)
+    std::shared_ptr<ast::OpenGLGpuTimer> createGpuTimer()
+    {
+        return std::make_shared<ast::OpenGLGpuTimer>();
+    }
+
+    ast::OpenGLRenderer createRenderer(std::shared_ptr<ast::OpenGLAssetManager> assetManager,
+                                       std::shared_ptr<ast::OpenGLGpuTimer> gpuTimer)
     {
-        return ast::OpenGLRenderer(assetManager);
+        return ast::OpenGLRenderer(assetManager, gpuTimer);
     }
 
     std::unique_ptr<ast::Scene> createMainScene(const ast::SDLWindow& window, ast::OpenGLAssetManager& assetManager)
     {
-        std::unique_ptr<ast::Scene> scene{std::make_unique<ast::SceneMain>(ast::sdl::getWindowSize(window.getWindow()))};
+        std::unique_ptr<ast::Scene> scene{std::make_unique<ast::SceneMain>(::getFrameSize(window))};
         assetManager.loadAssetManifest(scene->getAssetManifest());
         scene->prepare();
 
@@ -66,14 +107,18 @@ struct OpenGLApplication::Internal
 {
     const ast::SDLWindow window;
     SDL_GLContext context;
+    const std::unique_ptr<ast::OpenGLOffscreenTarget> offscreenTarget;
     const std::shared_ptr<ast::OpenGLAssetManager> assetManager;
+    const std::shared_ptr<ast::OpenGLGpuTimer> gpuTimer;
     ast::OpenGLRenderer renderer;
     std::unique_ptr<ast::Scene> scene;
 
-    Internal() : window(ast::SDLWindow(SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI)),
+    Internal() : window(ast::SDLWindow(::getWindowFlags())),
                  context(::createContext(window.getWindow())),
+                 offscreenTarget(::createOffscreenTarget()),
                  assetManager(::createAssetManager()),
-                 renderer(::createRenderer(assetManager)) {}
+                 gpuTimer(::createGpuTimer()),
+                 renderer(::createRenderer(assetManager, gpuTimer)) {}
 
     ast::Scene& getScene()
     {
@@ -92,24 +137,52 @@ struct OpenGLApplication::Internal
 
     void render()
     {
+        AST_PROFILE_ZONE("OpenGLApplication::render");
+
         SDL_GL_MakeCurrent(window.getWindow(), context);
 
+        if (offscreenTarget)
+        {
+            offscreenTarget->bind();
+        }
+
+        gpuTimer->beginFrame();
+
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         getScene().render(renderer);
+        renderer.flush();
+
+        // Rendering headless, the frame is read back rather than presented.
+        if (offscreenTarget)
+        {
+            gpuTimer->beginZone("Readback");
+            offscreenTarget->readback();
+            gpuTimer->endFrame();
+            return;
+        }
 
+        gpuTimer->endFrame();
+
+        AST_PROFILE_ZONE("OpenGLApplication::swapWindow");
         SDL_GL_SwapWindow(window.getWindow());
     }
 
     void onWindowResized()
     {
-        getScene().onWindowResized(ast::sdl::getWindowSize(window.getWindow()));
+        getScene().onWindowResized(::getFrameSize(window));
         ::updateViewport(window.getWindow());
     }
 
     ~Internal()
     {
+        if (offscreenTarget)
+        {
+            SDL_GL_MakeCurrent(window.getWindow(), context);
+            offscreenTarget->finishReadbacks();
+        }
+
         SDL_GL_DeleteContext(context);
     }
 };
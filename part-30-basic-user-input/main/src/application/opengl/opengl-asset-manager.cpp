@@ -1,22 +1,143 @@
 #include "opengl-asset-manager.hpp"
+#include "../../core/asset-decoding.hpp"
 #include "../../core/assets.hpp"
+#include "../../core/graphics-wrapper.hpp"
+#include "../../core/log.hpp"
+#include "../../core/mesh-encoder.hpp"
+#include "../../core/profiler.hpp"
+#include "../../core/texture-encoder.hpp"
+#include "../../core/thread-pool.hpp"
+#include <chrono>
 #include <unordered_map>
+#include <unordered_set>
 
 using ast::OpenGLAssetManager;
 
+namespace
+{
+    std::unordered_set<ast::TextureFormat> getSupportedTextureFormats()
+    {
+        // Uncompressed textures work everywhere, the rest depend on the extensions offered by
+        // the driver. WebGL names its extensions differently to desktop and mobile OpenGL.
+        const char* extensions{reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS))};
+        const std::string extensionNames{extensions ? extensions : ""};
+        std::unordered_set<ast::TextureFormat> formats{ast::TextureFormat::RGBA8};
+
+        if (extensionNames.find("GL_EXT_texture_compression_s3tc") != std::string::npos ||
+            extensionNames.find("WEBGL_compressed_texture_s3tc") != std::string::npos)
+        {
+            formats.insert(ast::TextureFormat::BC1);
+            formats.insert(ast::TextureFormat::BC3);
+        }
+
+        // Our ETC2 RGB8 textures are also valid ETC1, which is all that OpenGL ES 2 offers.
+        if (extensionNames.find("GL_OES_compressed_ETC1_RGB8_texture") != std::string::npos ||
+            extensionNames.find("WEBGL_compressed_texture_etc1") != std::string::npos)
+        {
+            formats.insert(ast::TextureFormat::ETC2RGB8);
+        }
+
+        return formats;
+    }
+
+    ast::VertexLayout getSupportedVertexLayout()
+    {
+        static const std::string logTag{"ast::OpenGLAssetManager::getSupportedVertexLayout"};
+
+        const ast::VertexLayout preferredLayout{ast::meshes::getPreferredVertexLayout()};
+
+        if (preferredLayout != ast::VertexLayout::Half)
+        {
+            return preferredLayout;
+        }
+
+        // Half float vertex attributes are core in desktop OpenGL 3, but older desktop and
+        // mobile drivers only offer them through an extension, and WebGL 1 not at all.
+        const char* extensions{reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS))};
+        const std::string extensionNames{extensions ? extensions : ""};
+
+        if (extensionNames.find("GL_OES_vertex_half_float") != std::string::npos ||
+            extensionNames.find("GL_ARB_half_float_vertex") != std::string::npos)
+        {
+            return preferredLayout;
+        }
+
+        ast::log(logTag, "Half float vertices are not supported, using Snorm16 instead.");
+
+        return ast::VertexLayout::Snorm16;
+    }
+
+    // Create a buffer large enough for the given number of bytes, to be filled in pieces later.
+    GLuint createGeometryBuffer(const GLenum& target, const size_t& size)
+    {
+        GLuint bufferId;
+        glGenBuffers(1, &bufferId);
+        glBindBuffer(target, bufferId);
+        glBufferData(target,
+                     size,
+                     nullptr,
+                     GL_STATIC_DRAW);
+
+        return bufferId;
+    }
+
+    void copyToBuffer(const GLenum& target, const size_t& offset, const std::vector<char>& data)
+    {
+        if (!data.empty())
+        {
+            glBufferSubData(target, offset, data.size(), data.data());
+        }
+    }
+} // namespace
+
 struct OpenGLAssetManager::Internal
 {
+    ast::ThreadPool workerPool;
     std::unordered_map<ast::assets::Pipeline, ast::OpenGLPipeline> pipelineCache;
     std::unordered_map<ast::assets::StaticMesh, ast::OpenGLMesh> staticMeshCache;
     std::unordered_map<ast::assets::Texture, ast::OpenGLTexture> textureCache;
+    const std::unordered_set<ast::TextureFormat> supportedTextureFormats;
+    const ast::VertexLayout vertexLayout;
+
+    // The vertex and index buffer of each geometry pool the static meshes are sub-allocated from.
+    std::vector<GLuint> geometryBufferIds;
 
-    Internal() {}
+    Internal() : supportedTextureFormats(::getSupportedTextureFormats()),
+                 vertexLayout(::getSupportedVertexLayout()) {}
+
+    ~Internal()
+    {
+        // The meshes only refer to the shared buffers, so it is up to us to delete them.
+        if (!geometryBufferIds.empty())
+        {
+            glDeleteBuffers(static_cast<GLsizei>(geometryBufferIds.size()), geometryBufferIds.data());
+        }
+    }
 
     void loadAssetManifest(const ast::AssetManifest& assetManifest)
     {
+        AST_PROFILE_ZONE("OpenGLAssetManager::loadAssetManifest");
+
+        static const std::string logTag{"ast::OpenGLAssetManager::loadAssetManifest"};
+
+        const auto start{std::chrono::steady_clock::now()};
+
+        // Kick off the CPU side decoding of every new mesh and texture on the worker pool
+        // first, so they can all be decoded in parallel while we compile the pipelines.
+        auto staticMeshJobs{decodeStaticMeshes(assetManifest.staticMeshes)};
+        auto textureJobs{decodeTextures(assetManifest.textures)};
+
         loadPipelines(assetManifest.pipelines);
-        loadStaticMeshes(assetManifest.staticMeshes);
-        loadTextures(assetManifest.textures);
+
+        // OpenGL calls must all happen on the thread that owns the context, so the uploads
+        // are done one at a time here as each decoding job completes.
+        loadStaticMeshes(staticMeshJobs);
+        loadTextures(textureJobs);
+
+        ast::log(logTag, "Loaded " + std::to_string(staticMeshJobs.size()) + " static meshes and " +
+                             std::to_string(textureJobs.size()) + " textures using " +
+                             std::to_string(workerPool.getNumThreads()) + " worker threads in " +
+                             std::to_string(ast::assets::millisecondsSince(start)) + "ms");
     }
 
     void loadPipelines(const std::vector<ast::assets::Pipeline>& pipelines)
@@ -32,30 +153,110 @@ struct OpenGLAssetManager::Internal
         }
     }
 
-    void loadStaticMeshes(const std::vector<ast::assets::StaticMesh>& staticMeshes)
+    std::unordered_map<ast::assets::StaticMesh, std::future<ast::DecodedAsset<ast::EncodedMesh>>> decodeStaticMeshes(
+        const std::vector<ast::assets::StaticMesh>& staticMeshes)
     {
+        std::unordered_map<ast::assets::StaticMesh, std::future<ast::DecodedAsset<ast::EncodedMesh>>> jobs;
+
         for (const auto& staticMesh : staticMeshes)
         {
-            if (staticMeshCache.count(staticMesh) == 0)
+            if (staticMeshCache.count(staticMesh) == 0 && jobs.count(staticMesh) == 0)
             {
-                staticMeshCache.insert(std::make_pair(
+                jobs.insert(std::make_pair(
                     staticMesh,
-                    ast::OpenGLMesh(ast::assets::loadOBJFile(ast::assets::resolveStaticMeshPath(staticMesh)))));
+                    workerPool.submit([this, staticMesh]() { return ast::assets::decodeStaticMesh(staticMesh, vertexLayout); })));
             }
         }
+
+        return jobs;
     }
 
-    void loadTextures(const std::vector<ast::assets::Texture>& textures)
+    std::unordered_map<ast::assets::Texture, std::future<ast::DecodedAsset<ast::TextureData>>> decodeTextures(
+        const std::vector<ast::assets::Texture>& textures)
     {
+        std::unordered_map<ast::assets::Texture, std::future<ast::DecodedAsset<ast::TextureData>>> jobs;
+
         for (const auto& texture : textures)
         {
-            if (textureCache.count(texture) == 0)
+            if (textureCache.count(texture) == 0 && jobs.count(texture) == 0)
             {
-                textureCache.insert(std::pair(
+                jobs.insert(std::make_pair(
                     texture,
-                    ast::OpenGLTexture(ast::assets::loadBitmap(ast::assets::resolveTexturePath(texture)))));
+                    workerPool.submit([this, texture]() {
+                        return ast::assets::decodeTexture(texture, [this](const ast::TextureFormat& format) {
+                            return supportedTextureFormats.count(format) > 0;
+                        });
+                    })));
             }
         }
+
+        return jobs;
+    }
+
+    void loadStaticMeshes(std::unordered_map<ast::assets::StaticMesh, std::future<ast::DecodedAsset<ast::EncodedMesh>>>& jobs)
+    {
+        static const std::string logTag{"ast::OpenGLAssetManager::loadStaticMeshes"};
+
+        if (jobs.empty())
+        {
+            return;
+        }
+
+        const ast::DecodedGeometryPool pool{ast::assets::collectGeometryPool(jobs)};
+        const ast::GeometryPoolLayout& layout{pool.layout};
+
+        ast::log(logTag, "Geometry pool " + std::to_string(geometryBufferIds.size() / 2) + ": " +
+                             ast::meshes::describeGeometryPoolLayout(layout));
+
+        const GLuint vertexBufferId{::createGeometryBuffer(GL_ARRAY_BUFFER, layout.vertexBufferSize)};
+        const GLuint indexBufferId{::createGeometryBuffer(GL_ELEMENT_ARRAY_BUFFER, layout.indexBufferSize)};
+
+        geometryBufferIds.push_back(vertexBufferId);
+        geometryBufferIds.push_back(indexBufferId);
+
+        // Both buffers stay bound from their creation, so each mesh is copied straight in.
+        for (size_t i = 0; i < pool.meshes.size(); i++)
+        {
+            const ast::assets::StaticMesh& staticMesh{pool.meshes[i].first};
+            const ast::DecodedAsset<ast::EncodedMesh>& decodedMesh{pool.meshes[i].second};
+            const ast::GeometryRange& geometryRange{layout.ranges[i]};
+            const auto start{std::chrono::steady_clock::now()};
+
+            ::copyToBuffer(GL_ARRAY_BUFFER,
+                           ast::meshes::getVertexByteOffset(decodedMesh.asset, geometryRange),
+                           decodedMesh.asset.vertices);
+
+            ::copyToBuffer(GL_ELEMENT_ARRAY_BUFFER,
+                           ast::meshes::getIndexByteOffset(decodedMesh.asset, geometryRange),
+                           decodedMesh.asset.indices);
+
+            staticMeshCache.insert(std::make_pair(
+                staticMesh,
+                ast::OpenGLMesh(decodedMesh.asset, vertexBufferId, indexBufferId, geometryRange)));
+
+            ast::log(logTag, "Created " + ast::meshes::getVertexLayoutName(decodedMesh.asset.vertexLayout) +
+                                 " static mesh from " + ast::assets::resolveStaticMeshPath(staticMesh) +
+                                 ast::assets::formatTimings(decodedMesh.decodeMilliseconds, ast::assets::millisecondsSince(start)));
+        }
+    }
+
+    void loadTextures(std::unordered_map<ast::assets::Texture, std::future<ast::DecodedAsset<ast::TextureData>>>& jobs)
+    {
+        static const std::string logTag{"ast::OpenGLAssetManager::loadTextures"};
+
+        for (auto& job : jobs)
+        {
+            const ast::DecodedAsset<ast::TextureData> decodedTexture{job.second.get()};
+            const auto start{std::chrono::steady_clock::now()};
+
+            textureCache.insert(std::pair(
+                job.first,
+                ast::OpenGLTexture(decodedTexture.asset)));
+
+            ast::log(logTag, "Created " + ast::textures::getFormatName(decodedTexture.asset.getFormat()) +
+                                 " texture from " + ast::assets::resolveTexturePath(job.first) +
+                                 ast::assets::formatTimings(decodedTexture.decodeMilliseconds, ast::assets::millisecondsSince(start)));
+        }
     }
 };
 
@@ -79,4 +280,4 @@ const ast::OpenGLMesh& OpenGLAssetManager::getStaticMesh(const ast::assets::Stat
 const ast::OpenGLTexture& OpenGLAssetManager::getTexture(const ast::assets::Texture& texture) const
 {
     return internal->textureCache.at(texture);
-}
+}
\ No newline at end of file
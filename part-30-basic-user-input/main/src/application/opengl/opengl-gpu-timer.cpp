@@ -0,0 +1,243 @@
+#include "opengl-gpu-timer.hpp"
+#include "../../core/gpu-timings.hpp"
+#include "../../core/graphics-wrapper.hpp"
+#include <limits>
+#include <vector>
+
+using ast::OpenGLGpuTimer;
+
+namespace
+{
+    // Results are collected this many frames after their queries were issued, by which time
+    // the GPU has almost always caught up.
+    constexpr size_t queryFrameCount{3};
+
+    // Marks a zone on the stack of open zones which isn't being timed.
+    constexpr size_t untimedZone{std::numeric_limits<size_t>::max()};
+
+    struct TimedZone
+    {
+        std::string name;
+        size_t beginQuery;
+        size_t endQuery;
+    };
+
+    struct FrameQueries
+    {
+        std::vector<GLuint> queries;
+        std::vector<::TimedZone> zones;
+        size_t queryCount;
+    };
+
+    bool isTimerQuerySupported()
+    {
+#ifndef USING_GLES
+        // Contexts without timer queries reject the query target, leaving the bit count at zero.
+        GLint counterBits{0};
+        glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &counterBits);
+
+        // Clear the error raised by an unsupported query target so nobody else trips over it.
+        while (glGetError() != GL_NO_ERROR) {}
+
+        return counterBits > 0;
+#else
+        return false;
+#endif
+    }
+
+    GLuint createQuery()
+    {
+        GLuint queryId{0};
+
+#ifndef USING_GLES
+        glGenQueries(1, &queryId);
+#endif
+
+        return queryId;
+    }
+
+    void writeTimestamp(const GLuint& queryId)
+    {
+#ifndef USING_GLES
+        glQueryCounter(queryId, GL_TIMESTAMP);
+#endif
+    }
+
+    bool isQueryResultAvailable(const GLuint& queryId)
+    {
+#ifndef USING_GLES
+        GLuint available{GL_FALSE};
+        glGetQueryObjectuiv(queryId, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        return available == GL_TRUE;
+#else
+        return false;
+#endif
+    }
+
+    bool areQueryResultsAvailable(const ::FrameQueries& frame)
+    {
+        for (size_t i = 0; i < frame.queryCount; i++)
+        {
+            if (!::isQueryResultAvailable(frame.queries[i]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    uint64_t getTimestamp(const GLuint& queryId)
+    {
+#ifndef USING_GLES
+        GLuint64 timestamp{0};
+        glGetQueryObjectui64v(queryId, GL_QUERY_RESULT, &timestamp);
+
+        return timestamp;
+#else
+        return 0;
+#endif
+    }
+
+    void deleteQueries(const std::vector<GLuint>& queries)
+    {
+#ifndef USING_GLES
+        if (!queries.empty())
+        {
+            glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+        }
+#endif
+    }
+} // namespace
+
+struct OpenGLGpuTimer::Internal
+{
+    const bool supported;
+    std::vector<::FrameQueries> frames;
+    std::vector<size_t> openZones;
+    ast::GpuTimings timings;
+    size_t currentFrameIndex;
+
+    Internal() : supported(::isTimerQuerySupported()),
+                 frames(::queryFrameCount, ::FrameQueries{{}, {}, 0}),
+                 currentFrameIndex(0) {}
+
+    void collectResults(::FrameQueries& frame)
+    {
+        if (frame.zones.empty())
+        {
+            return;
+        }
+
+        // Zones nest, so the last query issued isn't the last one written - the end of the
+        // enclosing frame zone comes after everything inside it. Every query is checked and
+        // the frame is dropped if any result is still pending rather than waiting for the GPU.
+        if (::areQueryResultsAvailable(frame))
+        {
+            for (const auto& zone : frame.zones)
+            {
+                const uint64_t begin{::getTimestamp(frame.queries[zone.beginQuery])};
+                const uint64_t end{::getTimestamp(frame.queries[zone.endQuery])};
+
+                timings.add(zone.name, static_cast<double>(end - begin) / 1000000.0);
+            }
+
+            timings.frameComplete();
+        }
+
+        frame.zones.clear();
+        frame.queryCount = 0;
+    }
+
+    void beginFrame()
+    {
+        currentFrameIndex = (currentFrameIndex + 1) % ::queryFrameCount;
+        openZones.clear();
+
+        // The queries of this frame were issued a few frames ago, so their results can be
+        // collected before they are reused.
+        collectResults(frames[currentFrameIndex]);
+
+        beginZone("Frame");
+    }
+
+    void beginZone(const std::string& name)
+    {
+        if (!supported)
+        {
+            openZones.push_back(::untimedZone);
+            return;
+        }
+
+        ::FrameQueries& frame{frames[currentFrameIndex]};
+
+        // Queries are created as they are first needed and then reused every time around.
+        while (frame.queries.size() < frame.queryCount + 2)
+        {
+            frame.queries.push_back(::createQuery());
+        }
+
+        frame.zones.push_back(::TimedZone{name, frame.queryCount, frame.queryCount + 1});
+        openZones.push_back(frame.zones.size() - 1);
+        frame.queryCount += 2;
+
+        ::writeTimestamp(frame.queries[frame.zones.back().beginQuery]);
+    }
+
+    void endZone()
+    {
+        if (openZones.empty())
+        {
+            return;
+        }
+
+        const size_t zoneIndex{openZones.back()};
+        openZones.pop_back();
+
+        if (zoneIndex != ::untimedZone)
+        {
+            ::FrameQueries& frame{frames[currentFrameIndex]};
+            ::writeTimestamp(frame.queries[frame.zones[zoneIndex].endQuery]);
+        }
+    }
+
+    void endFrame()
+    {
+        // Close any zones which were left open so every query of the frame gets written.
+        while (!openZones.empty())
+        {
+            endZone();
+        }
+    }
+
+    ~Internal()
+    {
+        for (const auto& frame : frames)
+        {
+            ::deleteQueries(frame.queries);
+        }
+    }
+};
+
+OpenGLGpuTimer::OpenGLGpuTimer() : internal(ast::make_internal_ptr<Internal>()) {}
+
+void OpenGLGpuTimer::beginFrame()
+{
+    internal->beginFrame();
+}
+
+void OpenGLGpuTimer::beginZone(const std::string& name)
+{
+    internal->beginZone(name);
+}
+
+void OpenGLGpuTimer::endZone()
+{
+    internal->endZone();
+}
+
+void OpenGLGpuTimer::endFrame()
+{
+    internal->endFrame();
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "../../core/internal-ptr.hpp"
+#include <string>
+
+namespace ast
+{
+    // Measures how long the GPU spends in named zones of each frame with timestamp queries.
+    // Queries are kept for a few frames before their results are collected, and a frame whose
+    // results still aren't available is left out rather than stalling the pipeline. OpenGL ES2
+    // has no timer queries, so there every call quietly does nothing.
+    struct OpenGLGpuTimer
+    {
+        OpenGLGpuTimer();
+
+        void beginFrame();
+
+        void beginZone(const std::string& name);
+
+        void endZone();
+
+        void endFrame();
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
@@ -1,72 +1,38 @@
 #include "opengl-mesh.hpp"
-#include "../../core/glm-wrapper.hpp"
 #include <vector>
 
 using ast::OpenGLMesh;
 
-namespace
-{
-    GLuint createVertexBuffer(const ast::Mesh& mesh)
-    {
-        std::vector<float> bufferData;
-
-        for (const auto& vertex : mesh.getVertices())
-        {
-			// Position
-            bufferData.push_back(vertex.position.x);
-            bufferData.push_back(vertex.position.y);
-            bufferData.push_back(vertex.position.z);
-
-			// Texture coordinate
-            bufferData.push_back(vertex.texCoord.x);
-            bufferData.push_back(vertex.texCoord.y);
-        }
-
-        GLuint bufferId;
-        glGenBuffers(1, &bufferId);
-        glBindBuffer(GL_ARRAY_BUFFER, bufferId);
-        glBufferData(GL_ARRAY_BUFFER,
-                     bufferData.size() * sizeof(float),
-                     bufferData.data(),
-                     GL_STATIC_DRAW);
-
-        return bufferId;
-    }
-
-    GLuint createIndexBuffer(const ast::Mesh& mesh)
-    {
-        GLuint bufferId;
-        glGenBuffers(1, &bufferId);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferId);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                     mesh.getIndices().size() * sizeof(uint32_t),
-                     mesh.getIndices().data(),
-                     GL_STATIC_DRAW);
-
-        return bufferId;
-    }
-} // namespace
-
 struct OpenGLMesh::Internal
 {
     const GLuint bufferIdVertices;
     const GLuint bufferIdIndices;
-    const uint32_t numIndices;
-
-    Internal(const ast::Mesh& mesh)
-        : bufferIdVertices(::createVertexBuffer(mesh)),
-          bufferIdIndices(::createIndexBuffer(mesh)),
-          numIndices(static_cast<uint32_t>(mesh.getIndices().size())) {}
-
-    ~Internal()
-    {
-        glDeleteBuffers(1, &bufferIdVertices);
-        glDeleteBuffers(1, &bufferIdIndices);
-    }
+    const ast::GeometryRange geometryRange;
+    const std::vector<ast::MeshLevelOfDetail> levels;
+    const GLenum indexType;
+    const ast::VertexLayout vertexLayout;
+    const ast::VertexDequantization dequantization;
+    const ast::BoundingBox boundingBox;
+
+    Internal(const ast::EncodedMesh& mesh,
+             const GLuint& vertexBufferId,
+             const GLuint& indexBufferId,
+             const ast::GeometryRange& geometryRange)
+        : bufferIdVertices(vertexBufferId),
+          bufferIdIndices(indexBufferId),
+          geometryRange(geometryRange),
+          levels(mesh.levels),
+          indexType(mesh.indexFormat == ast::IndexFormat::Uint16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT),
+          vertexLayout(mesh.vertexLayout),
+          dequantization(mesh.dequantization),
+          boundingBox(mesh.boundingBox) {}
 };
 
-OpenGLMesh::OpenGLMesh(const ast::Mesh& mesh)
-    : internal(ast::make_internal_ptr<Internal>(mesh)) {}
+OpenGLMesh::OpenGLMesh(const ast::EncodedMesh& mesh,
+                       const GLuint& vertexBufferId,
+                       const GLuint& indexBufferId,
+                       const ast::GeometryRange& geometryRange)
+    : internal(ast::make_internal_ptr<Internal>(mesh, vertexBufferId, indexBufferId, geometryRange)) {}
 
 const GLuint& OpenGLMesh::getVertexBufferId() const
 {
@@ -78,8 +44,38 @@ const GLuint& OpenGLMesh::getIndexBufferId() const
     return internal->bufferIdIndices;
 }
 
+const ast::GeometryRange& OpenGLMesh::getGeometryRange() const
+{
+    return internal->geometryRange;
+}
+
 const uint32_t& OpenGLMesh::getNumIndices() const
 {
 
-    return internal->numIndices;
+    return internal->geometryRange.numIndices;
+}
+
+const std::vector<ast::MeshLevelOfDetail>& OpenGLMesh::getLevels() const
+{
+    return internal->levels;
+}
+
+const GLenum& OpenGLMesh::getIndexType() const
+{
+    return internal->indexType;
+}
+
+const ast::VertexLayout& OpenGLMesh::getVertexLayout() const
+{
+    return internal->vertexLayout;
+}
+
+const ast::VertexDequantization& OpenGLMesh::getDequantization() const
+{
+    return internal->dequantization;
+}
+
+const ast::BoundingBox& OpenGLMesh::getBoundingBox() const
+{
+    return internal->boundingBox;
 }
\ No newline at end of file
@@ -2,20 +2,37 @@
 
 #include "../../core/graphics-wrapper.hpp"
 #include "../../core/internal-ptr.hpp"
-#include "../../core/mesh.hpp"
+#include "../../core/mesh-encoder.hpp"
 
 namespace ast
 {
+    // A static mesh whose vertices and indices live in vertex and index buffers shared with
+    // other meshes. The mesh does not own those buffers, so they must outlive it.
     struct OpenGLMesh
     {
-        OpenGLMesh(const ast::Mesh& mesh);
+        OpenGLMesh(const ast::EncodedMesh& mesh,
+                   const GLuint& vertexBufferId,
+                   const GLuint& indexBufferId,
+                   const ast::GeometryRange& geometryRange);
 
         const GLuint& getVertexBufferId() const;
 
         const GLuint& getIndexBufferId() const;
 
+        const ast::GeometryRange& getGeometryRange() const;
+
         const uint32_t& getNumIndices() const;
 
+        const std::vector<ast::MeshLevelOfDetail>& getLevels() const;
+
+        const GLenum& getIndexType() const;
+
+        const ast::VertexLayout& getVertexLayout() const;
+
+        const ast::VertexDequantization& getDequantization() const;
+
+        const ast::BoundingBox& getBoundingBox() const;
+
     private:
         struct Internal;
         ast::internal_ptr<Internal> internal;
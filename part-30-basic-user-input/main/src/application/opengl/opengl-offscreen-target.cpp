@@ -0,0 +1,223 @@
+#include "opengl-offscreen-target.hpp"
+#include "../../core/graphics-wrapper.hpp"
+#include "../../core/headless.hpp"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using ast::OpenGLOffscreenTarget;
+
+namespace
+{
+#ifndef USING_GLES
+    // Pixel buffers let a frame be read back without stalling, so we keep a few of them and
+    // only map each one a couple of frames after the read into it was issued.
+    constexpr size_t pixelBufferCount{3};
+#endif
+
+    size_t getFrameByteSize(const ast::WindowSize& frameSize)
+    {
+        return static_cast<size_t>(frameSize.width) * frameSize.height * 4;
+    }
+
+    GLuint createColorTexture(const ast::WindowSize& frameSize)
+    {
+        GLuint textureId;
+
+        // An RGBA texture is used for the color attachment rather than a render buffer, as
+        // OpenGL ES2 doesn't guarantee 8 bit RGBA render buffers.
+        glGenTextures(1, &textureId);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(
+            GL_TEXTURE_2D,
+            0,
+            GL_RGBA,
+            frameSize.width,
+            frameSize.height,
+            0,
+            GL_RGBA,
+            GL_UNSIGNED_BYTE,
+            nullptr);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        return textureId;
+    }
+
+    GLuint createDepthRenderbuffer(const ast::WindowSize& frameSize)
+    {
+        GLuint renderbufferId;
+
+        glGenRenderbuffers(1, &renderbufferId);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbufferId);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, frameSize.width, frameSize.height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        return renderbufferId;
+    }
+
+    GLuint createFramebuffer(const GLuint& colorTextureId, const GLuint& depthRenderbufferId)
+    {
+        static const std::string logTag{"ast::OpenGLOffscreenTarget::createFramebuffer"};
+
+        GLuint framebufferId;
+
+        glGenFramebuffers(1, &framebufferId);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTextureId, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderbufferId);
+
+        const GLenum status{glCheckFramebufferStatus(GL_FRAMEBUFFER)};
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            throw std::runtime_error(logTag + ": Offscreen framebuffer is incomplete.");
+        }
+
+        return framebufferId;
+    }
+
+#ifndef USING_GLES
+    std::vector<GLuint> createPixelBuffers(const ast::WindowSize& frameSize)
+    {
+        std::vector<GLuint> bufferIds(::pixelBufferCount);
+
+        glGenBuffers(static_cast<GLsizei>(bufferIds.size()), bufferIds.data());
+
+        for (const auto& bufferId : bufferIds)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, bufferId);
+            glBufferData(GL_PIXEL_PACK_BUFFER, ::getFrameByteSize(frameSize), nullptr, GL_STREAM_READ);
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        return bufferIds;
+    }
+#endif
+} // namespace
+
+struct OpenGLOffscreenTarget::Internal
+{
+    const ast::WindowSize frameSize;
+    const GLuint colorTextureId;
+    const GLuint depthRenderbufferId;
+    const GLuint framebufferId;
+#ifdef USING_GLES
+    std::vector<uint8_t> pixels;
+#else
+    const std::vector<GLuint> pixelBufferIds;
+    std::vector<bool> readbacksPending;
+    size_t pixelBufferIndex;
+#endif
+
+    Internal(const ast::WindowSize& frameSize)
+        : frameSize(frameSize),
+          colorTextureId(::createColorTexture(frameSize)),
+          depthRenderbufferId(::createDepthRenderbuffer(frameSize)),
+          framebufferId(::createFramebuffer(colorTextureId, depthRenderbufferId)),
+#ifdef USING_GLES
+          pixels(::getFrameByteSize(frameSize))
+#else
+          pixelBufferIds(::createPixelBuffers(frameSize)),
+          readbacksPending(pixelBufferIds.size(), false),
+          pixelBufferIndex(0)
+#endif
+    {
+    }
+
+    void bind() const
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+        glViewport(0, 0, frameSize.width, frameSize.height);
+    }
+
+    void readback()
+    {
+#ifdef USING_GLES
+        // OpenGL ES2 has no pixel buffers, so the only option is to read the frame straight
+        // into memory, which waits for the GPU to finish rendering it.
+        glReadPixels(0, 0, frameSize.width, frameSize.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        ast::headless::onFrameReadback(frameSize, pixels.data(), true);
+#else
+        // Start reading the frame into the current pixel buffer, which returns straight away
+        // as the copy happens on the GPU once it has finished rendering the frame.
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBufferIds[pixelBufferIndex]);
+        glReadPixels(0, 0, frameSize.width, frameSize.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        readbacksPending[pixelBufferIndex] = true;
+
+        // The next pixel buffer along was read into the longest time ago, so by now its copy
+        // should be complete and mapping it won't stall.
+        pixelBufferIndex = (pixelBufferIndex + 1) % pixelBufferIds.size();
+        deliverPixelBuffer(pixelBufferIndex);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+#endif
+    }
+
+    void finishReadbacks()
+    {
+#ifndef USING_GLES
+        // Frames still sitting in pixel buffers would otherwise never be delivered, so hand them
+        // over oldest first, waiting for any copies that are yet to complete.
+        for (size_t i = 0; i < pixelBufferIds.size(); i++)
+        {
+            deliverPixelBuffer((pixelBufferIndex + i) % pixelBufferIds.size());
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+#endif
+    }
+
+#ifndef USING_GLES
+    void deliverPixelBuffer(const size_t& index)
+    {
+        if (!readbacksPending[index])
+        {
+            return;
+        }
+
+        // Desktop contexts are only OpenGL 2.1, which can map a whole buffer but not a range.
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBufferIds[index]);
+        const void* pixels{glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY)};
+
+        if (pixels)
+        {
+            ast::headless::onFrameReadback(frameSize, static_cast<const uint8_t*>(pixels), true);
+        }
+
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        readbacksPending[index] = false;
+    }
+#endif
+
+    ~Internal()
+    {
+#ifndef USING_GLES
+        glDeleteBuffers(static_cast<GLsizei>(pixelBufferIds.size()), pixelBufferIds.data());
+#endif
+        glDeleteFramebuffers(1, &framebufferId);
+        glDeleteRenderbuffers(1, &depthRenderbufferId);
+        glDeleteTextures(1, &colorTextureId);
+    }
+};
+
+OpenGLOffscreenTarget::OpenGLOffscreenTarget(const ast::WindowSize& frameSize)
+    : internal(ast::make_internal_ptr<Internal>(frameSize)) {}
+
+void OpenGLOffscreenTarget::bind() const
+{
+    internal->bind();
+}
+
+void OpenGLOffscreenTarget::readback()
+{
+    internal->readback();
+}
+
+void OpenGLOffscreenTarget::finishReadbacks()
+{
+    internal->finishReadbacks();
+}
\ No newline at end of file
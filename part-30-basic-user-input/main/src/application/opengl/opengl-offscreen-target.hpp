@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../../core/internal-ptr.hpp"
+#include "../../core/window-size.hpp"
+
+namespace ast
+{
+    // Stands in for the window's default framebuffer when rendering headless, so frames are
+    // rendered into a framebuffer object and read back instead of being presented.
+    struct OpenGLOffscreenTarget
+    {
+        OpenGLOffscreenTarget(const ast::WindowSize& frameSize);
+
+        void bind() const;
+
+        void readback();
+
+        // Delivers every frame which has been read into a pixel buffer but not yet handed over,
+        // which has to happen before the target is destroyed or the last frames are lost.
+        void finishReadbacks();
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
@@ -1,21 +1,74 @@
 #include "opengl-pipeline.hpp"
-#include "../../core/assets.hpp"
+#include "../../core/asset-file.hpp"
 #include "../../core/log.hpp"
-#include "opengl-asset-manager.hpp"
+#include "opengl-mesh.hpp"
+#include <array>
 #include <stdexcept>
 #include <vector>
 
+// OpenGL ES 2 only reads half float vertex attributes through an extension, which gives the type
+// a different value to the one desktop OpenGL later adopted into its core.
+#ifdef USING_GLES
+#ifndef GL_HALF_FLOAT_OES
+#define GL_HALF_FLOAT_OES 0x8d61
+#endif
+#define AST_GL_HALF_FLOAT GL_HALF_FLOAT_OES
+#else
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140b
+#endif
+#define AST_GL_HALF_FLOAT GL_HALF_FLOAT
+#endif
+
 using ast::OpenGLPipeline;
 
 namespace
 {
-    GLuint compileShader(const GLenum& shaderType, const std::string& shaderSource)
+    GLenum getPositionType(const ast::VertexLayout& layout)
+    {
+        switch (layout)
+        {
+            case ast::VertexLayout::Snorm16:
+                return GL_SHORT;
+            case ast::VertexLayout::Half:
+                return AST_GL_HALF_FLOAT;
+            default:
+                return GL_FLOAT;
+        }
+    }
+
+    glm::vec3 getPositionScale(const ast::OpenGLMesh& mesh)
+    {
+        const glm::vec3 scale{mesh.getDequantization().positionScale};
+
+        // Signed normalised positions are read as plain shorts, because OpenGL before 4.2 and
+        // OpenGL ES 2 normalise them so that zero is not exactly representable. Folding the
+        // normalisation into the scale gives the same result on every version.
+        if (mesh.getVertexLayout() == ast::VertexLayout::Snorm16)
+        {
+            return scale / 32767.0f;
+        }
+
+        return scale;
+    }
+
+    GLuint compileShader(const GLenum& shaderType, const std::string& shaderPrefix, const ast::AssetFile& shaderFile)
     {
         const std::string logTag{"ast::OpenGLPipeline::compileShader"};
         GLuint shaderId{glCreateShader(shaderType)};
 
-        const char* shaderData{shaderSource.c_str()};
-        glShaderSource(shaderId, 1, &shaderData, nullptr);
+        // OpenGL accepts the shader source as a list of strings which it joins together, so we
+        // can pass our platform prefix and the file content separately and avoid building a
+        // combined copy. The file content is not null terminated so we give explicit lengths.
+        const std::array<const GLchar*, 2> shaderData{
+            shaderPrefix.c_str(),
+            shaderFile.getData()};
+
+        const std::array<GLint, 2> shaderDataLengths{
+            static_cast<GLint>(shaderPrefix.size()),
+            static_cast<GLint>(shaderFile.getSize())};
+
+        glShaderSource(shaderId, 2, shaderData.data(), shaderDataLengths.data());
         glCompileShader(shaderId);
 
         GLint shaderCompilationResult;
@@ -40,20 +93,20 @@ namespace
 
         ast::log(logTag, "Creating pipeline for '" + shaderName + "'");
 
-        const std::string vertexShaderCode{ast::assets::loadTextFile("assets/shaders/opengl/" + shaderName + ".vert")};
-        const std::string fragmentShaderCode{ast::assets::loadTextFile("assets/shaders/opengl/" + shaderName + ".frag")};
+        const ast::AssetFile vertexShaderFile("assets/shaders/opengl/" + shaderName + ".vert");
+        const ast::AssetFile fragmentShaderFile("assets/shaders/opengl/" + shaderName + ".frag");
 
 #ifdef USING_GLES
-        std::string vertexShaderSource{"#version 100\n" + vertexShaderCode};
-        std::string fragmentShaderSource{"#version 100\nprecision mediump float;\n" + fragmentShaderCode};
+        const std::string vertexShaderPrefix{"#version 100\n"};
+        const std::string fragmentShaderPrefix{"#version 100\nprecision mediump float;\n"};
 #else
-        std::string vertexShaderSource{"#version 120\n" + vertexShaderCode};
-        std::string fragmentShaderSource{"#version 120\n" + fragmentShaderCode};
+        const std::string vertexShaderPrefix{"#version 120\n"};
+        const std::string fragmentShaderPrefix{"#version 120\n"};
 #endif
 
         GLuint shaderProgramId{glCreateProgram()};
-        GLuint vertexShaderId{::compileShader(GL_VERTEX_SHADER, vertexShaderSource)};
-        GLuint fragmentShaderId{::compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource)};
+        GLuint vertexShaderId{::compileShader(GL_VERTEX_SHADER, vertexShaderPrefix, vertexShaderFile)};
+        GLuint fragmentShaderId{::compileShader(GL_FRAGMENT_SHADER, fragmentShaderPrefix, fragmentShaderFile)};
 
         glAttachShader(shaderProgramId, vertexShaderId);
         glAttachShader(shaderProgramId, fragmentShaderId);
@@ -85,24 +138,22 @@ struct OpenGLPipeline::Internal
 {
     const GLuint shaderProgramId;
     const GLuint uniformLocationMVP;
+    const GLuint uniformLocationPositionScale;
+    const GLuint uniformLocationPositionOffset;
+    const GLuint uniformLocationTexCoordScaleOffset;
     const GLuint attributeLocationVertexPosition;
     const GLuint attributeLocationTexCoord;
-    const GLsizei stride;
-    const GLsizei offsetPosition;
-    const GLsizei offsetTexCoord;
 
     Internal(const std::string& shaderName)
         : shaderProgramId(::createShaderProgram(shaderName)),
           uniformLocationMVP(glGetUniformLocation(shaderProgramId, "u_mvp")),
+          uniformLocationPositionScale(glGetUniformLocation(shaderProgramId, "u_positionScale")),
+          uniformLocationPositionOffset(glGetUniformLocation(shaderProgramId, "u_positionOffset")),
+          uniformLocationTexCoordScaleOffset(glGetUniformLocation(shaderProgramId, "u_texCoordScaleOffset")),
           attributeLocationVertexPosition(glGetAttribLocation(shaderProgramId, "a_vertexPosition")),
-          attributeLocationTexCoord(glGetAttribLocation(shaderProgramId, "a_texCoord")),
-          stride(5 * sizeof(float)),
-          offsetPosition(0),
-          offsetTexCoord(3 * sizeof(float)) {}
-
-    void render(
-        const ast::OpenGLAssetManager& assetManager,
-        const std::vector<ast::StaticMeshInstance>& staticMeshInstances) const
+          attributeLocationTexCoord(glGetAttribLocation(shaderProgramId, "a_texCoord")) {}
+
+    void bind() const
     {
         // Instruct OpenGL to starting using our shader program.
         glUseProgram(shaderProgramId);
@@ -112,46 +163,67 @@ struct OpenGLPipeline::Internal
 
         // Enable the 'a_texCoord' attribute.
         glEnableVertexAttribArray(attributeLocationTexCoord);
+    }
 
-        for (const auto& staticMeshInstance : staticMeshInstances)
-        {
-            const ast::OpenGLMesh& mesh = assetManager.getStaticMesh(staticMeshInstance.getMesh());
-
-            // Populate the 'u_mvp' uniform in the shader program.
-            glUniformMatrix4fv(uniformLocationMVP, 1, GL_FALSE, &staticMeshInstance.getTransformMatrix()[0][0]);
-
-            // Apply the texture we want to paint the mesh with.
-            assetManager.getTexture(staticMeshInstance.getTexture()).bind();
-
-            // Bind the vertex and index buffers.
-            glBindBuffer(GL_ARRAY_BUFFER, mesh.getVertexBufferId());
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.getIndexBufferId());
-
-            // Configure the 'a_vertexPosition' attribute.
-            glVertexAttribPointer(
-				attributeLocationVertexPosition,
-				3,
-				GL_FLOAT,
-				GL_FALSE,
-				stride,
-				reinterpret_cast<const GLvoid*>(offsetPosition));
-
-            // Configure the 'a_texCoord' attribute.
-            glVertexAttribPointer(attributeLocationTexCoord,
-				2,
-				GL_FLOAT,
-				GL_FALSE,
-				stride,
-				reinterpret_cast<const GLvoid*>(offsetTexCoord));
-
-            // Execute the draw command - with how many indices to iterate.
-            glDrawElements(
-				GL_TRIANGLES,
-				mesh.getNumIndices(),
-				GL_UNSIGNED_INT,
-				reinterpret_cast<const GLvoid*>(0));
-        }
+    void bindMesh(const ast::OpenGLMesh& mesh) const
+    {
+        const ast::VertexLayout& layout{mesh.getVertexLayout()};
+        const GLsizei stride{static_cast<GLsizei>(ast::meshes::getVertexSize(layout))};
+        const bool isCompact{layout != ast::VertexLayout::Float32};
+
+        // OpenGL ES 2 has no way to add a base vertex to each index, so the attributes are
+        // pointed at where the vertices of the mesh start within the shared vertex buffer.
+        const size_t offsetVertices{static_cast<size_t>(mesh.getGeometryRange().vertexOffset) * stride};
+        const size_t offsetPosition{offsetVertices + ast::meshes::getPositionOffset(layout)};
+        const size_t offsetTexCoord{offsetVertices + ast::meshes::getTexCoordOffset(layout)};
+
+        // Configure the 'a_vertexPosition' attribute.
+        glVertexAttribPointer(
+			attributeLocationVertexPosition,
+			3,
+			::getPositionType(layout),
+			GL_FALSE,
+			stride,
+			reinterpret_cast<const GLvoid*>(offsetPosition));
+
+        // Configure the 'a_texCoord' attribute, which compact layouts store as unsigned normalised shorts.
+        glVertexAttribPointer(attributeLocationTexCoord,
+			2,
+			isCompact ? GL_UNSIGNED_SHORT : GL_FLOAT,
+			isCompact ? GL_TRUE : GL_FALSE,
+			stride,
+			reinterpret_cast<const GLvoid*>(offsetTexCoord));
+
+        // Populate the uniforms which recover the original vertex attributes in the shader.
+        const ast::VertexDequantization& dequantization{mesh.getDequantization()};
+        const glm::vec3 positionScale{::getPositionScale(mesh)};
+        const glm::vec3 positionOffset{dequantization.positionOffset};
+
+        glUniform3fv(uniformLocationPositionScale, 1, &positionScale[0]);
+        glUniform3fv(uniformLocationPositionOffset, 1, &positionOffset[0]);
+        glUniform4fv(uniformLocationTexCoordScaleOffset, 1, &dequantization.texCoordScaleOffset[0]);
+    }
+
+    void draw(const ast::OpenGLMesh& mesh, const ast::MeshLevelOfDetail& level, const glm::mat4& transform) const
+    {
+        // Populate the 'u_mvp' uniform in the shader program.
+        glUniformMatrix4fv(uniformLocationMVP, 1, GL_FALSE, &transform[0][0]);
+
+        // The level of detail is a range within the indices of the mesh, which are themselves a
+        // range within the shared index buffer, given as a byte offset.
+        const size_t indexSize{mesh.getIndexType() == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t)};
+        const size_t firstIndex{mesh.getGeometryRange().firstIndex + level.firstIndex};
+
+        // Execute the draw command - with how many indices to iterate.
+        glDrawElements(
+			GL_TRIANGLES,
+			level.numIndices,
+			mesh.getIndexType(),
+			reinterpret_cast<const GLvoid*>(firstIndex * indexSize));
+    }
 
+    void unbind() const
+    {
         // Tidy up.
         glDisableVertexAttribArray(attributeLocationVertexPosition);
         glDisableVertexAttribArray(attributeLocationTexCoord);
@@ -166,9 +238,24 @@ struct OpenGLPipeline::Internal
 OpenGLPipeline::OpenGLPipeline(const std::string& shaderName)
     : internal(ast::make_internal_ptr<Internal>(shaderName)) {}
 
-void OpenGLPipeline::render(
-    const ast::OpenGLAssetManager& assetManager,
-    const std::vector<ast::StaticMeshInstance>& staticMeshInstances) const
+void OpenGLPipeline::bind() const
 {
-    internal->render(assetManager, staticMeshInstances);
+    internal->bind();
 }
+
+void OpenGLPipeline::bindMesh(const ast::OpenGLMesh& mesh) const
+{
+    internal->bindMesh(mesh);
+}
+
+void OpenGLPipeline::draw(const ast::OpenGLMesh& mesh,
+                          const ast::MeshLevelOfDetail& level,
+                          const glm::mat4& transform) const
+{
+    internal->draw(mesh, level, transform);
+}
+
+void OpenGLPipeline::unbind() const
+{
+    internal->unbind();
+}
\ No newline at end of file
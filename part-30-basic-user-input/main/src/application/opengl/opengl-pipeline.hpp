@@ -1,21 +1,29 @@
 #pragma once
 
 #include "../../core/internal-ptr.hpp"
-#include "../../core/static-mesh-instance.hpp"
+#include "../../core/glm-wrapper.hpp"
+#include "../../core/mesh.hpp"
 #include <string>
-#include <vector>
 
 namespace ast
 {
-    struct OpenGLAssetManager;
+    struct OpenGLMesh;
 
     struct OpenGLPipeline
     {
         OpenGLPipeline(const std::string& shaderName);
 
-        void render(
-            const ast::OpenGLAssetManager& assetManager,
-            const std::vector<ast::StaticMeshInstance>& staticMeshInstances) const;
+        void bind() const;
+
+        // Points the vertex attributes at the vertices of the mesh, so the shared vertex buffer
+        // the mesh lives in must already be bound.
+        void bindMesh(const ast::OpenGLMesh& mesh) const;
+
+        void draw(const ast::OpenGLMesh& mesh,
+                  const ast::MeshLevelOfDetail& level,
+                  const glm::mat4& transform) const;
+
+        void unbind() const;
 
     private:
         struct Internal;
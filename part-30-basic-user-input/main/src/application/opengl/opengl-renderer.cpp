@@ -1,27 +1,148 @@
 #include "opengl-renderer.hpp"
+#include "../../core/assets.hpp"
+#include "../../core/render-queue.hpp"
+#include "../../core/profiler.hpp"
+#include "../../core/static-mesh-culling.hpp"
 
 using ast::OpenGLRenderer;
 
 struct OpenGLRenderer::Internal
 {
     const std::shared_ptr<ast::OpenGLAssetManager> assetManager;
+    const std::shared_ptr<ast::OpenGLGpuTimer> gpuTimer;
+    ast::RenderQueue renderQueue;
+    std::vector<uint32_t> visibleInstances;
+    std::vector<uint32_t> visibleInstanceLevels;
 
-    Internal(std::shared_ptr<ast::OpenGLAssetManager> assetManager) : assetManager(assetManager) {}
+    Internal(std::shared_ptr<ast::OpenGLAssetManager> assetManager,
+             std::shared_ptr<ast::OpenGLGpuTimer> gpuTimer)
+        : assetManager(assetManager),
+          gpuTimer(gpuTimer),
+          renderQueue(ast::RenderQueue()) {}
 
     void render(
         const ast::assets::Pipeline& pipeline,
-        const std::vector<ast::StaticMeshInstance>& staticMeshInstances)
+        const ast::StaticMeshInstanceStore& staticMeshInstances,
+        const std::vector<uint32_t>& instanceIndices,
+        const std::vector<uint32_t>& instanceLevels)
     {
-        assetManager->getPipeline(pipeline).render(*assetManager, staticMeshInstances);
+        AST_PROFILE_ZONE("OpenGLRenderer::render");
+
+        renderQueue.add(pipeline, staticMeshInstances, instanceIndices, instanceLevels);
+    }
+
+    void flush()
+    {
+        AST_PROFILE_ZONE("OpenGLRenderer::flush");
+
+        renderQueue.sort();
+
+        const std::vector<glm::mat4>& transforms{renderQueue.getTransforms()};
+        const ast::OpenGLPipeline* activePipeline{nullptr};
+
+        // Meshes are sub-allocated from shared geometry buffers, so the buffers only need to be
+        // bound again when a mesh comes from a different pool.
+        GLuint boundVertexBufferId{0};
+        GLuint boundIndexBufferId{0};
+
+        gpuTimer->beginZone("Render queue");
+
+        for (const ast::RenderBatch& batch : renderQueue.getBatches())
+        {
+            const ast::OpenGLPipeline& pipeline{assetManager->getPipeline(batch.pipeline)};
+            const ast::OpenGLMesh& mesh{assetManager->getStaticMesh(batch.mesh)};
+            const ast::MeshLevelOfDetail& level{mesh.getLevels()[batch.level]};
+
+            if (renderQueue.bindPipeline(batch.pipeline))
+            {
+                if (activePipeline)
+                {
+                    activePipeline->unbind();
+                    gpuTimer->endZone();
+                }
+
+                // Batches are sorted by pipeline, so each pipeline gets one GPU zone around its draws.
+                gpuTimer->beginZone("Pipeline: " + ast::assets::resolvePipelinePath(batch.pipeline));
+                pipeline.bind();
+                activePipeline = &pipeline;
+            }
+
+            if (renderQueue.bindTexture(batch.texture))
+            {
+                assetManager->getTexture(batch.texture).bind();
+            }
+
+            if (renderQueue.bindMesh(batch.mesh))
+            {
+                if (mesh.getVertexBufferId() != boundVertexBufferId)
+                {
+                    glBindBuffer(GL_ARRAY_BUFFER, mesh.getVertexBufferId());
+                    boundVertexBufferId = mesh.getVertexBufferId();
+                }
+
+                if (mesh.getIndexBufferId() != boundIndexBufferId)
+                {
+                    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.getIndexBufferId());
+                    boundIndexBufferId = mesh.getIndexBufferId();
+                }
+
+                pipeline.bindMesh(mesh);
+            }
+
+            // OpenGL ES2 and OpenGL 2.1 have no instanced draw commands, so each instance in
+            // the batch is still drawn individually, but only its transform changes in between.
+            for (uint32_t i = 0; i < batch.instanceCount; i++)
+            {
+                pipeline.draw(mesh, level, transforms[batch.firstInstance + i]);
+            }
+        }
+
+        if (activePipeline)
+        {
+            activePipeline->unbind();
+            gpuTimer->endZone();
+        }
+
+        gpuTimer->endZone();
+        renderQueue.reset();
     }
 };
 
-OpenGLRenderer::OpenGLRenderer(std::shared_ptr<ast::OpenGLAssetManager> assetManager)
-    : internal(ast::make_internal_ptr<Internal>(assetManager)) {}
+OpenGLRenderer::OpenGLRenderer(std::shared_ptr<ast::OpenGLAssetManager> assetManager,
+                               std::shared_ptr<ast::OpenGLGpuTimer> gpuTimer)
+    : internal(ast::make_internal_ptr<Internal>(assetManager, gpuTimer)) {}
+
+const ast::BoundingBox& OpenGLRenderer::getStaticMeshBounds(const ast::assets::StaticMesh& staticMesh) const
+{
+    return internal->assetManager->getStaticMesh(staticMesh).getBoundingBox();
+}
+
+const std::vector<ast::MeshLevelOfDetail>& OpenGLRenderer::getStaticMeshLevels(const ast::assets::StaticMesh& staticMesh) const
+{
+    return internal->assetManager->getStaticMesh(staticMesh).getLevels();
+}
 
 void OpenGLRenderer::render(
     const ast::assets::Pipeline& pipeline,
-    const std::vector<ast::StaticMeshInstance>& staticMeshInstances)
+    const ast::StaticMeshInstanceStore& staticMeshInstances,
+    const std::vector<uint32_t>& instanceIndices,
+    const std::vector<uint32_t>& instanceLevels)
+{
+    internal->render(pipeline, staticMeshInstances, instanceIndices, instanceLevels);
+}
+
+void OpenGLRenderer::renderVisible(
+    const ast::assets::Pipeline& pipeline,
+    const ast::StaticMeshInstanceStore& staticMeshInstances,
+    const ast::RenderView& view)
+{
+    // There are no compute shaders in OpenGL ES 2, so the instances are always culled on the CPU.
+    ast::cullStaticMeshInstances(*this, staticMeshInstances, view, internal->visibleInstances, internal->visibleInstanceLevels);
+
+    render(pipeline, staticMeshInstances, internal->visibleInstances, internal->visibleInstanceLevels);
+}
+
+void OpenGLRenderer::flush()
 {
-    internal->render(pipeline, staticMeshInstances);
+    internal->flush();
 }
@@ -3,17 +3,32 @@
 #include "../../core/internal-ptr.hpp"
 #include "../../core/renderer.hpp"
 #include "opengl-asset-manager.hpp"
+#include "opengl-gpu-timer.hpp"
 #include <memory>
 
 namespace ast
 {
     struct OpenGLRenderer : public ast::Renderer
     {
-        OpenGLRenderer(std::shared_ptr<ast::OpenGLAssetManager> assetManager);
+        OpenGLRenderer(std::shared_ptr<ast::OpenGLAssetManager> assetManager,
+                       std::shared_ptr<ast::OpenGLGpuTimer> gpuTimer);
+
+        const ast::BoundingBox& getStaticMeshBounds(const ast::assets::StaticMesh& staticMesh) const override;
+
+        const std::vector<ast::MeshLevelOfDetail>& getStaticMeshLevels(const ast::assets::StaticMesh& staticMesh) const override;
 
         void render(
             const ast::assets::Pipeline& pipeline,
-            const std::vector<ast::StaticMeshInstance>& staticMeshInstances) override;
+            const ast::StaticMeshInstanceStore& staticMeshInstances,
+            const std::vector<uint32_t>& instanceIndices,
+            const std::vector<uint32_t>& instanceLevels) override;
+
+        void renderVisible(
+            const ast::assets::Pipeline& pipeline,
+            const ast::StaticMeshInstanceStore& staticMeshInstances,
+            const ast::RenderView& view) override;
+
+        void flush();
 
     private:
         struct Internal;
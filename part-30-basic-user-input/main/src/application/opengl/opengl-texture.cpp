@@ -1,29 +1,86 @@
 #include "opengl-texture.hpp"
 #include "../../core/graphics-wrapper.hpp"
+#include <stdexcept>
+#include <vector>
+
+// Not every platform's headers define the compressed formats we can upload, so we take their
+// values from the S3TC and ETC1 extensions that introduce them.
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83f0
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83f3
+#endif
+
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES 0x8d64
+#endif
 
 using ast::OpenGLTexture;
 
 namespace
 {
-    GLuint createTexture(const ast::Bitmap& bitmap)
+    GLenum getCompressedFormat(const ast::TextureFormat& format)
+    {
+        switch (format)
+        {
+            case ast::TextureFormat::BC1:
+                return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            case ast::TextureFormat::BC3:
+                return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case ast::TextureFormat::ETC2RGB8:
+                // Our baked ETC2 RGB8 blocks only use the modes it shares with ETC1.
+                return GL_ETC1_RGB8_OES;
+            default:
+                throw std::runtime_error("ast::OpenGLTexture::getCompressedFormat: Format not supported by OpenGL.");
+        }
+    }
+
+    GLuint createTexture(const ast::TextureData& textureData)
     {
         GLuint textureId;
 
         glGenTextures(1, &textureId);
         glBindTexture(GL_TEXTURE_2D, textureId);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RGBA,
-            bitmap.getWidth(),
-            bitmap.getHeight(),
-            0,
-            GL_RGBA,
-            GL_UNSIGNED_BYTE,
-            bitmap.getPixelData());
-        glGenerateMipmap(GL_TEXTURE_2D);
+
+        // The whole mip chain arrives prebuilt, so each level is uploaded as is rather than
+        // having the driver generate them. Block compressed levels stay compressed on the GPU.
+        const std::vector<ast::TextureMipLevel>& mipLevels{textureData.getMipLevels()};
+
+        for (size_t level = 0; level < mipLevels.size(); level++)
+        {
+            const ast::TextureMipLevel& mipLevel{mipLevels[level]};
+            const char* pixelData{textureData.getData() + mipLevel.offset};
+
+            if (textureData.getFormat() == ast::TextureFormat::RGBA8)
+            {
+                glTexImage2D(
+                    GL_TEXTURE_2D,
+                    static_cast<GLint>(level),
+                    GL_RGBA,
+                    mipLevel.width,
+                    mipLevel.height,
+                    0,
+                    GL_RGBA,
+                    GL_UNSIGNED_BYTE,
+                    pixelData);
+            }
+            else
+            {
+                glCompressedTexImage2D(
+                    GL_TEXTURE_2D,
+                    static_cast<GLint>(level),
+                    ::getCompressedFormat(textureData.getFormat()),
+                    mipLevel.width,
+                    mipLevel.height,
+                    0,
+                    static_cast<GLsizei>(mipLevel.size),
+                    pixelData);
+            }
+        }
 
         return textureId;
     }
@@ -33,8 +90,8 @@ struct OpenGLTexture::Internal
 {
     const GLuint textureId;
 
-    Internal(const ast::Bitmap& bitmap)
-        : textureId(::createTexture(bitmap)) {}
+    Internal(const ast::TextureData& textureData)
+        : textureId(::createTexture(textureData)) {}
 
     ~Internal()
     {
@@ -42,8 +99,8 @@ struct OpenGLTexture::Internal
     }
 };
 
-OpenGLTexture::OpenGLTexture(const ast::Bitmap& bitmap)
-    : internal(ast::make_internal_ptr<Internal>(bitmap)) {}
+OpenGLTexture::OpenGLTexture(const ast::TextureData& textureData)
+    : internal(ast::make_internal_ptr<Internal>(textureData)) {}
 
 void OpenGLTexture::bind() const
 {
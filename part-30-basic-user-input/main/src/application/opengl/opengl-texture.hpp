@@ -1,13 +1,13 @@
 #pragma once
 
-#include "../../core/bitmap.hpp"
 #include "../../core/internal-ptr.hpp"
+#include "../../core/texture-data.hpp"
 
 namespace ast
 {
     struct OpenGLTexture
     {
-        OpenGLTexture(const ast::Bitmap& bitmap);
+        OpenGLTexture(const ast::TextureData& textureData);
 
         void bind() const;
 
@@ -51,6 +51,7 @@ struct VulkanApplication::Internal
 
     void onWindowResized()
     {
+        context.onWindowResized();
         getScene().onWindowResized(context.getCurrentWindowSize());
     }
 };
@@ -1,8 +1,17 @@
 #include "vulkan-asset-manager.hpp"
+#include "../../core/asset-decoding.hpp"
 #include "../../core/assets.hpp"
 #include "../../core/log.hpp"
+#include "../../core/mesh-encoder.hpp"
+#include "../../core/profiler.hpp"
+#include "../../core/texture-encoder.hpp"
+#include "../../core/thread-pool.hpp"
+#include "vulkan-common.hpp"
 #include "vulkan-pipeline.hpp"
+#include <algorithm>
+#include <chrono>
 #include <unordered_map>
+#include <vector>
 
 using ast::VulkanAssetManager;
 
@@ -11,108 +20,283 @@ namespace
     ast::VulkanPipeline createPipeline(const ast::assets::Pipeline& pipeline,
                                        const ast::VulkanPhysicalDevice& physicalDevice,
                                        const ast::VulkanDevice& device,
-                                       const ast::VulkanRenderContext& renderContext)
+                                       const ast::VulkanPipelineCache& pipelineCache,
+                                       const ast::VulkanRenderContext& renderContext,
+                                       const ast::VertexLayout& vertexLayout)
     {
+        AST_PROFILE_ZONE("VulkanAssetManager::createPipeline");
+
         const std::string pipelinePath{ast::assets::resolvePipelinePath(pipeline)};
 
         ast::log("ast::VulkanAssetManager::createPipeline", "Creating pipeline: " + pipelinePath);
 
         return ast::VulkanPipeline(physicalDevice,
                                    device,
+                                   pipelineCache.getPipelineCache(),
                                    pipelinePath,
-                                   renderContext.getViewport(),
-                                   renderContext.getScissor(),
+                                   vertexLayout,
                                    renderContext.getRenderPass());
     }
 
-    ast::VulkanMesh createMesh(const ast::VulkanPhysicalDevice& physicalDevice,
-                               const ast::VulkanDevice& device,
-                               const ast::VulkanCommandPool& commandPool,
-                               const ast::assets::StaticMesh& staticMesh)
+    std::string formatMemoryStatistics(const ast::VulkanMemoryStatistics& statistics)
     {
-        std::string meshPath{ast::assets::resolveStaticMeshPath(staticMesh)};
+        return "Device memory: " + std::to_string(statistics.bytesInUse) + " of " +
+               std::to_string(statistics.bytesAllocated) + " bytes in use by " +
+               std::to_string(statistics.allocationCount) + " allocations across " +
+               std::to_string(statistics.blockCount) + " blocks (" +
+               std::to_string(statistics.dedicatedBlockCount) + " dedicated), fragmentation: " +
+               std::to_string(statistics.fragmentation);
+    }
 
-        ast::log("ast::VulkanAssetManager::createMesh", "Creating static mesh from " + meshPath);
+    ast::VulkanBuffer createGeometryBuffer(const ast::VulkanDevice& device,
+                                           const ast::VulkanTransferContext& transferContext,
+                                           const size_t& size,
+                                           const vk::BufferUsageFlags& bufferFlags,
+                                           const std::string& name)
+    {
+        // Vulkan does not allow empty buffers, so a pool without any indices still gets a few bytes.
+        const vk::DeviceSize bufferSize{std::max(size, static_cast<size_t>(4))};
+        ast::VulkanBuffer buffer{transferContext.createDeviceLocalBuffer(bufferSize, bufferFlags, nullptr)};
 
-        return ast::VulkanMesh(physicalDevice,
-                               device,
-                               commandPool,
-                               ast::assets::loadOBJFile(meshPath));
+        device.setObjectName(vk::ObjectType::eBuffer, ast::vulkan::getObjectHandle(buffer.getBuffer()), name);
+
+        return buffer;
+    }
+
+    ast::VulkanMesh createMesh(const ast::VulkanTransferContext& transferContext,
+                               const ast::assets::StaticMesh& staticMesh,
+                               const ast::DecodedAsset<ast::EncodedMesh>& decodedMesh,
+                               const ast::VulkanBuffer& vertexBuffer,
+                               const ast::VulkanBuffer& indexBuffer,
+                               const ast::GeometryRange& geometryRange)
+    {
+        const auto start{std::chrono::steady_clock::now()};
+        const ast::EncodedMesh& encodedMesh{decodedMesh.asset};
+
+        // The copies only need to be recorded if there is something to copy.
+        if (!encodedMesh.vertices.empty())
+        {
+            transferContext.copyToBuffer(vertexBuffer.getBuffer(),
+                                         ast::meshes::getVertexByteOffset(encodedMesh, geometryRange),
+                                         encodedMesh.vertices.size(),
+                                         encodedMesh.vertices.data());
+        }
+
+        if (!encodedMesh.indices.empty())
+        {
+            transferContext.copyToBuffer(indexBuffer.getBuffer(),
+                                         ast::meshes::getIndexByteOffset(encodedMesh, geometryRange),
+                                         encodedMesh.indices.size(),
+                                         encodedMesh.indices.data());
+        }
+
+        ast::VulkanMesh mesh(encodedMesh, vertexBuffer.getBuffer(), indexBuffer.getBuffer(), geometryRange);
+
+        ast::log("ast::VulkanAssetManager::createMesh",
+                 "Created " + ast::meshes::getVertexLayoutName(encodedMesh.vertexLayout) +
+                     " static mesh from " + ast::assets::resolveStaticMeshPath(staticMesh) +
+                     ast::assets::formatTimings(decodedMesh.decodeMilliseconds, ast::assets::millisecondsSince(start)));
+
+        return mesh;
     }
 
     ast::VulkanTexture createTexture(const ast::assets::Texture& texture,
                                      const ast::VulkanPhysicalDevice& physicalDevice,
                                      const ast::VulkanDevice& device,
-                                     const ast::VulkanCommandPool& commandPool,
-                                     const ast::VulkanRenderContext& renderContext)
+                                     const ast::VulkanTransferContext& transferContext,
+                                     const ast::DecodedAsset<ast::TextureData>& decodedTexture)
     {
-        std::string texturePath{ast::assets::resolveTexturePath(texture)};
-
-        ast::log("ast::VulkanAssetManager::createTexture", "Creating texture from " + texturePath);
+        const auto start{std::chrono::steady_clock::now()};
 
-        ast::Bitmap bitmap{ast::assets::loadBitmap(texturePath)};
-
-        return ast::VulkanTexture(texture,
+        ast::VulkanTexture result(texture,
                                   physicalDevice,
                                   device,
-                                  commandPool,
-                                  bitmap);
+                                  transferContext,
+                                  decodedTexture.asset);
+
+        ast::log("ast::VulkanAssetManager::createTexture",
+                 "Created " + ast::textures::getFormatName(decodedTexture.asset.getFormat()) +
+                     " texture from " + ast::assets::resolveTexturePath(texture) +
+                     ast::assets::formatTimings(decodedTexture.decodeMilliseconds, ast::assets::millisecondsSince(start)));
+
+        return result;
     }
 } // namespace
 
 struct VulkanAssetManager::Internal
 {
+    // Vulkan requires every device to read 16 bit vertex formats, so any layout can be used.
+    const ast::VertexLayout vertexLayout;
+    ast::ThreadPool workerPool;
     std::unordered_map<ast::assets::Pipeline, ast::VulkanPipeline> pipelineCache;
     std::unordered_map<ast::assets::StaticMesh, ast::VulkanMesh> staticMeshCache;
     std::unordered_map<ast::assets::Texture, ast::VulkanTexture> textureCache;
 
-    Internal() {}
+    // The vertex and index buffer of each geometry pool the static meshes are sub-allocated from.
+    std::vector<ast::VulkanBuffer> geometryBuffers;
+
+    Internal() : vertexLayout(ast::meshes::getPreferredVertexLayout()) {}
+
+    std::unordered_map<ast::assets::Pipeline, std::future<ast::VulkanPipeline>> createPipelines(
+        const std::vector<ast::assets::Pipeline>& pipelines,
+        const ast::VulkanPhysicalDevice& physicalDevice,
+        const ast::VulkanDevice& device,
+        const ast::VulkanPipelineCache& vulkanPipelineCache,
+        const ast::VulkanRenderContext& renderContext)
+    {
+        // Compiling pipelines is by far the slowest part of creating them, and Vulkan lets
+        // pipelines be created from any thread, so each one is compiled on the worker pool.
+        // The jobs refer to the Vulkan objects we were given, so they must be collected
+        // before those can go away.
+        std::unordered_map<ast::assets::Pipeline, std::future<ast::VulkanPipeline>> jobs;
+
+        for (const auto& pipeline : pipelines)
+        {
+            if (jobs.count(pipeline) == 0)
+            {
+                jobs.insert(std::make_pair(
+                    pipeline,
+                    workerPool.submit([this, pipeline, &physicalDevice, &device, &vulkanPipelineCache, &renderContext]() {
+                        return ::createPipeline(pipeline, physicalDevice, device, vulkanPipelineCache, renderContext, vertexLayout);
+                    })));
+            }
+        }
+
+        return jobs;
+    }
+
+    void createStaticMeshes(const ast::VulkanDevice& device,
+                            const ast::VulkanTransferContext& transferContext,
+                            std::unordered_map<ast::assets::StaticMesh, std::future<ast::DecodedAsset<ast::EncodedMesh>>>& jobs)
+    {
+        if (jobs.empty())
+        {
+            return;
+        }
+
+        const ast::DecodedGeometryPool pool{ast::assets::collectGeometryPool(jobs)};
+        const ast::GeometryPoolLayout& layout{pool.layout};
+        const std::string poolName{"Geometry pool " + std::to_string(geometryBuffers.size() / 2)};
+
+        ast::log("ast::VulkanAssetManager::createStaticMeshes",
+                 poolName + ": " + ast::meshes::describeGeometryPoolLayout(layout));
+
+        geometryBuffers.push_back(::createGeometryBuffer(device,
+                                                         transferContext,
+                                                         layout.vertexBufferSize,
+                                                         vk::BufferUsageFlagBits::eVertexBuffer,
+                                                         poolName + " (vertices)"));
+
+        geometryBuffers.push_back(::createGeometryBuffer(device,
+                                                         transferContext,
+                                                         layout.indexBufferSize,
+                                                         vk::BufferUsageFlagBits::eIndexBuffer,
+                                                         poolName + " (indices)"));
+
+        const ast::VulkanBuffer& vertexBuffer{geometryBuffers[geometryBuffers.size() - 2]};
+        const ast::VulkanBuffer& indexBuffer{geometryBuffers[geometryBuffers.size() - 1]};
+
+        for (size_t i = 0; i < pool.meshes.size(); i++)
+        {
+            staticMeshCache.insert(std::make_pair(
+                pool.meshes[i].first,
+                ::createMesh(transferContext,
+                             pool.meshes[i].first,
+                             pool.meshes[i].second,
+                             vertexBuffer,
+                             indexBuffer,
+                             layout.ranges[i])));
+        }
+    }
 
     void loadAssetManifest(const ast::VulkanPhysicalDevice& physicalDevice,
                            const ast::VulkanDevice& device,
+                           const ast::VulkanPipelineCache& vulkanPipelineCache,
                            const ast::VulkanRenderContext& renderContext,
-                           const ast::VulkanCommandPool& commandPool,
+                           const ast::VulkanTransferContext& transferContext,
                            const ast::AssetManifest& assetManifest)
     {
+        AST_PROFILE_ZONE("VulkanAssetManager::loadAssetManifest");
+
+        static const std::string logTag{"ast::VulkanAssetManager::loadAssetManifest"};
+
+        const auto start{std::chrono::steady_clock::now()};
+
+        // Kick off the compilation of every new pipeline and the CPU side decoding of every
+        // new mesh and texture on the worker pool first, so they can all happen in parallel.
+        std::vector<ast::assets::Pipeline> newPipelines;
+
         for (const auto& pipeline : assetManifest.pipelines)
         {
             if (pipelineCache.count(pipeline) == 0)
             {
-                pipelineCache.insert(std::make_pair(
-                    pipeline,
-                    ::createPipeline(pipeline, physicalDevice, device, renderContext)));
+                newPipelines.push_back(pipeline);
             }
         }
 
+        auto pipelineJobs{createPipelines(newPipelines, physicalDevice, device, vulkanPipelineCache, renderContext)};
+
+        std::unordered_map<ast::assets::StaticMesh, std::future<ast::DecodedAsset<ast::EncodedMesh>>> staticMeshJobs;
+        std::unordered_map<ast::assets::Texture, std::future<ast::DecodedAsset<ast::TextureData>>> textureJobs;
+
         for (const auto& staticMesh : assetManifest.staticMeshes)
         {
-            if (staticMeshCache.count(staticMesh) == 0)
+            if (staticMeshCache.count(staticMesh) == 0 && staticMeshJobs.count(staticMesh) == 0)
             {
-                staticMeshCache.insert(std::make_pair(
+                staticMeshJobs.insert(std::make_pair(
                     staticMesh,
-                    ::createMesh(physicalDevice, device, commandPool, staticMesh)));
+                    workerPool.submit([this, staticMesh]() { return ast::assets::decodeStaticMesh(staticMesh, vertexLayout); })));
             }
         }
 
         for (const auto& texture : assetManifest.textures)
         {
-            if (textureCache.count(texture) == 0)
+            if (textureCache.count(texture) == 0 && textureJobs.count(texture) == 0)
             {
-                textureCache.insert(std::make_pair(
+                textureJobs.insert(std::make_pair(
                     texture,
-                    ::createTexture(texture, physicalDevice, device, commandPool, renderContext)));
+                    workerPool.submit([texture, &physicalDevice]() {
+                        // Only accept a baked format that the device can sample from.
+                        return ast::assets::decodeTexture(texture, [&physicalDevice](const ast::TextureFormat& format) {
+                            return physicalDevice.isTextureFormatSupported(ast::vulkan::getTextureFormat(format));
+                        });
+                    })));
             }
         }
-    }
 
-    void reloadContextualAssets(const ast::VulkanPhysicalDevice& physicalDevice,
-                                const ast::VulkanDevice& device,
-                                const ast::VulkanRenderContext& renderContext)
-    {
-        for (auto& element : pipelineCache)
+        // The uploads to the GPU are all recorded into the transfer context which can only be
+        // used from this thread, so we collect the decoded results here.
+        createStaticMeshes(device, transferContext, staticMeshJobs);
+
+        for (auto& job : textureJobs)
+        {
+            textureCache.insert(std::make_pair(
+                job.first,
+                ::createTexture(job.first, physicalDevice, device, transferContext, job.second.get())));
+        }
+
+        // Submit every recorded upload as a single batch and wait for it to complete, while
+        // any pipelines which are still compiling carry on in the background.
+        transferContext.submit();
+
+        for (auto& job : pipelineJobs)
         {
-            element.second = ::createPipeline(element.first, physicalDevice, device, renderContext);
+            pipelineCache.insert(std::make_pair(job.first, job.second.get()));
         }
+
+        // Save whatever the driver compiled, so the next run can skip compiling it again.
+        if (!pipelineJobs.empty())
+        {
+            vulkanPipelineCache.save(device);
+        }
+
+        ast::log(logTag, "Loaded " + std::to_string(pipelineJobs.size()) + " pipelines, " +
+                             std::to_string(staticMeshJobs.size()) + " static meshes and " +
+                             std::to_string(textureJobs.size()) + " textures using " +
+                             std::to_string(workerPool.getNumThreads()) + " worker threads in " +
+                             std::to_string(ast::assets::millisecondsSince(start)) + "ms");
+
+        ast::log(logTag, ::formatMemoryStatistics(device.getMemoryAllocator().getStatistics()));
     }
 };
 
@@ -120,18 +304,12 @@ VulkanAssetManager::VulkanAssetManager() : internal(ast::make_internal_ptr<Inter
 
 void VulkanAssetManager::loadAssetManifest(const ast::VulkanPhysicalDevice& physicalDevice,
                                            const ast::VulkanDevice& device,
+                                           const ast::VulkanPipelineCache& pipelineCache,
                                            const ast::VulkanRenderContext& renderContext,
-                                           const ast::VulkanCommandPool& commandPool,
+                                           const ast::VulkanTransferContext& transferContext,
                                            const ast::AssetManifest& assetManifest)
 {
-    internal->loadAssetManifest(physicalDevice, device, renderContext, commandPool, assetManifest);
-}
-
-void VulkanAssetManager::reloadContextualAssets(const ast::VulkanPhysicalDevice& physicalDevice,
-                                                const ast::VulkanDevice& device,
-                                                const ast::VulkanRenderContext& renderContext)
-{
-    internal->reloadContextualAssets(physicalDevice, device, renderContext);
+    internal->loadAssetManifest(physicalDevice, device, pipelineCache, renderContext, transferContext, assetManifest);
 }
 
 const ast::VulkanPipeline& VulkanAssetManager::getPipeline(const ast::assets::Pipeline& pipeline) const
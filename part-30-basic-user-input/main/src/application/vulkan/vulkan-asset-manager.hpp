@@ -2,13 +2,14 @@
 
 #include "../../core/asset-manifest.hpp"
 #include "../../core/internal-ptr.hpp"
-#include "vulkan-command-pool.hpp"
 #include "vulkan-device.hpp"
 #include "vulkan-mesh.hpp"
 #include "vulkan-physical-device.hpp"
+#include "vulkan-pipeline-cache.hpp"
 #include "vulkan-pipeline.hpp"
 #include "vulkan-render-context.hpp"
 #include "vulkan-texture.hpp"
+#include "vulkan-transfer-context.hpp"
 
 namespace ast
 {
@@ -18,14 +19,11 @@ namespace ast
 
         void loadAssetManifest(const ast::VulkanPhysicalDevice& physicalDevice,
                                const ast::VulkanDevice& device,
+                               const ast::VulkanPipelineCache& pipelineCache,
                                const ast::VulkanRenderContext& renderContext,
-                               const ast::VulkanCommandPool& commandPool,
+                               const ast::VulkanTransferContext& transferContext,
                                const ast::AssetManifest& assetManifest);
 
-        void reloadContextualAssets(const ast::VulkanPhysicalDevice& physicalDevice,
-                                    const ast::VulkanDevice& device,
-                                    const ast::VulkanRenderContext& renderContext);
-
         const ast::VulkanPipeline& getPipeline(const ast::assets::Pipeline& pipeline) const;
 
         const ast::VulkanMesh& getStaticMesh(const ast::assets::StaticMesh& staticMesh) const;
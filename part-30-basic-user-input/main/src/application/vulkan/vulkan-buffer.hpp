@@ -2,7 +2,6 @@
 
 #include "../../core/graphics-wrapper.hpp"
 #include "../../core/internal-ptr.hpp"
-#include "vulkan-command-pool.hpp"
 #include "vulkan-device.hpp"
 #include "vulkan-physical-device.hpp"
 
@@ -19,12 +18,7 @@ namespace ast
 
         const vk::Buffer& getBuffer() const;
 
-        static ast::VulkanBuffer createDeviceLocalBuffer(const ast::VulkanPhysicalDevice& physicalDevice,
-                                                         const ast::VulkanDevice& device,
-                                                         const ast::VulkanCommandPool& commandPool,
-                                                         const vk::DeviceSize& size,
-                                                         const vk::BufferUsageFlags& bufferFlags,
-                                                         const void* dataSource);
+        void* getMappedMemory() const;
 
     private:
         struct Internal;
@@ -1,11 +1,34 @@
 #include "vulkan-common.hpp"
 #include "../../core/graphics-wrapper.hpp"
+#include "../../core/headless.hpp"
 #include "../../core/log.hpp"
 #include "../../core/sdl-wrapper.hpp"
 #include <set>
 
+namespace
+{
+    bool findDebugUtilsExtension()
+    {
+        for (auto const& availableExtension : vk::enumerateInstanceExtensionProperties())
+        {
+            if (std::string{availableExtension.extensionName} == VK_EXT_DEBUG_UTILS_EXTENSION_NAME)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+} // namespace
+
 std::vector<std::string> ast::vulkan::getRequiredVulkanExtensionNames()
 {
+    // Headless rendering never creates a surface so doesn't need any of the surface extensions.
+    if (ast::headless::isEnabled())
+    {
+        return std::vector<std::string>{};
+    }
+
     uint32_t extensionCount;
     SDL_Vulkan_GetInstanceExtensions(nullptr, &extensionCount, nullptr);
 
@@ -28,6 +51,14 @@ bool ast::vulkan::isVulkanAvailable()
     }
 #endif
 
+    // Headless rendering doesn't present anything, so it only needs a Vulkan driver - which
+    // may well be a software one such as lavapipe - rather than SDL support for Vulkan windows.
+    if (ast::headless::isEnabled())
+    {
+        ast::log(logTag, "Vulkan is available for headless rendering.");
+        return true;
+    }
+
     // Check if SDL itself can load Vulkan.
     if (SDL_Vulkan_LoadLibrary(nullptr) != 0)
     {
@@ -70,3 +101,27 @@ bool ast::vulkan::isVulkanAvailable()
     ast::log(logTag, "Vulkan is available.");
     return true;
 }
+
+bool ast::vulkan::isDebugUtilsAvailable()
+{
+    static const bool available{::findDebugUtilsExtension()};
+
+    return available;
+}
+
+vk::Format ast::vulkan::getTextureFormat(const ast::TextureFormat& format)
+{
+    switch (format)
+    {
+        case ast::TextureFormat::RGBA8:
+            return vk::Format::eR8G8B8A8Unorm;
+        case ast::TextureFormat::BC1:
+            return vk::Format::eBc1RgbUnormBlock;
+        case ast::TextureFormat::BC3:
+            return vk::Format::eBc3UnormBlock;
+        case ast::TextureFormat::ETC2RGB8:
+            return vk::Format::eEtc2R8G8B8UnormBlock;
+        case ast::TextureFormat::ETC2RGBA8:
+            return vk::Format::eEtc2R8G8B8A8UnormBlock;
+    }
+}
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "../../core/graphics-wrapper.hpp"
+#include "../../core/texture-data.hpp"
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -8,4 +11,17 @@ namespace ast::vulkan
     std::vector<std::string> getRequiredVulkanExtensionNames();
 
     bool isVulkanAvailable();
+
+    // Whether the VK_EXT_debug_utils extension can be enabled to label objects and regions of
+    // command buffers for capture and debugging tools.
+    bool isDebugUtilsAvailable();
+
+    vk::Format getTextureFormat(const ast::TextureFormat& format);
+
+    // Converts a Vulkan object into the integer handle that identifies it to debugging tools.
+    template <typename T>
+    uint64_t getObjectHandle(const T& object)
+    {
+        return (uint64_t)(static_cast<typename T::CType>(object));
+    }
 } // namespace ast::vulkan
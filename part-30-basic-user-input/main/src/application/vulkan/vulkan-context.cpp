@@ -1,14 +1,27 @@
 #include "vulkan-context.hpp"
+#include "../../core/assets.hpp"
 #include "../../core/graphics-wrapper.hpp"
+#include "../../core/headless.hpp"
 #include "../../core/log.hpp"
+#include "../../core/profiler.hpp"
+#include "../../core/render-queue.hpp"
 #include "../../core/sdl-window.hpp"
+#include "../../core/static-mesh-culling.hpp"
 #include "vulkan-asset-manager.hpp"
 #include "vulkan-command-pool.hpp"
 #include "vulkan-common.hpp"
+#include "vulkan-culling-pass.hpp"
 #include "vulkan-device.hpp"
+#include "vulkan-mesh.hpp"
 #include "vulkan-physical-device.hpp"
+#include "vulkan-pipeline-cache.hpp"
+#include "vulkan-pipeline.hpp"
 #include "vulkan-render-context.hpp"
 #include "vulkan-surface.hpp"
+#include "vulkan-texture.hpp"
+#include "vulkan-transfer-context.hpp"
+#include <cstring>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -62,6 +75,12 @@ namespace
         std::vector<std::string> requiredExtensionNames{
             ast::vulkan::getRequiredVulkanExtensionNames()};
 
+        // Debug utils are optional but let capture tools show named objects and labelled regions.
+        if (ast::vulkan::isDebugUtilsAvailable())
+        {
+            requiredExtensionNames.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        }
+
         // Pack the extension names into a data format consumable by Vulkan.
         std::vector<const char*> extensionNames;
         for (const auto& extension : requiredExtensionNames)
@@ -92,49 +111,181 @@ namespace
         // Build a new Vulkan instance from the configuration.
         return vk::createInstanceUnique(instanceCreateInfo);
     }
+
+    // The size of the persistent staging ring used to upload assets. Anything larger than
+    // this will be given its own temporary staging buffer when it is uploaded.
+    constexpr vk::DeviceSize stagingRingSize{32 * 1024 * 1024};
+
+    // The number of frames the CPU may record ahead of the GPU. More frames in flight keep the
+    // GPU busier at the cost of extra latency between input and display.
+    constexpr uint32_t framesInFlight{2};
+
+    std::unique_ptr<ast::SDLWindow> createWindow()
+    {
+        // Rendering headless there is no window at all, so we don't need a display to run.
+        if (ast::headless::isEnabled())
+        {
+            return nullptr;
+        }
+
+        return std::make_unique<ast::SDLWindow>(SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
+    }
+
+    std::unique_ptr<ast::VulkanSurface> createSurface(const vk::Instance& instance,
+                                                      const ast::VulkanPhysicalDevice& physicalDevice,
+                                                      const std::unique_ptr<ast::SDLWindow>& window)
+    {
+        if (!window)
+        {
+            return nullptr;
+        }
+
+        return std::make_unique<ast::VulkanSurface>(instance, physicalDevice, *window);
+    }
+
+    ast::VulkanDevice createDevice(const vk::Instance& instance,
+                                   const ast::VulkanPhysicalDevice& physicalDevice,
+                                   const std::unique_ptr<ast::VulkanSurface>& surface)
+    {
+        return surface ? ast::VulkanDevice(instance, physicalDevice, *surface) : ast::VulkanDevice(instance, physicalDevice);
+    }
+
+    ast::VulkanRenderContext createRenderContext(const std::unique_ptr<ast::SDLWindow>& window,
+                                                 const ast::VulkanPhysicalDevice& physicalDevice,
+                                                 const ast::VulkanDevice& device,
+                                                 const std::unique_ptr<ast::VulkanSurface>& surface,
+                                                 const ast::VulkanCommandPool& commandPool)
+    {
+        if (!window)
+        {
+            const ast::WindowSize frameSize{ast::headless::getFrameSize()};
+
+            return ast::VulkanRenderContext(physicalDevice,
+                                            device,
+                                            commandPool,
+                                            ::framesInFlight,
+                                            vk::Extent2D{frameSize.width, frameSize.height});
+        }
+
+        return ast::VulkanRenderContext(*window, physicalDevice, device, *surface, commandPool, ::framesInFlight);
+    }
+
+    std::unique_ptr<ast::VulkanCullingPass> createCullingPass(const ast::VulkanPhysicalDevice& physicalDevice,
+                                                              const ast::VulkanDevice& device,
+                                                              const ast::VulkanPipelineCache& pipelineCache)
+    {
+        static const std::string logTag{"ast::VulkanContext::createCullingPass"};
+
+        // The culling shader is dispatched on the graphics queue, so that queue must also be
+        // able to run compute work for instances to be culled on the GPU.
+        const std::vector<vk::QueueFamilyProperties> queueFamilies{
+            physicalDevice.getPhysicalDevice().getQueueFamilyProperties()};
+
+        const bool computeSupported{
+            static_cast<bool>(queueFamilies[device.getGraphicsQueueIndex()].queueFlags & vk::QueueFlagBits::eCompute)};
+
+        if (!computeSupported || !physicalDevice.isIndirectDrawingSupported())
+        {
+            ast::log(logTag, "Indirect drawing not supported, static mesh instances will be culled on the CPU.");
+            return nullptr;
+        }
+
+        return std::make_unique<ast::VulkanCullingPass>(device, pipelineCache, ::framesInFlight);
+    }
 } // namespace
 
 struct VulkanContext::Internal
 {
     const vk::UniqueInstance instance;
     const ast::VulkanPhysicalDevice physicalDevice;
-    const ast::SDLWindow window;
-    const ast::VulkanSurface surface;
+    const std::unique_ptr<ast::SDLWindow> window;
+    const std::unique_ptr<ast::VulkanSurface> surface;
     const ast::VulkanDevice device;
+    const ast::VulkanPipelineCache pipelineCache;
     const ast::VulkanCommandPool commandPool;
+    const ast::VulkanTransferContext transferContext;
     ast::VulkanRenderContext renderContext;
+    const std::unique_ptr<ast::VulkanCullingPass> cullingPass;
     ast::VulkanAssetManager assetManager;
+    ast::RenderQueue renderQueue;
+
+    // The instance stores to cull on the GPU once the frame ends, or the instances culled on
+    // the CPU if the device can't draw indirectly.
+    std::vector<ast::VulkanCullingSubmission> cullingSubmissions;
+    std::vector<uint32_t> visibleInstances;
+    std::vector<uint32_t> visibleInstanceLevels;
+
+    // Meshes are sub-allocated from shared geometry buffers, so the vertex and index buffers
+    // only change when a mesh comes from a different pool or uses a different index type.
+    vk::Buffer boundVertexBuffer;
+    vk::Buffer boundIndexBuffer;
+    vk::IndexType boundIndexType{vk::IndexType::eUint32};
+
+    // Set whenever the render targets may no longer match the window, and acted on once at the
+    // start of the next frame no matter how many times it was set in between.
+    bool resizePending{false};
 
     Internal()
         : instance(::createInstance()),
           physicalDevice(ast::VulkanPhysicalDevice(*instance)),
-          window(ast::SDLWindow(SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI)),
-          surface(ast::VulkanSurface(*instance, physicalDevice, window)),
-          device(ast::VulkanDevice(physicalDevice, surface)),
+          window(::createWindow()),
+          surface(::createSurface(*instance, physicalDevice, window)),
+          device(::createDevice(*instance, physicalDevice, surface)),
+          pipelineCache(ast::VulkanPipelineCache(physicalDevice, device)),
           commandPool(ast::VulkanCommandPool(device)),
-          renderContext(ast::VulkanRenderContext(window, physicalDevice, device, surface, commandPool)),
-          assetManager(ast::VulkanAssetManager())
+          transferContext(ast::VulkanTransferContext(physicalDevice, device, commandPool, ::stagingRingSize)),
+          renderContext(::createRenderContext(window, physicalDevice, device, surface, commandPool)),
+          cullingPass(::createCullingPass(physicalDevice, device, pipelineCache)),
+          assetManager(ast::VulkanAssetManager()),
+          renderQueue(ast::RenderQueue())
     {
         ast::log("ast::VulkanContext", "Initialized Vulkan context successfully.");
     }
 
+    ~Internal()
+    {
+        // Frames are no longer waited on as they are presented, so the device has to finish
+        // whatever is still in flight before any of the resources it uses are destroyed.
+        renderContext.finishReadbacks(device);
+        device.getDevice().waitIdle();
+    }
+
     void loadAssetManifest(const ast::AssetManifest& assetManifest)
     {
-        assetManager.loadAssetManifest(physicalDevice, device, renderContext, commandPool, assetManifest);
+        assetManager.loadAssetManifest(physicalDevice, device, pipelineCache, renderContext, transferContext, assetManifest);
     }
 
-    void recreateRenderContext()
+    void resizeRenderContext()
     {
-        device.getDevice().waitIdle();
-        renderContext = renderContext.recreate(window, physicalDevice, device, surface, commandPool);
-        assetManager.reloadContextualAssets(physicalDevice, device, renderContext);
+        AST_PROFILE_ZONE("VulkanContext::resizeRenderContext");
+
+        // Only a render context which presents to a window can ever need resizing. There is no
+        // need to wait for the device to go idle, as the render context keeps anything still in
+        // use by frames in flight alive until they complete, and the pipelines remain valid.
+        renderContext.resize(*window, physicalDevice, device, *surface, commandPool);
+        resizePending = false;
+    }
+
+    void onWindowResized()
+    {
+        if (window)
+        {
+            resizePending = true;
+        }
     }
 
     bool renderBegin()
     {
+        AST_PROFILE_ZONE("VulkanContext::renderBegin");
+
+        if (resizePending)
+        {
+            resizeRenderContext();
+        }
+
         if (!renderContext.renderBegin(device))
         {
-            recreateRenderContext();
+            resizeRenderContext();
             return false;
         }
 
@@ -142,19 +293,232 @@ struct VulkanContext::Internal
     }
 
     void render(const ast::assets::Pipeline& pipeline,
-                const std::vector<ast::StaticMeshInstance>& staticMeshInstances)
+                const ast::StaticMeshInstanceStore& staticMeshInstances,
+                const std::vector<uint32_t>& instanceIndices,
+                const std::vector<uint32_t>& instanceLevels)
+    {
+        AST_PROFILE_ZONE("VulkanContext::render");
+
+        renderQueue.add(pipeline, staticMeshInstances, instanceIndices, instanceLevels);
+    }
+
+    void renderVisible(const ast::Renderer& renderer,
+                       const ast::assets::Pipeline& pipeline,
+                       const ast::StaticMeshInstanceStore& staticMeshInstances,
+                       const ast::RenderView& view)
+    {
+        AST_PROFILE_ZONE("VulkanContext::renderVisible");
+
+        if (cullingPass)
+        {
+            cullingSubmissions.push_back(ast::VulkanCullingSubmission{pipeline, &staticMeshInstances, view});
+            return;
+        }
+
+        ast::cullStaticMeshInstances(renderer, staticMeshInstances, view, visibleInstances, visibleInstanceLevels);
+
+        render(pipeline, staticMeshInstances, visibleInstances, visibleInstanceLevels);
+    }
+
+    std::vector<ast::VulkanIndirectDrawList> cullStaticMeshes()
+    {
+        if (cullingSubmissions.empty())
+        {
+            return std::vector<ast::VulkanIndirectDrawList>{};
+        }
+
+        renderContext.beginGpuZone(device, "Culling");
+
+        std::vector<ast::VulkanIndirectDrawList> drawLists{
+            cullingPass->record(device, transferContext, renderContext, assetManager, cullingSubmissions)};
+
+        renderContext.endGpuZone(device);
+        cullingSubmissions.clear();
+
+        return drawLists;
+    }
+
+    void bindStaticMesh(const vk::CommandBuffer& commandBuffer,
+                        const ast::VulkanPipeline& pipeline,
+                        const ast::VulkanMesh& mesh)
+    {
+        if (mesh.getVertexBuffer() != boundVertexBuffer)
+        {
+            const vk::DeviceSize offset{0};
+            commandBuffer.bindVertexBuffers(0, 1, &mesh.getVertexBuffer(), &offset);
+            boundVertexBuffer = mesh.getVertexBuffer();
+        }
+
+        if (mesh.getIndexBuffer() != boundIndexBuffer || mesh.getIndexType() != boundIndexType)
+        {
+            commandBuffer.bindIndexBuffer(mesh.getIndexBuffer(), 0, mesh.getIndexType());
+            boundIndexBuffer = mesh.getIndexBuffer();
+            boundIndexType = mesh.getIndexType();
+        }
+
+        pipeline.bindMesh(commandBuffer, mesh);
+    }
+
+    void flushRenderQueue()
+    {
+        AST_PROFILE_ZONE("VulkanContext::flushRenderQueue");
+
+        renderQueue.sort();
+
+        const std::vector<glm::mat4>& transforms{renderQueue.getTransforms()};
+
+        if (transforms.empty())
+        {
+            return;
+        }
+
+        const vk::CommandBuffer& commandBuffer{renderContext.getActiveCommandBuffer()};
+
+        // Copy the MVP matrix of every instance straight into this frame's instance buffer.
+        // The matrices are in sorted order, so each batch occupies a contiguous run of them.
+        const vk::DeviceSize transformsSize{transforms.size() * sizeof(glm::mat4)};
+        const ast::VulkanBufferRange instanceRange{renderContext.getActiveInstanceBuffer().allocate(transformsSize)};
+
+        std::memcpy(instanceRange.mappedMemory, transforms.data(), static_cast<size_t>(transformsSize));
+
+        // The instance buffer is shared by every batch so only needs to be bound once.
+        commandBuffer.bindVertexBuffers(1, 1, &instanceRange.buffer, &instanceRange.offset);
+
+        // Batches are sorted by pipeline, so each pipeline gets one GPU zone around its draws.
+        bool pipelineZoneOpen{false};
+
+        for (const ast::RenderBatch& batch : renderQueue.getBatches())
+        {
+            const ast::VulkanPipeline& pipeline{assetManager.getPipeline(batch.pipeline)};
+            const ast::VulkanMesh& mesh{assetManager.getStaticMesh(batch.mesh)};
+
+            if (renderQueue.bindPipeline(batch.pipeline))
+            {
+                if (pipelineZoneOpen)
+                {
+                    renderContext.endGpuZone(device);
+                }
+
+                renderContext.beginGpuZone(device, "Pipeline: " + ast::assets::resolvePipelinePath(batch.pipeline));
+                pipelineZoneOpen = true;
+
+                pipeline.bind(commandBuffer);
+            }
+
+            if (renderQueue.bindTexture(batch.texture))
+            {
+                pipeline.bindTexture(device, commandBuffer, assetManager.getTexture(batch.texture));
+            }
+
+            if (renderQueue.bindMesh(batch.mesh))
+            {
+                bindStaticMesh(commandBuffer, pipeline, mesh);
+            }
+
+            // Every level of detail is a range of the mesh's indices, which are themselves a
+            // range of the shared index buffer, so only the range changes between draws.
+            const ast::GeometryRange& geometryRange{mesh.getGeometryRange()};
+            const ast::MeshLevelOfDetail& level{mesh.getLevels()[batch.level]};
+
+            commandBuffer.drawIndexed(level.numIndices,
+                                      batch.instanceCount,
+                                      geometryRange.firstIndex + level.firstIndex,
+                                      geometryRange.vertexOffset,
+                                      batch.firstInstance);
+        }
+
+        if (pipelineZoneOpen)
+        {
+            renderContext.endGpuZone(device);
+        }
+    }
+
+    void drawIndirect(const std::vector<ast::VulkanIndirectDrawList>& drawLists)
     {
-        assetManager.getPipeline(pipeline).render(device,
-                                                  renderContext.getActiveCommandBuffer(),
-                                                  assetManager,
-                                                  staticMeshInstances);
+        AST_PROFILE_ZONE("VulkanContext::drawIndirect");
+
+        const vk::CommandBuffer& commandBuffer{renderContext.getActiveCommandBuffer()};
+        const vk::DeviceSize commandStride{sizeof(vk::DrawIndexedIndirectCommand)};
+
+        for (const ast::VulkanIndirectDrawList& drawList : drawLists)
+        {
+            const ast::VulkanPipeline& pipeline{assetManager.getPipeline(drawList.pipeline)};
+
+            renderContext.beginGpuZone(device, "Indirect pipeline: " + ast::assets::resolvePipelinePath(drawList.pipeline));
+
+            if (renderQueue.bindPipeline(drawList.pipeline))
+            {
+                pipeline.bind(commandBuffer);
+            }
+
+            // The culling shader wrote the MVP matrices of the visible instances, grouped by the
+            // command which draws them, so they are read as instance data just like the sorted
+            // matrices of the render queue.
+            const vk::DeviceSize transformsOffset{0};
+            commandBuffer.bindVertexBuffers(1, 1, &drawList.transforms, &transformsOffset);
+
+            for (const ast::VulkanIndirectDraw& draw : drawList.draws)
+            {
+                if (renderQueue.bindTexture(draw.texture))
+                {
+                    pipeline.bindTexture(device, commandBuffer, assetManager.getTexture(draw.texture));
+                }
+
+                if (renderQueue.bindMesh(draw.mesh))
+                {
+                    bindStaticMesh(commandBuffer, pipeline, assetManager.getStaticMesh(draw.mesh));
+                }
+
+                // Each command covers one level of detail of the mesh, and draws however many
+                // instances the culling shader counted for it, which may well be none.
+                const vk::DeviceSize offset{draw.firstCommand * commandStride};
+
+                if (physicalDevice.isMultiDrawIndirectSupported())
+                {
+                    commandBuffer.drawIndexedIndirect(drawList.commands,
+                                                      offset,
+                                                      draw.commandCount,
+                                                      static_cast<uint32_t>(commandStride));
+                }
+                else
+                {
+                    for (uint32_t i = 0; i < draw.commandCount; i++)
+                    {
+                        commandBuffer.drawIndexedIndirect(drawList.commands,
+                                                          offset + i * commandStride,
+                                                          1,
+                                                          static_cast<uint32_t>(commandStride));
+                    }
+                }
+            }
+
+            renderContext.endGpuZone(device);
+        }
     }
 
     void renderEnd()
     {
+        AST_PROFILE_ZONE("VulkanContext::renderEnd");
+
+        // Compute work can't be recorded inside a render pass, so the instances are culled
+        // before it begins and the draw commands the culling wrote are drawn inside it.
+        const std::vector<ast::VulkanIndirectDrawList> drawLists{cullStaticMeshes()};
+
+        renderContext.beginRenderPass(device);
+
+        // Nothing is bound in a newly begun command buffer.
+        boundVertexBuffer = vk::Buffer();
+        boundIndexBuffer = vk::Buffer();
+
+        flushRenderQueue();
+        drawIndirect(drawLists);
+        renderQueue.reset();
+
+        // Resizing is left until the next frame begins, so it can be combined with any window
+        // resize events which arrive in the meantime.
         if (!renderContext.renderEnd(device))
         {
-            recreateRenderContext();
+            resizePending = true;
         }
     }
 };
@@ -171,10 +535,29 @@ bool VulkanContext::renderBegin()
     return internal->renderBegin();
 }
 
+const ast::BoundingBox& VulkanContext::getStaticMeshBounds(const ast::assets::StaticMesh& staticMesh) const
+{
+    return internal->assetManager.getStaticMesh(staticMesh).getBoundingBox();
+}
+
+const std::vector<ast::MeshLevelOfDetail>& VulkanContext::getStaticMeshLevels(const ast::assets::StaticMesh& staticMesh) const
+{
+    return internal->assetManager.getStaticMesh(staticMesh).getLevels();
+}
+
 void VulkanContext::render(const ast::assets::Pipeline& pipeline,
-                           const std::vector<ast::StaticMeshInstance>& staticMeshInstances)
+                           const ast::StaticMeshInstanceStore& staticMeshInstances,
+                           const std::vector<uint32_t>& instanceIndices,
+                           const std::vector<uint32_t>& instanceLevels)
 {
-    internal->render(pipeline, staticMeshInstances);
+    internal->render(pipeline, staticMeshInstances, instanceIndices, instanceLevels);
+}
+
+void VulkanContext::renderVisible(const ast::assets::Pipeline& pipeline,
+                                  const ast::StaticMeshInstanceStore& staticMeshInstances,
+                                  const ast::RenderView& view)
+{
+    internal->renderVisible(*this, pipeline, staticMeshInstances, view);
 }
 
 void VulkanContext::renderEnd()
@@ -182,7 +565,17 @@ void VulkanContext::renderEnd()
     internal->renderEnd();
 }
 
+void VulkanContext::onWindowResized()
+{
+    internal->onWindowResized();
+}
+
 ast::WindowSize VulkanContext::getCurrentWindowSize() const
 {
-    return ast::sdl::getWindowSize(internal->window.getWindow());
+    if (!internal->window)
+    {
+        return ast::headless::getFrameSize();
+    }
+
+    return ast::sdl::getWindowSize(internal->window->getWindow());
 }
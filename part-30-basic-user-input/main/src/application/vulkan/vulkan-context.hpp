@@ -15,12 +15,25 @@ namespace ast
 
         bool renderBegin();
 
+        const ast::BoundingBox& getStaticMeshBounds(const ast::assets::StaticMesh& staticMesh) const override;
+
+        const std::vector<ast::MeshLevelOfDetail>& getStaticMeshLevels(const ast::assets::StaticMesh& staticMesh) const override;
+
         void render(
             const ast::assets::Pipeline& pipeline,
-            const std::vector<ast::StaticMeshInstance>& staticMeshInstances) override;
+            const ast::StaticMeshInstanceStore& staticMeshInstances,
+            const std::vector<uint32_t>& instanceIndices,
+            const std::vector<uint32_t>& instanceLevels) override;
+
+        void renderVisible(
+            const ast::assets::Pipeline& pipeline,
+            const ast::StaticMeshInstanceStore& staticMeshInstances,
+            const ast::RenderView& view) override;
 
         void renderEnd();
 
+        void onWindowResized();
+
         ast::WindowSize getCurrentWindowSize() const;
 
     private:
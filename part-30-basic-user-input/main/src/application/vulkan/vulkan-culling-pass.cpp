@@ -0,0 +1,687 @@
+#include "vulkan-culling-pass.hpp"
+#include "../../core/asset-file.hpp"
+#include "../../core/level-of-detail.hpp"
+#include "../../core/profiler.hpp"
+#include "vulkan-common.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+using ast::VulkanCullingPass;
+
+namespace
+{
+    // The most levels of detail the culling shader can choose between for one mesh.
+    constexpr uint32_t maxLevels{8};
+
+    // The number of instances culled by each work group of the culling shader.
+    constexpr uint32_t workGroupSize{64};
+
+    // Each submission culled in a frame needs its own descriptor set.
+    constexpr uint32_t maxSubmissionsPerFrame{16};
+
+    // The instance, group and push constant layouts below must match those in the culling shader.
+    struct CullingInstance
+    {
+        glm::mat4 modelMatrix;
+        uint32_t group;
+        uint32_t padding[3];
+    };
+
+    struct CullingGroup
+    {
+        glm::vec4 boundsMin;
+        glm::vec4 boundsMax;
+        uint32_t firstCommand;
+        uint32_t levelCount;
+        float levelErrors[::maxLevels];
+        uint32_t padding[2];
+    };
+
+    struct CullingConstants
+    {
+        glm::mat4 projectionViewMatrix;
+        glm::vec4 cameraPosition;
+        uint32_t instanceCount;
+        float maxScreenError;
+        float minScreenSize;
+        uint32_t padding;
+    };
+
+    static_assert(sizeof(::CullingInstance) == 80, "Culling instances must match the shader layout");
+    static_assert(sizeof(::CullingGroup) == 80, "Culling groups must match the shader layout");
+
+    // The instances of a submission which share a mesh and texture, in the order they were first
+    // seen, and the run of draw commands which will draw them.
+    struct InstanceGroup
+    {
+        ast::assets::StaticMesh mesh;
+        ast::assets::Texture texture;
+        uint32_t instanceCount;
+        uint32_t firstCommand;
+        uint32_t commandCount;
+    };
+
+    // The persistent GPU copy of an instance store, holding the model matrix and group of each
+    // instance, the bounds and levels of each group, and the draw commands of every group with
+    // no instances, which are copied over the commands the culling shader wrote last time to
+    // reset them. Everything is rebuilt when instances are added or removed, otherwise only the
+    // instances are uploaded again, and only if their model matrices have changed.
+    struct StoreState
+    {
+        uint64_t layoutVersion{0};
+        uint64_t modelVersion{0};
+        uint64_t lastUsedFrame{0};
+        std::vector<::InstanceGroup> groups;
+        std::vector<uint32_t> instanceGroups;
+        std::vector<uint32_t> drawOrder;
+        uint32_t commandCount{0};
+        uint32_t transformCount{0};
+        std::unique_ptr<ast::VulkanBuffer> instances;
+        std::unique_ptr<ast::VulkanBuffer> cullingGroups;
+        std::unique_ptr<ast::VulkanBuffer> commandTemplate;
+    };
+
+    // The draw commands and MVP matrices written by the culling shader for one submission in a
+    // frame. Only the GPU touches them, so they live in device local memory, and they are only
+    // ever grown so a store which keeps growing doesn't need new buffers every frame.
+    struct SubmissionOutput
+    {
+        vk::DeviceSize commandsCapacity{0};
+        vk::DeviceSize transformsCapacity{0};
+        std::unique_ptr<ast::VulkanBuffer> commands;
+        std::unique_ptr<ast::VulkanBuffer> transforms;
+    };
+
+    vk::UniqueDescriptorSetLayout createDescriptorSetLayout(const ast::VulkanDevice& device)
+    {
+        // The instances, groups, draw commands and output transforms are all storage buffers.
+        std::array<vk::DescriptorSetLayoutBinding, 4> bindings;
+
+        for (uint32_t i = 0; i < bindings.size(); i++)
+        {
+            bindings[i] = vk::DescriptorSetLayoutBinding{
+                i,                                  // Binding
+                vk::DescriptorType::eStorageBuffer, // Descriptor type
+                1,                                  // Descriptor count
+                vk::ShaderStageFlagBits::eCompute,  // Shader stage flags
+                nullptr};                           // Immutable samplers
+        }
+
+        vk::DescriptorSetLayoutCreateInfo info{
+            vk::DescriptorSetLayoutCreateFlags(),   // Flags
+            static_cast<uint32_t>(bindings.size()), // Binding count
+            bindings.data()};                       // Bindings
+
+        return device.getDevice().createDescriptorSetLayoutUnique(info);
+    }
+
+    vk::UniquePipelineLayout createPipelineLayout(const ast::VulkanDevice& device,
+                                                  const vk::DescriptorSetLayout& descriptorSetLayout)
+    {
+        // The view to cull against changes with every submission, so arrives as push constants.
+        vk::PushConstantRange cullingRange{
+            vk::ShaderStageFlagBits::eCompute, // Stage flags
+            0,                                 // Offset
+            sizeof(::CullingConstants)};       // Size
+
+        vk::PipelineLayoutCreateInfo info{
+            vk::PipelineLayoutCreateFlags(), // Flags
+            1,                               // Layout count
+            &descriptorSetLayout,            // Layouts,
+            1,                               // Push constant range count,
+            &cullingRange                    // Push constant ranges
+        };
+
+        return device.getDevice().createPipelineLayoutUnique(info);
+    }
+
+    vk::UniquePipeline createPipeline(const ast::VulkanDevice& device,
+                                      const vk::PipelineLayout& pipelineLayout,
+                                      const vk::PipelineCache& pipelineCache)
+    {
+        vk::UniqueShaderModule shaderModule{
+            device.createShaderModule(ast::AssetFile("assets/shaders/vulkan/cull.comp"))};
+
+        vk::PipelineShaderStageCreateInfo shaderInfo{
+            vk::PipelineShaderStageCreateFlags(), // Flags
+            vk::ShaderStageFlagBits::eCompute,    // Shader stage
+            shaderModule.get(),                   // Shader module
+            "main",                               // Name
+            nullptr};                             // Specialisation info
+
+        vk::ComputePipelineCreateInfo info{
+            vk::PipelineCreateFlags(), // Flags
+            shaderInfo,                // Stage
+            pipelineLayout,            // Pipeline layout
+            vk::Pipeline(),            // Base pipeline handle
+            0};                        // Base pipeline index
+
+        return device.getDevice().createComputePipelineUnique(pipelineCache, info);
+    }
+
+    std::vector<vk::UniqueDescriptorPool> createDescriptorPools(const ast::VulkanDevice& device,
+                                                                const uint32_t& count)
+    {
+        // Every render frame has its own pool, which is reset in one go once the frame's fence
+        // has been waited on rather than freeing its descriptor sets one at a time.
+        vk::DescriptorPoolSize storageBufferPoolSize{
+            vk::DescriptorType::eStorageBuffer, // Type
+            ::maxSubmissionsPerFrame * 4};      // Max descriptor count
+
+        vk::DescriptorPoolCreateInfo info{
+            vk::DescriptorPoolCreateFlags(), // Flags
+            ::maxSubmissionsPerFrame,        // Max sets
+            1,                               // Pool size count
+            &storageBufferPoolSize};         // Pool sizes
+
+        std::vector<vk::UniqueDescriptorPool> descriptorPools;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            descriptorPools.push_back(device.getDevice().createDescriptorPoolUnique(info));
+        }
+
+        return descriptorPools;
+    }
+
+    vk::DescriptorSet createDescriptorSet(const ast::VulkanDevice& device,
+                                          const vk::DescriptorPool& descriptorPool,
+                                          const vk::DescriptorSetLayout& descriptorSetLayout,
+                                          const std::array<vk::DescriptorBufferInfo, 4>& bufferInfos)
+    {
+        vk::DescriptorSetAllocateInfo createInfo{
+            descriptorPool,        // Descriptor pool
+            1,                     // Descriptor set count
+            &descriptorSetLayout}; // Descriptor set layouts
+
+        vk::DescriptorSet descriptorSet{device.getDevice().allocateDescriptorSets(createInfo)[0]};
+
+        vk::WriteDescriptorSet writeInfo{
+            descriptorSet,                             // Destination set
+            0,                                         // Destination binding
+            0,                                         // Destination array element
+            static_cast<uint32_t>(bufferInfos.size()), // Descriptor count
+            vk::DescriptorType::eStorageBuffer,        // Descriptor type
+            nullptr,                                   // Image info
+            bufferInfos.data(),                        // Buffer info
+            nullptr};                                  // Texel buffer view
+
+        device.getDevice().updateDescriptorSets(1, &writeInfo, 0, nullptr);
+
+        return descriptorSet;
+    }
+
+    std::unique_ptr<ast::VulkanBuffer> createBuffer(const ast::VulkanDevice& device,
+                                                    const ast::VulkanTransferContext& transferContext,
+                                                    const vk::DeviceSize& size,
+                                                    const vk::BufferUsageFlags& bufferFlags,
+                                                    const std::string& name)
+    {
+        std::unique_ptr<ast::VulkanBuffer> buffer{
+            std::make_unique<ast::VulkanBuffer>(transferContext.createDeviceLocalBuffer(size, bufferFlags, nullptr))};
+
+        device.setObjectName(vk::ObjectType::eBuffer, ast::vulkan::getObjectHandle(buffer->getBuffer()), name);
+
+        return buffer;
+    }
+
+    // Records a copy from the staging memory of the render frame into a device local buffer,
+    // returning the staging range for the caller to fill in before the frame is submitted.
+    void* recordUpload(const vk::CommandBuffer& commandBuffer,
+                       const ast::VulkanDynamicBuffer& stagingBuffer,
+                       const vk::Buffer& buffer,
+                       const vk::DeviceSize& size)
+    {
+        const ast::VulkanBufferRange stagingRange{stagingBuffer.allocate(size)};
+
+        vk::BufferCopy region{
+            stagingRange.offset, // Source offset
+            0,                   // Destination offset
+            size};               // Size
+
+        commandBuffer.copyBuffer(stagingRange.buffer, buffer, 1, &region);
+
+        return stagingRange.mappedMemory;
+    }
+} // namespace
+
+struct VulkanCullingPass::Internal
+{
+    const uint32_t framesInFlight;
+    const vk::UniqueDescriptorSetLayout descriptorSetLayout;
+    const vk::UniquePipelineLayout pipelineLayout;
+    const vk::UniquePipeline pipeline;
+    const std::vector<vk::UniqueDescriptorPool> descriptorPools;
+
+    // The stores culled recently, and the output buffers of each submission slot in a frame.
+    std::unordered_map<const ast::StaticMeshInstanceStore*, ::StoreState> stores;
+    std::vector<::SubmissionOutput> outputs;
+
+    // Buffers which have been replaced, along with the frame they were replaced in, which are
+    // kept alive until no frame in flight can still be using them.
+    std::vector<std::pair<uint64_t, std::unique_ptr<ast::VulkanBuffer>>> retiredBuffers;
+    uint64_t frameCount{0};
+
+    Internal(const ast::VulkanDevice& device,
+             const ast::VulkanPipelineCache& pipelineCache,
+             const uint32_t& framesInFlight)
+        : framesInFlight(framesInFlight),
+          descriptorSetLayout(::createDescriptorSetLayout(device)),
+          pipelineLayout(::createPipelineLayout(device, descriptorSetLayout.get())),
+          pipeline(::createPipeline(device, pipelineLayout.get(), pipelineCache.getPipelineCache())),
+          descriptorPools(::createDescriptorPools(device, framesInFlight)),
+          outputs(::maxSubmissionsPerFrame)
+    {
+        device.setObjectName(vk::ObjectType::ePipeline, ast::vulkan::getObjectHandle(pipeline.get()), "cull");
+    }
+
+    void retire(std::unique_ptr<ast::VulkanBuffer>& buffer)
+    {
+        if (buffer)
+        {
+            retiredBuffers.push_back(std::make_pair(frameCount, std::move(buffer)));
+        }
+    }
+
+    void releaseUnusedBuffers()
+    {
+        // The fence of the active render frame has been waited on, so any frame at least as many
+        // frames ago as there can be in flight has completed and no longer uses its buffers.
+        retiredBuffers.erase(std::remove_if(retiredBuffers.begin(),
+                                            retiredBuffers.end(),
+                                            [this](const std::pair<uint64_t, std::unique_ptr<ast::VulkanBuffer>>& retired) {
+                                                return frameCount >= retired.first + framesInFlight;
+                                            }),
+                             retiredBuffers.end());
+
+        // Stores which have not been culled for as long are dropped, which also covers stores
+        // that have since been destroyed.
+        for (auto it = stores.begin(); it != stores.end();)
+        {
+            it = frameCount >= it->second.lastUsedFrame + framesInFlight ? stores.erase(it) : std::next(it);
+        }
+    }
+
+    void rebuildStore(const ast::VulkanDevice& device,
+                      const ast::VulkanTransferContext& transferContext,
+                      const ast::VulkanRenderContext& renderContext,
+                      const ast::VulkanAssetManager& assetManager,
+                      const ast::StaticMeshInstanceStore& staticMeshInstances,
+                      ::StoreState& state)
+    {
+        const vk::CommandBuffer& commandBuffer{renderContext.getActiveCommandBuffer()};
+        const ast::VulkanDynamicBuffer& stagingBuffer{renderContext.getActiveInstanceBuffer()};
+        const uint32_t instanceCount{staticMeshInstances.getSize()};
+        const std::vector<ast::assets::StaticMesh>& meshes{staticMeshInstances.getMeshes()};
+        const std::vector<ast::assets::Texture>& textures{staticMeshInstances.getTextures()};
+
+        // Tag every instance with the group of instances sharing its mesh and texture. Instances
+        // of the same mesh and texture tend to sit next to each other, so the last group found
+        // is checked first.
+        std::map<std::pair<ast::assets::Texture, ast::assets::StaticMesh>, uint32_t> groupIndices;
+        uint32_t currentGroup{0};
+
+        state.groups.clear();
+        state.instanceGroups.resize(instanceCount);
+
+        for (uint32_t i = 0; i < instanceCount; i++)
+        {
+            if (state.groups.empty() ||
+                state.groups[currentGroup].mesh != meshes[i] ||
+                state.groups[currentGroup].texture != textures[i])
+            {
+                const auto key{std::make_pair(textures[i], meshes[i])};
+                const auto existing{groupIndices.find(key)};
+
+                if (existing == groupIndices.end())
+                {
+                    currentGroup = static_cast<uint32_t>(state.groups.size());
+                    groupIndices.insert(std::make_pair(key, currentGroup));
+                    state.groups.push_back(::InstanceGroup{meshes[i], textures[i], 0, 0, 0});
+                }
+                else
+                {
+                    currentGroup = existing->second;
+                }
+            }
+
+            state.groups[currentGroup].instanceCount++;
+            state.instanceGroups[i] = currentGroup;
+        }
+
+        // The groups are drawn ordered by texture and then mesh, so each texture is bound once.
+        state.drawOrder.clear();
+
+        for (const auto& entry : groupIndices)
+        {
+            state.drawOrder.push_back(entry.second);
+        }
+
+        // Give every level of every group a draw command with no instances, which the culling
+        // shader counts up, and room for the MVP matrices of all of the group's instances, as
+        // any of them may end up being drawn with any level.
+        std::vector<::CullingGroup> cullingGroups(state.groups.size());
+        std::vector<vk::DrawIndexedIndirectCommand> commands;
+        uint32_t transformCount{0};
+
+        for (size_t i = 0; i < state.groups.size(); i++)
+        {
+            ::InstanceGroup& group{state.groups[i]};
+            const ast::VulkanMesh& mesh{assetManager.getStaticMesh(group.mesh)};
+            const ast::GeometryRange& geometryRange{mesh.getGeometryRange()};
+            const std::vector<ast::MeshLevelOfDetail>& levels{mesh.getLevels()};
+            const ast::BoundingBox& bounds{mesh.getBoundingBox()};
+
+            group.firstCommand = static_cast<uint32_t>(commands.size());
+            group.commandCount = std::min(static_cast<uint32_t>(levels.size()), ::maxLevels);
+
+            ::CullingGroup& cullingGroup{cullingGroups[i]};
+            cullingGroup.boundsMin = glm::vec4{bounds.min, 1.0f};
+            cullingGroup.boundsMax = glm::vec4{bounds.max, 1.0f};
+            cullingGroup.firstCommand = group.firstCommand;
+            cullingGroup.levelCount = group.commandCount;
+
+            for (uint32_t level = 0; level < group.commandCount; level++)
+            {
+                cullingGroup.levelErrors[level] = levels[level].error;
+
+                commands.push_back(vk::DrawIndexedIndirectCommand{
+                    levels[level].numIndices,                            // Index count
+                    0,                                                   // Instance count
+                    geometryRange.firstIndex + levels[level].firstIndex, // First index
+                    geometryRange.vertexOffset,                          // Vertex offset
+                    transformCount});                                    // First instance
+
+                transformCount += group.instanceCount;
+            }
+        }
+
+        state.commandCount = static_cast<uint32_t>(commands.size());
+        state.transformCount = transformCount;
+
+        // The buffers are sized exactly, as they only change when the store itself does.
+        const vk::DeviceSize instancesSize{instanceCount * sizeof(::CullingInstance)};
+        const vk::DeviceSize groupsSize{cullingGroups.size() * sizeof(::CullingGroup)};
+        const vk::DeviceSize commandsSize{commands.size() * sizeof(vk::DrawIndexedIndirectCommand)};
+
+        retire(state.instances);
+        retire(state.cullingGroups);
+        retire(state.commandTemplate);
+
+        state.instances = ::createBuffer(device, transferContext, instancesSize, vk::BufferUsageFlagBits::eStorageBuffer, "Culling instances");
+        state.cullingGroups = ::createBuffer(device, transferContext, groupsSize, vk::BufferUsageFlagBits::eStorageBuffer, "Culling groups");
+        state.commandTemplate = ::createBuffer(device, transferContext, commandsSize, vk::BufferUsageFlagBits::eTransferSrc, "Culling command template");
+
+        std::memcpy(::recordUpload(commandBuffer, stagingBuffer, state.cullingGroups->getBuffer(), groupsSize),
+                    cullingGroups.data(),
+                    static_cast<size_t>(groupsSize));
+
+        std::memcpy(::recordUpload(commandBuffer, stagingBuffer, state.commandTemplate->getBuffer(), commandsSize),
+                    commands.data(),
+                    static_cast<size_t>(commandsSize));
+    }
+
+    const ::StoreState& prepareStore(const ast::VulkanDevice& device,
+                                     const ast::VulkanTransferContext& transferContext,
+                                     const ast::VulkanRenderContext& renderContext,
+                                     const ast::VulkanAssetManager& assetManager,
+                                     const ast::StaticMeshInstanceStore& staticMeshInstances)
+    {
+        ::StoreState& state{stores[&staticMeshInstances]};
+        const ast::TransformBatch& transforms{staticMeshInstances.getTransforms()};
+        const bool layoutChanged{state.layoutVersion != staticMeshInstances.getLayoutVersion()};
+
+        state.lastUsedFrame = frameCount;
+
+        if (layoutChanged)
+        {
+            rebuildStore(device, transferContext, renderContext, assetManager, staticMeshInstances, state);
+            state.layoutVersion = staticMeshInstances.getLayoutVersion();
+        }
+
+        // Only upload the model matrices if they have changed since they were last uploaded.
+        if (layoutChanged || state.modelVersion != transforms.getModelVersion())
+        {
+            const uint32_t instanceCount{staticMeshInstances.getSize()};
+
+            ::CullingInstance* instances{static_cast<::CullingInstance*>(
+                ::recordUpload(renderContext.getActiveCommandBuffer(),
+                               renderContext.getActiveInstanceBuffer(),
+                               state.instances->getBuffer(),
+                               instanceCount * sizeof(::CullingInstance)))};
+
+            for (uint32_t i = 0; i < instanceCount; i++)
+            {
+                instances[i].modelMatrix = transforms.getModelMatrix(i);
+                instances[i].group = state.instanceGroups[i];
+            }
+
+            state.modelVersion = transforms.getModelVersion();
+        }
+
+        return state;
+    }
+
+    const ::SubmissionOutput& prepareOutput(const ast::VulkanDevice& device,
+                                            const ast::VulkanTransferContext& transferContext,
+                                            const size_t& slot,
+                                            const ::StoreState& state)
+    {
+        ::SubmissionOutput& output{outputs[slot]};
+        const vk::DeviceSize commandsSize{state.commandCount * sizeof(vk::DrawIndexedIndirectCommand)};
+        const vk::DeviceSize transformsSize{state.transformCount * sizeof(glm::mat4)};
+
+        if (output.commandsCapacity < commandsSize)
+        {
+            retire(output.commands);
+            output.commandsCapacity = std::max(commandsSize, output.commandsCapacity * 2);
+            output.commands = ::createBuffer(device,
+                                             transferContext,
+                                             output.commandsCapacity,
+                                             vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer,
+                                             "Culling commands " + std::to_string(slot));
+        }
+
+        if (output.transformsCapacity < transformsSize)
+        {
+            retire(output.transforms);
+            output.transformsCapacity = std::max(transformsSize, output.transformsCapacity * 2);
+            output.transforms = ::createBuffer(device,
+                                               transferContext,
+                                               output.transformsCapacity,
+                                               vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eVertexBuffer,
+                                               "Culling transforms " + std::to_string(slot));
+        }
+
+        return output;
+    }
+
+    ast::VulkanIndirectDrawList recordSubmission(const ast::VulkanDevice& device,
+                                                 const ast::VulkanRenderContext& renderContext,
+                                                 const ast::VulkanCullingSubmission& submission,
+                                                 const ::StoreState& state,
+                                                 const ::SubmissionOutput& output,
+                                                 const vk::DescriptorPool& descriptorPool) const
+    {
+        const uint32_t instanceCount{submission.staticMeshInstances->getSize()};
+
+        const vk::DescriptorSet descriptorSet{::createDescriptorSet(
+            device,
+            descriptorPool,
+            descriptorSetLayout.get(),
+            std::array<vk::DescriptorBufferInfo, 4>{
+                vk::DescriptorBufferInfo{state.instances->getBuffer(), 0, instanceCount * sizeof(::CullingInstance)},
+                vk::DescriptorBufferInfo{state.cullingGroups->getBuffer(), 0, state.groups.size() * sizeof(::CullingGroup)},
+                vk::DescriptorBufferInfo{output.commands->getBuffer(), 0, state.commandCount * sizeof(vk::DrawIndexedIndirectCommand)},
+                vk::DescriptorBufferInfo{output.transforms->getBuffer(), 0, state.transformCount * sizeof(glm::mat4)}})};
+
+        const ast::RenderView& view{submission.view};
+        const float pixelsPerUnit{ast::LevelOfDetailSelector::getPixelsPerUnit(view.projectionMatrix, view.viewportHeight)};
+
+        // The camera position carries the pixels per unit in its last component.
+        const ::CullingConstants constants{
+            view.projectionMatrix * view.viewMatrix,       // Projection view matrix
+            glm::vec4{view.cameraPosition, pixelsPerUnit}, // Camera position
+            instanceCount,                                 // Instance count
+            ast::LevelOfDetailSelector::maxScreenError,    // Max screen error
+            ast::LevelOfDetailSelector::minScreenSize,     // Min screen size
+            0};                                            // Padding
+
+        const vk::CommandBuffer& commandBuffer{renderContext.getActiveCommandBuffer()};
+
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                                         pipelineLayout.get(),
+                                         0,
+                                         1,
+                                         &descriptorSet,
+                                         0,
+                                         nullptr);
+
+        commandBuffer.pushConstants(pipelineLayout.get(),
+                                    vk::ShaderStageFlagBits::eCompute,
+                                    0,
+                                    sizeof(::CullingConstants),
+                                    &constants);
+
+        commandBuffer.dispatch((instanceCount + ::workGroupSize - 1) / ::workGroupSize, 1, 1);
+
+        ast::VulkanIndirectDrawList drawList{submission.pipeline, output.transforms->getBuffer(), output.commands->getBuffer(), {}};
+
+        for (const uint32_t& groupIndex : state.drawOrder)
+        {
+            const ::InstanceGroup& group{state.groups[groupIndex]};
+
+            drawList.draws.push_back(ast::VulkanIndirectDraw{
+                group.mesh,           // Mesh
+                group.texture,        // Texture
+                group.firstCommand,   // First command
+                group.commandCount}); // Command count
+        }
+
+        return drawList;
+    }
+
+    std::vector<ast::VulkanIndirectDrawList> record(const ast::VulkanDevice& device,
+                                                    const ast::VulkanTransferContext& transferContext,
+                                                    const ast::VulkanRenderContext& renderContext,
+                                                    const ast::VulkanAssetManager& assetManager,
+                                                    const std::vector<ast::VulkanCullingSubmission>& submissions)
+    {
+        static const std::string logTag{"ast::VulkanCullingPass::record"};
+
+        AST_PROFILE_ZONE("VulkanCullingPass::record");
+
+        if (submissions.size() > ::maxSubmissionsPerFrame)
+        {
+            throw std::runtime_error(logTag + ": Too many culling submissions in one frame.");
+        }
+
+        frameCount++;
+        releaseUnusedBuffers();
+
+        // The fence of the active render frame has been waited on, so none of the descriptor
+        // sets allocated from its pool the last time around are still in use.
+        const vk::DescriptorPool& descriptorPool{descriptorPools[renderContext.getActiveFrameIndex()].get()};
+        device.getDevice().resetDescriptorPool(descriptorPool);
+
+        const vk::CommandBuffer& commandBuffer{renderContext.getActiveCommandBuffer()};
+
+        // The culling buffers are shared by every frame, so the previous frame must be done
+        // culling and drawing with them before any of them are written to again.
+        commandBuffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::DependencyFlags(),
+            0, nullptr,
+            0, nullptr,
+            0, nullptr);
+
+        // Upload whatever has changed in each store and reset the draw commands of each
+        // submission, with every copy recorded ahead of the culling dispatches.
+        std::vector<std::pair<const ::StoreState*, const ::SubmissionOutput*>> prepared;
+
+        for (size_t i = 0; i < submissions.size(); i++)
+        {
+            if (submissions[i].staticMeshInstances->getSize() == 0)
+            {
+                prepared.push_back(std::make_pair(nullptr, nullptr));
+                continue;
+            }
+
+            const ::StoreState& state{prepareStore(device, transferContext, renderContext, assetManager, *submissions[i].staticMeshInstances)};
+            const ::SubmissionOutput& output{prepareOutput(device, transferContext, i, state)};
+
+            vk::BufferCopy region{
+                0,                                                            // Source offset
+                0,                                                            // Destination offset
+                state.commandCount * sizeof(vk::DrawIndexedIndirectCommand)}; // Size
+
+            commandBuffer.copyBuffer(state.commandTemplate->getBuffer(), output.commands->getBuffer(), 1, &region);
+            prepared.push_back(std::make_pair(&state, &output));
+        }
+
+        vk::MemoryBarrier uploadBarrier{
+            vk::AccessFlagBits::eTransferWrite,                                  // Source access mask
+            vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite}; // Destination access mask
+
+        commandBuffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::DependencyFlags(),
+            1, &uploadBarrier,
+            0, nullptr,
+            0, nullptr);
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline.get());
+
+        std::vector<ast::VulkanIndirectDrawList> drawLists;
+
+        for (size_t i = 0; i < submissions.size(); i++)
+        {
+            if (prepared[i].first)
+            {
+                drawLists.push_back(recordSubmission(device,
+                                                     renderContext,
+                                                     submissions[i],
+                                                     *prepared[i].first,
+                                                     *prepared[i].second,
+                                                     descriptorPool));
+            }
+        }
+
+        // The draw commands and transforms written by the culling shader are read back by the
+        // indirect draws and as instance vertex data in the render pass which follows.
+        vk::MemoryBarrier barrier{
+            vk::AccessFlagBits::eShaderWrite,                                                      // Source access mask
+            vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eVertexAttributeRead}; // Destination access mask
+
+        commandBuffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput,
+            vk::DependencyFlags(),
+            1, &barrier,
+            0, nullptr,
+            0, nullptr);
+
+        return drawLists;
+    }
+};
+
+VulkanCullingPass::VulkanCullingPass(const ast::VulkanDevice& device,
+                                     const ast::VulkanPipelineCache& pipelineCache,
+                                     const uint32_t& framesInFlight)
+    : internal(ast::make_internal_ptr<Internal>(device, pipelineCache, framesInFlight)) {}
+
+std::vector<ast::VulkanIndirectDrawList> VulkanCullingPass::record(const ast::VulkanDevice& device,
+                                                                   const ast::VulkanTransferContext& transferContext,
+                                                                   const ast::VulkanRenderContext& renderContext,
+                                                                   const ast::VulkanAssetManager& assetManager,
+                                                                   const std::vector<ast::VulkanCullingSubmission>& submissions)
+{
+    return internal->record(device, transferContext, renderContext, assetManager, submissions);
+}
\ No newline at end of file
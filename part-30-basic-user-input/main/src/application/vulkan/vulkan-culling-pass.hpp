@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../../core/asset-inventory.hpp"
+#include "../../core/graphics-wrapper.hpp"
+#include "../../core/internal-ptr.hpp"
+#include "../../core/renderer.hpp"
+#include "../../core/static-mesh-instance-store.hpp"
+#include "vulkan-asset-manager.hpp"
+#include "vulkan-device.hpp"
+#include "vulkan-dynamic-buffer.hpp"
+#include "vulkan-pipeline-cache.hpp"
+#include "vulkan-render-context.hpp"
+#include "vulkan-transfer-context.hpp"
+#include <vector>
+
+namespace ast
+{
+    // A request to draw every visible instance of a store from the given view.
+    struct VulkanCullingSubmission
+    {
+        ast::assets::Pipeline pipeline;
+        const ast::StaticMeshInstanceStore* staticMeshInstances;
+        ast::RenderView view;
+    };
+
+    // The instances of a store which share a mesh and texture, drawn by a run of indirect draw
+    // commands holding one command for each level of detail of the mesh.
+    struct VulkanIndirectDraw
+    {
+        ast::assets::StaticMesh mesh;
+        ast::assets::Texture texture;
+        uint32_t firstCommand;
+        uint32_t commandCount;
+    };
+
+    // The draw commands written by the culling pass for one submission, along with the MVP
+    // matrices of the visible instances which the commands draw from. Both buffers live in
+    // device local memory and are owned by the culling pass.
+    struct VulkanIndirectDrawList
+    {
+        ast::assets::Pipeline pipeline;
+        vk::Buffer transforms;
+        vk::Buffer commands;
+        std::vector<ast::VulkanIndirectDraw> draws;
+    };
+
+    // Culls static mesh instances and picks their levels of detail in a compute shader, which
+    // writes the indirect draw commands that render them. Each store keeps a persistent copy of
+    // its instances and draw commands on the GPU, which the CPU only uploads again when the
+    // store changes, leaving the GPU to count how many instances each command draws.
+    struct VulkanCullingPass
+    {
+        VulkanCullingPass(const ast::VulkanDevice& device,
+                          const ast::VulkanPipelineCache& pipelineCache,
+                          const uint32_t& framesInFlight);
+
+        // Records the culling of every submission into the active command buffer of the render
+        // context, which must not yet have begun its render pass. Must be called at most once
+        // per frame, as that is how it tells when buffers are no longer in use.
+        std::vector<ast::VulkanIndirectDrawList> record(const ast::VulkanDevice& device,
+                                                        const ast::VulkanTransferContext& transferContext,
+                                                        const ast::VulkanRenderContext& renderContext,
+                                                        const ast::VulkanAssetManager& assetManager,
+                                                        const std::vector<ast::VulkanCullingSubmission>& submissions);
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
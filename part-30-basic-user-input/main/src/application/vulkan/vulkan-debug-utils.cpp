@@ -0,0 +1,97 @@
+#include "vulkan-debug-utils.hpp"
+#include "vulkan-common.hpp"
+
+using ast::VulkanDebugUtils;
+
+namespace
+{
+    template <typename Function>
+    Function getFunction(const vk::Instance& instance, const char* name)
+    {
+        // The extension functions are not exported by the Vulkan loader, so they have to be looked
+        // up through the instance - but only if the extension was enabled when creating it.
+        if (!ast::vulkan::isDebugUtilsAvailable())
+        {
+            return nullptr;
+        }
+
+        return reinterpret_cast<Function>(instance.getProcAddr(name));
+    }
+} // namespace
+
+struct VulkanDebugUtils::Internal
+{
+    const PFN_vkSetDebugUtilsObjectNameEXT setObjectNameFunction;
+    const PFN_vkCmdBeginDebugUtilsLabelEXT beginLabelFunction;
+    const PFN_vkCmdEndDebugUtilsLabelEXT endLabelFunction;
+
+    Internal(const vk::Instance& instance)
+        : setObjectNameFunction(::getFunction<PFN_vkSetDebugUtilsObjectNameEXT>(instance, "vkSetDebugUtilsObjectNameEXT")),
+          beginLabelFunction(::getFunction<PFN_vkCmdBeginDebugUtilsLabelEXT>(instance, "vkCmdBeginDebugUtilsLabelEXT")),
+          endLabelFunction(::getFunction<PFN_vkCmdEndDebugUtilsLabelEXT>(instance, "vkCmdEndDebugUtilsLabelEXT")) {}
+
+    void setObjectName(const vk::Device& device,
+                       const vk::ObjectType& objectType,
+                       const uint64_t& objectHandle,
+                       const std::string& name) const
+    {
+        if (!setObjectNameFunction)
+        {
+            return;
+        }
+
+        vk::DebugUtilsObjectNameInfoEXT info{
+            objectType,    // Object type
+            objectHandle,  // Object handle
+            name.c_str()}; // Object name
+
+        setObjectNameFunction(static_cast<VkDevice>(device),
+                              reinterpret_cast<const VkDebugUtilsObjectNameInfoEXT*>(&info));
+    }
+
+    void beginLabel(const vk::CommandBuffer& commandBuffer, const std::string& name) const
+    {
+        if (!beginLabelFunction)
+        {
+            return;
+        }
+
+        vk::DebugUtilsLabelEXT label{
+            name.c_str(),                                   // Label name
+            std::array<float, 4>{0.0f, 0.0f, 0.0f, 0.0f}}; // Color
+
+        beginLabelFunction(static_cast<VkCommandBuffer>(commandBuffer),
+                           reinterpret_cast<const VkDebugUtilsLabelEXT*>(&label));
+    }
+
+    void endLabel(const vk::CommandBuffer& commandBuffer) const
+    {
+        if (!endLabelFunction)
+        {
+            return;
+        }
+
+        endLabelFunction(static_cast<VkCommandBuffer>(commandBuffer));
+    }
+};
+
+VulkanDebugUtils::VulkanDebugUtils(const vk::Instance& instance)
+    : internal(ast::make_internal_ptr<Internal>(instance)) {}
+
+void VulkanDebugUtils::setObjectName(const vk::Device& device,
+                                     const vk::ObjectType& objectType,
+                                     const uint64_t& objectHandle,
+                                     const std::string& name) const
+{
+    internal->setObjectName(device, objectType, objectHandle, name);
+}
+
+void VulkanDebugUtils::beginLabel(const vk::CommandBuffer& commandBuffer, const std::string& name) const
+{
+    internal->beginLabel(commandBuffer, name);
+}
+
+void VulkanDebugUtils::endLabel(const vk::CommandBuffer& commandBuffer) const
+{
+    internal->endLabel(commandBuffer);
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../../core/graphics-wrapper.hpp"
+#include "../../core/internal-ptr.hpp"
+#include <string>
+
+namespace ast
+{
+    // Names Vulkan objects and labels regions of command buffers through the VK_EXT_debug_utils
+    // extension, so capture tools such as RenderDoc show meaningful names. If the extension is
+    // not available every call quietly does nothing.
+    struct VulkanDebugUtils
+    {
+        VulkanDebugUtils(const vk::Instance& instance);
+
+        void setObjectName(const vk::Device& device,
+                           const vk::ObjectType& objectType,
+                           const uint64_t& objectHandle,
+                           const std::string& name) const;
+
+        void beginLabel(const vk::CommandBuffer& commandBuffer, const std::string& name) const;
+
+        void endLabel(const vk::CommandBuffer& commandBuffer) const;
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
@@ -43,6 +43,14 @@ namespace
                     graphicsQueueIndex = currentQueueIndex;
                 }
 
+                // Without a surface nothing will be presented, so the graphics queue simply stands
+                // in as the presentation queue and we are done.
+                if (!surface)
+                {
+                    presentationQueueIndex = currentQueueIndex;
+                    break;
+                }
+
                 // We now need to see if the queue index can also behave as a presentation queue and
                 // if so, both the graphics and presentation queue indices will be the same, effectively
                 // meaning that we will only need to create a single queue and use it for both purposes.
@@ -99,7 +107,8 @@ namespace
     }
 
     vk::UniqueDevice createDevice(const ast::VulkanPhysicalDevice& physicalDevice,
-                                  const QueueConfig& queueConfig)
+                                  const QueueConfig& queueConfig,
+                                  const bool& swapchainRequired)
     {
         const float deviceQueuePriority{1.0f};
 
@@ -125,8 +134,13 @@ namespace
             });
         }
 
-        // We also need to request the swapchain extension be activated as we will need to use a swapchain
-        std::vector<const char*> extensionNames{VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+        // We also need to request the swapchain extension be activated if we will need to use a swapchain.
+        std::vector<const char*> extensionNames;
+
+        if (swapchainRequired)
+        {
+            extensionNames.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        }
 
         // Specify which physical device features to expose in our logical device
         vk::PhysicalDeviceFeatures physicalDeviceFeatures;
@@ -137,6 +151,16 @@ namespace
             physicalDeviceFeatures.sampleRateShading = true;
         }
 
+        // Enable whichever block compressed texture formats the device offers, so baked
+        // textures can stay compressed in device memory.
+        const vk::PhysicalDeviceFeatures supportedFeatures{physicalDevice.getPhysicalDevice().getFeatures()};
+        physicalDeviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+        physicalDeviceFeatures.textureCompressionETC2 = supportedFeatures.textureCompressionETC2;
+
+        // Draw commands written by the GPU need these to choose their instances and to be issued as a batch.
+        physicalDeviceFeatures.drawIndirectFirstInstance = physicalDevice.isIndirectDrawingSupported();
+        physicalDeviceFeatures.multiDrawIndirect = physicalDevice.isMultiDrawIndirectSupported();
+
         // Take the queue and extension name configurations and form the device creation definition.
         vk::DeviceCreateInfo deviceCreateInfo{
             vk::DeviceCreateFlags(),                        // Flags
@@ -185,12 +209,14 @@ namespace
         return fences;
     }
 
-    vk::UniqueShaderModule createShaderModule(const vk::Device& device, const std::vector<char>& shaderCode)
+    vk::UniqueShaderModule createShaderModule(const vk::Device& device, const ast::AssetFile& shaderFile)
     {
+        // SPIR-V code must be 4 byte aligned, which is guaranteed by both the page aligned
+        // memory mapping and the heap allocation an asset file might hold its data in.
         vk::ShaderModuleCreateInfo info{
-            vk::ShaderModuleCreateFlags(),                         // Flags
-            shaderCode.size(),                                     // Code size
-            reinterpret_cast<const uint32_t*>(shaderCode.data())}; // Code
+            vk::ShaderModuleCreateFlags(),                            // Flags
+            shaderFile.getSize(),                                     // Code size
+            reinterpret_cast<const uint32_t*>(shaderFile.getData())}; // Code
 
         return device.createShaderModuleUnique(info);
     }
@@ -202,12 +228,18 @@ struct VulkanDevice::Internal
     const vk::UniqueDevice device;
     const vk::Queue graphicsQueue;
     const vk::Queue presentationQueue;
-
-    Internal(const ast::VulkanPhysicalDevice& physicalDevice, const ast::VulkanSurface& surface)
-        : queueConfig(::getQueueConfig(physicalDevice.getPhysicalDevice(), surface.getSurface())),
-          device(::createDevice(physicalDevice, queueConfig)),
+    const ast::VulkanMemoryAllocator memoryAllocator;
+    const ast::VulkanDebugUtils debugUtils;
+
+    Internal(const vk::Instance& instance,
+             const ast::VulkanPhysicalDevice& physicalDevice,
+             const vk::SurfaceKHR& surface)
+        : queueConfig(::getQueueConfig(physicalDevice.getPhysicalDevice(), surface)),
+          device(::createDevice(physicalDevice, queueConfig, static_cast<bool>(surface))),
           graphicsQueue(::getQueue(device.get(), queueConfig.graphicsQueueIndex)),
-          presentationQueue(::getQueue(device.get(), queueConfig.presentationQueueIndex)) {}
+          presentationQueue(::getQueue(device.get(), queueConfig.presentationQueueIndex)),
+          memoryAllocator(ast::VulkanMemoryAllocator(physicalDevice, device.get())),
+          debugUtils(ast::VulkanDebugUtils(instance)) {}
 
     ~Internal()
     {
@@ -216,9 +248,14 @@ struct VulkanDevice::Internal
     }
 };
 
-VulkanDevice::VulkanDevice(const ast::VulkanPhysicalDevice& physicalDevice,
+VulkanDevice::VulkanDevice(const vk::Instance& instance,
+                           const ast::VulkanPhysicalDevice& physicalDevice,
                            const ast::VulkanSurface& surface)
-    : internal(ast::make_internal_ptr<Internal>(physicalDevice, surface)) {}
+    : internal(ast::make_internal_ptr<Internal>(instance, physicalDevice, surface.getSurface())) {}
+
+VulkanDevice::VulkanDevice(const vk::Instance& instance,
+                           const ast::VulkanPhysicalDevice& physicalDevice)
+    : internal(ast::make_internal_ptr<Internal>(instance, physicalDevice, vk::SurfaceKHR())) {}
 
 const vk::Device& VulkanDevice::getDevice() const
 {
@@ -250,6 +287,23 @@ const vk::Queue& VulkanDevice::getPresentationQueue() const
     return internal->presentationQueue;
 }
 
+const ast::VulkanMemoryAllocator& VulkanDevice::getMemoryAllocator() const
+{
+    return internal->memoryAllocator;
+}
+
+const ast::VulkanDebugUtils& VulkanDevice::getDebugUtils() const
+{
+    return internal->debugUtils;
+}
+
+void VulkanDevice::setObjectName(const vk::ObjectType& objectType,
+                                 const uint64_t& objectHandle,
+                                 const std::string& name) const
+{
+    internal->debugUtils.setObjectName(internal->device.get(), objectType, objectHandle, name);
+}
+
 std::vector<vk::UniqueSemaphore> VulkanDevice::createSemaphores(const uint32_t& count) const
 {
     return ::createSemaphores(internal->device.get(), count);
@@ -260,7 +314,7 @@ std::vector<vk::UniqueFence> VulkanDevice::createFences(const uint32_t& count) c
     return ::createFences(internal->device.get(), count);
 }
 
-vk::UniqueShaderModule VulkanDevice::createShaderModule(const std::vector<char>& shaderCode) const
+vk::UniqueShaderModule VulkanDevice::createShaderModule(const ast::AssetFile& shaderFile) const
 {
-    return ::createShaderModule(internal->device.get(), shaderCode);
+    return ::createShaderModule(internal->device.get(), shaderFile);
 }
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "../../core/asset-file.hpp"
 #include "../../core/graphics-wrapper.hpp"
 #include "../../core/internal-ptr.hpp"
+#include "vulkan-debug-utils.hpp"
+#include "vulkan-memory-allocator.hpp"
 #include "vulkan-physical-device.hpp"
 #include "vulkan-surface.hpp"
 #include <vector>
@@ -10,9 +13,14 @@ namespace ast
 {
     struct VulkanDevice
     {
-        VulkanDevice(const ast::VulkanPhysicalDevice& physicalDevice,
+        VulkanDevice(const vk::Instance& instance,
+                     const ast::VulkanPhysicalDevice& physicalDevice,
                      const ast::VulkanSurface& surface);
 
+        // Creates a device without presentation support, for rendering headless.
+        VulkanDevice(const vk::Instance& instance,
+                     const ast::VulkanPhysicalDevice& physicalDevice);
+
         const vk::Device& getDevice() const;
 
         uint32_t getGraphicsQueueIndex() const;
@@ -25,11 +33,20 @@ namespace ast
 
         const vk::Queue& getPresentationQueue() const;
 
+        const ast::VulkanMemoryAllocator& getMemoryAllocator() const;
+
+        const ast::VulkanDebugUtils& getDebugUtils() const;
+
+        // Gives a Vulkan object a name for capture and debugging tools to show.
+        void setObjectName(const vk::ObjectType& objectType,
+                           const uint64_t& objectHandle,
+                           const std::string& name) const;
+
         std::vector<vk::UniqueSemaphore> createSemaphores(const uint32_t& count) const;
 
         std::vector<vk::UniqueFence> createFences(const uint32_t& count) const;
 
-		vk::UniqueShaderModule createShaderModule(const std::vector<char>& shaderCode) const;
+		vk::UniqueShaderModule createShaderModule(const ast::AssetFile& shaderFile) const;
 
     private:
         struct Internal;
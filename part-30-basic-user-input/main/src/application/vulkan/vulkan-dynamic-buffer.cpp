@@ -0,0 +1,120 @@
+#include "vulkan-dynamic-buffer.hpp"
+#include "vulkan-buffer.hpp"
+#include <algorithm>
+#include <vector>
+
+using ast::VulkanDynamicBuffer;
+
+namespace
+{
+    vk::DeviceSize getRangeAlignment(const ast::VulkanPhysicalDevice& physicalDevice,
+                                     const vk::BufferUsageFlags& bufferFlags)
+    {
+        // Ranges are aligned so they can safely hold vectors and matrices of floats.
+        vk::DeviceSize alignment{16};
+
+        // Ranges bound as storage buffers must also start where the device allows them to.
+        if (bufferFlags & vk::BufferUsageFlagBits::eStorageBuffer)
+        {
+            const vk::PhysicalDeviceLimits limits{physicalDevice.getPhysicalDevice().getProperties().limits};
+            alignment = std::max(alignment, limits.minStorageBufferOffsetAlignment);
+        }
+
+        return alignment;
+    }
+
+    struct Chunk
+    {
+        ast::VulkanBuffer buffer;
+        vk::DeviceSize size;
+    };
+} // namespace
+
+struct VulkanDynamicBuffer::Internal
+{
+    const ast::VulkanPhysicalDevice& physicalDevice;
+    const ast::VulkanDevice& device;
+    const vk::BufferUsageFlags bufferFlags;
+    const vk::DeviceSize chunkSize;
+    const vk::DeviceSize rangeAlignment;
+    std::vector<::Chunk> chunks;
+    size_t currentChunk;
+    vk::DeviceSize currentOffset;
+
+    Internal(const ast::VulkanPhysicalDevice& physicalDevice,
+             const ast::VulkanDevice& device,
+             const vk::BufferUsageFlags& bufferFlags,
+             const vk::DeviceSize& chunkSize)
+        : physicalDevice(physicalDevice),
+          device(device),
+          bufferFlags(bufferFlags),
+          chunkSize(chunkSize),
+          rangeAlignment(::getRangeAlignment(physicalDevice, bufferFlags)),
+          currentChunk(0),
+          currentOffset(0) {}
+
+    ast::VulkanBufferRange allocate(const vk::DeviceSize& size)
+    {
+        // Move through the existing chunks until we find one with enough room left in it.
+        while (currentChunk < chunks.size())
+        {
+            const vk::DeviceSize offset{(currentOffset + rangeAlignment - 1) & ~(rangeAlignment - 1)};
+            const ::Chunk& chunk{chunks[currentChunk]};
+
+            if (offset + size <= chunk.size)
+            {
+                currentOffset = offset + size;
+
+                return ast::VulkanBufferRange{
+                    chunk.buffer.getBuffer(),
+                    offset,
+                    static_cast<char*>(chunk.buffer.getMappedMemory()) + offset};
+            }
+
+            currentChunk++;
+            currentOffset = 0;
+        }
+
+        // None of the chunks had room, so add a new one which is big enough for the request.
+        const vk::DeviceSize newChunkSize{std::max(chunkSize, size)};
+
+        chunks.push_back(::Chunk{
+            ast::VulkanBuffer(physicalDevice,
+                              device,
+                              newChunkSize,
+                              bufferFlags,
+                              vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                              nullptr),
+            newChunkSize});
+
+        currentChunk = chunks.size() - 1;
+        currentOffset = size;
+
+        return ast::VulkanBufferRange{
+            chunks.back().buffer.getBuffer(),
+            0,
+            chunks.back().buffer.getMappedMemory()};
+    }
+
+    void reset()
+    {
+        currentChunk = 0;
+        currentOffset = 0;
+    }
+};
+
+VulkanDynamicBuffer::VulkanDynamicBuffer(const ast::VulkanPhysicalDevice& physicalDevice,
+                                         const ast::VulkanDevice& device,
+                                         const vk::BufferUsageFlags& bufferFlags,
+                                         const vk::DeviceSize& chunkSize)
+    : internal(ast::make_internal_ptr<Internal>(physicalDevice, device, bufferFlags, chunkSize)) {}
+
+ast::VulkanBufferRange VulkanDynamicBuffer::allocate(const vk::DeviceSize& size) const
+{
+    return internal->allocate(size);
+}
+
+void VulkanDynamicBuffer::reset() const
+{
+    internal->reset();
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../../core/graphics-wrapper.hpp"
+#include "../../core/internal-ptr.hpp"
+#include "vulkan-device.hpp"
+#include "vulkan-physical-device.hpp"
+
+namespace ast
+{
+    // A range of a host visible buffer which can be written to directly through its mapped memory.
+    struct VulkanBufferRange
+    {
+        vk::Buffer buffer;
+        vk::DeviceSize offset;
+        void* mappedMemory;
+    };
+
+    // A dynamic buffer hands out ranges of host visible memory for data that changes every
+    // frame, such as instance transforms. Ranges are simply bumped along the end of the current
+    // chunk, with new chunks added as needed. Calling 'reset' makes all the chunks available
+    // again, which must only be done once the GPU is no longer reading from them.
+    struct VulkanDynamicBuffer
+    {
+        VulkanDynamicBuffer(const ast::VulkanPhysicalDevice& physicalDevice,
+                            const ast::VulkanDevice& device,
+                            const vk::BufferUsageFlags& bufferFlags,
+                            const vk::DeviceSize& chunkSize);
+
+        ast::VulkanBufferRange allocate(const vk::DeviceSize& size) const;
+
+        void reset() const;
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include "vulkan-gpu-timer.hpp"
+#include "../../core/gpu-timings.hpp"
+#include <limits>
+#include <vector>
+
+using ast::VulkanGpuTimer;
+
+namespace
+{
+    // Every zone takes two queries, so this allows for plenty of zones in each frame.
+    constexpr uint32_t maxQueriesPerFrame{128};
+
+    // Marks a zone on the stack of open zones which ran out of queries so isn't being timed.
+    constexpr size_t untimedZone{std::numeric_limits<size_t>::max()};
+
+    struct TimedZone
+    {
+        std::string name;
+        uint32_t beginQuery;
+        uint32_t endQuery;
+    };
+
+    uint32_t getTimestampValidBits(const ast::VulkanPhysicalDevice& physicalDevice,
+                                   const ast::VulkanDevice& device)
+    {
+        // Timestamps are only supported on queues which report some valid bits for them.
+        std::vector<vk::QueueFamilyProperties> queueFamilies{
+            physicalDevice.getPhysicalDevice().getQueueFamilyProperties()};
+
+        return queueFamilies[device.getGraphicsQueueIndex()].timestampValidBits;
+    }
+
+    std::vector<vk::UniqueQueryPool> createQueryPools(const ast::VulkanDevice& device,
+                                                      const uint32_t& timestampValidBits,
+                                                      const uint32_t& count)
+    {
+        std::vector<vk::UniqueQueryPool> queryPools;
+
+        if (timestampValidBits == 0)
+        {
+            return queryPools;
+        }
+
+        vk::QueryPoolCreateInfo info{
+            vk::QueryPoolCreateFlags(),         // Flags
+            vk::QueryType::eTimestamp,          // Query type
+            ::maxQueriesPerFrame,               // Query count
+            vk::QueryPipelineStatisticFlags()}; // Pipeline statistics
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            queryPools.push_back(device.getDevice().createQueryPoolUnique(info));
+        }
+
+        return queryPools;
+    }
+
+    std::vector<std::vector<::TimedZone>> createFrameZones(const std::vector<vk::UniqueQueryPool>& queryPools)
+    {
+        return std::vector<std::vector<::TimedZone>>(queryPools.size());
+    }
+} // namespace
+
+struct VulkanGpuTimer::Internal
+{
+    const uint32_t timestampValidBits;
+    const double nanosecondsPerTick;
+    const std::vector<vk::UniqueQueryPool> queryPools;
+
+    // The zones recorded into each frame in flight, which are resolved the next time around.
+    std::vector<std::vector<::TimedZone>> frameZones;
+    std::vector<uint64_t> timestamps;
+    std::vector<size_t> openZones;
+    ast::GpuTimings timings;
+    uint32_t currentFrameIndex{0};
+    uint32_t queryCount{0};
+
+    Internal(const ast::VulkanPhysicalDevice& physicalDevice,
+             const ast::VulkanDevice& device,
+             const uint32_t& framesInFlight)
+        : timestampValidBits(::getTimestampValidBits(physicalDevice, device)),
+          nanosecondsPerTick(physicalDevice.getPhysicalDevice().getProperties().limits.timestampPeriod),
+          queryPools(::createQueryPools(device, timestampValidBits, framesInFlight)),
+          frameZones(::createFrameZones(queryPools)),
+          timestamps(::maxQueriesPerFrame, 0) {}
+
+    uint64_t getTimestampDelta(const uint64_t& begin, const uint64_t& end) const
+    {
+        // Only the lowest valid bits of a timestamp are meaningful, so the counter may wrap.
+        const uint64_t mask{timestampValidBits >= 64 ? std::numeric_limits<uint64_t>::max()
+                                                     : (static_cast<uint64_t>(1) << timestampValidBits) - 1};
+
+        return ((end & mask) - (begin & mask)) & mask;
+    }
+
+    void collectResults(const ast::VulkanDevice& device)
+    {
+        std::vector<::TimedZone>& zones{frameZones[currentFrameIndex]};
+
+        if (zones.empty())
+        {
+            return;
+        }
+
+        // The timed zones of a frame always use up its queries in order from the first one.
+        const uint32_t resultCount{static_cast<uint32_t>(zones.size() * 2)};
+
+        // We never ask to wait for the results - if the GPU somehow hasn't produced them yet
+        // the frame is simply left out of the timings rather than holding up the CPU.
+        const vk::Result result{device.getDevice().getQueryPoolResults(
+            queryPools[currentFrameIndex].get(), // Query pool
+            0,                                   // First query
+            resultCount,                         // Query count
+            resultCount * sizeof(uint64_t),      // Data size
+            timestamps.data(),                   // Data
+            sizeof(uint64_t),                    // Stride
+            vk::QueryResultFlagBits::e64)};      // Flags
+
+        if (result == vk::Result::eSuccess)
+        {
+            for (const auto& zone : zones)
+            {
+                const uint64_t ticks{getTimestampDelta(timestamps[zone.beginQuery], timestamps[zone.endQuery])};
+
+                timings.add(zone.name, static_cast<double>(ticks) * nanosecondsPerTick / 1000000.0);
+            }
+
+            timings.frameComplete();
+        }
+
+        zones.clear();
+    }
+
+    void beginFrame(const ast::VulkanDevice& device,
+                    const vk::CommandBuffer& commandBuffer,
+                    const uint32_t& frameIndex)
+    {
+        currentFrameIndex = frameIndex;
+        queryCount = 0;
+        openZones.clear();
+
+        if (!queryPools.empty())
+        {
+            // The fence of this frame has been waited on, so its previous queries have completed.
+            collectResults(device);
+
+            commandBuffer.resetQueryPool(queryPools[currentFrameIndex].get(), 0, ::maxQueriesPerFrame);
+        }
+
+        beginZone(device, commandBuffer, "Frame");
+    }
+
+    void beginZone(const ast::VulkanDevice& device,
+                   const vk::CommandBuffer& commandBuffer,
+                   const std::string& name)
+    {
+        device.getDebugUtils().beginLabel(commandBuffer, name);
+
+        if (queryPools.empty() || queryCount + 2 > ::maxQueriesPerFrame)
+        {
+            openZones.push_back(::untimedZone);
+            return;
+        }
+
+        std::vector<::TimedZone>& zones{frameZones[currentFrameIndex]};
+
+        zones.push_back(::TimedZone{name, queryCount, queryCount + 1});
+        openZones.push_back(zones.size() - 1);
+        queryCount += 2;
+
+        commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe,
+                                     queryPools[currentFrameIndex].get(),
+                                     zones.back().beginQuery);
+    }
+
+    void endZone(const ast::VulkanDevice& device, const vk::CommandBuffer& commandBuffer)
+    {
+        if (openZones.empty())
+        {
+            return;
+        }
+
+        const size_t zoneIndex{openZones.back()};
+        openZones.pop_back();
+
+        if (zoneIndex != ::untimedZone)
+        {
+            commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe,
+                                         queryPools[currentFrameIndex].get(),
+                                         frameZones[currentFrameIndex][zoneIndex].endQuery);
+        }
+
+        device.getDebugUtils().endLabel(commandBuffer);
+    }
+
+    void endFrame(const ast::VulkanDevice& device, const vk::CommandBuffer& commandBuffer)
+    {
+        // Close any zones which were left open so every query of the frame gets written.
+        while (!openZones.empty())
+        {
+            endZone(device, commandBuffer);
+        }
+    }
+};
+
+VulkanGpuTimer::VulkanGpuTimer(const ast::VulkanPhysicalDevice& physicalDevice,
+                               const ast::VulkanDevice& device,
+                               const uint32_t& framesInFlight)
+    : internal(ast::make_internal_ptr<Internal>(physicalDevice, device, framesInFlight)) {}
+
+void VulkanGpuTimer::beginFrame(const ast::VulkanDevice& device,
+                                const vk::CommandBuffer& commandBuffer,
+                                const uint32_t& frameIndex)
+{
+    internal->beginFrame(device, commandBuffer, frameIndex);
+}
+
+void VulkanGpuTimer::beginZone(const ast::VulkanDevice& device,
+                               const vk::CommandBuffer& commandBuffer,
+                               const std::string& name)
+{
+    internal->beginZone(device, commandBuffer, name);
+}
+
+void VulkanGpuTimer::endZone(const ast::VulkanDevice& device, const vk::CommandBuffer& commandBuffer)
+{
+    internal->endZone(device, commandBuffer);
+}
+
+void VulkanGpuTimer::endFrame(const ast::VulkanDevice& device, const vk::CommandBuffer& commandBuffer)
+{
+    internal->endFrame(device, commandBuffer);
+}
\ No newline at end of file
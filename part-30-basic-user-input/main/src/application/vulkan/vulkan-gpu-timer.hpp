@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../../core/graphics-wrapper.hpp"
+#include "../../core/internal-ptr.hpp"
+#include "vulkan-device.hpp"
+#include "vulkan-physical-device.hpp"
+#include <string>
+
+namespace ast
+{
+    // Measures how long the GPU spends in named zones of each render frame with timestamp
+    // queries, and labels the same zones in the command buffer for capture tools. Each frame in
+    // flight has its own query pool whose results are only collected once the frame's fence has
+    // been waited on, so reading them back never stalls the CPU.
+    struct VulkanGpuTimer
+    {
+        VulkanGpuTimer(const ast::VulkanPhysicalDevice& physicalDevice,
+                       const ast::VulkanDevice& device,
+                       const uint32_t& framesInFlight);
+
+        // Must be recorded outside of a render pass, as the frame's queries are reset here.
+        void beginFrame(const ast::VulkanDevice& device,
+                        const vk::CommandBuffer& commandBuffer,
+                        const uint32_t& frameIndex);
+
+        void beginZone(const ast::VulkanDevice& device,
+                       const vk::CommandBuffer& commandBuffer,
+                       const std::string& name);
+
+        void endZone(const ast::VulkanDevice& device, const vk::CommandBuffer& commandBuffer);
+
+        void endFrame(const ast::VulkanDevice& device, const vk::CommandBuffer& commandBuffer);
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
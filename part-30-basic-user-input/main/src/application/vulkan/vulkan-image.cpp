@@ -37,58 +37,46 @@ namespace
         return device.createImageUnique(imageInfo);
     }
 
-    vk::UniqueDeviceMemory allocateImageMemory(const ast::VulkanPhysicalDevice& physicalDevice,
-                                               const vk::Device& device,
-                                               const vk::Image& image,
-                                               const vk::MemoryPropertyFlags& memoryFlags)
+    ast::VulkanMemoryAllocation allocateImageMemory(const ast::VulkanDevice& device,
+                                                    const vk::Image& image,
+                                                    const vk::ImageTiling& tiling,
+                                                    const vk::MemoryPropertyFlags& memoryFlags)
     {
         // Discover what the memory requirements are for the specified image configuration.
-        vk::MemoryRequirements memoryRequirements{device.getImageMemoryRequirements(image)};
+        vk::MemoryRequirements memoryRequirements{device.getDevice().getImageMemoryRequirements(image)};
 
-        // Query the physical device to determine where to find the memory type the image requires.
-        uint32_t memoryTypeIndex{physicalDevice.getMemoryTypeIndex(memoryRequirements.memoryTypeBits, memoryFlags)};
-
-        // Form a configuration to model what kind of memory to allocate.
-        vk::MemoryAllocateInfo info{
-            memoryRequirements.size, // Allocation size
-            memoryTypeIndex};        // Memory type index
-
-        // Request that the logical device allocate memory for our configuration.
-        vk::UniqueDeviceMemory deviceMemory{device.allocateMemoryUnique(info)};
+        // Ask the memory allocator for a suitable range of memory, telling it whether the image
+        // is linear so it is kept apart from optimally tiled images.
+        ast::VulkanMemoryAllocation memory{device.getMemoryAllocator().allocate(
+            memoryRequirements,
+            memoryFlags,
+            tiling == vk::ImageTiling::eLinear)};
 
         // Bind the image to the allocated memory to associate them with each other.
-        device.bindImageMemory(image, deviceMemory.get(), 0);
+        device.getDevice().bindImageMemory(image, memory.getDeviceMemory(), memory.getOffset());
 
         // Give back the allocated memory.
-        return deviceMemory;
+        return memory;
     }
 
-    void applyTransitionLayoutCommand(const ast::VulkanDevice& device,
-                                      const ast::VulkanCommandPool& commandPool,
+    void applyTransitionLayoutCommand(const vk::CommandBuffer& commandBuffer,
                                       const vk::PipelineStageFlags& sourceStageFlags,
                                       const vk::PipelineStageFlags& destinationStageFlags,
                                       const vk::ImageMemoryBarrier& barrier)
     {
-        // Obtain a new command buffer than has been started.
-        vk::UniqueCommandBuffer commandBuffer{commandPool.beginCommandBuffer(device)};
-
         // Issue a 'pipeline barrier' command, using the image memory barrier as configuration
         // and the source / destination stage flags to determine where in the graphics pipeline
         // to apply the command.
-        commandBuffer->pipelineBarrier(
+        commandBuffer.pipelineBarrier(
             sourceStageFlags,
             destinationStageFlags,
             vk::DependencyFlags(),
             0, nullptr,
             0, nullptr,
             1, &barrier);
-
-        // End the command buffer, causing it to be run.
-        commandPool.endCommandBuffer(commandBuffer.get(), device);
     }
 
-    void transitionLayout(const ast::VulkanDevice& device,
-                          const ast::VulkanCommandPool& commandPool,
+    void transitionLayout(const vk::CommandBuffer& commandBuffer,
                           const vk::Image& image,
                           const vk::Format& format,
                           const uint32_t& mipLevels,
@@ -112,8 +100,7 @@ namespace
         {
             barrier.dstAccessMask = vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite;
 
-            return ::applyTransitionLayoutCommand(device,
-                                                  commandPool,
+            return ::applyTransitionLayoutCommand(commandBuffer,
                                                   vk::PipelineStageFlagBits::eTopOfPipe,
                                                   vk::PipelineStageFlagBits::eColorAttachmentOutput,
                                                   barrier);
@@ -125,8 +112,7 @@ namespace
             barrier.dstAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
             barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eDepth;
 
-            return ::applyTransitionLayoutCommand(device,
-                                                  commandPool,
+            return ::applyTransitionLayoutCommand(commandBuffer,
                                                   vk::PipelineStageFlagBits::eTopOfPipe,
                                                   vk::PipelineStageFlagBits::eEarlyFragmentTests,
                                                   barrier);
@@ -137,8 +123,7 @@ namespace
         {
             barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
 
-            return ::applyTransitionLayoutCommand(device,
-                                                  commandPool,
+            return ::applyTransitionLayoutCommand(commandBuffer,
                                                   vk::PipelineStageFlagBits::eTopOfPipe,
                                                   vk::PipelineStageFlagBits::eTransfer,
                                                   barrier);
@@ -147,6 +132,30 @@ namespace
         // An unknown combination might mean we need to add a new scenario to handle it.
         throw std::runtime_error("ast::VulkanImage::transitionLayout: Unsupported 'old' and 'new' image layout combination.");
     }
+
+    void transitionLayout(const ast::VulkanDevice& device,
+                          const ast::VulkanCommandPool& commandPool,
+                          const vk::Image& image,
+                          const vk::Format& format,
+                          const uint32_t& mipLevels,
+                          const vk::ImageLayout& oldLayout,
+                          const vk::ImageLayout& newLayout)
+    {
+        // Images which are only ever used as attachments can be left undefined for the render
+        // pass to transition, which saves submitting work and waiting for the graphics queue.
+        if (oldLayout == newLayout)
+        {
+            return;
+        }
+
+        // Obtain a new command buffer than has been started.
+        vk::UniqueCommandBuffer commandBuffer{commandPool.beginCommandBuffer(device)};
+
+        ::transitionLayout(commandBuffer.get(), image, format, mipLevels, oldLayout, newLayout);
+
+        // End the command buffer, causing it to be run.
+        commandPool.endCommandBuffer(commandBuffer.get(), device);
+    }
 } // namespace
 
 struct VulkanImage::Internal
@@ -156,10 +165,9 @@ struct VulkanImage::Internal
     const uint32_t mipLevels;
     const vk::Format format;
     const vk::UniqueImage image;
-    const vk::UniqueDeviceMemory imageMemory;
+    const ast::VulkanMemoryAllocation imageMemory;
 
-    Internal(const ast::VulkanCommandPool& commandPool,
-             const ast::VulkanPhysicalDevice& physicalDevice,
+    Internal(const ast::VulkanPhysicalDevice& physicalDevice,
              const ast::VulkanDevice& device,
              const uint32_t& width,
              const uint32_t& height,
@@ -168,18 +176,13 @@ struct VulkanImage::Internal
              const vk::Format& format,
              const vk::ImageTiling& tiling,
              const vk::ImageUsageFlags& usageFlags,
-             const vk::MemoryPropertyFlags& memoryFlags,
-             const vk::ImageLayout& oldLayout,
-             const vk::ImageLayout& newLayout)
+             const vk::MemoryPropertyFlags& memoryFlags)
         : width(width),
           height(height),
           mipLevels(mipLevels),
           format(format),
           image(::createImage(device.getDevice(), width, height, mipLevels, sampleCount, format, tiling, usageFlags)),
-          imageMemory(::allocateImageMemory(physicalDevice, device.getDevice(), image.get(), memoryFlags))
-    {
-        ::transitionLayout(device, commandPool, image.get(), format, mipLevels, oldLayout, newLayout);
-    }
+          imageMemory(::allocateImageMemory(device, image.get(), tiling, memoryFlags)) {}
 };
 
 VulkanImage::VulkanImage(const ast::VulkanCommandPool& commandPool,
@@ -195,8 +198,34 @@ VulkanImage::VulkanImage(const ast::VulkanCommandPool& commandPool,
                          const vk::MemoryPropertyFlags& memoryFlags,
                          const vk::ImageLayout& oldLayout,
                          const vk::ImageLayout& newLayout)
-    : internal(ast::make_internal_ptr<Internal>(commandPool,
-                                                physicalDevice,
+    : internal(ast::make_internal_ptr<Internal>(physicalDevice,
+                                                device,
+                                                width,
+                                                height,
+                                                mipLevels,
+                                                sampleCount,
+                                                format,
+                                                tiling,
+                                                usageFlags,
+                                                memoryFlags))
+{
+    ::transitionLayout(device, commandPool, internal->image.get(), format, mipLevels, oldLayout, newLayout);
+}
+
+VulkanImage::VulkanImage(const vk::CommandBuffer& commandBuffer,
+                         const ast::VulkanPhysicalDevice& physicalDevice,
+                         const ast::VulkanDevice& device,
+                         const uint32_t& width,
+                         const uint32_t& height,
+                         const uint32_t& mipLevels,
+                         const vk::SampleCountFlagBits& sampleCount,
+                         const vk::Format& format,
+                         const vk::ImageTiling& tiling,
+                         const vk::ImageUsageFlags& usageFlags,
+                         const vk::MemoryPropertyFlags& memoryFlags,
+                         const vk::ImageLayout& oldLayout,
+                         const vk::ImageLayout& newLayout)
+    : internal(ast::make_internal_ptr<Internal>(physicalDevice,
                                                 device,
                                                 width,
                                                 height,
@@ -205,9 +234,11 @@ VulkanImage::VulkanImage(const ast::VulkanCommandPool& commandPool,
                                                 format,
                                                 tiling,
                                                 usageFlags,
-                                                memoryFlags,
-                                                oldLayout,
-                                                newLayout)) {}
+                                                memoryFlags))
+{
+    // Record the layout transition into the given command buffer rather than running it now.
+    ::transitionLayout(commandBuffer, internal->image.get(), format, mipLevels, oldLayout, newLayout);
+}
 
 uint32_t VulkanImage::getWidth() const
 {
@@ -24,6 +24,20 @@ namespace ast
                     const vk::ImageLayout& oldLayout,
                     const vk::ImageLayout& newLayout);
 
+        VulkanImage(const vk::CommandBuffer& commandBuffer,
+                    const ast::VulkanPhysicalDevice& physicalDevice,
+                    const ast::VulkanDevice& device,
+                    const uint32_t& width,
+                    const uint32_t& height,
+                    const uint32_t& mipLevels,
+                    const vk::SampleCountFlagBits& sampleCount,
+                    const vk::Format& format,
+                    const vk::ImageTiling& tiling,
+                    const vk::ImageUsageFlags& usageFlags,
+                    const vk::MemoryPropertyFlags& memoryFlags,
+                    const vk::ImageLayout& oldLayout,
+                    const vk::ImageLayout& newLayout);
+
         uint32_t getWidth() const;
 
         uint32_t getHeight() const;
@@ -0,0 +1,370 @@
+#include "vulkan-memory-allocator.hpp"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using ast::VulkanMemoryAllocation;
+using ast::VulkanMemoryAllocator;
+
+namespace
+{
+    // The size of each block of memory requested from the driver. Resources which would take
+    // up more than half of a block are given their own dedicated block instead, as they would
+    // otherwise leave a large hole that few other resources could fill.
+    constexpr vk::DeviceSize blockSize{64 * 1024 * 1024};
+    constexpr vk::DeviceSize dedicatedThreshold{blockSize / 2};
+
+    struct Block
+    {
+        vk::UniqueDeviceMemory deviceMemory;
+        vk::DeviceSize size;
+        void* mappedMemory;
+        bool dedicated;
+        uint32_t allocationCount;
+        vk::DeviceSize bytesInUse;
+
+        // The free ranges in the block, keyed by their offset so neighbours can be merged.
+        std::map<vk::DeviceSize, vk::DeviceSize> freeRanges;
+    };
+
+    // Buffers and linear images are kept apart from optimal images in separate pools. This
+    // means we never need to worry about 'bufferImageGranularity' for neighbouring resources.
+    struct Pool
+    {
+        std::vector<std::unique_ptr<::Block>> blocks;
+    };
+
+    vk::DeviceSize alignOffset(const vk::DeviceSize& offset, const vk::DeviceSize& alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    std::unique_ptr<::Block> createBlock(const vk::Device& device,
+                                         const vk::PhysicalDeviceMemoryProperties& memoryProperties,
+                                         const uint32_t& memoryTypeIndex,
+                                         const vk::DeviceSize& size,
+                                         const bool& dedicated)
+    {
+        vk::MemoryAllocateInfo info{
+            size,             // Allocation size
+            memoryTypeIndex}; // Memory type index
+
+        std::unique_ptr<::Block> block{std::make_unique<::Block>()};
+        block->deviceMemory = device.allocateMemoryUnique(info);
+        block->size = size;
+        block->mappedMemory = nullptr;
+        block->dedicated = dedicated;
+        block->allocationCount = 0;
+        block->bytesInUse = 0;
+        block->freeRanges[0] = size;
+
+        // Host visible blocks are mapped once for their whole lifetime. Freeing the memory will
+        // implicitly unmap it so there is no need to ever unmap it ourselves. We check the
+        // memory type itself rather than what was asked for, as a block may later serve a host
+        // visible request even if the request that created it didn't need it to be mapped.
+        if (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible)
+        {
+            block->mappedMemory = device.mapMemory(block->deviceMemory.get(), 0, size);
+        }
+
+        return block;
+    }
+
+    bool allocateFromBlock(::Block& block,
+                           const vk::DeviceSize& size,
+                           const vk::DeviceSize& alignment,
+                           vk::DeviceSize& offset)
+    {
+        // Walk the free ranges looking for the first one that can fit the size once aligned.
+        for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); it++)
+        {
+            const vk::DeviceSize rangeOffset{it->first};
+            const vk::DeviceSize rangeSize{it->second};
+            const vk::DeviceSize alignedOffset{::alignOffset(rangeOffset, alignment)};
+            const vk::DeviceSize padding{alignedOffset - rangeOffset};
+
+            if (rangeSize < padding + size)
+            {
+                continue;
+            }
+
+            // Carve the allocation out of the range, putting back any space either side of it.
+            block.freeRanges.erase(it);
+
+            if (padding > 0)
+            {
+                block.freeRanges[rangeOffset] = padding;
+            }
+
+            const vk::DeviceSize remaining{rangeSize - padding - size};
+
+            if (remaining > 0)
+            {
+                block.freeRanges[alignedOffset + size] = remaining;
+            }
+
+            offset = alignedOffset;
+            return true;
+        }
+
+        return false;
+    }
+
+    void releaseToBlock(::Block& block, const vk::DeviceSize& offset, const vk::DeviceSize& size)
+    {
+        auto it{block.freeRanges.emplace(offset, size).first};
+
+        // Merge with the following range if it starts exactly where we end.
+        auto next{std::next(it)};
+
+        if (next != block.freeRanges.end() && it->first + it->second == next->first)
+        {
+            it->second += next->second;
+            block.freeRanges.erase(next);
+        }
+
+        // Merge with the preceding range if it ends exactly where we start.
+        if (it != block.freeRanges.begin())
+        {
+            auto previous{std::prev(it)};
+
+            if (previous->first + previous->second == it->first)
+            {
+                previous->second += it->second;
+                block.freeRanges.erase(it);
+            }
+        }
+    }
+} // namespace
+
+struct VulkanMemoryAllocation::Internal
+{
+    const vk::DeviceMemory deviceMemory;
+    const vk::DeviceSize offset;
+    const vk::DeviceSize size;
+    void* mappedMemory;
+    const std::function<void()> release;
+
+    Internal(const vk::DeviceMemory& deviceMemory,
+             const vk::DeviceSize& offset,
+             const vk::DeviceSize& size,
+             void* mappedMemory,
+             std::function<void()> release)
+        : deviceMemory(deviceMemory),
+          offset(offset),
+          size(size),
+          mappedMemory(mappedMemory),
+          release(std::move(release)) {}
+
+    ~Internal()
+    {
+        release();
+    }
+};
+
+VulkanMemoryAllocation::VulkanMemoryAllocation(const vk::DeviceMemory& deviceMemory,
+                                               const vk::DeviceSize& offset,
+                                               const vk::DeviceSize& size,
+                                               void* mappedMemory,
+                                               std::function<void()> release)
+    : internal(ast::make_internal_ptr<Internal>(deviceMemory, offset, size, mappedMemory, std::move(release))) {}
+
+const vk::DeviceMemory& VulkanMemoryAllocation::getDeviceMemory() const
+{
+    return internal->deviceMemory;
+}
+
+vk::DeviceSize VulkanMemoryAllocation::getOffset() const
+{
+    return internal->offset;
+}
+
+vk::DeviceSize VulkanMemoryAllocation::getSize() const
+{
+    return internal->size;
+}
+
+void* VulkanMemoryAllocation::getMappedMemory() const
+{
+    return internal->mappedMemory;
+}
+
+struct VulkanMemoryAllocator::Internal
+{
+    const ast::VulkanPhysicalDevice& physicalDevice;
+    const vk::PhysicalDeviceMemoryProperties memoryProperties;
+    const vk::Device device;
+    std::mutex mutex;
+
+    // Pools are keyed by their memory type index and whether they hold linear resources.
+    std::map<std::pair<uint32_t, bool>, ::Pool> pools;
+
+    Internal(const ast::VulkanPhysicalDevice& physicalDevice, const vk::Device& device)
+        : physicalDevice(physicalDevice),
+          memoryProperties(physicalDevice.getPhysicalDevice().getMemoryProperties()),
+          device(device) {}
+
+    ast::VulkanMemoryAllocation allocate(const vk::MemoryRequirements& requirements,
+                                         const vk::MemoryPropertyFlags& memoryFlags,
+                                         const bool& linear)
+    {
+        const uint32_t memoryTypeIndex{physicalDevice.getMemoryTypeIndex(requirements.memoryTypeBits, memoryFlags)};
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        ::Pool& pool{pools[std::make_pair(memoryTypeIndex, linear)]};
+
+        // Large resources get a block all to themselves.
+        if (requirements.size > ::dedicatedThreshold)
+        {
+            pool.blocks.push_back(::createBlock(device, memoryProperties, memoryTypeIndex, requirements.size, true));
+
+            return allocateFromNewBlock(pool, *pool.blocks.back(), requirements);
+        }
+
+        // Otherwise try to fit the resource into one of the blocks we already have.
+        for (auto& block : pool.blocks)
+        {
+            if (!block->dedicated)
+            {
+                vk::DeviceSize offset;
+
+                if (::allocateFromBlock(*block, requirements.size, requirements.alignment, offset))
+                {
+                    return createAllocation(pool, *block, offset, requirements.size);
+                }
+            }
+        }
+
+        // No existing block had room, so we need to grow the pool with a new block.
+        pool.blocks.push_back(::createBlock(device, memoryProperties, memoryTypeIndex, ::blockSize, false));
+
+        return allocateFromNewBlock(pool, *pool.blocks.back(), requirements);
+    }
+
+    ast::VulkanMemoryAllocation allocateFromNewBlock(::Pool& pool,
+                                                     ::Block& block,
+                                                     const vk::MemoryRequirements& requirements)
+    {
+        vk::DeviceSize offset;
+
+        // A new block always has room at offset 0, which satisfies any alignment.
+        ::allocateFromBlock(block, requirements.size, requirements.alignment, offset);
+
+        return createAllocation(pool, block, offset, requirements.size);
+    }
+
+    ast::VulkanMemoryAllocation createAllocation(::Pool& pool,
+                                                 ::Block& block,
+                                                 const vk::DeviceSize& offset,
+                                                 const vk::DeviceSize& size)
+    {
+        block.allocationCount++;
+        block.bytesInUse += size;
+
+        void* mappedMemory{block.mappedMemory ? static_cast<char*>(block.mappedMemory) + offset : nullptr};
+
+        // Pools live in a map and blocks are heap allocated, so neither will move while the
+        // allocation is alive and it is safe for the allocation to hold on to them.
+        ::Pool* owningPool{&pool};
+        ::Block* owningBlock{&block};
+
+        return ast::VulkanMemoryAllocation(block.deviceMemory.get(),
+                                           offset,
+                                           size,
+                                           mappedMemory,
+                                           [this, owningPool, owningBlock, offset, size]() {
+                                               release(*owningPool, *owningBlock, offset, size);
+                                           });
+    }
+
+    void release(::Pool& pool, ::Block& block, const vk::DeviceSize& offset, const vk::DeviceSize& size)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        ::releaseToBlock(block, offset, size);
+        block.allocationCount--;
+        block.bytesInUse -= size;
+
+        // Give empty blocks back to the driver, though we hold on to the last regular block
+        // in a pool to avoid repeatedly allocating and freeing it as resources come and go.
+        if (block.allocationCount > 0 || (!block.dedicated && countRegularBlocks(pool) == 1))
+        {
+            return;
+        }
+
+        for (auto it = pool.blocks.begin(); it != pool.blocks.end(); it++)
+        {
+            if (it->get() == &block)
+            {
+                pool.blocks.erase(it);
+                return;
+            }
+        }
+    }
+
+    size_t countRegularBlocks(const ::Pool& pool)
+    {
+        size_t count{0};
+
+        for (const auto& block : pool.blocks)
+        {
+            if (!block->dedicated)
+            {
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    ast::VulkanMemoryStatistics getStatistics()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        ast::VulkanMemoryStatistics statistics{0, 0, 0, 0, 0, 0, 0, 0.0f};
+
+        for (const auto& pool : pools)
+        {
+            for (const auto& block : pool.second.blocks)
+            {
+                statistics.blockCount++;
+                statistics.dedicatedBlockCount += block->dedicated ? 1 : 0;
+                statistics.allocationCount += block->allocationCount;
+                statistics.bytesAllocated += block->size;
+                statistics.bytesInUse += block->bytesInUse;
+
+                for (const auto& range : block->freeRanges)
+                {
+                    statistics.bytesFree += range.second;
+                    statistics.largestFreeRange = std::max(statistics.largestFreeRange, range.second);
+                }
+            }
+        }
+
+        if (statistics.bytesFree > 0)
+        {
+            statistics.fragmentation = 1.0f - static_cast<float>(statistics.largestFreeRange) / static_cast<float>(statistics.bytesFree);
+        }
+
+        return statistics;
+    }
+};
+
+VulkanMemoryAllocator::VulkanMemoryAllocator(const ast::VulkanPhysicalDevice& physicalDevice, const vk::Device& device)
+    : internal(ast::make_internal_ptr<Internal>(physicalDevice, device)) {}
+
+ast::VulkanMemoryAllocation VulkanMemoryAllocator::allocate(const vk::MemoryRequirements& requirements,
+                                                            const vk::MemoryPropertyFlags& memoryFlags,
+                                                            const bool& linear) const
+{
+    return internal->allocate(requirements, memoryFlags, linear);
+}
+
+ast::VulkanMemoryStatistics VulkanMemoryAllocator::getStatistics() const
+{
+    return internal->getStatistics();
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../../core/graphics-wrapper.hpp"
+#include "../../core/internal-ptr.hpp"
+#include "vulkan-physical-device.hpp"
+#include <functional>
+
+namespace ast
+{
+    // A range of device memory handed out by the memory allocator. The range is given back to
+    // the allocator automatically when the allocation object is destroyed.
+    struct VulkanMemoryAllocation
+    {
+        VulkanMemoryAllocation(const vk::DeviceMemory& deviceMemory,
+                               const vk::DeviceSize& offset,
+                               const vk::DeviceSize& size,
+                               void* mappedMemory,
+                               std::function<void()> release);
+
+        const vk::DeviceMemory& getDeviceMemory() const;
+
+        vk::DeviceSize getOffset() const;
+
+        vk::DeviceSize getSize() const;
+
+        // Host visible allocations are always mapped, otherwise this will be a null pointer.
+        void* getMappedMemory() const;
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+
+    struct VulkanMemoryStatistics
+    {
+        // How many device memory objects have been allocated from the driver.
+        uint32_t blockCount;
+
+        // How many of the device memory objects are dedicated to a single resource.
+        uint32_t dedicatedBlockCount;
+
+        // How many allocations are currently alive.
+        uint32_t allocationCount;
+
+        // The total number of bytes allocated from the driver.
+        vk::DeviceSize bytesAllocated;
+
+        // The number of bytes currently handed out to resources, excluding alignment padding.
+        vk::DeviceSize bytesInUse;
+
+        // The number of bytes sitting in free ranges within the blocks.
+        vk::DeviceSize bytesFree;
+
+        // The size of the largest free range in any of the blocks.
+        vk::DeviceSize largestFreeRange;
+
+        // 0 when all the free space is in a single range, approaching 1 as the free space is
+        // split into more and more small ranges which are harder to use.
+        float fragmentation;
+    };
+
+    // Rather than asking the driver for a new device memory object for every buffer and image,
+    // which is slow and limited by 'maxMemoryAllocationCount', the memory allocator requests
+    // large blocks of memory per memory type and hands out ranges within them.
+    struct VulkanMemoryAllocator
+    {
+        VulkanMemoryAllocator(const ast::VulkanPhysicalDevice& physicalDevice, const vk::Device& device);
+
+        ast::VulkanMemoryAllocation allocate(const vk::MemoryRequirements& requirements,
+                                             const vk::MemoryPropertyFlags& memoryFlags,
+                                             const bool& linear) const;
+
+        ast::VulkanMemoryStatistics getStatistics() const;
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
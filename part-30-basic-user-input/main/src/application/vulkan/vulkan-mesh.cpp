@@ -1,70 +1,81 @@
 #include "vulkan-mesh.hpp"
-#include "vulkan-buffer.hpp"
 #include <vector>
 
 using ast::VulkanMesh;
 
 namespace
 {
-    ast::VulkanBuffer createVertexBuffer(const ast::VulkanPhysicalDevice& physicalDevice,
-                                         const ast::VulkanDevice& device,
-                                         const ast::VulkanCommandPool& commandPool,
-                                         const ast::Mesh& mesh)
+    vk::IndexType getIndexType(const ast::IndexFormat& format)
     {
-        return ast::VulkanBuffer::createDeviceLocalBuffer(physicalDevice,
-                                                          device,
-                                                          commandPool,
-                                                          sizeof(ast::Vertex) * mesh.getNumVertices(),
-                                                          vk::BufferUsageFlagBits::eVertexBuffer,
-                                                          mesh.getVertices().data());
-    }
-
-    ast::VulkanBuffer createIndexBuffer(const ast::VulkanPhysicalDevice& physicalDevice,
-                                        const ast::VulkanDevice& device,
-                                        const ast::VulkanCommandPool& commandPool,
-                                        const ast::Mesh& mesh)
-    {
-        return ast::VulkanBuffer::createDeviceLocalBuffer(physicalDevice,
-                                                          device,
-                                                          commandPool,
-                                                          sizeof(uint32_t) * mesh.getNumIndices(),
-                                                          vk::BufferUsageFlagBits::eIndexBuffer,
-                                                          mesh.getIndices().data());
+        return format == ast::IndexFormat::Uint16 ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
     }
 } // namespace
 
 struct VulkanMesh::Internal
 {
-    const ast::VulkanBuffer vertexBuffer;
-    const ast::VulkanBuffer indexBuffer;
-    const uint32_t numIndices;
+    const vk::Buffer vertexBuffer;
+    const vk::Buffer indexBuffer;
+    const vk::IndexType indexType;
+    const ast::GeometryRange geometryRange;
+    const std::vector<ast::MeshLevelOfDetail> levels;
+    const ast::VertexDequantization dequantization;
+    const ast::BoundingBox boundingBox;
 
-    Internal(const ast::VulkanPhysicalDevice& physicalDevice,
-             const ast::VulkanDevice& device,
-             const ast::VulkanCommandPool& commandPool,
-             const ast::Mesh& mesh)
-        : vertexBuffer(::createVertexBuffer(physicalDevice, device, commandPool, mesh)),
-          indexBuffer(::createIndexBuffer(physicalDevice, device, commandPool, mesh)),
-          numIndices(mesh.getNumIndices()) {}
+    Internal(const ast::EncodedMesh& mesh,
+             const vk::Buffer& vertexBuffer,
+             const vk::Buffer& indexBuffer,
+             const ast::GeometryRange& geometryRange)
+        : vertexBuffer(vertexBuffer),
+          indexBuffer(indexBuffer),
+          indexType(::getIndexType(mesh.indexFormat)),
+          geometryRange(geometryRange),
+          levels(mesh.levels),
+          dequantization(mesh.dequantization),
+          boundingBox(mesh.boundingBox) {}
 };
 
-VulkanMesh::VulkanMesh(const ast::VulkanPhysicalDevice& physicalDevice,
-                       const ast::VulkanDevice& device,
-                       const ast::VulkanCommandPool& commandPool,
-                       const ast::Mesh& mesh)
-    : internal(ast::make_internal_ptr<Internal>(physicalDevice, device, commandPool, mesh)) {}
+VulkanMesh::VulkanMesh(const ast::EncodedMesh& mesh,
+                       const vk::Buffer& vertexBuffer,
+                       const vk::Buffer& indexBuffer,
+                       const ast::GeometryRange& geometryRange)
+    : internal(ast::make_internal_ptr<Internal>(mesh, vertexBuffer, indexBuffer, geometryRange)) {}
 
 const vk::Buffer& VulkanMesh::getVertexBuffer() const
 {
-    return internal->vertexBuffer.getBuffer();
+    return internal->vertexBuffer;
 }
 
 const vk::Buffer& VulkanMesh::getIndexBuffer() const
 {
-    return internal->indexBuffer.getBuffer();
+    return internal->indexBuffer;
+}
+
+const vk::IndexType& VulkanMesh::getIndexType() const
+{
+    return internal->indexType;
+}
+
+const ast::GeometryRange& VulkanMesh::getGeometryRange() const
+{
+    return internal->geometryRange;
+}
+
+const ast::VertexDequantization& VulkanMesh::getDequantization() const
+{
+    return internal->dequantization;
 }
 
 const uint32_t& VulkanMesh::getNumIndices() const
 {
-    return internal->numIndices;
+    return internal->geometryRange.numIndices;
+}
+
+const std::vector<ast::MeshLevelOfDetail>& VulkanMesh::getLevels() const
+{
+    return internal->levels;
+}
+
+const ast::BoundingBox& VulkanMesh::getBoundingBox() const
+{
+    return internal->boundingBox;
 }
@@ -2,26 +2,35 @@
 
 #include "../../core/graphics-wrapper.hpp"
 #include "../../core/internal-ptr.hpp"
-#include "../../core/mesh.hpp"
-#include "vulkan-command-pool.hpp"
-#include "vulkan-device.hpp"
-#include "vulkan-physical-device.hpp"
+#include "../../core/mesh-encoder.hpp"
 
 namespace ast
 {
+    // A static mesh whose vertices and indices live in vertex and index buffers shared with
+    // other meshes. The mesh does not own those buffers, so they must outlive it.
     struct VulkanMesh
     {
-        VulkanMesh(const ast::VulkanPhysicalDevice& physicalDevice,
-                   const ast::VulkanDevice& device,
-                   const ast::VulkanCommandPool& commandPool,
-                   const ast::Mesh& mesh);
+        VulkanMesh(const ast::EncodedMesh& mesh,
+                   const vk::Buffer& vertexBuffer,
+                   const vk::Buffer& indexBuffer,
+                   const ast::GeometryRange& geometryRange);
 
         const vk::Buffer& getVertexBuffer() const;
 
         const vk::Buffer& getIndexBuffer() const;
 
+        const vk::IndexType& getIndexType() const;
+
+        const ast::GeometryRange& getGeometryRange() const;
+
+        const ast::VertexDequantization& getDequantization() const;
+
         const uint32_t& getNumIndices() const;
 
+        const std::vector<ast::MeshLevelOfDetail>& getLevels() const;
+
+        const ast::BoundingBox& getBoundingBox() const;
+
     private:
         struct Internal;
         ast::internal_ptr<Internal> internal;
@@ -0,0 +1,213 @@
+#include "vulkan-offscreen-target.hpp"
+#include "vulkan-buffer.hpp"
+#include "vulkan-common.hpp"
+#include "vulkan-image.hpp"
+#include <string>
+
+using ast::VulkanOffscreenTarget;
+
+namespace
+{
+    // Frames are always read back as 8 bit RGBA, which every Vulkan implementation is required
+    // to support as a color attachment.
+    constexpr vk::Format colorFormat{vk::Format::eR8G8B8A8Unorm};
+
+    std::vector<ast::VulkanImage> createImages(const ast::VulkanCommandPool& commandPool,
+                                               const ast::VulkanPhysicalDevice& physicalDevice,
+                                               const ast::VulkanDevice& device,
+                                               const vk::Extent2D& extent,
+                                               const uint32_t& imageCount)
+    {
+        std::vector<ast::VulkanImage> images;
+
+        for (uint32_t i = 0; i < imageCount; i++)
+        {
+            images.push_back(ast::VulkanImage(
+                commandPool,
+                physicalDevice,
+                device,
+                extent.width,
+                extent.height,
+                1,
+                vk::SampleCountFlagBits::e1,
+                ::colorFormat,
+                vk::ImageTiling::eOptimal,
+                vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+                vk::MemoryPropertyFlagBits::eDeviceLocal,
+                vk::ImageLayout::eUndefined,
+                vk::ImageLayout::eColorAttachmentOptimal));
+
+            device.setObjectName(vk::ObjectType::eImage,
+                                 ast::vulkan::getObjectHandle(images.back().getImage()),
+                                 "Offscreen image " + std::to_string(i));
+        }
+
+        return images;
+    }
+
+    std::vector<ast::VulkanImageView> createImageViews(const ast::VulkanDevice& device,
+                                                       const std::vector<ast::VulkanImage>& images)
+    {
+        std::vector<ast::VulkanImageView> imageViews;
+
+        for (const auto& image : images)
+        {
+            imageViews.push_back(ast::VulkanImageView(device.getDevice(),
+                                                      image.getImage(),
+                                                      image.getFormat(),
+                                                      vk::ImageAspectFlagBits::eColor,
+                                                      image.getMipLevels()));
+        }
+
+        return imageViews;
+    }
+
+    vk::MemoryPropertyFlags getReadbackMemoryFlags(const ast::VulkanPhysicalDevice& physicalDevice)
+    {
+        const vk::MemoryPropertyFlags cachedFlags{vk::MemoryPropertyFlagBits::eHostVisible |
+                                                  vk::MemoryPropertyFlagBits::eHostCoherent |
+                                                  vk::MemoryPropertyFlagBits::eHostCached};
+
+        // Reading from uncached memory on the CPU is very slow, so prefer cached memory for the
+        // readback buffers if the physical device has any, which software drivers always do.
+        vk::PhysicalDeviceMemoryProperties memoryProperties{physicalDevice.getPhysicalDevice().getMemoryProperties()};
+
+        for (uint32_t index = 0; index < memoryProperties.memoryTypeCount; index++)
+        {
+            if ((memoryProperties.memoryTypes[index].propertyFlags & cachedFlags) == cachedFlags)
+            {
+                return cachedFlags;
+            }
+        }
+
+        return vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+    }
+
+    std::vector<ast::VulkanBuffer> createReadbackBuffers(const ast::VulkanPhysicalDevice& physicalDevice,
+                                                         const ast::VulkanDevice& device,
+                                                         const vk::Extent2D& extent,
+                                                         const uint32_t& imageCount)
+    {
+        const vk::DeviceSize size{static_cast<vk::DeviceSize>(extent.width) * extent.height * 4};
+        const vk::MemoryPropertyFlags memoryFlags{::getReadbackMemoryFlags(physicalDevice)};
+
+        std::vector<ast::VulkanBuffer> buffers;
+
+        for (uint32_t i = 0; i < imageCount; i++)
+        {
+            buffers.push_back(ast::VulkanBuffer(physicalDevice,
+                                                device,
+                                                size,
+                                                vk::BufferUsageFlagBits::eTransferDst,
+                                                memoryFlags,
+                                                nullptr));
+        }
+
+        return buffers;
+    }
+} // namespace
+
+struct VulkanOffscreenTarget::Internal
+{
+    const vk::Extent2D extent;
+    const std::vector<ast::VulkanImage> images;
+    const std::vector<ast::VulkanImageView> imageViews;
+    const std::vector<ast::VulkanBuffer> readbackBuffers;
+
+    Internal(const ast::VulkanCommandPool& commandPool,
+             const ast::VulkanPhysicalDevice& physicalDevice,
+             const ast::VulkanDevice& device,
+             const vk::Extent2D& extent,
+             const uint32_t& imageCount)
+        : extent(extent),
+          images(::createImages(commandPool, physicalDevice, device, extent, imageCount)),
+          imageViews(::createImageViews(device, images)),
+          readbackBuffers(::createReadbackBuffers(physicalDevice, device, extent, imageCount)) {}
+
+    void recordReadback(const vk::CommandBuffer& commandBuffer, const uint32_t& imageIndex) const
+    {
+        const vk::Buffer& readbackBuffer{readbackBuffers[imageIndex].getBuffer()};
+
+        vk::ImageSubresourceLayers imageSubresource{
+            vk::ImageAspectFlagBits::eColor, // Aspect mask
+            0,                               // Mip level
+            0,                               // Base array layer
+            1};                              // Layer count
+
+        vk::Extent3D imageExtent{
+            extent.width,  // Width
+            extent.height, // Height
+            1};            // Depth
+
+        vk::BufferImageCopy bufferImageCopy{
+            0,                // Buffer offset
+            0,                // Buffer row length
+            0,                // Buffer image height
+            imageSubresource, // Image subresource
+            vk::Offset3D(),   // Image offset
+            imageExtent};     // Image extent
+
+        // The render pass leaves the image in the transfer source layout once it ends, and its
+        // subpass dependencies make sure the copy waits for rendering to finish.
+        commandBuffer.copyImageToBuffer(images[imageIndex].getImage(),
+                                        vk::ImageLayout::eTransferSrcOptimal,
+                                        readbackBuffer,
+                                        1,
+                                        &bufferImageCopy);
+
+        // Make the copied pixels visible to the host once the frame's fence has been signalled.
+        vk::BufferMemoryBarrier barrier{
+            vk::AccessFlagBits::eTransferWrite, // Source access mask
+            vk::AccessFlagBits::eHostRead,      // Destination access mask
+            VK_QUEUE_FAMILY_IGNORED,            // Source queue family index
+            VK_QUEUE_FAMILY_IGNORED,            // Destination queue family index
+            readbackBuffer,                     // Buffer
+            0,                                  // Offset
+            VK_WHOLE_SIZE};                     // Size
+
+        commandBuffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eHost,
+            vk::DependencyFlags(),
+            0, nullptr,
+            1, &barrier,
+            0, nullptr);
+    }
+};
+
+VulkanOffscreenTarget::VulkanOffscreenTarget(const ast::VulkanCommandPool& commandPool,
+                                             const ast::VulkanPhysicalDevice& physicalDevice,
+                                             const ast::VulkanDevice& device,
+                                             const vk::Extent2D& extent,
+                                             const uint32_t& imageCount)
+    : internal(ast::make_internal_ptr<Internal>(commandPool, physicalDevice, device, extent, imageCount)) {}
+
+const std::vector<ast::VulkanImageView>& VulkanOffscreenTarget::getImageViews() const
+{
+    return internal->imageViews;
+}
+
+const vk::Format& VulkanOffscreenTarget::getColorFormat() const
+{
+    return ::colorFormat;
+}
+
+const vk::Extent2D& VulkanOffscreenTarget::getExtent() const
+{
+    return internal->extent;
+}
+
+uint32_t VulkanOffscreenTarget::getImageCount() const
+{
+    return static_cast<uint32_t>(internal->images.size());
+}
+
+void VulkanOffscreenTarget::recordReadback(const vk::CommandBuffer& commandBuffer, const uint32_t& imageIndex) const
+{
+    internal->recordReadback(commandBuffer, imageIndex);
+}
+
+const uint8_t* VulkanOffscreenTarget::getReadbackPixels(const uint32_t& imageIndex) const
+{
+    return static_cast<const uint8_t*>(internal->readbackBuffers[imageIndex].getMappedMemory());
+}
\ No newline at end of file
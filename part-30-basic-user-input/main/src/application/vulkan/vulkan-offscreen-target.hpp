@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../../core/graphics-wrapper.hpp"
+#include "../../core/internal-ptr.hpp"
+#include "vulkan-command-pool.hpp"
+#include "vulkan-device.hpp"
+#include "vulkan-image-view.hpp"
+#include "vulkan-physical-device.hpp"
+#include <vector>
+
+namespace ast
+{
+    // Stands in for a swapchain when rendering headless, providing color images to render into
+    // and host visible buffers that each rendered image is copied into so it can be read back.
+    struct VulkanOffscreenTarget
+    {
+        VulkanOffscreenTarget(const ast::VulkanCommandPool& commandPool,
+                              const ast::VulkanPhysicalDevice& physicalDevice,
+                              const ast::VulkanDevice& device,
+                              const vk::Extent2D& extent,
+                              const uint32_t& imageCount);
+
+        const std::vector<ast::VulkanImageView>& getImageViews() const;
+
+        const vk::Format& getColorFormat() const;
+
+        const vk::Extent2D& getExtent() const;
+
+        uint32_t getImageCount() const;
+
+        void recordReadback(const vk::CommandBuffer& commandBuffer, const uint32_t& imageIndex) const;
+
+        const uint8_t* getReadbackPixels(const uint32_t& imageIndex) const;
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
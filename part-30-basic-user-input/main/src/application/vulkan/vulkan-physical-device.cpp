@@ -1,4 +1,5 @@
 #include "vulkan-physical-device.hpp"
+#include "../../core/headless.hpp"
 #include "../../core/log.hpp"
 #include <stack>
 
@@ -64,8 +65,9 @@ namespace
             }
         }
 
-        // We can't render without swapchain support.
-        if (!hasSwapchainSupport)
+        // We can't render without swapchain support, unless we are rendering headless in which
+        // case nothing is ever presented.
+        if (!hasSwapchainSupport && !ast::headless::isEnabled())
         {
             throw std::runtime_error(logTag + ": Swapchain support not found.");
         }
@@ -153,6 +155,50 @@ namespace
     {
         return physicalDevice.getFeatures().samplerAnisotropy;
     }
+
+    bool getIndirectDrawingSupport(const vk::PhysicalDevice& physicalDevice)
+    {
+        // Indirect draws written by the GPU pick their own first instance, which needs its own feature.
+        return physicalDevice.getFeatures().drawIndirectFirstInstance;
+    }
+
+    bool getMultiDrawIndirectSupport(const vk::PhysicalDevice& physicalDevice)
+    {
+        return physicalDevice.getFeatures().multiDrawIndirect;
+    }
+
+    bool getTextureFormatSupport(const vk::PhysicalDevice& physicalDevice, const vk::Format& format)
+    {
+        const vk::PhysicalDeviceFeatures features{physicalDevice.getFeatures()};
+
+        // Each family of block compressed formats can only be used if its device feature is
+        // available, as that is what our logical device enables.
+        switch (format)
+        {
+            case vk::Format::eBc1RgbUnormBlock:
+            case vk::Format::eBc3UnormBlock:
+                if (!features.textureCompressionBC)
+                {
+                    return false;
+                }
+                break;
+            case vk::Format::eEtc2R8G8B8UnormBlock:
+            case vk::Format::eEtc2R8G8B8A8UnormBlock:
+                if (!features.textureCompressionETC2)
+                {
+                    return false;
+                }
+                break;
+            default:
+                break;
+        }
+
+        // Our textures are sampled with linear filtering between their mip levels.
+        const vk::FormatFeatureFlags requiredFeatures{vk::FormatFeatureFlagBits::eSampledImage |
+                                                      vk::FormatFeatureFlagBits::eSampledImageFilterLinear};
+
+        return (physicalDevice.getFormatProperties(format).optimalTilingFeatures & requiredFeatures) == requiredFeatures;
+    }
 } // namespace
 
 struct VulkanPhysicalDevice::Internal
@@ -162,13 +208,17 @@ struct VulkanPhysicalDevice::Internal
     const vk::Format depthFormat;
     const bool shaderMultiSamplingSupported;
     const bool anisotropicFilteringSupported;
+    const bool indirectDrawingSupported;
+    const bool multiDrawIndirectSupported;
 
     Internal(const vk::Instance& instance)
         : physicalDevice(::createPhysicalDevice(instance)),
           multiSamplingLevel(::getMultiSamplingLevel(physicalDevice)),
           depthFormat(::getDepthFormat(physicalDevice)),
           shaderMultiSamplingSupported(::getShaderMultiSamplingSupport(physicalDevice)),
-          anisotropicFilteringSupported(::getAnisotropicFilteringSupport(physicalDevice)) {}
+          anisotropicFilteringSupported(::getAnisotropicFilteringSupport(physicalDevice)),
+          indirectDrawingSupported(::getIndirectDrawingSupport(physicalDevice)),
+          multiDrawIndirectSupported(::getMultiDrawIndirectSupport(physicalDevice)) {}
 };
 
 VulkanPhysicalDevice::VulkanPhysicalDevice(const vk::Instance& instance)
@@ -203,3 +253,18 @@ bool VulkanPhysicalDevice::isAnisotropicFilteringSupported() const
 {
     return internal->anisotropicFilteringSupported;
 }
+
+bool VulkanPhysicalDevice::isIndirectDrawingSupported() const
+{
+    return internal->indirectDrawingSupported;
+}
+
+bool VulkanPhysicalDevice::isMultiDrawIndirectSupported() const
+{
+    return internal->multiDrawIndirectSupported;
+}
+
+bool VulkanPhysicalDevice::isTextureFormatSupported(const vk::Format& format) const
+{
+    return ::getTextureFormatSupport(internal->physicalDevice, format);
+}
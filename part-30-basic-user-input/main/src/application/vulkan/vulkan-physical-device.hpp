@@ -21,6 +21,12 @@ namespace ast
 
         bool isAnisotropicFilteringSupported() const;
 
+        bool isIndirectDrawingSupported() const;
+
+        bool isMultiDrawIndirectSupported() const;
+
+        bool isTextureFormatSupported(const vk::Format& format) const;
+
     private:
         struct Internal;
         ast::internal_ptr<Internal> internal;
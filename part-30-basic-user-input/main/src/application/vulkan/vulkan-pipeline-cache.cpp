@@ -0,0 +1,183 @@
+#include "vulkan-pipeline-cache.hpp"
+#include "../../core/log.hpp"
+#include "../../core/sdl-wrapper.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using ast::VulkanPipelineCache;
+
+namespace
+{
+    // The layout of the header every Vulkan implementation writes at the start of its cache data.
+    struct PipelineCacheHeader
+    {
+        uint32_t headerSize;
+        uint32_t headerVersion;
+        uint32_t vendorId;
+        uint32_t deviceId;
+        uint8_t pipelineCacheUuid[VK_UUID_SIZE];
+    };
+
+    std::string getCachePath()
+    {
+        // Some platforms have no writable preferences folder, in which case nothing is saved.
+        char* prefPath{SDL_GetPrefPath("ast", "a-simple-triangle")};
+
+        if (!prefPath)
+        {
+            return "";
+        }
+
+        const std::string path{std::string(prefPath) + "vulkan-pipeline-cache.bin"};
+        SDL_free(prefPath);
+
+        return path;
+    }
+
+    std::vector<uint8_t> loadCacheData(const std::string& path)
+    {
+        if (path.empty())
+        {
+            return std::vector<uint8_t>();
+        }
+
+        SDL_RWops* file{SDL_RWFromFile(path.c_str(), "rb")};
+
+        if (!file)
+        {
+            return std::vector<uint8_t>();
+        }
+
+        const Sint64 size{SDL_RWsize(file)};
+        std::vector<uint8_t> data(size > 0 ? static_cast<size_t>(size) : 0);
+
+        if (!data.empty() && SDL_RWread(file, data.data(), data.size(), 1) != 1)
+        {
+            data.clear();
+        }
+
+        SDL_RWclose(file);
+
+        return data;
+    }
+
+    bool isCacheDataValid(const ast::VulkanPhysicalDevice& physicalDevice, const std::vector<uint8_t>& data)
+    {
+        if (data.size() < sizeof(::PipelineCacheHeader))
+        {
+            return false;
+        }
+
+        ::PipelineCacheHeader header;
+        std::memcpy(&header, data.data(), sizeof(::PipelineCacheHeader));
+
+        const vk::PhysicalDeviceProperties properties{physicalDevice.getPhysicalDevice().getProperties()};
+
+        // The cache UUID changes whenever the driver's compiled pipelines become incompatible, so
+        // along with the vendor and device it tells us whether the data is safe to hand back.
+        return header.headerSize >= sizeof(::PipelineCacheHeader) &&
+               header.headerSize <= data.size() &&
+               header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+               header.vendorId == properties.vendorID &&
+               header.deviceId == properties.deviceID &&
+               std::memcmp(header.pipelineCacheUuid, &properties.pipelineCacheUUID[0], VK_UUID_SIZE) == 0;
+    }
+
+    vk::UniquePipelineCache createPipelineCache(const ast::VulkanPhysicalDevice& physicalDevice,
+                                                const ast::VulkanDevice& device,
+                                                const std::string& path)
+    {
+        static const std::string logTag{"ast::VulkanPipelineCache::createPipelineCache"};
+
+        std::vector<uint8_t> data{::loadCacheData(path)};
+
+        if (!data.empty() && !::isCacheDataValid(physicalDevice, data))
+        {
+            ast::log(logTag, "Discarding pipeline cache from a different device or driver: " + path);
+            data.clear();
+        }
+        else if (!data.empty())
+        {
+            ast::log(logTag, "Loaded " + std::to_string(data.size()) + " bytes of pipeline cache from " + path);
+        }
+
+        vk::PipelineCacheCreateInfo info{
+            vk::PipelineCacheCreateFlags(), // Flags
+            data.size(),                    // Initial data size
+            data.data()};                   // Initial data
+
+        return device.getDevice().createPipelineCacheUnique(info);
+    }
+} // namespace
+
+struct VulkanPipelineCache::Internal
+{
+    const std::string path;
+    const vk::UniquePipelineCache pipelineCache;
+
+    Internal(const ast::VulkanPhysicalDevice& physicalDevice, const ast::VulkanDevice& device)
+        : path(::getCachePath()),
+          pipelineCache(::createPipelineCache(physicalDevice, device, path)) {}
+
+    void save(const ast::VulkanDevice& device) const
+    {
+        static const std::string logTag{"ast::VulkanPipelineCache::save"};
+
+        if (path.empty())
+        {
+            return;
+        }
+
+        const std::vector<uint8_t> data{device.getDevice().getPipelineCacheData(pipelineCache.get())};
+
+        // The cache is written beside the real one and only moved over it once complete, so a
+        // failed or interrupted save can never leave a truncated cache to be loaded next run.
+        const std::string temporaryPath{path + ".tmp"};
+        SDL_RWops* file{SDL_RWFromFile(temporaryPath.c_str(), "wb")};
+
+        // Failing to save the cache only costs compilation time in the next run, so isn't fatal.
+        if (!file)
+        {
+            ast::log(logTag, "Could not open " + temporaryPath);
+            return;
+        }
+
+        const bool written{data.empty() || SDL_RWwrite(file, data.data(), data.size(), 1) == 1};
+        const bool closed{SDL_RWclose(file) == 0};
+
+        if (!written || !closed)
+        {
+            ast::log(logTag, "Could not write " + temporaryPath);
+            std::remove(temporaryPath.c_str());
+            return;
+        }
+
+        // Renaming over an existing file isn't allowed on every platform, so clear it out first
+        // if the first attempt fails.
+        if (std::rename(temporaryPath.c_str(), path.c_str()) != 0 &&
+            (std::remove(path.c_str()) != 0 || std::rename(temporaryPath.c_str(), path.c_str()) != 0))
+        {
+            ast::log(logTag, "Could not replace " + path);
+            std::remove(temporaryPath.c_str());
+            return;
+        }
+
+        ast::log(logTag, "Saved " + std::to_string(data.size()) + " bytes of pipeline cache to " + path);
+    }
+};
+
+VulkanPipelineCache::VulkanPipelineCache(const ast::VulkanPhysicalDevice& physicalDevice,
+                                         const ast::VulkanDevice& device)
+    : internal(ast::make_internal_ptr<Internal>(physicalDevice, device)) {}
+
+const vk::PipelineCache& VulkanPipelineCache::getPipelineCache() const
+{
+    return internal->pipelineCache.get();
+}
+
+void VulkanPipelineCache::save(const ast::VulkanDevice& device) const
+{
+    internal->save(device);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../../core/graphics-wrapper.hpp"
+#include "../../core/internal-ptr.hpp"
+#include "vulkan-device.hpp"
+#include "vulkan-physical-device.hpp"
+
+namespace ast
+{
+    // A pipeline cache which is loaded from and saved to the user's preferences folder, so
+    // pipelines compiled during one run don't need to be compiled from SPIR-V again in the next.
+    // A saved cache is discarded if it was produced by a different device or driver.
+    struct VulkanPipelineCache
+    {
+        VulkanPipelineCache(const ast::VulkanPhysicalDevice& physicalDevice,
+                            const ast::VulkanDevice& device);
+
+        const vk::PipelineCache& getPipelineCache() const;
+
+        void save(const ast::VulkanDevice& device) const;
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
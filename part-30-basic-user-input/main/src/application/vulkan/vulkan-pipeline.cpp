@@ -1,11 +1,11 @@
 #include "vulkan-pipeline.hpp"
+#include "../../core/asset-file.hpp"
 #include "../../core/asset-inventory.hpp"
-#include "../../core/assets.hpp"
-#include "../../core/vertex.hpp"
-#include "vulkan-asset-manager.hpp"
+#include "vulkan-common.hpp"
 #include "vulkan-mesh.hpp"
 #include "vulkan-texture.hpp"
 #include <unordered_map>
+#include <vector>
 
 using ast::VulkanPipeline;
 
@@ -14,7 +14,7 @@ namespace
     // The default shader will have one descriptor for texture mapping which
     // will be made available in the fragment shader pipeline stage only. Note
     // that this pipeline does not include a descriptor set for vertex data as
-    // we will use Vulkan push constants for this instead of uniform buffers.
+    // the per instance matrices are streamed in through an instance vertex buffer.
     vk::UniqueDescriptorSetLayout createDescriptorSetLayout(const ast::VulkanDevice& device)
     {
         vk::DescriptorSetLayoutBinding textureBinding{
@@ -35,44 +35,56 @@ namespace
     vk::UniquePipelineLayout createPipelineLayout(const ast::VulkanDevice& device,
                                                   const vk::DescriptorSetLayout& descriptorSetLayout)
     {
-        // We use push constants for delivering the vertex MVP data to the shader. This is
-        // a lightweight alternative to using Vulkan uniform buffers with the caveat that
-        // we can only push data up to a certain size, which the minimum guaranteed Vulkan
-        // spec claims is 128 bytes. Note that this definition directly correlates to the
-        // push constant in the shader code and must match up. A 4x4 matrix will consume
-        // 16 floating point values, each of which is 4 bytes making a total of 64 bytes
-        // which is half of our 128 byte quota. If we ever needed to push more than 128
-        // bytes of data into our shader we must instead implement Vulkan uniform buffers
-        // which require more setup work and are less performant than push constants.
-        vk::PushConstantRange pushConstantRange{
-            vk::ShaderStageFlagBits::eAllGraphics, // Flags
-            0,                                     // Offset
-            sizeof(glm::mat4)};                    // Size
-
-        // We use the descriptor set layout combined with our definition of how we intend
-        // to use push constants during the pipeline to produce an overall pipeline layout.
+        // The MVP matrix for each mesh instance arrives as a per instance vertex attribute
+        // rather than a push constant, which lets a whole batch of instances sharing the same
+        // mesh and texture be drawn with a single instanced draw call. The only push constants
+        // are the per mesh values the vertex shader needs to decode compact vertices.
+        vk::PushConstantRange dequantizationRange{
+            vk::ShaderStageFlagBits::eVertex,   // Stage flags
+            0,                                  // Offset
+            sizeof(ast::VertexDequantization)}; // Size
+
         vk::PipelineLayoutCreateInfo info{
             vk::PipelineLayoutCreateFlags(), // Flags
             1,                               // Layout count
             &descriptorSetLayout,            // Layouts,
             1,                               // Push constant range count,
-            &pushConstantRange               // Push constant ranges
+            &dequantizationRange             // Push constant ranges
         };
 
         return device.getDevice().createPipelineLayoutUnique(info);
     }
 
+    // The formats our vertex shader reads each vertex position and texture coordinate from.
+    vk::Format getPositionFormat(const ast::VertexLayout& vertexLayout)
+    {
+        switch (vertexLayout)
+        {
+            case ast::VertexLayout::Snorm16:
+                return vk::Format::eR16G16B16A16Snorm;
+            case ast::VertexLayout::Half:
+                return vk::Format::eR16G16B16A16Sfloat;
+            default:
+                return vk::Format::eR32G32B32Sfloat;
+        }
+    }
+
+    vk::Format getTexCoordFormat(const ast::VertexLayout& vertexLayout)
+    {
+        return vertexLayout == ast::VertexLayout::Float32 ? vk::Format::eR32G32Sfloat : vk::Format::eR16G16Unorm;
+    }
+
     vk::UniquePipeline createPipeline(const ast::VulkanPhysicalDevice& physicalDevice,
                                       const ast::VulkanDevice& device,
                                       const vk::PipelineLayout& pipelineLayout,
+                                      const vk::PipelineCache& pipelineCache,
                                       const std::string& shaderName,
-                                      const vk::Viewport& viewport,
-                                      const vk::Rect2D& scissor,
+                                      const ast::VertexLayout& vertexLayout,
                                       const vk::RenderPass& renderPass)
     {
         // Create a vertex shader module from asset file.
         vk::UniqueShaderModule vertexShaderModule{
-            device.createShaderModule(ast::assets::loadBinaryFile("assets/shaders/vulkan/" + shaderName + ".vert"))};
+            device.createShaderModule(ast::AssetFile("assets/shaders/vulkan/" + shaderName + ".vert"))};
 
         // Describe how to use the vertex shader module in the pipeline.
         vk::PipelineShaderStageCreateInfo vertexShaderInfo{
@@ -84,41 +96,65 @@ namespace
 
         // Define the data format that will be passed into the vertex shader.
         vk::VertexInputBindingDescription vertexBindingDescription{
-            0,                           // Binding
-            sizeof(ast::Vertex),         // Stride
-            vk::VertexInputRate::eVertex // Input rate
+            0,                                        // Binding
+            ast::meshes::getVertexSize(vertexLayout), // Stride
+            vk::VertexInputRate::eVertex              // Input rate
         };
 
-        // Define the shape of the vertex position (x, y, z) attribute.
+        // Define the per instance data format, which is one MVP matrix for each mesh instance.
+        vk::VertexInputBindingDescription instanceBindingDescription{
+            1,                             // Binding
+            sizeof(glm::mat4),             // Stride
+            vk::VertexInputRate::eInstance // Input rate
+        };
+
+        // Collate the vertex and instance bindings that will be used in the pipeline.
+        std::array<vk::VertexInputBindingDescription, 2> vertexBindingDescriptions{
+            vertexBindingDescription,
+            instanceBindingDescription};
+
+        // Define the shape of the vertex position (x, y, z) attribute. The compact layouts
+        // carry a fourth component which the shader ignores.
         vk::VertexInputAttributeDescription vertexPositionDescription{
-            0,                                // Location
-            0,                                // Binding
-            vk::Format::eR32G32B32Sfloat,     // Format
-            offsetof(ast::Vertex, position)}; // Offset
+            0,                                             // Location
+            0,                                             // Binding
+            ::getPositionFormat(vertexLayout),             // Format
+            ast::meshes::getPositionOffset(vertexLayout)}; // Offset
 
         // Define the shape of the texture coordinate (u, v) attribute.
         vk::VertexInputAttributeDescription textureCoordinateDescription{
-            1,                                // Location
-            0,                                // Binding
-            vk::Format::eR32G32Sfloat,        // Format
-            offsetof(ast::Vertex, texCoord)}; // Offset
+            1,                                             // Location
+            0,                                             // Binding
+            ::getTexCoordFormat(vertexLayout),             // Format
+            ast::meshes::getTexCoordOffset(vertexLayout)}; // Offset
 
         // Collate all the vertex shader attributes that will be used in the pipeline.
-        std::array<vk::VertexInputAttributeDescription, 2> vertexAttributeDescriptions{
+        std::vector<vk::VertexInputAttributeDescription> vertexAttributeDescriptions{
             vertexPositionDescription,
             textureCoordinateDescription};
 
+        // A 4x4 matrix attribute is consumed by the shader as four consecutive vec4 locations,
+        // so we define one attribute for each column of the instance MVP matrix.
+        for (uint32_t column = 0; column < 4; column++)
+        {
+            vertexAttributeDescriptions.push_back(vk::VertexInputAttributeDescription{
+                2 + column,                                          // Location
+                1,                                                   // Binding
+                vk::Format::eR32G32B32A32Sfloat,                     // Format
+                static_cast<uint32_t>(column * sizeof(glm::vec4))}); // Offset
+        }
+
         // Bundle up the collated descriptions defining how vertex data will be passed into the shader.
         vk::PipelineVertexInputStateCreateInfo vertexInputState{
             vk::PipelineVertexInputStateCreateFlags(),                 // Flags
-            1,                                                         // Vertex binding description count
-            &vertexBindingDescription,                                 // Vertex binding description
+            static_cast<uint32_t>(vertexBindingDescriptions.size()),   // Vertex binding description count
+            vertexBindingDescriptions.data(),                          // Vertex binding descriptions
             static_cast<uint32_t>(vertexAttributeDescriptions.size()), // Vertex attribute descriptions
             vertexAttributeDescriptions.data()};                       // Vertex attribute descriptions
 
         // Create a fragment shader module from asset file.
         vk::UniqueShaderModule fragmentShaderModule{
-            device.createShaderModule(ast::assets::loadBinaryFile("assets/shaders/vulkan/" + shaderName + ".frag"))};
+            device.createShaderModule(ast::AssetFile("assets/shaders/vulkan/" + shaderName + ".frag"))};
 
         // Describe how to use the fragment shader module in the pipeline.
         vk::PipelineShaderStageCreateInfo fragmentShaderInfo{
@@ -139,13 +175,14 @@ namespace
             vk::PrimitiveTopology::eTriangleList,        // Topology
             0};                                          // Primitive restart enable
 
-        // Declare the viewport and scissor to apply to the shader output.
+        // Declare that there is one viewport and one scissor. Their actual values are dynamic
+        // state set while recording each frame, so the pipeline doesn't depend on the window size.
         vk::PipelineViewportStateCreateInfo viewportState{
             vk::PipelineViewportStateCreateFlags(), // Flags
             1,                                      // Viewport count
-            &viewport,                              // Viewports
+            nullptr,                                // Viewports
             1,                                      // Scissor count
-            &scissor};                              // Scissors
+            nullptr};                               // Scissors
 
         // Define how the pipeline should process output during rendering.
         vk::PipelineRasterizationStateCreateInfo rasterizationState{
@@ -218,6 +255,16 @@ namespace
             &colorBlendAttachment,                    // Attachments
             {{0, 0, 0, 0}}};                          // Blend constants
 
+        // Define which parts of the pipeline state are supplied while recording command buffers.
+        std::array<vk::DynamicState, 2> dynamicStates{
+            vk::DynamicState::eViewport,
+            vk::DynamicState::eScissor};
+
+        vk::PipelineDynamicStateCreateInfo dynamicState{
+            vk::PipelineDynamicStateCreateFlags(),       // Flags
+            static_cast<uint32_t>(dynamicStates.size()), // Dynamic state count
+            dynamicStates.data()};                       // Dynamic states
+
         // Collate all the components into a single graphics pipeline definition.
         vk::GraphicsPipelineCreateInfo pipelineCreateInfo{
             vk::PipelineCreateFlags(),            // Flags
@@ -231,14 +278,15 @@ namespace
             &multisampleState,                    // Multi sample state
             &depthStencilState,                   // Depth stencil state
             &colorBlendState,                     // Color blend state
-            nullptr,                              // Dynamic state
+            &dynamicState,                        // Dynamic state
             pipelineLayout,                       // Pipeline layout
             renderPass,                           // Render pass
             0,                                    // Subpass
             vk::Pipeline(),                       // Base pipeline handle
             0};                                   // Base pipeline index
 
-        return device.getDevice().createGraphicsPipelineUnique(nullptr, pipelineCreateInfo);
+        // The pipeline cache lets the driver skip compiling any pipeline it has seen before.
+        return device.getDevice().createGraphicsPipelineUnique(pipelineCache, pipelineCreateInfo);
     }
 
     vk::UniqueDescriptorPool createDescriptorPool(const ast::VulkanDevice& device)
@@ -307,20 +355,23 @@ struct VulkanPipeline::Internal
 
     Internal(const ast::VulkanPhysicalDevice& physicalDevice,
              const ast::VulkanDevice& device,
+             const vk::PipelineCache& pipelineCache,
              const std::string& shaderName,
-             const vk::Viewport& viewport,
-             const vk::Rect2D& scissor,
+             const ast::VertexLayout& vertexLayout,
              const vk::RenderPass& renderPass)
         : descriptorSetLayout(::createDescriptorSetLayout(device)),
           pipelineLayout(::createPipelineLayout(device, descriptorSetLayout.get())),
           pipeline(::createPipeline(physicalDevice,
                                     device,
                                     pipelineLayout.get(),
+                                    pipelineCache,
                                     shaderName,
-                                    viewport,
-                                    scissor,
+                                    vertexLayout,
                                     renderPass)),
-          descriptorPool(::createDescriptorPool(device)) {}
+          descriptorPool(::createDescriptorPool(device))
+    {
+        device.setObjectName(vk::ObjectType::ePipeline, ast::vulkan::getObjectHandle(pipeline.get()), shaderName);
+    }
 
     const vk::DescriptorSet& getTextureSamplerDescriptorSet(const ast::VulkanDevice& device,
                                                             const ast::VulkanTexture& texture)
@@ -338,57 +389,62 @@ struct VulkanPipeline::Internal
         return textureSamplerDescriptorSets.at(texture.getTextureId()).get();
     }
 
-    void render(const ast::VulkanDevice& device,
-                const vk::CommandBuffer& commandBuffer,
-                const ast::VulkanAssetManager& assetManager,
-                const std::vector<ast::StaticMeshInstance>& staticMeshInstances)
+    void bind(const vk::CommandBuffer& commandBuffer) const
     {
-        for (const ast::StaticMeshInstance& meshInstance : staticMeshInstances)
-        {
-            const ast::VulkanMesh& mesh{assetManager.getStaticMesh(meshInstance.getMesh())};
-            const glm::mat4& transform{meshInstance.getTransformMatrix()};
-
-            commandBuffer.pushConstants(pipelineLayout.get(),
-                                        vk::ShaderStageFlagBits::eAllGraphics,
-                                        0,
-                                        sizeof(glm::mat4),
-                                        &transform);
-
-            commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.get());
-
-            vk::DeviceSize offsets[]{0};
-            commandBuffer.bindVertexBuffers(0, 1, &mesh.getVertexBuffer(), offsets);
-
-            commandBuffer.bindIndexBuffer(mesh.getIndexBuffer(), 0, vk::IndexType::eUint32);
-
-            const ast::VulkanTexture& texture{assetManager.getTexture(meshInstance.getTexture())};
-
-            const vk::DescriptorSet& textureSamplerDescriptorSet{
-                getTextureSamplerDescriptorSet(device, texture)};
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.get());
+    }
 
-            commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
-                                             pipelineLayout.get(),
-                                             0,
-                                             1, &textureSamplerDescriptorSet,
-                                             0, nullptr);
+    void bindMesh(const vk::CommandBuffer& commandBuffer, const ast::VulkanMesh& mesh) const
+    {
+        // Give the vertex shader what it needs to recover the original vertices of the mesh.
+        commandBuffer.pushConstants(pipelineLayout.get(),
+                                    vk::ShaderStageFlagBits::eVertex,
+                                    0,
+                                    sizeof(ast::VertexDequantization),
+                                    &mesh.getDequantization());
+    }
 
-            commandBuffer.drawIndexed(mesh.getNumIndices(), 1, 0, 0, 0);
-        }
+    void bindTexture(const ast::VulkanDevice& device,
+                     const vk::CommandBuffer& commandBuffer,
+                     const ast::VulkanTexture& texture)
+    {
+        const vk::DescriptorSet& textureSamplerDescriptorSet{
+            getTextureSamplerDescriptorSet(device, texture)};
+
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                         pipelineLayout.get(),
+                                         0,
+                                         1, &textureSamplerDescriptorSet,
+                                         0, nullptr);
     }
 };
 
 VulkanPipeline::VulkanPipeline(const ast::VulkanPhysicalDevice& physicalDevice,
                                const ast::VulkanDevice& device,
+                               const vk::PipelineCache& pipelineCache,
                                const std::string& shaderName,
-                               const vk::Viewport& viewport,
-                               const vk::Rect2D& scissor,
+                               const ast::VertexLayout& vertexLayout,
                                const vk::RenderPass& renderPass)
-    : internal(ast::make_internal_ptr<Internal>(physicalDevice, device, shaderName, viewport, scissor, renderPass)) {}
+    : internal(ast::make_internal_ptr<Internal>(physicalDevice,
+                                                device,
+                                                pipelineCache,
+                                                shaderName,
+                                                vertexLayout,
+                                                renderPass)) {}
+
+void VulkanPipeline::bind(const vk::CommandBuffer& commandBuffer) const
+{
+    internal->bind(commandBuffer);
+}
 
-void VulkanPipeline::render(const ast::VulkanDevice& device,
-                            const vk::CommandBuffer& commandBuffer,
-                            const ast::VulkanAssetManager& assetManager,
-                            const std::vector<ast::StaticMeshInstance>& staticMeshInstances) const
+void VulkanPipeline::bindMesh(const vk::CommandBuffer& commandBuffer, const ast::VulkanMesh& mesh) const
 {
-    internal->render(device, commandBuffer, assetManager, staticMeshInstances);
+    internal->bindMesh(commandBuffer, mesh);
 }
+
+void VulkanPipeline::bindTexture(const ast::VulkanDevice& device,
+                                 const vk::CommandBuffer& commandBuffer,
+                                 const ast::VulkanTexture& texture) const
+{
+    internal->bindTexture(device, commandBuffer, texture);
+}
\ No newline at end of file
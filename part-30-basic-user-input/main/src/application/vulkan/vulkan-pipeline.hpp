@@ -2,7 +2,7 @@
 
 #include "../../core/graphics-wrapper.hpp"
 #include "../../core/internal-ptr.hpp"
-#include "../../core/static-mesh-instance.hpp"
+#include "../../core/mesh-encoder.hpp"
 #include "vulkan-device.hpp"
 #include "vulkan-physical-device.hpp"
 #include <string>
@@ -10,21 +10,28 @@
 
 namespace ast
 {
-    struct VulkanAssetManager;
+    struct VulkanMesh;
+
+    struct VulkanTexture;
 
     struct VulkanPipeline
     {
         VulkanPipeline(const ast::VulkanPhysicalDevice& physicalDevice,
                        const ast::VulkanDevice& device,
+                       const vk::PipelineCache& pipelineCache,
                        const std::string& shaderName,
-                       const vk::Viewport& viewport,
-                       const vk::Rect2D& scissor,
+                       const ast::VertexLayout& vertexLayout,
                        const vk::RenderPass& renderPass);
 
-        void render(const ast::VulkanDevice& device,
-                    const vk::CommandBuffer& commandBuffer,
-                    const ast::VulkanAssetManager& assetManager,
-                    const std::vector<ast::StaticMeshInstance>& staticMeshInstances) const;
+        void bind(const vk::CommandBuffer& commandBuffer) const;
+
+        // Hands the vertex shader what it needs to decode the vertices of the mesh. The shared
+        // buffers the mesh lives in are bound separately, as many meshes draw from the same ones.
+        void bindMesh(const vk::CommandBuffer& commandBuffer, const ast::VulkanMesh& mesh) const;
+
+        void bindTexture(const ast::VulkanDevice& device,
+                         const vk::CommandBuffer& commandBuffer,
+                         const ast::VulkanTexture& texture) const;
 
     private:
         struct Internal;
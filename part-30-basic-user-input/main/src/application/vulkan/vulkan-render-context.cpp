@@ -2,7 +2,17 @@
 #include "vulkan-image-view.hpp"
 #include "vulkan-image.hpp"
 #include "vulkan-render-pass.hpp"
+#include "../../core/headless.hpp"
+#include "../../core/log.hpp"
+#include "../../core/profiler.hpp"
+#include "vulkan-common.hpp"
+#include "vulkan-gpu-timer.hpp"
+#include "vulkan-offscreen-target.hpp"
 #include "vulkan-swapchain.hpp"
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 using ast::VulkanRenderContext;
@@ -12,10 +22,9 @@ namespace
     ast::VulkanImage createMultiSampleImage(const ast::VulkanCommandPool& commandPool,
                                             const ast::VulkanPhysicalDevice& physicalDevice,
                                             const ast::VulkanDevice& device,
-                                            const ast::VulkanSwapchain& swapchain)
+                                            const vk::Format& colorFormat,
+                                            const vk::Extent2D& extent)
     {
-        const vk::Extent2D& extent{swapchain.getExtent()};
-
         return ast::VulkanImage(
             commandPool,
             physicalDevice,
@@ -24,12 +33,12 @@ namespace
             extent.height,
             1,
             physicalDevice.getMultiSamplingLevel(),
-            swapchain.getColorFormat(),
+            colorFormat,
             vk::ImageTiling::eOptimal,
             vk::ImageUsageFlagBits::eTransientAttachment | vk::ImageUsageFlagBits::eColorAttachment,
             vk::MemoryPropertyFlagBits::eDeviceLocal,
             vk::ImageLayout::eUndefined,
-            vk::ImageLayout::eColorAttachmentOptimal);
+            vk::ImageLayout::eUndefined);
     }
 
     ast::VulkanImageView createImageView(const ast::VulkanDevice& device,
@@ -46,10 +55,8 @@ namespace
     ast::VulkanImage createDepthImage(const ast::VulkanCommandPool& commandPool,
                                       const ast::VulkanPhysicalDevice& physicalDevice,
                                       const ast::VulkanDevice& device,
-                                      const ast::VulkanSwapchain& swapchain)
+                                      const vk::Extent2D& extent)
     {
-        const vk::Extent2D& extent{swapchain.getExtent()};
-
         return ast::VulkanImage(
             commandPool,
             physicalDevice,
@@ -63,25 +70,24 @@ namespace
             vk::ImageUsageFlagBits::eDepthStencilAttachment,
             vk::MemoryPropertyFlagBits::eDeviceLocal,
             vk::ImageLayout::eUndefined,
-            vk::ImageLayout::eDepthStencilAttachmentOptimal);
+            vk::ImageLayout::eUndefined);
     }
 
     std::vector<vk::UniqueFramebuffer> createFramebuffers(const ast::VulkanDevice& device,
-                                                          const ast::VulkanSwapchain& swapchain,
+                                                          const std::vector<ast::VulkanImageView>& targetImageViews,
+                                                          const vk::Extent2D& extent,
                                                           const ast::VulkanRenderPass& renderPass,
                                                           const ast::VulkanImageView& multiSampleImageView,
                                                           const ast::VulkanImageView& depthImageView)
     {
         std::vector<vk::UniqueFramebuffer> framebuffers;
 
-        const vk::Extent2D& extent{swapchain.getExtent()};
-
-        for (const auto& swapchainImageView : swapchain.getImageViews())
+        for (const auto& targetImageView : targetImageViews)
         {
             std::array<vk::ImageView, 3> attachments{
                 multiSampleImageView.getImageView(),
                 depthImageView.getImageView(),
-                swapchainImageView.getImageView()};
+                targetImageView.getImageView()};
 
             vk::FramebufferCreateInfo info{
                 vk::FramebufferCreateFlags(),              // Flags
@@ -98,18 +104,17 @@ namespace
         return framebuffers;
     }
 
-    vk::Rect2D createScissor(const ast::VulkanSwapchain& swapchain)
+    vk::Rect2D createScissor(const vk::Extent2D& extent)
     {
         vk::Offset2D offset{0, 0};
 
         return vk::Rect2D{
             offset,
-            swapchain.getExtent()};
+            extent};
     }
 
-    vk::Viewport createViewport(const ast::VulkanSwapchain& swapchain)
+    vk::Viewport createViewport(const vk::Extent2D& extent)
     {
-        const vk::Extent2D extent{swapchain.getExtent()};
         const float viewportWidth{static_cast<float>(extent.width)};
         const float viewportHeight{static_cast<float>(extent.height)};
 
@@ -137,22 +142,75 @@ namespace
         return std::array<vk::ClearValue, 2>{color, depth};
     }
 
+    std::vector<ast::VulkanDynamicBuffer> createInstanceBuffers(const ast::VulkanPhysicalDevice& physicalDevice,
+                                                                const ast::VulkanDevice& device,
+                                                                const uint32_t& count)
+    {
+        // Each render frame needs its own instance buffer so we never write instance data
+        // into memory that the GPU might still be reading from for a previous frame. Besides
+        // being read as vertices, it stages the uploads of the GPU culling pass.
+        static constexpr vk::DeviceSize chunkSize{1024 * 1024};
+
+        std::vector<ast::VulkanDynamicBuffer> instanceBuffers;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            instanceBuffers.push_back(ast::VulkanDynamicBuffer(physicalDevice,
+                                                               device,
+                                                               vk::BufferUsageFlagBits::eVertexBuffer |
+                                                                   vk::BufferUsageFlagBits::eTransferSrc,
+                                                               chunkSize));
+        }
+
+        return instanceBuffers;
+    }
+
+    // How many frames to gather fence statistics over before logging them.
+    constexpr uint32_t fenceStatisticsFrameInterval{600};
+
+    std::vector<vk::UniqueCommandPool> createFrameCommandPools(const ast::VulkanDevice& device,
+                                                               const uint32_t& count)
+    {
+        // Each frame gets its own transient command pool, which is reset as a whole at the
+        // start of the frame rather than resetting its command buffer individually.
+        vk::CommandPoolCreateInfo info{
+            vk::CommandPoolCreateFlagBits::eTransient, // Flags
+            device.getGraphicsQueueIndex()};           // Queue family index
+
+        std::vector<vk::UniqueCommandPool> commandPools;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            commandPools.push_back(device.getDevice().createCommandPoolUnique(info));
+        }
+
+        return commandPools;
+    }
+
+    std::vector<vk::UniqueCommandBuffer> createFrameCommandBuffers(const ast::VulkanDevice& device,
+                                                                   const std::vector<vk::UniqueCommandPool>& commandPools)
+    {
+        std::vector<vk::UniqueCommandBuffer> commandBuffers;
+
+        for (const auto& commandPool : commandPools)
+        {
+            vk::CommandBufferAllocateInfo info{
+                commandPool.get(),                // Command pool
+                vk::CommandBufferLevel::ePrimary, // Level
+                1};                               // Command buffer count
+
+            commandBuffers.push_back(std::move(device.getDevice().allocateCommandBuffersUnique(info)[0]));
+        }
+
+        return commandBuffers;
+    }
+
     uint32_t acquireNextImageIndex(const vk::Device& device,
                                    const vk::SwapchainKHR& swapchain,
-                                   const vk::Fence& fence,
                                    const vk::Semaphore& semaphore)
     {
         static constexpr uint64_t timeOut{std::numeric_limits<uint64_t>::max()};
 
-        device.waitForFences(
-            1,        // Number of fences to wait for
-            &fence,   // Fences to wait for
-            VK_TRUE,  // Wait for all fences
-            timeOut); // Timeout while waiting
-
-        // The fence should now be reset, ready for the next use case.
-        device.resetFences(1, &fence);
-
         vk::ResultValue nextImageIndex{device.acquireNextImageKHR(
             swapchain, // Swapchain to acquire from
             timeOut,   // Timeout while waiting
@@ -161,53 +219,322 @@ namespace
 
         return nextImageIndex.value;
     }
+
+    // Everything which depends on the size of the surface being rendered into. These are the
+    // only things which need to be recreated when the window is resized - the render pass, and
+    // therefore every pipeline, along with all the per frame resources are left untouched.
+    struct RenderTargets
+    {
+        // Exactly one of the swapchain or the offscreen target is used to render into, depending
+        // on whether we are presenting to a window or rendering headless.
+        const std::unique_ptr<ast::VulkanSwapchain> swapchain;
+        const std::unique_ptr<ast::VulkanOffscreenTarget> offscreenTarget;
+        const vk::Extent2D extent;
+        const ast::VulkanImage multiSampleImage;
+        const ast::VulkanImageView multiSampleImageView;
+        const ast::VulkanImage depthImage;
+        const ast::VulkanImageView depthImageView;
+        const std::vector<vk::UniqueFramebuffer> framebuffers;
+        const vk::Rect2D scissor;
+        const vk::Viewport viewport;
+
+        RenderTargets(std::unique_ptr<ast::VulkanSwapchain> swapchain,
+                      std::unique_ptr<ast::VulkanOffscreenTarget> offscreenTarget,
+                      const ast::VulkanPhysicalDevice& physicalDevice,
+                      const ast::VulkanDevice& device,
+                      const ast::VulkanCommandPool& commandPool,
+                      const vk::Format& colorFormat,
+                      const ast::VulkanRenderPass& renderPass)
+            : swapchain(std::move(swapchain)),
+              offscreenTarget(std::move(offscreenTarget)),
+              extent(this->swapchain ? this->swapchain->getExtent() : this->offscreenTarget->getExtent()),
+              multiSampleImage(::createMultiSampleImage(commandPool, physicalDevice, device, colorFormat, extent)),
+              multiSampleImageView(::createImageView(device, multiSampleImage, vk::ImageAspectFlagBits::eColor)),
+              depthImage(::createDepthImage(commandPool, physicalDevice, device, extent)),
+              depthImageView(::createImageView(device, depthImage, vk::ImageAspectFlagBits::eDepth)),
+              framebuffers(::createFramebuffers(device,
+                                                this->swapchain ? this->swapchain->getImageViews() : this->offscreenTarget->getImageViews(),
+                                                extent,
+                                                renderPass,
+                                                multiSampleImageView,
+                                                depthImageView)),
+              scissor(::createScissor(extent)),
+              viewport(::createViewport(extent))
+        {
+            device.setObjectName(vk::ObjectType::eImage,
+                                 ast::vulkan::getObjectHandle(multiSampleImage.getImage()),
+                                 "Multi sample image");
+
+            device.setObjectName(vk::ObjectType::eImage,
+                                 ast::vulkan::getObjectHandle(depthImage.getImage()),
+                                 "Depth image");
+        }
+    };
+
+    // Render targets which have been replaced, but may still be in use by frames in flight.
+    struct RetiredRenderTargets
+    {
+        std::unique_ptr<::RenderTargets> targets;
+        uint64_t retiredAtFrame;
+    };
 } // namespace
 
 struct VulkanRenderContext::Internal
 {
-    const ast::VulkanSwapchain swapchain;
+    const vk::Format colorFormat;
     const ast::VulkanRenderPass renderPass;
-    const ast::VulkanImage multiSampleImage;
-    const ast::VulkanImageView multiSampleImageView;
-    const ast::VulkanImage depthImage;
-    const ast::VulkanImageView depthImageView;
-    const std::vector<vk::UniqueFramebuffer> framebuffers;
+    std::unique_ptr<::RenderTargets> targets;
+    std::vector<::RetiredRenderTargets> retiredTargets;
+    const uint32_t maxRenderFrames;
+    const std::vector<vk::UniqueCommandPool> commandPools;
     const std::vector<vk::UniqueCommandBuffer> commandBuffers;
-    const uint32_t maxRenderFrames{2};
     const std::vector<vk::UniqueSemaphore> graphicsSemaphores;
     const std::vector<vk::UniqueSemaphore> presentationSemaphores;
     const std::vector<vk::UniqueFence> graphicsFences;
-    const vk::Rect2D scissor;
-    const vk::Viewport viewport;
+    const std::vector<ast::VulkanDynamicBuffer> instanceBuffers;
     const std::array<vk::ClearValue, 2> clearValues;
+    ast::VulkanGpuTimer gpuTimer;
+
+    // The fence of the frame which last rendered into each swapchain image, if any.
+    std::vector<vk::Fence> imagesInFlight;
+
+    // Whether each render frame has copied an offscreen image which hasn't been read back yet.
+    std::vector<bool> readbacksPending;
 
     uint32_t currentFrameIndex{0};
-    uint32_t currentSwapchainImageIndex{0};
+    uint32_t currentImageIndex{0};
+
+    // How many frames have been submitted to the GPU so far.
+    uint64_t submittedFrameCount{0};
+
+    // Counters of how much CPU time is spent blocked waiting for the GPU to catch up.
+    uint32_t statisticsFrameCount{0};
+    uint32_t fenceWaitCount{0};
+    std::chrono::duration<double, std::milli> fenceWaitTime{0};
 
-    Internal(const ast::SDLWindow& window,
+    Internal(std::unique_ptr<ast::VulkanSwapchain> swapchain,
+             std::unique_ptr<ast::VulkanOffscreenTarget> offscreenTarget,
              const ast::VulkanPhysicalDevice& physicalDevice,
              const ast::VulkanDevice& device,
-             const ast::VulkanSurface& surface,
              const ast::VulkanCommandPool& commandPool,
-             const vk::SwapchainKHR& oldSwapchain)
-        : swapchain(ast::VulkanSwapchain(window, physicalDevice, device, surface, oldSwapchain)),
-          renderPass(ast::VulkanRenderPass(physicalDevice, device, swapchain)),
-          multiSampleImage(::createMultiSampleImage(commandPool, physicalDevice, device, swapchain)),
-          multiSampleImageView(::createImageView(device, multiSampleImage, vk::ImageAspectFlagBits::eColor)),
-          depthImage(::createDepthImage(commandPool, physicalDevice, device, swapchain)),
-          depthImageView(::createImageView(device, depthImage, vk::ImageAspectFlagBits::eDepth)),
-          framebuffers(::createFramebuffers(device, swapchain, renderPass, multiSampleImageView, depthImageView)),
-          commandBuffers(commandPool.createCommandBuffers(device, swapchain.getImageCount())),
+             const uint32_t& framesInFlight)
+        : colorFormat(swapchain ? swapchain->getColorFormat() : offscreenTarget->getColorFormat()),
+          renderPass(ast::VulkanRenderPass(physicalDevice,
+                                           device,
+                                           colorFormat,
+                                           swapchain ? vk::ImageLayout::ePresentSrcKHR : vk::ImageLayout::eTransferSrcOptimal)),
+          targets(std::make_unique<::RenderTargets>(std::move(swapchain),
+                                                    std::move(offscreenTarget),
+                                                    physicalDevice,
+                                                    device,
+                                                    commandPool,
+                                                    colorFormat,
+                                                    renderPass)),
+          maxRenderFrames(framesInFlight),
+          commandPools(::createFrameCommandPools(device, maxRenderFrames)),
+          commandBuffers(::createFrameCommandBuffers(device, commandPools)),
           graphicsSemaphores(device.createSemaphores(maxRenderFrames)),
           presentationSemaphores(device.createSemaphores(maxRenderFrames)),
           graphicsFences(device.createFences(maxRenderFrames)),
-          scissor(::createScissor(swapchain)),
-          viewport(::createViewport(swapchain)),
-          clearValues(::createClearValues()) {}
+          instanceBuffers(::createInstanceBuffers(physicalDevice, device, maxRenderFrames)),
+          clearValues(::createClearValues()),
+          gpuTimer(ast::VulkanGpuTimer(physicalDevice, device, maxRenderFrames)),
+          imagesInFlight(targets->framebuffers.size(), vk::Fence()),
+          readbacksPending(maxRenderFrames, false)
+    {
+        nameObjects(device);
+    }
+
+    void nameObjects(const ast::VulkanDevice& device) const
+    {
+        device.setObjectName(vk::ObjectType::eRenderPass,
+                             ast::vulkan::getObjectHandle(renderPass.getRenderPass()),
+                             "Main render pass");
+
+        for (uint32_t i = 0; i < maxRenderFrames; i++)
+        {
+            device.setObjectName(vk::ObjectType::eCommandBuffer,
+                                 ast::vulkan::getObjectHandle(commandBuffers[i].get()),
+                                 "Frame command buffer " + std::to_string(i));
+        }
+    }
+
+    void resize(const ast::SDLWindow& window,
+                const ast::VulkanPhysicalDevice& physicalDevice,
+                const ast::VulkanDevice& device,
+                const ast::VulkanSurface& surface,
+                const ast::VulkanCommandPool& commandPool)
+    {
+        static const std::string logTag{"ast::VulkanRenderContext::resize"};
+
+        // Handing the current swapchain over as the old one lets the presentation engine move
+        // straight on to the new one without us having to wait for the GPU to go idle.
+        std::unique_ptr<ast::VulkanSwapchain> swapchain{std::make_unique<ast::VulkanSwapchain>(
+            window, physicalDevice, device, surface, targets->swapchain->getSwapchain())};
+
+        // The render pass, and every pipeline created against it, depends on the color format
+        // which is chosen from what the surface supports, so it doesn't change with its size.
+        if (swapchain->getColorFormat() != colorFormat)
+        {
+            throw std::runtime_error(logTag + ": Swapchain color format changed during resize.");
+        }
+
+        // Frames which are still in flight may be using the current targets, so they are only
+        // destroyed once every frame submitted before now has completed.
+        retiredTargets.push_back(::RetiredRenderTargets{std::move(targets), submittedFrameCount});
+
+        targets = std::make_unique<::RenderTargets>(std::move(swapchain),
+                                                    nullptr,
+                                                    physicalDevice,
+                                                    device,
+                                                    commandPool,
+                                                    colorFormat,
+                                                    renderPass);
+
+        imagesInFlight.assign(targets->framebuffers.size(), vk::Fence());
+
+        ast::log(logTag, "Resized render targets to " + std::to_string(targets->extent.width) +
+                             " x " + std::to_string(targets->extent.height));
+    }
+
+    void destroyRetiredTargets()
+    {
+        // The fence of the current render frame has just been waited on, and frames complete in
+        // the order they were submitted, so every frame up to the last one which used this
+        // render frame is known to be complete.
+        if (retiredTargets.empty() || submittedFrameCount < maxRenderFrames)
+        {
+            return;
+        }
+
+        const uint64_t completedFrameCount{submittedFrameCount - maxRenderFrames + 1};
+
+        while (!retiredTargets.empty() && retiredTargets.front().retiredAtFrame <= completedFrameCount)
+        {
+            retiredTargets.erase(retiredTargets.begin());
+        }
+    }
 
     const vk::CommandBuffer& getActiveCommandBuffer() const
     {
-        return commandBuffers[currentSwapchainImageIndex].get();
+        return commandBuffers[currentFrameIndex].get();
+    }
+
+    const ast::VulkanDynamicBuffer& getActiveInstanceBuffer() const
+    {
+        return instanceBuffers[currentFrameIndex];
+    }
+
+    void waitForFence(const ast::VulkanDevice& device, const vk::Fence& fence)
+    {
+        AST_PROFILE_ZONE("VulkanRenderContext::waitForFence");
+
+        static constexpr uint64_t timeOut{std::numeric_limits<uint64_t>::max()};
+
+        const auto waitStart{std::chrono::steady_clock::now()};
+
+        device.getDevice().waitForFences(
+            1,        // Number of fences to wait for
+            &fence,   // Fences to wait for
+            VK_TRUE,  // Wait for all fences
+            timeOut); // Timeout while waiting
+
+        fenceWaitTime += std::chrono::steady_clock::now() - waitStart;
+        fenceWaitCount++;
+    }
+
+    void recordFrameStatistics()
+    {
+        static const std::string logTag{"ast::VulkanRenderContext::recordFrameStatistics"};
+
+        if (++statisticsFrameCount < ::fenceStatisticsFrameInterval)
+        {
+            return;
+        }
+
+        ast::log(logTag, "Frames in flight: " + std::to_string(maxRenderFrames) +
+                             ", fence waits: " + std::to_string(fenceWaitCount) +
+                             ", CPU blocked on fences: " + std::to_string(fenceWaitTime.count() / statisticsFrameCount) +
+                             " ms per frame over " + std::to_string(statisticsFrameCount) + " frames");
+
+        statisticsFrameCount = 0;
+        fenceWaitCount = 0;
+        fenceWaitTime = std::chrono::duration<double, std::milli>{0};
+    }
+
+    bool acquireSwapchainImage(const ast::VulkanDevice& device,
+                               const vk::Fence& graphicsFence,
+                               const vk::Semaphore& graphicsSemaphore)
+    {
+        try
+        {
+            // Attempt to acquire the next swapchain image index to target.
+            currentImageIndex = ::acquireNextImageIndex(device.getDevice(),
+                                                        targets->swapchain->getSwapchain(),
+                                                        graphicsSemaphore);
+        }
+        catch (vk::OutOfDateKHRError outOfDateError)
+        {
+            return false;
+        }
+
+        // If the swapchain hands back its images out of order, a frame which is still in flight
+        // may be rendering into the image we just acquired, so we must wait for it as well.
+        vk::Fence& imageFence{imagesInFlight[currentImageIndex]};
+
+        if (imageFence && imageFence != graphicsFence)
+        {
+            waitForFence(device, imageFence);
+        }
+
+        imageFence = graphicsFence;
+
+        return true;
+    }
+
+    void readbackFrame(const uint32_t& frameIndex)
+    {
+        AST_PROFILE_ZONE("VulkanRenderContext::readbackFrame");
+
+        // The fence of the render frame has already been waited on, so the copy it made of its
+        // offscreen image the last time around has completed. Reading back a frame this late
+        // means it never costs more than the usual wait for frames in flight.
+        if (!readbacksPending[frameIndex])
+        {
+            return;
+        }
+
+        readbacksPending[frameIndex] = false;
+
+        ast::headless::onFrameReadback(ast::WindowSize{targets->extent.width, targets->extent.height},
+                                       targets->offscreenTarget->getReadbackPixels(frameIndex),
+                                       false);
+    }
+
+    void finishReadbacks(const ast::VulkanDevice& device)
+    {
+        // The last frames in flight are otherwise never read back, as no later frame comes around
+        // to collect them. The current render frame is the oldest, so start from there.
+        for (uint32_t i = 0; i < maxRenderFrames; i++)
+        {
+            const uint32_t frameIndex{(currentFrameIndex + i) % maxRenderFrames};
+
+            if (readbacksPending[frameIndex])
+            {
+                waitForFence(device, graphicsFences[frameIndex].get());
+                readbackFrame(frameIndex);
+            }
+        }
+    }
+
+    void advanceFrame()
+    {
+        // Move on to the next render frame straight away. We deliberately don't wait for the
+        // GPU to complete this one, so the CPU can record the next frame while the GPU is still
+        // working on this one, up to the number of frames we allow to be in flight.
+        currentFrameIndex = (currentFrameIndex + 1) % maxRenderFrames;
+        submittedFrameCount++;
+        recordFrameStatistics();
     }
 
     bool renderBegin(const ast::VulkanDevice& device)
@@ -216,63 +543,102 @@ struct VulkanRenderContext::Internal
         const vk::Fence& graphicsFence{graphicsFences[currentFrameIndex].get()};
         const vk::Semaphore& graphicsSemaphore{graphicsSemaphores[currentFrameIndex].get()};
 
-        try
+        // Wait until the GPU has finished the last frame which used this frame's resources. With
+        // more than one frame in flight this typically returns immediately, as the GPU has been
+        // working through the previous frames while we recorded the ones after them.
+        waitForFence(device, graphicsFence);
+        destroyRetiredTargets();
+
+        if (targets->offscreenTarget)
         {
-            // Attempt to acquire the next swapchain image index to target.
-            currentSwapchainImageIndex = ::acquireNextImageIndex(device.getDevice(),
-                                                                 swapchain.getSwapchain(),
-                                                                 graphicsFence,
-                                                                 graphicsSemaphore);
+            // Rendering headless, each render frame owns one of the offscreen images so there is
+            // nothing to acquire, but the frame last rendered into it can now be read back.
+            readbackFrame(currentFrameIndex);
+            currentImageIndex = currentFrameIndex;
         }
-        catch (vk::OutOfDateKHRError outOfDateError)
+        else if (!acquireSwapchainImage(device, graphicsFence, graphicsSemaphore))
         {
             // We cannot render with the current swapchain - it needs to be recreated.
             return false;
         }
 
-        // Grab the command buffer to use for the current swapchain image index.
-        const vk::CommandBuffer& commandBuffer{getActiveCommandBuffer()};
+        // Only reset the fence once we know that this frame will submit work which signals it.
+        device.getDevice().resetFences(1, &graphicsFence);
 
-        // Reset the command buffer to a fresh state.
-        commandBuffer.reset(vk::CommandBufferResetFlagBits::eReleaseResources);
+        // The graphics fence has been waited on, so the GPU is no longer reading the instance
+        // data that was written during the last use of this render frame and it can be reused.
+        getActiveInstanceBuffer().reset();
+
+        // Reset every command buffer for this frame in one go by resetting their command pool.
+        device.getDevice().resetCommandPool(commandPools[currentFrameIndex].get(), vk::CommandPoolResetFlags());
+
+        // Grab the command buffer to use for the current render frame.
+        const vk::CommandBuffer& commandBuffer{getActiveCommandBuffer()};
 
         // Begin the command buffer.
         vk::CommandBufferBeginInfo commandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit, nullptr};
         commandBuffer.begin(&commandBufferBeginInfo);
 
-        // Configure the scissor.
+        // Collect the GPU timings of the last use of this render frame, whose fence has been
+        // waited on, and start timing this one. This has to happen outside of the render pass.
+        gpuTimer.beginFrame(device, commandBuffer, currentFrameIndex);
+
+        // Configure the scissor, which is dynamic pipeline state so it can follow the size of
+        // the render targets without any pipelines being rebuilt.
         commandBuffer.setScissor(
-            0,         // Which scissor to start at
-            1,         // How many scissors to apply
-            &scissor); // Scissor data
+            0,                  // Which scissor to start at
+            1,                  // How many scissors to apply
+            &targets->scissor); // Scissor data
 
-        // Configure the viewport.
+        // Configure the viewport, which is also dynamic pipeline state.
         commandBuffer.setViewport(
-            0,          // Which viewport to start at
-            1,          // How many viewports to apply
-            &viewport); // Viewport data
+            0,                   // Which viewport to start at
+            1,                   // How many viewports to apply
+            &targets->viewport); // Viewport data
+
+        return true;
+    }
+
+    void beginRenderPass(const ast::VulkanDevice& device)
+    {
+        // Grab the command buffer to use for the current render frame.
+        const vk::CommandBuffer& commandBuffer{getActiveCommandBuffer()};
 
         // Define the render pass attributes to apply.
         vk::RenderPassBeginInfo renderPassBeginInfo{
             renderPass.getRenderPass(),                     // Render pass to use
-            framebuffers[currentSwapchainImageIndex].get(), // Current frame buffer
-            scissor,                                        // Render area
+            targets->framebuffers[currentImageIndex].get(), // Current frame buffer
+            targets->scissor,                               // Render area
             2,                                              // Clear value count
             clearValues.data()};                            // Clear values
 
+        // Time and label everything recorded into the render pass as the main pass.
+        gpuTimer.beginZone(device, commandBuffer, "Main pass");
+
         // Record the begin render pass command.
         commandBuffer.beginRenderPass(&renderPassBeginInfo, vk::SubpassContents::eInline);
-
-        return true;
     }
 
     bool renderEnd(const ast::VulkanDevice& device)
     {
-        // Grab the command buffer to use for the current swapchain image index.
+        // Grab the command buffer to use for the current render frame.
         const vk::CommandBuffer& commandBuffer{getActiveCommandBuffer()};
 
         // Request the command buffer to end its recording phase.
         commandBuffer.endRenderPass();
+        gpuTimer.endZone(device, commandBuffer);
+
+        // Rendering headless, copy the frame out of its offscreen image so it can be read back
+        // the next time this render frame comes around.
+        if (targets->offscreenTarget)
+        {
+            gpuTimer.beginZone(device, commandBuffer, "Readback");
+            targets->offscreenTarget->recordReadback(commandBuffer, currentImageIndex);
+            readbacksPending[currentFrameIndex] = true;
+            gpuTimer.endZone(device, commandBuffer);
+        }
+
+        gpuTimer.endFrame(device, commandBuffer);
         commandBuffer.end();
 
         // Get the appropriate graphics fence and semaphores for the current render frame.
@@ -281,6 +647,25 @@ struct VulkanRenderContext::Internal
         const vk::Semaphore& presentationSemaphore{presentationSemaphores[currentFrameIndex].get()};
         const vk::PipelineStageFlags pipelineStageFlags{vk::PipelineStageFlagBits::eColorAttachmentOutput};
 
+        // Rendering headless there was no image to wait for and there is nothing to present,
+        // so the command buffer can be submitted on its own.
+        if (targets->offscreenTarget)
+        {
+            vk::SubmitInfo submitInfo{
+                0,              // Wait semaphore count
+                nullptr,        // Wait semaphores
+                nullptr,        // Pipeline stage flags
+                1,              // Command buffer count
+                &commandBuffer, // Command buffer
+                0,              // Signal semaphore count
+                nullptr};       // Signal semaphores
+
+            device.getGraphicsQueue().submit(1, &submitInfo, graphicsFence);
+            advanceFrame();
+
+            return true;
+        }
+
         // Build a submission object for the graphics queue to process.
         vk::SubmitInfo submitInfo{
             1,                       // Wait semaphore count
@@ -296,12 +681,15 @@ struct VulkanRenderContext::Internal
 
         // Construct an info object to describe what to present to the screen.
         vk::PresentInfoKHR presentationInfo{
-            1,                           // Semaphore count
-            &presentationSemaphore,      // Wait semaphore
-            1,                           // Swapchain count
-            &swapchain.getSwapchain(),   // Swapchain
-            &currentSwapchainImageIndex, // Image indices
-            nullptr};                    // Results
+            1,                                   // Semaphore count
+            &presentationSemaphore,              // Wait semaphore
+            1,                                   // Swapchain count
+            &targets->swapchain->getSwapchain(), // Swapchain
+            &currentImageIndex,                  // Image indices
+            nullptr};                            // Results
+
+        // Move on to the next render frame without waiting for the presentation to complete.
+        advanceFrame();
 
         try
         {
@@ -318,12 +706,6 @@ struct VulkanRenderContext::Internal
             return false;
         }
 
-        // We now wait for the presentation to have been completed before continuing.
-        device.getPresentationQueue().waitIdle();
-
-        // Increment our current frame index, wrapping it when it hits our maximum.
-        currentFrameIndex = (currentFrameIndex + 1) % maxRenderFrames;
-
         return true;
     }
 };
@@ -333,49 +715,83 @@ VulkanRenderContext::VulkanRenderContext(const ast::SDLWindow& window,
                                          const ast::VulkanDevice& device,
                                          const ast::VulkanSurface& surface,
                                          const ast::VulkanCommandPool& commandPool,
-                                         const vk::SwapchainKHR& oldSwapchain)
-    : internal(ast::make_internal_ptr<Internal>(window, physicalDevice, device, surface, commandPool, oldSwapchain)) {}
+                                         const uint32_t& framesInFlight)
+    : internal(ast::make_internal_ptr<Internal>(
+          std::make_unique<ast::VulkanSwapchain>(window, physicalDevice, device, surface, vk::SwapchainKHR()),
+          nullptr,
+          physicalDevice,
+          device,
+          commandPool,
+          framesInFlight)) {}
+
+VulkanRenderContext::VulkanRenderContext(const ast::VulkanPhysicalDevice& physicalDevice,
+                                         const ast::VulkanDevice& device,
+                                         const ast::VulkanCommandPool& commandPool,
+                                         const uint32_t& framesInFlight,
+                                         const vk::Extent2D& extent)
+    : internal(ast::make_internal_ptr<Internal>(
+          nullptr,
+          std::make_unique<ast::VulkanOffscreenTarget>(commandPool, physicalDevice, device, extent, framesInFlight),
+          physicalDevice,
+          device,
+          commandPool,
+          framesInFlight)) {}
 
 bool VulkanRenderContext::renderBegin(const ast::VulkanDevice& device)
 {
     return internal->renderBegin(device);
 }
 
+void VulkanRenderContext::beginRenderPass(const ast::VulkanDevice& device)
+{
+    internal->beginRenderPass(device);
+}
+
 bool VulkanRenderContext::renderEnd(const ast::VulkanDevice& device)
 {
     return internal->renderEnd(device);
 }
 
-ast::VulkanRenderContext VulkanRenderContext::recreate(const ast::SDLWindow& window,
-                                                       const ast::VulkanPhysicalDevice& physicalDevice,
-                                                       const ast::VulkanDevice& device,
-                                                       const ast::VulkanSurface& surface,
-                                                       const ast::VulkanCommandPool& commandPool)
+void VulkanRenderContext::resize(const ast::SDLWindow& window,
+                                 const ast::VulkanPhysicalDevice& physicalDevice,
+                                 const ast::VulkanDevice& device,
+                                 const ast::VulkanSurface& surface,
+                                 const ast::VulkanCommandPool& commandPool)
 {
-    return ast::VulkanRenderContext(window,
-                                    physicalDevice,
-                                    device,
-                                    surface,
-                                    commandPool,
-                                    internal->swapchain.getSwapchain());
+    internal->resize(window, physicalDevice, device, surface, commandPool);
 }
 
-const vk::Viewport& VulkanRenderContext::getViewport() const
+const vk::RenderPass& VulkanRenderContext::getRenderPass() const
 {
-    return internal->viewport;
+    return internal->renderPass.getRenderPass();
 }
 
-const vk::Rect2D& VulkanRenderContext::getScissor() const
+const vk::CommandBuffer& VulkanRenderContext::getActiveCommandBuffer() const
 {
-    return internal->scissor;
+    return internal->getActiveCommandBuffer();
 }
 
-const vk::RenderPass& VulkanRenderContext::getRenderPass() const
+const ast::VulkanDynamicBuffer& VulkanRenderContext::getActiveInstanceBuffer() const
 {
-    return internal->renderPass.getRenderPass();
+    return internal->getActiveInstanceBuffer();
 }
 
-const vk::CommandBuffer& VulkanRenderContext::getActiveCommandBuffer() const
+void VulkanRenderContext::finishReadbacks(const ast::VulkanDevice& device)
 {
-    return internal->getActiveCommandBuffer();
+    internal->finishReadbacks(device);
+}
+
+uint32_t VulkanRenderContext::getActiveFrameIndex() const
+{
+    return internal->currentFrameIndex;
+}
+
+void VulkanRenderContext::beginGpuZone(const ast::VulkanDevice& device, const std::string& name)
+{
+    internal->gpuTimer.beginZone(device, internal->getActiveCommandBuffer(), name);
+}
+
+void VulkanRenderContext::endGpuZone(const ast::VulkanDevice& device)
+{
+    internal->gpuTimer.endZone(device, internal->getActiveCommandBuffer());
 }
@@ -4,8 +4,10 @@
 #include "../../core/sdl-window.hpp"
 #include "vulkan-command-pool.hpp"
 #include "vulkan-device.hpp"
+#include "vulkan-dynamic-buffer.hpp"
 #include "vulkan-physical-device.hpp"
 #include "vulkan-surface.hpp"
+#include <string>
 
 namespace ast
 {
@@ -16,26 +18,51 @@ namespace ast
                             const ast::VulkanDevice& device,
                             const ast::VulkanSurface& surface,
                             const ast::VulkanCommandPool& commandPool,
-                            const vk::SwapchainKHR& oldSwapchain = vk::SwapchainKHR());
+                            const uint32_t& framesInFlight);
 
+        // Creates a render context which renders headless into offscreen images of the given
+        // extent, reading each frame back instead of presenting it.
+        VulkanRenderContext(const ast::VulkanPhysicalDevice& physicalDevice,
+                            const ast::VulkanDevice& device,
+                            const ast::VulkanCommandPool& commandPool,
+                            const uint32_t& framesInFlight,
+                            const vk::Extent2D& extent);
+
+        // Begins recording a frame. Work which has to happen outside of the render pass, such as
+        // compute dispatches, can be recorded before the render pass is begun.
         bool renderBegin(const ast::VulkanDevice& device);
 
-        bool renderEnd(const ast::VulkanDevice& device);
+        void beginRenderPass(const ast::VulkanDevice& device);
 
-        ast::VulkanRenderContext recreate(const ast::SDLWindow& window,
-                                          const ast::VulkanPhysicalDevice& physicalDevice,
-                                          const ast::VulkanDevice& device,
-                                          const ast::VulkanSurface& surface,
-                                          const ast::VulkanCommandPool& commandPool);
+        bool renderEnd(const ast::VulkanDevice& device);
 
-        const vk::Viewport& getViewport() const;
+        // Recreates only the swapchain and the attachments which depend on the size of the
+        // window. The render pass stays the same, so pipelines created against it remain valid.
+        void resize(const ast::SDLWindow& window,
+                    const ast::VulkanPhysicalDevice& physicalDevice,
+                    const ast::VulkanDevice& device,
+                    const ast::VulkanSurface& surface,
+                    const ast::VulkanCommandPool& commandPool);
 
-        const vk::Rect2D& getScissor() const;
+        // Reads back every headless frame still in flight, waiting for each to complete. This has
+        // to happen before shutting down or the last frames rendered are never delivered.
+        void finishReadbacks(const ast::VulkanDevice& device);
 
         const vk::RenderPass& getRenderPass() const;
 
         const vk::CommandBuffer& getActiveCommandBuffer() const;
 
+        const ast::VulkanDynamicBuffer& getActiveInstanceBuffer() const;
+
+        // Which of the render frames in flight is being recorded.
+        uint32_t getActiveFrameIndex() const;
+
+        // Opens a named zone in the active command buffer which is timed on the GPU and labelled
+        // for capture tools. Zones can be nested, and each must be closed within the frame.
+        void beginGpuZone(const ast::VulkanDevice& device, const std::string& name);
+
+        void endGpuZone(const ast::VulkanDevice& device);
+
     private:
         struct Internal;
         ast::internal_ptr<Internal> internal;
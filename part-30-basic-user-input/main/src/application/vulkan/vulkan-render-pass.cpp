@@ -1,4 +1,5 @@
 #include "vulkan-render-pass.hpp"
+#include <vector>
 
 using ast::VulkanRenderPass;
 
@@ -6,9 +7,9 @@ namespace
 {
     vk::UniqueRenderPass createRenderPass(const ast::VulkanPhysicalDevice& physicalDevice,
                                           const ast::VulkanDevice& device,
-                                          const ast::VulkanSwapchain& swapchain)
+                                          const vk::Format& colorFormat,
+                                          const vk::ImageLayout& finalLayout)
     {
-        vk::Format colorFormat{swapchain.getColorFormat()};
         vk::SampleCountFlagBits multiSamplingLevel{physicalDevice.getMultiSamplingLevel()};
         vk::Format depthFormat{physicalDevice.getDepthFormat()};
 
@@ -54,7 +55,7 @@ namespace
             vk::AttachmentLoadOp::eDontCare,  // Stencil load operation
             vk::AttachmentStoreOp::eDontCare, // Stencil store operation
             vk::ImageLayout::eUndefined,      // Initial layout
-            vk::ImageLayout::ePresentSrcKHR}; // Final layout
+            finalLayout};                     // Final layout
 
         vk::AttachmentReference multiSamplingAttachmentReference{
             2,                                         // Attachment index
@@ -92,16 +93,49 @@ namespace
             vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite, // Destination access flags
             vk::DependencyFlags()};                                                               // Dependency flags
 
+        // With more than one frame in flight the depth and multi sampling images are shared
+        // between frames, so this frame's layout transitions and clears must wait for the
+        // previous frame's attachment writes. Waiting on the color attachment output stage
+        // also orders the swapchain image transition after the image available semaphore.
+        vk::SubpassDependency previousFrameDependency{
+            VK_SUBPASS_EXTERNAL,                                                                          // Source subpass index
+            0,                                                                                            // Destination subpass index
+            vk::PipelineStageFlagBits::eColorAttachmentOutput |
+                vk::PipelineStageFlagBits::eEarlyFragmentTests |
+                vk::PipelineStageFlagBits::eLateFragmentTests,                                            // Source access mask
+            vk::PipelineStageFlagBits::eColorAttachmentOutput |
+                vk::PipelineStageFlagBits::eEarlyFragmentTests |
+                vk::PipelineStageFlagBits::eLateFragmentTests,                                            // Destination access mask
+            vk::AccessFlagBits::eDepthStencilAttachmentWrite | vk::AccessFlagBits::eColorAttachmentWrite, // Source access flags
+            vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite, // Destination access flags
+            vk::DependencyFlags()};                                                                       // Dependency flags
+
+        std::vector<vk::SubpassDependency> subpassDependencies{previousFrameDependency, subpassDependency};
+
+        // If the resolved image is going to be copied out of once the render pass ends, the copy
+        // must wait for the color writes and the transition into the transfer source layout.
+        if (finalLayout == vk::ImageLayout::eTransferSrcOptimal)
+        {
+            subpassDependencies.push_back(vk::SubpassDependency{
+                0,                                                 // Source subpass index
+                VK_SUBPASS_EXTERNAL,                               // Destination subpass index
+                vk::PipelineStageFlagBits::eColorAttachmentOutput, // Source access mask
+                vk::PipelineStageFlagBits::eTransfer,              // Destination access mask
+                vk::AccessFlagBits::eColorAttachmentWrite,         // Source access flags
+                vk::AccessFlagBits::eTransferRead,                 // Destination access flags
+                vk::DependencyFlags()});                           // Dependency flags
+        }
+
         // Collate the attachments, subpass and subpass dependencies into the
         // configuration object needed to construct a render pass.
         vk::RenderPassCreateInfo renderPassCreateInfo{
-            vk::RenderPassCreateFlags(),               // Flags
-            static_cast<uint32_t>(attachments.size()), // Attachment count
-            attachments.data(),                        // Attachments
-            1,                                         // Subpass count
-            &subpass,                                  // Subpasses
-            1,                                         // Dependency count
-            &subpassDependency};                       // Dependencies
+            vk::RenderPassCreateFlags(),                       // Flags
+            static_cast<uint32_t>(attachments.size()),         // Attachment count
+            attachments.data(),                                // Attachments
+            1,                                                 // Subpass count
+            &subpass,                                          // Subpasses
+            static_cast<uint32_t>(subpassDependencies.size()), // Dependency count
+            subpassDependencies.data()};                       // Dependencies
 
         // Ask the logical device to provision a render pass.
         return device.getDevice().createRenderPassUnique(renderPassCreateInfo);
@@ -114,14 +148,16 @@ struct VulkanRenderPass::Internal
 
     Internal(const ast::VulkanPhysicalDevice& physicalDevice,
              const ast::VulkanDevice& device,
-             const ast::VulkanSwapchain& swapchain)
-        : renderPass(::createRenderPass(physicalDevice, device, swapchain)) {}
+             const vk::Format& colorFormat,
+             const vk::ImageLayout& finalLayout)
+        : renderPass(::createRenderPass(physicalDevice, device, colorFormat, finalLayout)) {}
 };
 
 VulkanRenderPass::VulkanRenderPass(const ast::VulkanPhysicalDevice& physicalDevice,
                                    const ast::VulkanDevice& device,
-                                   const ast::VulkanSwapchain& swapchain)
-    : internal(ast::make_internal_ptr<Internal>(physicalDevice, device, swapchain)) {}
+                                   const vk::Format& colorFormat,
+                                   const vk::ImageLayout& finalLayout)
+    : internal(ast::make_internal_ptr<Internal>(physicalDevice, device, colorFormat, finalLayout)) {}
 
 const vk::RenderPass& VulkanRenderPass::getRenderPass() const
 {
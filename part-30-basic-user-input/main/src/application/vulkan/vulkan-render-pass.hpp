@@ -3,15 +3,17 @@
 #include "../../core/internal-ptr.hpp"
 #include "vulkan-device.hpp"
 #include "vulkan-physical-device.hpp"
-#include "vulkan-swapchain.hpp"
 
 namespace ast
 {
     struct VulkanRenderPass
     {
+        // The final layout is the layout the resolved color image is left in once the render pass
+        // ends, ready for it to be presented or copied out of.
         VulkanRenderPass(const ast::VulkanPhysicalDevice& physicalDevice,
                          const ast::VulkanDevice& device,
-                         const ast::VulkanSwapchain& swapchain);
+                         const vk::Format& colorFormat,
+                         const vk::ImageLayout& finalLayout);
 
 		const vk::RenderPass& getRenderPass() const;
 
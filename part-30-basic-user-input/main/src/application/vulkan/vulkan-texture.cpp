@@ -1,215 +1,83 @@
 #include "vulkan-texture.hpp"
-#include "vulkan-buffer.hpp"
+#include "../../core/assets.hpp"
+#include "vulkan-common.hpp"
 #include "vulkan-image.hpp"
-#include <cmath>
+#include <vector>
 
 using ast::VulkanTexture;
 
 namespace
 {
-    void generateMipMaps(const ast::VulkanDevice& device,
-                         const ast::VulkanCommandPool& commandPool,
-                         const ast::VulkanImage& image)
+    void transitionToShaderRead(const vk::CommandBuffer& commandBuffer, const ast::VulkanImage& image)
     {
-        vk::ImageSubresourceRange barrierSubresourceRange{
+        vk::ImageSubresourceRange subresourceRange{
             vk::ImageAspectFlagBits::eColor, // Aspect mask
             0,                               // Base mip level
-            1,                               // Level count
+            image.getMipLevels(),            // Level count
             0,                               // Base array layer
             1};                              // Layer count
 
-        // Setup a barrier object that we will reuse throughout the mip mapping code.
+        // Every mip level has been copied in, so they can all move to being sampled together.
         vk::ImageMemoryBarrier barrier{
-            vk::AccessFlags(),           // Source access mask
-            vk::AccessFlags(),           // Destination access mask
-            vk::ImageLayout::eUndefined, // Old layout
-            vk::ImageLayout::eUndefined, // New layout
-            VK_QUEUE_FAMILY_IGNORED,     // Source queue family index
-            VK_QUEUE_FAMILY_IGNORED,     // Destination queue family index
-            image.getImage(),            // Image
-            barrierSubresourceRange};    // Subresource range
-
-        // Start a new command buffer to generate the mipmaps.
-        vk::UniqueCommandBuffer commandBuffer{commandPool.beginCommandBuffer(device)};
-
-        // Our first mip size will be the same size as the image.
-        int32_t mipWidth{static_cast<int32_t>(image.getWidth())};
-        int32_t mipHeight{static_cast<int32_t>(image.getHeight())};
-        uint32_t mipLevels{image.getMipLevels()};
-
-        for (uint32_t mipLevel = 1; mipLevel < mipLevels; mipLevel++)
-        {
-            barrier.subresourceRange.baseMipLevel = mipLevel - 1;
-            barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-            barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
-            barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-            barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
-
-            commandBuffer->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
-                                           vk::PipelineStageFlagBits::eTransfer,
-                                           vk::DependencyFlags(),
-                                           0, nullptr,
-                                           0, nullptr,
-                                           1, &barrier);
-
-            vk::ImageSubresourceLayers sourceSubresource{
-                vk::ImageAspectFlagBits::eColor, // Aspect mask
-                mipLevel - 1,                    // Mip level
-                0,                               // Base array layer
-                1};                              // Layer count
-
-            std::array<vk::Offset3D, 2> sourceOffsets{
-                vk::Offset3D{0, 0, 0},
-                vk::Offset3D{mipWidth, mipHeight, 1}};
-
-            vk::ImageSubresourceLayers destinationSubresource{
-                vk::ImageAspectFlagBits::eColor, // Aspect mask
-                mipLevel,                        // Mip level
-                0,                               // Base array layer
-                1};                              // Layer count
-
-            std::array<vk::Offset3D, 2> destinationOffsets{
-                vk::Offset3D{0, 0, 0},
-                vk::Offset3D{mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1}};
-
-            vk::ImageBlit blit{
-                sourceSubresource,      // Source subresource
-                sourceOffsets,          // Source offsets
-                destinationSubresource, // Destination subresource
-                destinationOffsets};    // Destination offsets
-
-            commandBuffer->blitImage(image.getImage(), vk::ImageLayout::eTransferSrcOptimal,
-                                     image.getImage(), vk::ImageLayout::eTransferDstOptimal,
-                                     1, &blit,
-                                     vk::Filter::eLinear);
-
-            barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
-            barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-            barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
-            barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-
-            commandBuffer->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
-                                           vk::PipelineStageFlagBits::eFragmentShader,
-                                           vk::DependencyFlags(),
-                                           0, nullptr,
-                                           0, nullptr,
-                                           1, &barrier);
-
-            if (mipWidth > 1)
-            {
-                mipWidth /= 2;
-            }
-
-            if (mipHeight > 1)
-            {
-                mipHeight /= 2;
-            }
-        }
-
-        barrier.subresourceRange.baseMipLevel = mipLevels - 1;
-        barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-        barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-        barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-
-        commandBuffer->pipelineBarrier(
-            vk::PipelineStageFlagBits::eTransfer,
-            vk::PipelineStageFlagBits::eFragmentShader,
-            vk::DependencyFlags(),
-            0, nullptr,
-            0, nullptr,
-            1, &barrier);
-
-        commandPool.endCommandBuffer(commandBuffer.get(), device);
+            vk::AccessFlagBits::eTransferWrite,      // Source access mask
+            vk::AccessFlagBits::eShaderRead,         // Destination access mask
+            vk::ImageLayout::eTransferDstOptimal,    // Old layout
+            vk::ImageLayout::eShaderReadOnlyOptimal, // New layout
+            VK_QUEUE_FAMILY_IGNORED,                 // Source queue family index
+            VK_QUEUE_FAMILY_IGNORED,                 // Destination queue family index
+            image.getImage(),                        // Image
+            subresourceRange};                       // Subresource range
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                      vk::PipelineStageFlagBits::eFragmentShader,
+                                      vk::DependencyFlags(),
+                                      0, nullptr,
+                                      0, nullptr,
+                                      1, &barrier);
     }
 
     ast::VulkanImage createImage(const ast::VulkanPhysicalDevice& physicalDevice,
                                  const ast::VulkanDevice& device,
-                                 const ast::VulkanCommandPool& commandPool,
-                                 const ast::Bitmap& bitmap)
+                                 const ast::VulkanTransferContext& transferContext,
+                                 const ast::TextureData& textureData)
     {
-        uint32_t imageWidth{bitmap.getWidth()};
-        uint32_t imageHeight{bitmap.getHeight()};
-
-        // We determine the mipmapping level by choosing the larger of the
-        // width or height then finding the log base 2 of it which tells us
-        // how many times we can multiply by 2 to reach the size.
-        // For example if the image size is ( 1024 x 512 ):
-        // 1. max ( 1024, 512 ) = 1024
-        // 2. log2 ( 1024 ) = 10 (because 2 x 2 x 2 x 2 x 2 x 2 x 2 x 2 x 2 x 2 = 1024)
-        // 3. floor ( 10 ) = 10
-        // 4. add 1 to accommodate original full sized image = 11
-        // mip levels = 11
-        uint32_t mipLevels{static_cast<uint32_t>(std::floor(std::log2(std::max(imageWidth, imageHeight)))) + 1};
-
-        // We expect that the supplied bitmap object is already in the
-        // RGBA format therefore we know there will be 4 bytes per pixel.
-        vk::DeviceSize bufferSize{imageWidth * imageHeight * 4};
-
-        // Vulkan requires us to stage texture image data in a buffer then copy it into an
-        // image object using Vulkan commands. We start by creating a buffer to hold the
-        // raw bitmap data marked as a transfer source.
-        ast::VulkanBuffer stagingBuffer{
-            physicalDevice,
-            device,
-            bufferSize,
-            vk::BufferUsageFlagBits::eTransferSrc,
-            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-            bitmap.getPixelData()};
-
-        // We will create a new image object which we will mark as being able to be used as
-        // both a transfer source and destination and that can be used to sample from which
-        // is what our fragment shader will want to do with it via a sampler. We can't write
-        // the actual pixel data directly into the image as Vulkan does not allow that. Instead
-        // we must create the shell image and run a Vulkan command to copy the contents of the
-        // staging buffer into the image memory area.
+        const std::vector<ast::TextureMipLevel>& mipLevels{textureData.getMipLevels()};
+
+        // The texture data arrives with its whole mip chain already built (and possibly block
+        // compressed) by the asset baker, so we only need to create an image in the same
+        // format that can be copied into and sampled from. We can't write the data directly
+        // into the image as Vulkan does not allow that. Instead we must create the shell image
+        // and record a copy of each mip level from staging memory into it. All of the commands
+        // needed to prepare the image are recorded into the transfer context to be run later
+        // in one batch.
         ast::VulkanImage image{
-            commandPool,
+            transferContext.getCommandBuffer(),
             physicalDevice,
             device,
-            imageWidth,
-            imageHeight,
-            mipLevels,
+            textureData.getWidth(),
+            textureData.getHeight(),
+            static_cast<uint32_t>(mipLevels.size()),
             vk::SampleCountFlagBits::e1,
-            vk::Format::eR8G8B8A8Unorm,
+            ast::vulkan::getTextureFormat(textureData.getFormat()),
             vk::ImageTiling::eOptimal,
-            vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eSampled,
+            vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
             vk::MemoryPropertyFlagBits::eDeviceLocal,
             vk::ImageLayout::eUndefined,
             vk::ImageLayout::eTransferDstOptimal};
 
-        // Kick off a new command buffer to copy the staging buffer to the image.
-        vk::UniqueCommandBuffer commandBuffer{commandPool.beginCommandBuffer(device)};
-
-        vk::ImageSubresourceLayers imageSubresource{
-            vk::ImageAspectFlagBits::eColor, // Aspect mask
-            0,                               // Mip level
-            0,                               // Base array layer
-            1};                              // Layer count
-
-        vk::Extent3D imageExtent{
-            imageWidth,  // Width
-            imageHeight, // Height
-            1};          // Depth
-
-        vk::BufferImageCopy bufferImageCopy{
-            0,                // Buffer offset
-            0,                // Buffer row length
-            0,                // Buffer image height
-            imageSubresource, // Image subresource
-            vk::Offset3D(),   // Image offset
-            imageExtent};     // Image extent
-
-        // Perform the copy operation from the staging buffer into the image.
-        commandBuffer->copyBufferToImage(stagingBuffer.getBuffer(),
-                                         image.getImage(),
-                                         vk::ImageLayout::eTransferDstOptimal,
-                                         1,
-                                         &bufferImageCopy);
-
-        commandPool.endCommandBuffer(commandBuffer.get(), device);
+        for (uint32_t mipLevel = 0; mipLevel < mipLevels.size(); mipLevel++)
+        {
+            const ast::TextureMipLevel& level{mipLevels[mipLevel]};
+
+            transferContext.copyToImage(image.getImage(),
+                                        mipLevel,
+                                        level.width,
+                                        level.height,
+                                        level.size,
+                                        textureData.getData() + level.offset);
+        }
 
-        ::generateMipMaps(device, commandPool, image);
+        ::transitionToShaderRead(transferContext.getCommandBuffer(), image);
 
         return image;
     }
@@ -265,24 +133,29 @@ struct VulkanTexture::Internal
     Internal(const ast::assets::Texture textureId,
              const ast::VulkanPhysicalDevice& physicalDevice,
              const ast::VulkanDevice& device,
-             const ast::VulkanCommandPool& commandPool,
-             const ast::Bitmap& bitmap)
+             const ast::VulkanTransferContext& transferContext,
+             const ast::TextureData& textureData)
         : textureId(textureId),
-          image(::createImage(physicalDevice, device, commandPool, bitmap)),
+          image(::createImage(physicalDevice, device, transferContext, textureData)),
           imageView(::createImageView(device, image)),
-          sampler(::createSampler(physicalDevice, device, image)) {}
+          sampler(::createSampler(physicalDevice, device, image))
+    {
+        device.setObjectName(vk::ObjectType::eImage,
+                             ast::vulkan::getObjectHandle(image.getImage()),
+                             ast::assets::resolveTexturePath(textureId));
+    }
 };
 
 VulkanTexture::VulkanTexture(const ast::assets::Texture& textureId,
                              const ast::VulkanPhysicalDevice& physicalDevice,
                              const ast::VulkanDevice& device,
-                             const ast::VulkanCommandPool& commandPool,
-                             const ast::Bitmap& bitmap)
+                             const ast::VulkanTransferContext& transferContext,
+                             const ast::TextureData& textureData)
     : internal(ast::make_internal_ptr<Internal>(textureId,
                                                 physicalDevice,
                                                 device,
-                                                commandPool,
-                                                bitmap)) {}
+                                                transferContext,
+                                                textureData)) {}
 
 const ast::assets::Texture& VulkanTexture::getTextureId() const
 {
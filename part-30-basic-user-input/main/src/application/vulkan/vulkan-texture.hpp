@@ -1,13 +1,13 @@
 #pragma once
 
 #include "../../core/asset-inventory.hpp"
-#include "../../core/bitmap.hpp"
 #include "../../core/graphics-wrapper.hpp"
 #include "../../core/internal-ptr.hpp"
-#include "vulkan-command-pool.hpp"
+#include "../../core/texture-data.hpp"
 #include "vulkan-device.hpp"
 #include "vulkan-image-view.hpp"
 #include "vulkan-physical-device.hpp"
+#include "vulkan-transfer-context.hpp"
 
 namespace ast
 {
@@ -16,8 +16,8 @@ namespace ast
         VulkanTexture(const ast::assets::Texture& textureId,
                       const ast::VulkanPhysicalDevice& physicalDevice,
                       const ast::VulkanDevice& device,
-                      const ast::VulkanCommandPool& commandPool,
-                      const ast::Bitmap& bitmap);
+                      const ast::VulkanTransferContext& transferContext,
+                      const ast::TextureData& textureData);
 
         const ast::assets::Texture& getTextureId() const;
 
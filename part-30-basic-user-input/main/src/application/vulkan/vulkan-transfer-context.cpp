@@ -0,0 +1,295 @@
+#include "vulkan-transfer-context.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+using ast::VulkanTransferContext;
+
+namespace
+{
+    vk::UniqueCommandBuffer createCommandBuffer(const ast::VulkanDevice& device,
+                                                const ast::VulkanCommandPool& commandPool)
+    {
+        return std::move(commandPool.createCommandBuffers(device, 1)[0]);
+    }
+
+    vk::UniqueFence createFence(const ast::VulkanDevice& device)
+    {
+        // The fence starts off unsignaled as nothing has been submitted yet.
+        vk::FenceCreateInfo info{vk::FenceCreateFlags()};
+
+        return device.getDevice().createFenceUnique(info);
+    }
+
+    ast::VulkanBuffer createStagingBuffer(const ast::VulkanPhysicalDevice& physicalDevice,
+                                          const ast::VulkanDevice& device,
+                                          const vk::DeviceSize& size,
+                                          const void* dataSource)
+    {
+        return ast::VulkanBuffer(physicalDevice,
+                                 device,
+                                 size,
+                                 vk::BufferUsageFlagBits::eTransferSrc,
+                                 vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                 dataSource);
+    }
+
+    vk::DeviceSize getStagingAlignment(const ast::VulkanPhysicalDevice& physicalDevice)
+    {
+        // Copies into images require the source offset to be a multiple of 4 and of the texel
+        // size, so we never go below 16 bytes even if the device has no preferred alignment.
+        vk::DeviceSize preferredAlignment{
+            physicalDevice.getPhysicalDevice().getProperties().limits.optimalBufferCopyOffsetAlignment};
+
+        return std::max(preferredAlignment, static_cast<vk::DeviceSize>(16));
+    }
+
+    void beginCommandBuffer(const vk::CommandBuffer& commandBuffer)
+    {
+        vk::CommandBufferBeginInfo beginInfo{
+            vk::CommandBufferUsageFlagBits::eOneTimeSubmit, // Flags
+            nullptr};                                       // Inheritance info
+
+        commandBuffer.begin(beginInfo);
+    }
+} // namespace
+
+struct VulkanTransferContext::Internal
+{
+    const ast::VulkanPhysicalDevice& physicalDevice;
+    const ast::VulkanDevice& device;
+    const vk::UniqueCommandBuffer commandBuffer;
+    const vk::UniqueFence fence;
+    const ast::VulkanBuffer stagingBuffer;
+    const vk::DeviceSize stagingSize;
+    const vk::DeviceSize stagingAlignment;
+    vk::DeviceSize stagingOffset;
+    std::vector<ast::VulkanBuffer> oversizedStagingBuffers;
+    bool hasPendingWork;
+
+    Internal(const ast::VulkanPhysicalDevice& physicalDevice,
+             const ast::VulkanDevice& device,
+             const ast::VulkanCommandPool& commandPool,
+             const vk::DeviceSize& stagingSize)
+        : physicalDevice(physicalDevice),
+          device(device),
+          commandBuffer(::createCommandBuffer(device, commandPool)),
+          fence(::createFence(device)),
+          stagingBuffer(::createStagingBuffer(physicalDevice, device, stagingSize, nullptr)),
+          stagingSize(stagingSize),
+          stagingAlignment(::getStagingAlignment(physicalDevice)),
+          stagingOffset(0),
+          hasPendingWork(false)
+    {
+        // The command buffer is always kept in the recording state, ready to accept commands.
+        ::beginCommandBuffer(commandBuffer.get());
+    }
+
+    const vk::CommandBuffer& getCommandBuffer()
+    {
+        // We can't know what the caller records, so assume there is now something to submit.
+        hasPendingWork = true;
+
+        return commandBuffer.get();
+    }
+
+    std::pair<vk::Buffer, vk::DeviceSize> stage(const vk::DeviceSize& size, const void* dataSource)
+    {
+        hasPendingWork = true;
+
+        // Data that could never fit in the staging ring gets its own temporary staging buffer
+        // which is kept alive until the batch it was recorded into has completed.
+        if (size > stagingSize)
+        {
+            oversizedStagingBuffers.push_back(::createStagingBuffer(physicalDevice, device, size, dataSource));
+
+            return std::make_pair(oversizedStagingBuffers.back().getBuffer(), static_cast<vk::DeviceSize>(0));
+        }
+
+        vk::DeviceSize offset{(stagingOffset + stagingAlignment - 1) & ~(stagingAlignment - 1)};
+
+        // If the ring is full we must flush what we have so far before we can reuse it.
+        if (offset + size > stagingSize)
+        {
+            submit();
+            hasPendingWork = true;
+            offset = 0;
+        }
+
+        std::memcpy(static_cast<char*>(stagingBuffer.getMappedMemory()) + offset, dataSource, static_cast<size_t>(size));
+        stagingOffset = offset + size;
+
+        return std::make_pair(stagingBuffer.getBuffer(), offset);
+    }
+
+    ast::VulkanBuffer createDeviceLocalBuffer(const vk::DeviceSize& size,
+                                              const vk::BufferUsageFlags& bufferFlags,
+                                              const void* dataSource)
+    {
+        // Create the device local buffer with no data source but which is marked as being a
+        // 'transfer destination' and adopts whatever additional buffer flags the caller
+        // specified. The memory properties we want for this one is to be in device local memory.
+        ast::VulkanBuffer deviceLocalBuffer{
+            physicalDevice,
+            device,
+            size,
+            vk::BufferUsageFlagBits::eTransferDst | bufferFlags,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            nullptr};
+
+        if (dataSource)
+        {
+            copyToBuffer(deviceLocalBuffer.getBuffer(), 0, size, dataSource);
+        }
+
+        return deviceLocalBuffer;
+    }
+
+    void copyToBuffer(const vk::Buffer& buffer,
+                      const vk::DeviceSize& offset,
+                      const vk::DeviceSize& size,
+                      const void* dataSource)
+    {
+        const auto staged{stage(size, dataSource)};
+
+        // Define what region of the two buffers should participate in the copy operation.
+        vk::BufferCopy copyRegion{
+            staged.second, // Source offset
+            offset,        // Destination offset
+            size};         // Size
+
+        // Record the copy into our batch - it won't actually happen until the batch is submitted.
+        commandBuffer->copyBuffer(staged.first, buffer, 1, &copyRegion);
+    }
+
+    void copyToImage(const vk::Image& image,
+                     const uint32_t& mipLevel,
+                     const uint32_t& width,
+                     const uint32_t& height,
+                     const vk::DeviceSize& size,
+                     const void* dataSource)
+    {
+        const auto staged{stage(size, dataSource)};
+
+        vk::ImageSubresourceLayers imageSubresource{
+            vk::ImageAspectFlagBits::eColor, // Aspect mask
+            mipLevel,                        // Mip level
+            0,                               // Base array layer
+            1};                              // Layer count
+
+        vk::Extent3D imageExtent{
+            width,  // Width
+            height, // Height
+            1};     // Depth
+
+        vk::BufferImageCopy bufferImageCopy{
+            staged.second,    // Buffer offset
+            0,                // Buffer row length
+            0,                // Buffer image height
+            imageSubresource, // Image subresource
+            vk::Offset3D(),   // Image offset
+            imageExtent};     // Image extent
+
+        // The image is expected to already be in the transfer destination layout.
+        commandBuffer->copyBufferToImage(staged.first,
+                                         image,
+                                         vk::ImageLayout::eTransferDstOptimal,
+                                         1,
+                                         &bufferImageCopy);
+    }
+
+    void submit()
+    {
+        if (!hasPendingWork)
+        {
+            return;
+        }
+
+        // Make sure all the buffer copies are visible to any vertex input that reads them
+        // in later submissions. Images take care of their own barriers as they are prepared.
+        vk::MemoryBarrier barrier{
+            vk::AccessFlagBits::eTransferWrite,                                          // Source access mask
+            vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead}; // Destination access mask
+
+        commandBuffer->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                       vk::PipelineStageFlagBits::eVertexInput,
+                                       vk::DependencyFlags(),
+                                       1, &barrier,
+                                       0, nullptr,
+                                       0, nullptr);
+
+        commandBuffer->end();
+
+        vk::SubmitInfo submitInfo{
+            0,                    // Wait semaphore count
+            nullptr,              // Wait semaphores
+            nullptr,              // Wait destination stage mask
+            1,                    // Command buffer count
+            &commandBuffer.get(), // Command buffers,
+            0,                    // Signal semaphore count
+            nullptr};             // Signal semaphores
+
+        // Submit the whole batch in one go, then wait only for our own fence rather than for
+        // the entire graphics queue to become idle.
+        device.getGraphicsQueue().submit(1, &submitInfo, fence.get());
+        device.getDevice().waitForFences(1, &fence.get(), VK_TRUE, std::numeric_limits<uint64_t>::max());
+        device.getDevice().resetFences(1, &fence.get());
+
+        // The batch is complete so all the staging memory can now be reused.
+        stagingOffset = 0;
+        oversizedStagingBuffers.clear();
+        hasPendingWork = false;
+
+        commandBuffer->reset(vk::CommandBufferResetFlags());
+        ::beginCommandBuffer(commandBuffer.get());
+    }
+
+    ~Internal()
+    {
+        // Don't leave any recorded work behind, as it may reference our staging buffers.
+        submit();
+    }
+};
+
+VulkanTransferContext::VulkanTransferContext(const ast::VulkanPhysicalDevice& physicalDevice,
+                                             const ast::VulkanDevice& device,
+                                             const ast::VulkanCommandPool& commandPool,
+                                             const vk::DeviceSize& stagingSize)
+    : internal(ast::make_internal_ptr<Internal>(physicalDevice, device, commandPool, stagingSize)) {}
+
+const vk::CommandBuffer& VulkanTransferContext::getCommandBuffer() const
+{
+    return internal->getCommandBuffer();
+}
+
+ast::VulkanBuffer VulkanTransferContext::createDeviceLocalBuffer(const vk::DeviceSize& size,
+                                                                 const vk::BufferUsageFlags& bufferFlags,
+                                                                 const void* dataSource) const
+{
+    return internal->createDeviceLocalBuffer(size, bufferFlags, dataSource);
+}
+
+void VulkanTransferContext::copyToBuffer(const vk::Buffer& buffer,
+                                         const vk::DeviceSize& offset,
+                                         const vk::DeviceSize& size,
+                                         const void* dataSource) const
+{
+    internal->copyToBuffer(buffer, offset, size, dataSource);
+}
+
+void VulkanTransferContext::copyToImage(const vk::Image& image,
+                                        const uint32_t& mipLevel,
+                                        const uint32_t& width,
+                                        const uint32_t& height,
+                                        const vk::DeviceSize& size,
+                                        const void* dataSource) const
+{
+    internal->copyToImage(image, mipLevel, width, height, size, dataSource);
+}
+
+void VulkanTransferContext::submit() const
+{
+    internal->submit();
+}
\ No newline at end of file
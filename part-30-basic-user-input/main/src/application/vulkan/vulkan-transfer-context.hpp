@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../../core/graphics-wrapper.hpp"
+#include "../../core/internal-ptr.hpp"
+#include "vulkan-buffer.hpp"
+#include "vulkan-command-pool.hpp"
+#include "vulkan-device.hpp"
+#include "vulkan-physical-device.hpp"
+
+namespace ast
+{
+    // A transfer context batches up uploads of data into device local memory. Source data is
+    // written into a persistently mapped staging ring and every copy is recorded into a single
+    // command buffer, which is only submitted when 'submit' is called (or if the staging ring
+    // fills up). This means many assets can be uploaded with one queue submission and one
+    // fence wait, instead of stalling the graphics queue for each individual transfer.
+    struct VulkanTransferContext
+    {
+        VulkanTransferContext(const ast::VulkanPhysicalDevice& physicalDevice,
+                              const ast::VulkanDevice& device,
+                              const ast::VulkanCommandPool& commandPool,
+                              const vk::DeviceSize& stagingSize);
+
+        const vk::CommandBuffer& getCommandBuffer() const;
+
+        // Creates a device local buffer holding a copy of the data source. Without a data
+        // source the buffer is left empty, ready to be filled in pieces with 'copyToBuffer'.
+        ast::VulkanBuffer createDeviceLocalBuffer(const vk::DeviceSize& size,
+                                                  const vk::BufferUsageFlags& bufferFlags,
+                                                  const void* dataSource) const;
+
+        void copyToBuffer(const vk::Buffer& buffer,
+                          const vk::DeviceSize& offset,
+                          const vk::DeviceSize& size,
+                          const void* dataSource) const;
+
+        void copyToImage(const vk::Image& image,
+                         const uint32_t& mipLevel,
+                         const uint32_t& width,
+                         const uint32_t& height,
+                         const vk::DeviceSize& size,
+                         const void* dataSource) const;
+
+        void submit() const;
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
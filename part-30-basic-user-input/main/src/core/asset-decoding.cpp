@@ -0,0 +1,57 @@
+#include "asset-decoding.hpp"
+#include "assets.hpp"
+#include "profiler.hpp"
+
+double ast::assets::millisecondsSince(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+ast::DecodedAsset<ast::EncodedMesh> ast::assets::decodeStaticMesh(const ast::assets::StaticMesh& staticMesh,
+                                                                  const ast::VertexLayout& vertexLayout)
+{
+    AST_PROFILE_ZONE("ast::assets::decodeStaticMesh");
+
+    const auto start{std::chrono::steady_clock::now()};
+    ast::EncodedMesh mesh{ast::meshes::encode(ast::assets::loadStaticMesh(staticMesh), vertexLayout)};
+
+    return ast::DecodedAsset<ast::EncodedMesh>{std::move(mesh), ast::assets::millisecondsSince(start)};
+}
+
+ast::DecodedAsset<ast::TextureData> ast::assets::decodeTexture(const ast::assets::Texture& texture,
+                                                               const std::function<bool(const ast::TextureFormat&)>& isFormatSupported)
+{
+    AST_PROFILE_ZONE("ast::assets::decodeTexture");
+
+    const auto start{std::chrono::steady_clock::now()};
+    ast::TextureData textureData{ast::assets::loadTexture(texture, isFormatSupported)};
+
+    return ast::DecodedAsset<ast::TextureData>{std::move(textureData), ast::assets::millisecondsSince(start)};
+}
+
+ast::DecodedGeometryPool ast::assets::collectGeometryPool(
+    std::unordered_map<ast::assets::StaticMesh, std::future<ast::DecodedAsset<ast::EncodedMesh>>>& jobs)
+{
+    ast::DecodedGeometryPool pool;
+    std::vector<const ast::EncodedMesh*> encodedMeshes;
+
+    for (auto& job : jobs)
+    {
+        pool.meshes.push_back(std::make_pair(job.first, job.second.get()));
+    }
+
+    for (const auto& decodedMesh : pool.meshes)
+    {
+        encodedMeshes.push_back(&decodedMesh.second.asset);
+    }
+
+    pool.layout = ast::meshes::createGeometryPoolLayout(encodedMeshes);
+
+    return pool;
+}
+
+std::string ast::assets::formatTimings(const double& decodeMilliseconds, const double& uploadMilliseconds)
+{
+    return " (decode: " + std::to_string(decodeMilliseconds) + "ms" +
+           ", upload: " + std::to_string(uploadMilliseconds) + "ms)";
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "asset-inventory.hpp"
+#include "mesh-encoder.hpp"
+#include "texture-data.hpp"
+#include <chrono>
+#include <functional>
+#include <future>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ast
+{
+    // The CPU side result of decoding an asset on a worker thread, along with how long it took.
+    template <typename T>
+    struct DecodedAsset
+    {
+        T asset;
+        double decodeMilliseconds;
+    };
+
+    // The new static meshes of an asset manifest, packed into one pair of vertex and index
+    // buffers so a scene loaded from a single manifest can be drawn with its geometry bound
+    // only once. Each mesh is placed at the range with the same position in the layout, leaving
+    // the renderer to create the buffers and copy the meshes into them.
+    struct DecodedGeometryPool
+    {
+        std::vector<std::pair<ast::assets::StaticMesh, ast::DecodedAsset<ast::EncodedMesh>>> meshes;
+        ast::GeometryPoolLayout layout;
+    };
+} // namespace ast
+
+namespace ast::assets
+{
+    double millisecondsSince(const std::chrono::steady_clock::time_point& start);
+
+    // Load a static mesh and encode it into the given vertex layout, ready to be uploaded.
+    ast::DecodedAsset<ast::EncodedMesh> decodeStaticMesh(const ast::assets::StaticMesh& staticMesh,
+                                                         const ast::VertexLayout& vertexLayout);
+
+    // Load a texture in the first baked format the renderer accepts, or decode its source image.
+    ast::DecodedAsset<ast::TextureData> decodeTexture(const ast::assets::Texture& texture,
+                                                      const std::function<bool(const ast::TextureFormat&)>& isFormatSupported);
+
+    // Wait for every static mesh to finish decoding, as only then is it known how large the shared
+    // buffers must be, and lay them all out in a single geometry pool.
+    ast::DecodedGeometryPool collectGeometryPool(
+        std::unordered_map<ast::assets::StaticMesh, std::future<ast::DecodedAsset<ast::EncodedMesh>>>& jobs);
+
+    // Describe how long an asset took to decode and to upload, for logging.
+    std::string formatTimings(const double& decodeMilliseconds, const double& uploadMilliseconds);
+} // namespace ast::assets
\ No newline at end of file
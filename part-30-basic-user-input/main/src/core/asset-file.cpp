@@ -0,0 +1,157 @@
+#include "asset-file.hpp"
+#include "sdl-wrapper.hpp"
+#include <stdexcept>
+
+// Memory mapping is only used on desktop Linux. Android assets live inside the APK, the Apple
+// platforms resolve assets through the application bundle and Emscripten uses a virtual file
+// system, all of which SDL already knows how to navigate for us.
+#if defined(__linux__) && !defined(__ANDROID__)
+#define AST_ASSET_FILE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using ast::AssetFile;
+
+namespace
+{
+#ifdef AST_ASSET_FILE_MMAP
+    // Attempt to memory map the given file, returning a null pointer if it could not be mapped
+    // so the caller can fall back to loading through SDL instead.
+    void* mapFile(const std::string& path, size_t& size)
+    {
+        const int fileDescriptor{open(path.c_str(), O_RDONLY)};
+
+        if (fileDescriptor < 0)
+        {
+            return nullptr;
+        }
+
+        struct stat fileStatus;
+
+        if (fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+        {
+            close(fileDescriptor);
+            return nullptr;
+        }
+
+        size = static_cast<size_t>(fileStatus.st_size);
+
+        void* data{mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0)};
+
+        // The mapping keeps its own reference to the file so we can close the descriptor now.
+        close(fileDescriptor);
+
+        if (data == MAP_FAILED)
+        {
+            return nullptr;
+        }
+
+        // Our assets are almost always read from start to finish so let the kernel read ahead.
+        madvise(data, size, MADV_SEQUENTIAL);
+
+        return data;
+    }
+#endif
+
+    // Load the entire file through SDL, which gives us a single allocation that we will
+    // hold on to rather than copying into another container. A file which doesn't exist
+    // gives a null pointer, leaving the caller to decide whether that is an error.
+    void* loadFile(const std::string& path, size_t& size)
+    {
+        static const std::string logTag{"ast::AssetFile::loadFile"};
+
+        SDL_RWops* file{SDL_RWFromFile(path.c_str(), "rb")};
+
+        if (!file)
+        {
+            return nullptr;
+        }
+
+        void* data{SDL_LoadFile_RW(file, &size, 1)};
+
+        if (!data)
+        {
+            throw std::runtime_error(logTag + ": Could not read " + path);
+        }
+
+        return data;
+    }
+} // namespace
+
+struct AssetFile::Internal
+{
+    size_t size;
+    bool mapped;
+    void* data;
+
+    Internal(const std::string& path) : size(0), mapped(false), data(nullptr)
+    {
+#ifdef AST_ASSET_FILE_MMAP
+        data = ::mapFile(path, size);
+        mapped = data != nullptr;
+#endif
+
+        if (!mapped)
+        {
+            data = ::loadFile(path, size);
+        }
+    }
+
+    ~Internal()
+    {
+#ifdef AST_ASSET_FILE_MMAP
+        if (mapped)
+        {
+            munmap(data, size);
+            return;
+        }
+#endif
+
+        SDL_free(data);
+    }
+};
+
+AssetFile::AssetFile(const std::string& path) : internal(ast::make_internal_ptr<Internal>(path))
+{
+    if (!internal->data)
+    {
+        throw std::runtime_error("ast::AssetFile: Could not open " + path);
+    }
+}
+
+AssetFile::AssetFile(ast::internal_ptr<Internal> internal) : internal(std::move(internal)) {}
+
+std::unique_ptr<AssetFile> AssetFile::openIfExists(const std::string& path)
+{
+    ast::internal_ptr<Internal> internal{ast::make_internal_ptr<Internal>(path)};
+
+    if (!internal->data)
+    {
+        return nullptr;
+    }
+
+    return std::unique_ptr<AssetFile>(new AssetFile(std::move(internal)));
+}
+
+const char* AssetFile::getData() const
+{
+    return static_cast<const char*>(internal->data);
+}
+
+size_t AssetFile::getSize() const
+{
+    return internal->size;
+}
+
+const char* AssetFile::begin() const
+{
+    return getData();
+}
+
+const char* AssetFile::end() const
+{
+    return getData() + getSize();
+}
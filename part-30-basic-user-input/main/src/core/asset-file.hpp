@@ -0,0 +1,36 @@
+#pragma once
+
+#include "internal-ptr.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace ast
+{
+    // An asset file gives read only access to the raw bytes of a file on disk for as long as
+    // the asset file object is alive. Where possible the file is memory mapped so its bytes
+    // are never copied into our own buffers, otherwise it is loaded once through SDL. Either
+    // way, consumers should read directly from the data pointer rather than taking a copy.
+    struct AssetFile
+    {
+        AssetFile(const std::string& path);
+
+        // Opens the file at the given path if there is one, or returns nothing if there isn't,
+        // so an optional asset is only opened once rather than checked for and then loaded.
+        static std::unique_ptr<ast::AssetFile> openIfExists(const std::string& path);
+
+        const char* getData() const;
+
+        size_t getSize() const;
+
+        const char* begin() const;
+
+        const char* end() const;
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+
+        AssetFile(ast::internal_ptr<Internal> internal);
+    };
+} // namespace ast
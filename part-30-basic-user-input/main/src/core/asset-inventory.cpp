@@ -21,6 +21,17 @@ std::string ast::assets::resolveStaticMeshPath(const ast::assets::StaticMesh& st
     }
 }
 
+std::string ast::assets::resolveBakedStaticMeshPath(const ast::assets::StaticMesh& staticMesh)
+{
+    switch (staticMesh)
+    {
+        case ast::assets::StaticMesh::Crate:
+            return "assets/models/crate.mesh";
+        case ast::assets::StaticMesh::Torus:
+            return "assets/models/torus.mesh";
+    }
+}
+
 std::string ast::assets::resolveTexturePath(const ast::assets::Texture& texture)
 {
     switch (texture)
@@ -31,3 +42,20 @@ std::string ast::assets::resolveTexturePath(const ast::assets::Texture& texture)
             return "assets/textures/red_cross_hatch.png";
     }
 }
+
+std::vector<std::string> ast::assets::resolveBakedTexturePaths(const ast::assets::Texture& texture)
+{
+    // The asset baker produces a version of each texture for each family of block compressed
+    // formats plus an uncompressed fallback, listed here from most to least preferred.
+    switch (texture)
+    {
+        case ast::assets::Texture::Crate:
+            return {"assets/textures/crate.bc.ktx2",
+                    "assets/textures/crate.etc2.ktx2",
+                    "assets/textures/crate.rgba8.ktx2"};
+        case ast::assets::Texture::RedCrossHatch:
+            return {"assets/textures/red_cross_hatch.bc.ktx2",
+                    "assets/textures/red_cross_hatch.etc2.ktx2",
+                    "assets/textures/red_cross_hatch.rgba8.ktx2"};
+    }
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 namespace ast::assets
 {
@@ -25,6 +26,10 @@ namespace ast::assets
 
     std::string resolveStaticMeshPath(const ast::assets::StaticMesh& staticMesh);
 
+    std::string resolveBakedStaticMeshPath(const ast::assets::StaticMesh& staticMesh);
+
     std::string resolveTexturePath(const ast::assets::Texture& texture);
 
+    std::vector<std::string> resolveBakedTexturePaths(const ast::assets::Texture& texture);
+
 } // namespace ast::assets
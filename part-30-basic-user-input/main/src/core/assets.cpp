@@ -1,152 +1,548 @@
-#define TINYOBJLOADER_IMPLEMENTATION
-
 #include "assets.hpp"
+#include "asset-file.hpp"
+#include "log.hpp"
+#include "obj-parser.hpp"
 #include "sdl-wrapper.hpp"
+#include "texture-encoder.hpp"
 #include "vertex.hpp"
 #include <SDL_image.h>
-#include <sstream>
-#include <tiny_obj_loader.h>
-#include <unordered_map>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
 #include <vector>
 
-std::string ast::assets::loadTextFile(const std::string& path)
+namespace
 {
-    // Open a file operation handle to the asset file.
-    SDL_RWops* file{SDL_RWFromFile(path.c_str(), "r")};
+    // A baked mesh file is a fixed size header followed by the packed array of
+    // vertices, the packed array of indices, then the packed array of levels of
+    // detail, exactly as they are laid out in memory. This lets us read the data
+    // straight into the mesh containers without any parsing at all. Note that the
+    // data is written in the native byte order of the machine that baked it, which
+    // is little endian for all of our targets.
+    struct MeshFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vertexSize;
+        uint32_t numVertices;
+        uint32_t numIndices;
+        uint32_t numLevels;
+    };
 
-    // Determine how big the file is.
-    size_t fileLength{static_cast<size_t>(SDL_RWsize(file))};
+    // The characters 'ASTM' packed into an integer to identify a baked mesh file.
+    constexpr uint32_t meshFileMagic{0x4d545341};
 
-    // Ask SDL to load the content of the file into a data pointer.
-    void* data{SDL_LoadFile_RW(file, nullptr, 1)};
+    // Bump this whenever the layout of a baked mesh file changes so old files are rejected.
+    constexpr uint32_t meshFileVersion{2};
 
-    // Construct a new string based on the data pointer.
-    std::string result(static_cast<char*>(data), fileLength);
+    ast::Mesh loadMeshFile(const ast::AssetFile& file, const std::string& path)
+    {
+        static const std::string logTag{"ast::assets::loadMeshFile"};
 
-    // Free up the original SDL managed data pointer.
-    SDL_free(data);
+        if (file.getSize() < sizeof(MeshFileHeader))
+        {
+            throw std::runtime_error(logTag + ": Could not read header from " + path);
+        }
 
-    // Hand back the resulting string which is the content of the file.
-    return result;
-}
+        MeshFileHeader header;
+        std::memcpy(&header, file.getData(), sizeof(MeshFileHeader));
 
-ast::Mesh ast::assets::loadOBJFile(const std::string& path)
-{
-    // Load the .obj file into a string and wrap it as a stream.
-    std::istringstream sourceStream(ast::assets::loadTextFile(path));
-
-    tinyobj::attrib_t attributes;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warning;
-    std::string error;
-
-    // Ask tinyobj to parse the string loaded from our file.
-    if (!tinyobj::LoadObj(
-            &attributes,
-            &shapes,
-            &materials,
-            &warning,
-            &error,
-            &sourceStream))
-    {
-        throw std::runtime_error("ast::assets::loadOBJFile: Error: " + warning + error);
-    }
-
-    std::vector<ast::Vertex> vertices;
-    std::vector<uint32_t> indices;
-    std::unordered_map<ast::Vertex, uint32_t> uniqueVertices;
-
-    // Loop through all the shapes that there found.
-    for (const auto& shape : shapes)
-    {
-        // For each shape, loop through its indices.
-        for (const auto& index : shape.mesh.indices)
-        {
-            // Construct a new (x, y, z) position for the current mesh index.
-            glm::vec3 position{
-                attributes.vertices[3 * index.vertex_index + 0],
-                attributes.vertices[3 * index.vertex_index + 1],
-                attributes.vertices[3 * index.vertex_index + 2]};
-
-            // Construct a new (u, v) texture coordinate for the current mesh index.
-            glm::vec2 texCoord{
-                attributes.texcoords[2 * index.texcoord_index + 0],
-                1.0f - attributes.texcoords[2 * index.texcoord_index + 1]};
-
-            // Construct a vertex with the extracted data.
-            ast::Vertex vertex{position, texCoord};
-
-            // This will help deduplicate vertices - we maintain a hash map where a
-            // vertex is used as a unique key with its value being which index can
-            // be used to locate the vertex. The vertex is only added if it has not
-            // been added before.
-            if (uniqueVertices.count(vertex) == 0)
+        // Make sure the file was produced by a compatible version of the baker and
+        // that our vertex structure still has the same shape as when it was baked.
+        if (header.magic != meshFileMagic ||
+            header.version != meshFileVersion ||
+            header.vertexSize != sizeof(ast::Vertex))
+        {
+            throw std::runtime_error(logTag + ": Incompatible mesh file " + path);
+        }
+
+        // The lengths are worked out in 64 bits so counts from a corrupt header can't wrap
+        // around on 32 bit targets and slip past the file length check.
+        const uint64_t expectedLength{static_cast<uint64_t>(sizeof(MeshFileHeader)) +
+                                      static_cast<uint64_t>(sizeof(ast::Vertex)) * header.numVertices +
+                                      static_cast<uint64_t>(sizeof(uint32_t)) * header.numIndices +
+                                      static_cast<uint64_t>(sizeof(ast::MeshLevelOfDetail)) * header.numLevels};
+
+        if (static_cast<uint64_t>(file.getSize()) != expectedLength)
+        {
+            throw std::runtime_error(logTag + ": Unexpected file length for " + path);
+        }
+
+        // Every array fits inside the file, so its length now fits in a size_t.
+        const size_t verticesLength{sizeof(ast::Vertex) * header.numVertices};
+        const size_t indicesLength{sizeof(uint32_t) * header.numIndices};
+        const size_t levelsLength{sizeof(ast::MeshLevelOfDetail) * header.numLevels};
+
+        // Size the containers up front then copy the packed arrays straight out of the
+        // file data into them - this is the only copy the mesh data goes through.
+        std::vector<ast::Vertex> vertices(header.numVertices);
+        std::vector<uint32_t> indices(header.numIndices);
+        std::vector<ast::MeshLevelOfDetail> levels(header.numLevels);
+
+        const char* verticesData{file.getData() + sizeof(MeshFileHeader)};
+        std::memcpy(vertices.data(), verticesData, verticesLength);
+        std::memcpy(indices.data(), verticesData + verticesLength, indicesLength);
+        std::memcpy(levels.data(), verticesData + verticesLength + indicesLength, levelsLength);
+
+        for (const auto& level : levels)
+        {
+            if (level.firstIndex > header.numIndices ||
+                level.numIndices > header.numIndices - level.firstIndex)
+            {
+                throw std::runtime_error(logTag + ": Level of detail outside of the indices in " + path);
+            }
+        }
+
+        return ast::Mesh{std::move(vertices), std::move(indices), std::move(levels)};
+    }
+
+    // Baked textures are stored in the standard KTX2 container, which holds a complete chain of
+    // mip levels in one GPU format. We only ever write and read plain 2D textures without any
+    // supercompression, so the level data can be handed straight to the GPU. As with the mesh
+    // files, all the fields are little endian which matches the machines we run on.
+    struct KTX2Header
+    {
+        uint8_t identifier[12];
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+
+    struct KTX2LevelIndex
+    {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    constexpr uint8_t ktx2Identifier[12]{0xab, 0x4b, 0x54, 0x58, 0x20, 0x32, 0x30, 0xbb, 0x0d, 0x0a, 0x1a, 0x0a};
+
+    // The KTX2 container identifies formats by their Vulkan 'VkFormat' values.
+    uint32_t getVkFormat(const ast::TextureFormat& format)
+    {
+        switch (format)
+        {
+            case ast::TextureFormat::RGBA8:
+                return 37; // VK_FORMAT_R8G8B8A8_UNORM
+            case ast::TextureFormat::BC1:
+                return 131; // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+            case ast::TextureFormat::BC3:
+                return 137; // VK_FORMAT_BC3_UNORM_BLOCK
+            case ast::TextureFormat::ETC2RGB8:
+                return 147; // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+            case ast::TextureFormat::ETC2RGBA8:
+                return 151; // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+        }
+    }
+
+    ast::TextureFormat getTextureFormat(const uint32_t& vkFormat, const std::string& path)
+    {
+        for (const auto format : {ast::TextureFormat::RGBA8,
+                                  ast::TextureFormat::BC1,
+                                  ast::TextureFormat::BC3,
+                                  ast::TextureFormat::ETC2RGB8,
+                                  ast::TextureFormat::ETC2RGBA8})
+        {
+            if (::getVkFormat(format) == vkFormat)
+            {
+                return format;
+            }
+        }
+
+        throw std::runtime_error("ast::assets::getTextureFormat: Unsupported format " + std::to_string(vkFormat) + " in " + path);
+    }
+
+    // Every KTX2 file must describe its format with a 'basic data format descriptor' so that
+    // generic tools can interpret it. It is a list of 32 bit words giving the colour model
+    // and block size, followed by one entry for each channel (or compressed block half).
+    std::vector<uint32_t> createDataFormatDescriptor(const ast::TextureFormat& format)
+    {
+        struct Sample
+        {
+            uint32_t bitOffset;
+            uint32_t bitLength;
+            uint32_t channel;
+            uint32_t upper;
+        };
+
+        uint32_t colorModel;
+        uint32_t blockDimensions{0};
+        uint32_t bytesPerBlock;
+        std::vector<Sample> samples;
+
+        switch (format)
+        {
+            case ast::TextureFormat::RGBA8:
+                colorModel = 1; // KHR_DF_MODEL_RGBSDA
+                bytesPerBlock = 4;
+                samples = {{0, 8, 0, 255}, {8, 8, 1, 255}, {16, 8, 2, 255}, {24, 8, 15, 255}};
+                break;
+            case ast::TextureFormat::BC1:
+                colorModel = 128; // KHR_DF_MODEL_BC1A
+                blockDimensions = 0x0303;
+                bytesPerBlock = 8;
+                samples = {{0, 64, 0, 0xffffffff}};
+                break;
+            case ast::TextureFormat::BC3:
+                colorModel = 130; // KHR_DF_MODEL_BC3
+                blockDimensions = 0x0303;
+                bytesPerBlock = 16;
+                samples = {{0, 64, 15, 0xffffffff}, {64, 64, 0, 0xffffffff}};
+                break;
+            case ast::TextureFormat::ETC2RGB8:
+                colorModel = 161; // KHR_DF_MODEL_ETC2
+                blockDimensions = 0x0303;
+                bytesPerBlock = 8;
+                samples = {{0, 64, 2, 0xffffffff}};
+                break;
+            case ast::TextureFormat::ETC2RGBA8:
+                colorModel = 161; // KHR_DF_MODEL_ETC2
+                blockDimensions = 0x0303;
+                bytesPerBlock = 16;
+                samples = {{0, 64, 15, 0xffffffff}, {64, 64, 2, 0xffffffff}};
+                break;
+        }
+
+        const uint32_t blockSize{24 + 16 * static_cast<uint32_t>(samples.size())};
+
+        // BT.709 primaries with a linear transfer function, to match our UNORM formats.
+        std::vector<uint32_t> words{
+            4 + blockSize,                     // Total size
+            0,                                 // Vendor and descriptor type
+            2 | (blockSize << 16),             // Version and block size
+            colorModel | (1 << 8) | (1 << 16), // Model, primaries, transfer and flags
+            blockDimensions,                   // Texel block dimensions
+            bytesPerBlock,                     // Bytes in planes 0 to 3
+            0};                                // Bytes in planes 4 to 7
+
+        for (const auto& sample : samples)
+        {
+            words.push_back(sample.bitOffset | ((sample.bitLength - 1) << 16) | (sample.channel << 24));
+            words.push_back(0);
+            words.push_back(0);
+            words.push_back(sample.upper);
+        }
+
+        return words;
+    }
+
+    size_t alignTo(const size_t& value, const size_t& alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    void checkKTX2Header(const ::KTX2Header& header, const std::string& path)
+    {
+        static const std::string logTag{"ast::assets::checkKTX2Header"};
+
+        // We only support the subset of KTX2 that our own baker writes.
+        if (std::memcmp(header.identifier, ::ktx2Identifier, sizeof(::ktx2Identifier)) != 0 ||
+            header.pixelDepth != 0 ||
+            header.layerCount != 0 ||
+            header.faceCount != 1 ||
+            header.levelCount == 0 ||
+            header.supercompressionScheme != 0)
+        {
+            throw std::runtime_error(logTag + ": Incompatible texture file " + path);
+        }
+    }
+
+    ::KTX2Header readKTX2Header(const ast::AssetFile& file, const std::string& path)
+    {
+        static const std::string logTag{"ast::assets::readKTX2Header"};
+
+        if (file.getSize() < sizeof(KTX2Header))
+        {
+            throw std::runtime_error(logTag + ": Could not read header from " + path);
+        }
+
+        KTX2Header header;
+        std::memcpy(&header, file.getData(), sizeof(KTX2Header));
+        ::checkKTX2Header(header, path);
+
+        return header;
+    }
+
+    // Reads nothing but the header of a texture file, so that candidate files can be ruled out
+    // without loading their levels. Returns false if there is no file at the given path.
+    bool peekKTX2Header(const std::string& path, ::KTX2Header& header)
+    {
+        static const std::string logTag{"ast::assets::peekKTX2Header"};
+
+        SDL_RWops* file{SDL_RWFromFile(path.c_str(), "rb")};
+
+        if (!file)
+        {
+            return false;
+        }
+
+        const bool read{SDL_RWread(file, &header, sizeof(KTX2Header), 1) == 1};
+        SDL_RWclose(file);
+
+        if (!read)
+        {
+            throw std::runtime_error(logTag + ": Could not read header from " + path);
+        }
+
+        ::checkKTX2Header(header, path);
+
+        return true;
+    }
+
+    ast::TextureData loadKTX2File(const ast::AssetFile& file, const ::KTX2Header& header, const std::string& path)
+    {
+        static const std::string logTag{"ast::assets::loadKTX2File"};
+
+        const ast::TextureFormat format{::getTextureFormat(header.vkFormat, path)};
+
+        if (file.getSize() < sizeof(KTX2Header) + sizeof(KTX2LevelIndex) * header.levelCount)
+        {
+            throw std::runtime_error(logTag + ": Could not read level index from " + path);
+        }
+
+        std::vector<KTX2LevelIndex> levelIndex(header.levelCount);
+        std::memcpy(levelIndex.data(), file.getData() + sizeof(KTX2Header), sizeof(KTX2LevelIndex) * header.levelCount);
+
+        std::vector<ast::TextureMipLevel> mipLevels;
+        size_t dataSize{0};
+
+        for (uint32_t level = 0; level < header.levelCount; level++)
+        {
+            const uint32_t width{std::max(header.pixelWidth >> level, static_cast<uint32_t>(1))};
+            const uint32_t height{std::max(header.pixelHeight >> level, static_cast<uint32_t>(1))};
+            const size_t size{ast::textures::getMipLevelSize(format, width, height)};
+
+            if (levelIndex[level].byteLength != size ||
+                levelIndex[level].byteOffset + levelIndex[level].byteLength > file.getSize())
             {
-                uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                vertices.push_back(vertex);
+                throw std::runtime_error(logTag + ": Unexpected level length in " + path);
             }
 
-            indices.push_back(uniqueVertices[vertex]);
+            mipLevels.push_back(ast::TextureMipLevel{width, height, dataSize, size});
+            dataSize += size;
         }
+
+        // The file stores the smallest level first, so gather them back up in level order.
+        std::vector<char> data(dataSize);
+
+        for (uint32_t level = 0; level < header.levelCount; level++)
+        {
+            std::memcpy(data.data() + mipLevels[level].offset,
+                        file.getData() + levelIndex[level].byteOffset,
+                        mipLevels[level].size);
+        }
+
+        return ast::TextureData(format, std::move(mipLevels), std::move(data));
     }
+} // namespace
 
-    return ast::Mesh{vertices, indices};
+ast::Mesh ast::assets::loadOBJFile(const std::string& path)
+{
+    // Map the .obj file and parse its text straight out of memory.
+    const ast::AssetFile file(path);
+
+    return ast::obj::parse(file.getData(), file.getSize());
+}
+
+ast::Mesh ast::assets::loadMeshFile(const std::string& path)
+{
+    return ::loadMeshFile(ast::AssetFile(path), path);
+}
+
+void ast::assets::saveMeshFile(const std::string& path, const ast::Mesh& mesh)
+{
+    SDL_RWops* file{SDL_RWFromFile(path.c_str(), "wb")};
+
+    if (!file)
+    {
+        throw std::runtime_error("ast::assets::saveMeshFile: Could not open " + path);
+    }
+
+    const MeshFileHeader header{
+        ::meshFileMagic,                                 // Magic
+        ::meshFileVersion,                               // Version
+        sizeof(ast::Vertex),                             // Vertex size
+        mesh.getNumVertices(),                           // Vertex count
+        mesh.getNumIndices(),                            // Index count
+        static_cast<uint32_t>(mesh.getLevels().size())}; // Level count
+
+    const std::vector<ast::MeshLevelOfDetail>& levels{mesh.getLevels()};
+
+    const bool written{
+        SDL_RWwrite(file, &header, sizeof(MeshFileHeader), 1) == 1 &&
+        SDL_RWwrite(file, mesh.getVertices().data(), sizeof(ast::Vertex), mesh.getNumVertices()) == mesh.getNumVertices() &&
+        SDL_RWwrite(file, mesh.getIndices().data(), sizeof(uint32_t), mesh.getNumIndices()) == mesh.getNumIndices() &&
+        SDL_RWwrite(file, levels.data(), sizeof(ast::MeshLevelOfDetail), levels.size()) == levels.size()};
+
+    // Closing the file flushes anything still buffered, so it can fail as well.
+    const bool closed{SDL_RWclose(file) == 0};
+
+    // A short write leaves a truncated file behind, which must not be mistaken for a baked mesh.
+    if (!written || !closed)
+    {
+        std::remove(path.c_str());
+        throw std::runtime_error("ast::assets::saveMeshFile: Could not write " + path);
+    }
+}
+
+ast::Mesh ast::assets::loadStaticMesh(const ast::assets::StaticMesh& staticMesh)
+{
+    static const std::string logTag{"ast::assets::loadStaticMesh"};
+
+    // Prefer the baked version of the mesh if it has been produced by the asset baker.
+    const std::string bakedPath{ast::assets::resolveBakedStaticMeshPath(staticMesh)};
+    const std::unique_ptr<ast::AssetFile> bakedFile{ast::AssetFile::openIfExists(bakedPath)};
+
+    if (bakedFile)
+    {
+        return ::loadMeshFile(*bakedFile, bakedPath);
+    }
+
+    // Otherwise we fall back to parsing the original .obj file which is much slower. Building
+    // levels of detail and optimising the triangle order takes far longer again, so that is
+    // left to the baker and the mesh is drawn at full detail in its original order.
+    const std::string objPath{ast::assets::resolveStaticMeshPath(staticMesh)};
+    ast::log(logTag, "Warning: no baked mesh found at " + bakedPath + ", parsing " + objPath +
+                         " without levels of detail. Run the asset baker to produce one.");
+
+    return ast::assets::loadOBJFile(objPath);
 }
 
 ast::Bitmap ast::assets::loadBitmap(const std::string& path)
 {
-    SDL_RWops* file{SDL_RWFromFile(path.c_str(), "rb")};
-    SDL_Surface* source{IMG_Load_RW(file, 1)};
-    SDL_Rect imageFrame{0, 0, source->w, source->h};
-
-    uint32_t redMask;
-    uint32_t greenMask;
-    uint32_t blueMask;
-    uint32_t alphaMask;
-
-#if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
-    redMask = 0xff000000;
-    greenMask = 0x00ff0000;
-    blueMask = 0x0000ff00;
-    alphaMask = 0x000000ff;
-#else
-    redMask = 0x000000ff;
-    greenMask = 0x0000ff00;
-    blueMask = 0x00ff0000;
-    alphaMask = 0xff000000;
-#endif
-
-    SDL_Surface* target{SDL_CreateRGBSurface(
-        0,
-        imageFrame.w, imageFrame.h,
-        32,
-        redMask, greenMask, blueMask, alphaMask)};
-
-    SDL_BlitSurface(source, &imageFrame, target, &imageFrame);
-
-    SDL_FreeSurface(source);
-
-    return ast::Bitmap(target);
+    // Decode the image directly from the bytes of the asset file. The surface is kept in
+    // whatever format the image was stored in - the bitmap converts the pixels to RGBA as
+    // they are copied out, so there is no need for a second surface and a blit here.
+    const ast::AssetFile file(path);
+    SDL_RWops* stream{SDL_RWFromConstMem(file.getData(), static_cast<int>(file.getSize()))};
+    SDL_Surface* source{IMG_Load_RW(stream, 1)};
+
+    if (!source)
+    {
+        throw std::runtime_error("ast::assets::loadBitmap: Could not decode " + path);
+    }
+
+    return ast::Bitmap(source);
+}
+
+ast::TextureData ast::assets::loadKTX2File(const std::string& path)
+{
+    const ast::AssetFile file(path);
+
+    return ::loadKTX2File(file, ::readKTX2Header(file, path), path);
 }
 
-std::vector<char> ast::assets::loadBinaryFile(const std::string& path)
+void ast::assets::saveKTX2File(const std::string& path, const ast::TextureData& textureData)
 {
-    // Open a file operation handle to the asset file.
-    SDL_RWops* file{SDL_RWFromFile(path.c_str(), "rb")};
+    const ast::TextureFormat& format{textureData.getFormat()};
+    const std::vector<ast::TextureMipLevel>& mipLevels{textureData.getMipLevels()};
+    const uint32_t levelCount{static_cast<uint32_t>(mipLevels.size())};
+    const std::vector<uint32_t> dataFormatDescriptor{::createDataFormatDescriptor(format)};
+    const size_t dataFormatDescriptorOffset{sizeof(KTX2Header) + sizeof(KTX2LevelIndex) * levelCount};
+    const size_t dataFormatDescriptorLength{sizeof(uint32_t) * dataFormatDescriptor.size()};
+
+    // Each level must start on a multiple of its block size, and the levels are laid out from
+    // the smallest to the largest so a streaming loader could show the small ones first.
+    const size_t levelAlignment{format == ast::TextureFormat::BC3 || format == ast::TextureFormat::ETC2RGBA8 ? 16u : 8u};
+    std::vector<KTX2LevelIndex> levelIndex(levelCount);
+    size_t fileSize{dataFormatDescriptorOffset + dataFormatDescriptorLength};
+
+    for (uint32_t level = levelCount; level-- > 0;)
+    {
+        fileSize = ::alignTo(fileSize, levelAlignment);
+        levelIndex[level] = KTX2LevelIndex{fileSize, mipLevels[level].size, mipLevels[level].size};
+        fileSize += mipLevels[level].size;
+    }
 
-    // Determine how big the file is.
-    size_t fileLength{static_cast<size_t>(SDL_RWsize(file))};
+    KTX2Header header{
+        {},                                                // Identifier
+        ::getVkFormat(format),                             // Vulkan format
+        1,                                                 // Type size
+        textureData.getWidth(),                            // Pixel width
+        textureData.getHeight(),                           // Pixel height
+        0,                                                 // Pixel depth
+        0,                                                 // Layer count
+        1,                                                 // Face count
+        levelCount,                                        // Level count
+        0,                                                 // Supercompression scheme
+        static_cast<uint32_t>(dataFormatDescriptorOffset), // Data format descriptor offset
+        static_cast<uint32_t>(dataFormatDescriptorLength), // Data format descriptor length
+        0,                                                 // Key value data offset
+        0,                                                 // Key value data length
+        0,                                                 // Supercompression global data offset
+        0};                                                // Supercompression global data length
 
-    // Ask SDL to load the content of the file into a data pointer.
-    char* data{static_cast<char*>(SDL_LoadFile_RW(file, nullptr, 1))};
+    std::memcpy(header.identifier, ::ktx2Identifier, sizeof(::ktx2Identifier));
 
-    // Make a copy of the data as a vector of characters.
-    std::vector<char> result(data, data + fileLength);
+    // Assemble the whole file in memory so it can be written out in one go.
+    std::vector<char> contents(fileSize);
+    std::memcpy(contents.data(), &header, sizeof(KTX2Header));
+    std::memcpy(contents.data() + sizeof(KTX2Header), levelIndex.data(), sizeof(KTX2LevelIndex) * levelCount);
+    std::memcpy(contents.data() + dataFormatDescriptorOffset, dataFormatDescriptor.data(), dataFormatDescriptorLength);
 
-    // Let SDL free the data memory (we took a copy into a vector).
-    SDL_free(data);
+    for (uint32_t level = 0; level < levelCount; level++)
+    {
+        std::memcpy(contents.data() + levelIndex[level].byteOffset,
+                    textureData.getData() + mipLevels[level].offset,
+                    mipLevels[level].size);
+    }
+
+    SDL_RWops* file{SDL_RWFromFile(path.c_str(), "wb")};
+
+    if (!file)
+    {
+        throw std::runtime_error("ast::assets::saveKTX2File: Could not open " + path);
+    }
+
+    const bool written{SDL_RWwrite(file, contents.data(), contents.size(), 1) == 1};
+
+    // Closing the file flushes anything still buffered, so it can fail as well.
+    const bool closed{SDL_RWclose(file) == 0};
 
-    // Hand back the resulting vector which is the content of the file.
-    return result;
+    // A short write leaves a truncated file behind, which must not be mistaken for a baked texture.
+    if (!written || !closed)
+    {
+        std::remove(path.c_str());
+        throw std::runtime_error("ast::assets::saveKTX2File: Could not write " + path);
+    }
 }
+
+ast::TextureData ast::assets::loadTexture(const ast::assets::Texture& texture,
+                                          const std::function<bool(const ast::TextureFormat&)>& isFormatSupported)
+{
+    static const std::string logTag{"ast::assets::loadTexture"};
+
+    // Prefer the first baked version of the texture whose format the renderer can sample.
+    // Only the header of each candidate is read, and just the one that is usable is loaded.
+    for (const auto& bakedPath : ast::assets::resolveBakedTexturePaths(texture))
+    {
+        ::KTX2Header header;
+
+        if (::peekKTX2Header(bakedPath, header) &&
+            isFormatSupported(::getTextureFormat(header.vkFormat, bakedPath)))
+        {
+            return ::loadKTX2File(ast::AssetFile(bakedPath), header, bakedPath);
+        }
+    }
+
+    // Otherwise we fall back to decoding the original image and building its mip chain
+    // ourselves, which is much slower.
+    const std::string sourcePath{ast::assets::resolveTexturePath(texture)};
+    ast::log(logTag, "No usable baked texture found for " + sourcePath + ", decoding it instead");
+
+    return ast::textures::encode(ast::assets::loadBitmap(sourcePath), ast::TextureFormat::RGBA8);
+}
\ No newline at end of file
@@ -1,17 +1,28 @@
 #pragma once
 
+#include "asset-inventory.hpp"
 #include "bitmap.hpp"
 #include "mesh.hpp"
+#include "texture-data.hpp"
+#include <functional>
 #include <string>
-#include <vector>
 
 namespace ast::assets
 {
-    std::string loadTextFile(const std::string& path);
-
     ast::Mesh loadOBJFile(const std::string& path);
 
+    ast::Mesh loadMeshFile(const std::string& path);
+
+    void saveMeshFile(const std::string& path, const ast::Mesh& mesh);
+
+    ast::Mesh loadStaticMesh(const ast::assets::StaticMesh& staticMesh);
+
     ast::Bitmap loadBitmap(const std::string& path);
 
-    std::vector<char> loadBinaryFile(const std::string& path);
+    ast::TextureData loadKTX2File(const std::string& path);
+
+    void saveKTX2File(const std::string& path, const ast::TextureData& textureData);
+
+    ast::TextureData loadTexture(const ast::assets::Texture& texture,
+                                 const std::function<bool(const ast::TextureFormat&)>& isFormatSupported);
 } // namespace ast::assets
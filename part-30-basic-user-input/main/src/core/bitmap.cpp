@@ -1,7 +1,140 @@
 #include "bitmap.hpp"
+#include <cstring>
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#define AST_BITMAP_SSSE3
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AST_BITMAP_NEON
+#include <arm_neon.h>
+#endif
 
 using ast::Bitmap;
 
+namespace
+{
+    void copyRGBA(const uint8_t* source, uint8_t* destination, const int& width)
+    {
+        std::memcpy(destination, source, static_cast<size_t>(width) * 4);
+    }
+
+    void expandRGB(const uint8_t* source, uint8_t* destination, const int& width)
+    {
+        int x{0};
+
+#if defined(AST_BITMAP_SSSE3)
+        // Spread 4 pixels of 3 bytes each into 4 pixels of 4 bytes each with a single
+        // shuffle, then fill in the alpha bytes. Each load reads 16 bytes of which only 12
+        // are used, so we must stop early enough not to read beyond the end of the row.
+        const __m128i shuffle{_mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1)};
+        const __m128i alpha{_mm_set1_epi32(static_cast<int>(0xff000000))};
+
+        for (; x + 6 <= width; x += 4)
+        {
+            const __m128i pixels{_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 3))};
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x * 4),
+                             _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha));
+        }
+#elif defined(AST_BITMAP_NEON)
+        // NEON can load 16 pixels with their channels split into separate registers, then
+        // store them back interleaved with a fourth register of alpha.
+        const uint8x16_t alpha{vdupq_n_u8(255)};
+
+        for (; x + 16 <= width; x += 16)
+        {
+            const uint8x16x3_t pixels{vld3q_u8(source + x * 3)};
+            const uint8x16x4_t expanded{{pixels.val[0], pixels.val[1], pixels.val[2], alpha}};
+            vst4q_u8(destination + x * 4, expanded);
+        }
+#endif
+
+        for (; x < width; x++)
+        {
+            destination[x * 4 + 0] = source[x * 3 + 0];
+            destination[x * 4 + 1] = source[x * 3 + 1];
+            destination[x * 4 + 2] = source[x * 3 + 2];
+            destination[x * 4 + 3] = 255;
+        }
+    }
+
+    void expandPalette(const uint8_t* source, uint8_t* destination, const int& width, const uint32_t (&lookup)[256])
+    {
+        for (int x = 0; x < width; x++)
+        {
+            std::memcpy(destination + x * 4, &lookup[source[x]], 4);
+        }
+    }
+
+    void createPaletteLookup(SDL_Surface* surface, uint32_t (&lookup)[256])
+    {
+        std::memset(lookup, 0, sizeof(lookup));
+
+        const SDL_Palette* palette{surface->format->palette};
+
+        for (int i = 0; i < palette->ncolors && i < 256; i++)
+        {
+            const SDL_Color& color{palette->colors[i]};
+            const uint8_t rgba[4]{color.r, color.g, color.b, color.a};
+            std::memcpy(&lookup[i], rgba, 4);
+        }
+
+        // Transparency in paletted images may be expressed as a colour key instead.
+        uint32_t colorKey;
+
+        if (SDL_GetColorKey(surface, &colorKey) == 0 && colorKey < 256)
+        {
+            reinterpret_cast<uint8_t*>(&lookup[colorKey])[3] = 0;
+        }
+    }
+
+    void copyPixels(SDL_Surface* surface, uint8_t* destination)
+    {
+        const int width{surface->w};
+        const int height{surface->h};
+        const int destinationPitch{width * 4};
+        const uint8_t* source{static_cast<const uint8_t*>(surface->pixels)};
+
+        // Handle the formats that images are most commonly decoded into ourselves, row by
+        // row. Images which are already RGBA are copied as they are.
+        switch (surface->format->format)
+        {
+            case SDL_PIXELFORMAT_RGBA32:
+                for (int y = 0; y < height; y++)
+                {
+                    ::copyRGBA(source + y * surface->pitch, destination + y * destinationPitch, width);
+                }
+                return;
+
+            case SDL_PIXELFORMAT_RGB24:
+                for (int y = 0; y < height; y++)
+                {
+                    ::expandRGB(source + y * surface->pitch, destination + y * destinationPitch, width);
+                }
+                return;
+
+            case SDL_PIXELFORMAT_INDEX8:
+            {
+                uint32_t lookup[256];
+                ::createPaletteLookup(surface, lookup);
+
+                for (int y = 0; y < height; y++)
+                {
+                    ::expandPalette(source + y * surface->pitch, destination + y * destinationPitch, width, lookup);
+                }
+                return;
+            }
+
+            default:
+                break;
+        }
+
+        // Anything else is converted by SDL, still writing directly into the destination.
+        SDL_ConvertPixels(width, height,
+                          surface->format->format, surface->pixels, surface->pitch,
+                          SDL_PIXELFORMAT_RGBA32, destination, destinationPitch);
+    }
+} // namespace
+
 struct Bitmap::Internal
 {
     SDL_Surface* surface;
@@ -26,7 +159,7 @@ uint16_t Bitmap::getHeight() const
     return static_cast<uint16_t>(internal->surface->h);
 }
 
-void* Bitmap::getPixelData() const
+void Bitmap::copyPixelsTo(void* destination) const
 {
-    return internal->surface->pixels;
-}
+    ::copyPixels(internal->surface, static_cast<uint8_t*>(destination));
+}
\ No newline at end of file
@@ -5,6 +5,9 @@
 
 namespace ast
 {
+    // A bitmap owns a decoded image in whatever pixel format it was stored in. Rather than
+    // converting the whole image into a second surface up front, the pixels are converted
+    // only as they are copied out, straight into the memory the caller wants them in.
     struct Bitmap
     {
         Bitmap(SDL_Surface* surface);
@@ -13,7 +16,9 @@ namespace ast
 
         uint16_t getHeight() const;
 
-        void* getPixelData() const;
+        // Writes the pixels into the destination as tightly packed RGBA with 8 bits per
+        // channel, which must have room for width * height * 4 bytes.
+        void copyPixelsTo(void* destination) const;
 
     private:
         struct Internal;
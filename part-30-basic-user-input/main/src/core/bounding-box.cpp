@@ -0,0 +1,50 @@
+#include "bounding-box.hpp"
+#include <algorithm>
+#include <cmath>
+
+ast::BoundingBox ast::createBoundingBox(const std::vector<ast::Vertex>& vertices)
+{
+    if (vertices.empty())
+    {
+        return ast::BoundingBox{glm::vec3{0.0f, 0.0f, 0.0f}, glm::vec3{0.0f, 0.0f, 0.0f}};
+    }
+
+    ast::BoundingBox box{vertices[0].position, vertices[0].position};
+
+    for (const auto& vertex : vertices)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            box.min[i] = std::min(box.min[i], vertex.position[i]);
+            box.max[i] = std::max(box.max[i], vertex.position[i]);
+        }
+    }
+
+    return box;
+}
+
+ast::BoundingBox ast::transformBoundingBox(const ast::BoundingBox& box, const glm::mat4& transform)
+{
+    // Rather than transforming all eight corners, we transform the centre of the box and work
+    // out how far the transformed box can extend along each axis from the absolute values of
+    // the rotation and scale part of the matrix (Arvo's method).
+    const glm::vec3 centre{(box.min + box.max) * 0.5f};
+    const glm::vec3 extent{(box.max - box.min) * 0.5f};
+
+    glm::vec3 transformedCentre;
+    glm::vec3 transformedExtent;
+
+    for (int row = 0; row < 3; row++)
+    {
+        transformedCentre[row] = transform[3][row];
+        transformedExtent[row] = 0.0f;
+
+        for (int column = 0; column < 3; column++)
+        {
+            transformedCentre[row] += transform[column][row] * centre[column];
+            transformedExtent[row] += std::abs(transform[column][row]) * extent[column];
+        }
+    }
+
+    return ast::BoundingBox{transformedCentre - transformedExtent, transformedCentre + transformedExtent};
+}
\ No newline at end of file
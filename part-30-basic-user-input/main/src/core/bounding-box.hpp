@@ -0,0 +1,21 @@
+#pragma once
+
+#include "glm-wrapper.hpp"
+#include "vertex.hpp"
+#include <vector>
+
+namespace ast
+{
+    // An axis aligned box which fully contains a piece of geometry.
+    struct BoundingBox
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    ast::BoundingBox createBoundingBox(const std::vector<ast::Vertex>& vertices);
+
+    // Produces the axis aligned box which fully contains the given box after it has been
+    // transformed, which may be larger than the transformed box itself if it was rotated.
+    ast::BoundingBox transformBoundingBox(const ast::BoundingBox& box, const glm::mat4& transform);
+} // namespace ast
\ No newline at end of file
@@ -7,7 +7,9 @@
 #include "../application/vulkan/vulkan-common.hpp"
 #endif
 
+#include "headless.hpp"
 #include "log.hpp"
+#include "profiler.hpp"
 #include "sdl-wrapper.hpp"
 #include <SDL_image.h>
 #include <stdexcept>
@@ -35,7 +37,17 @@ struct Engine::Internal
         }
         ast::log(logTag, "SDL2_image initialized successfully with PNG support ...");
 
+        if (ast::headless::isEnabled())
+        {
+            ast::log(logTag, "Running headless, frames will be rendered offscreen ...");
+        }
+
+        AST_PROFILE_THREAD("Main");
+
         resolveApplication()->startApplication();
+
+        // Once the application has finished, write out everything the profiler recorded.
+        ast::profiler::writeTrace();
     }
 
     std::unique_ptr<ast::Application> resolveApplication()
@@ -0,0 +1,87 @@
+#include "frustum.hpp"
+#include <array>
+#include <cmath>
+
+using ast::Frustum;
+
+namespace
+{
+    struct Plane
+    {
+        glm::vec3 normal;
+        float distance;
+    };
+
+    glm::vec4 getRow(const glm::mat4& matrix, const int& row)
+    {
+        return glm::vec4{matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row]};
+    }
+
+    ::Plane createPlane(const glm::vec4& coefficients)
+    {
+        const glm::vec3 normal{coefficients.x, coefficients.y, coefficients.z};
+        const float length{std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z)};
+
+        return ::Plane{glm::vec3{normal.x / length, normal.y / length, normal.z / length},
+                       coefficients.w / length};
+    }
+
+    // Extract the frustum planes directly from the combined projection and view matrix, using
+    // the approach described by Gribb and Hartmann. Each plane is a sum or difference of the
+    // last row of the matrix with one of the other rows, and its normal faces into the frustum.
+    std::array<::Plane, 6> createPlanes(const glm::mat4& projectionViewMatrix)
+    {
+        const glm::vec4 row0{::getRow(projectionViewMatrix, 0)};
+        const glm::vec4 row1{::getRow(projectionViewMatrix, 1)};
+        const glm::vec4 row2{::getRow(projectionViewMatrix, 2)};
+        const glm::vec4 row3{::getRow(projectionViewMatrix, 3)};
+
+        return std::array<::Plane, 6>{
+            ::createPlane(row3 + row0),  // Left
+            ::createPlane(row3 - row0),  // Right
+            ::createPlane(row3 + row1),  // Bottom
+            ::createPlane(row3 - row1),  // Top
+            ::createPlane(row3 + row2),  // Near
+            ::createPlane(row3 - row2)}; // Far
+    }
+} // namespace
+
+struct Frustum::Internal
+{
+    const std::array<::Plane, 6> planes;
+
+    Internal(const glm::mat4& projectionViewMatrix)
+        : planes(::createPlanes(projectionViewMatrix)) {}
+
+    bool isVisible(const ast::BoundingBox& box) const
+    {
+        for (const auto& plane : planes)
+        {
+            // Find the corner of the box which lies furthest along the plane normal. If even
+            // that corner is behind the plane, the whole box must be outside the frustum.
+            const glm::vec3 corner{plane.normal.x >= 0.0f ? box.max.x : box.min.x,
+                                   plane.normal.y >= 0.0f ? box.max.y : box.min.y,
+                                   plane.normal.z >= 0.0f ? box.max.z : box.min.z};
+
+            const float distance{plane.normal.x * corner.x +
+                                 plane.normal.y * corner.y +
+                                 plane.normal.z * corner.z +
+                                 plane.distance};
+
+            if (distance < 0.0f)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+Frustum::Frustum(const glm::mat4& projectionViewMatrix)
+    : internal(ast::make_internal_ptr<Internal>(projectionViewMatrix)) {}
+
+bool Frustum::isVisible(const ast::BoundingBox& box) const
+{
+    return internal->isVisible(box);
+}
\ No newline at end of file
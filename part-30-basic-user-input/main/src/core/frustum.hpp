@@ -0,0 +1,20 @@
+#pragma once
+
+#include "bounding-box.hpp"
+#include "glm-wrapper.hpp"
+#include "internal-ptr.hpp"
+
+namespace ast
+{
+    // The viewing volume of a camera, described by the six planes which enclose it.
+    struct Frustum
+    {
+        Frustum(const glm::mat4& projectionViewMatrix);
+
+        bool isVisible(const ast::BoundingBox& box) const;
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "gpu-timings.hpp"
+#include "log.hpp"
+#include <utility>
+#include <vector>
+
+using ast::GpuTimings;
+
+namespace
+{
+    // How many frames to gather GPU timings over before logging them.
+    constexpr uint32_t timingsFrameInterval{600};
+
+    struct ZoneTiming
+    {
+        std::string name;
+        double totalMilliseconds;
+    };
+} // namespace
+
+struct GpuTimings::Internal
+{
+    // Zones are kept in the order they were first seen, which is the order they run on the GPU.
+    std::vector<ZoneTiming> zones;
+    uint32_t frameCount;
+
+    Internal() : frameCount(0) {}
+
+    void add(const std::string& zoneName, const double& milliseconds)
+    {
+        for (auto& zone : zones)
+        {
+            if (zone.name == zoneName)
+            {
+                zone.totalMilliseconds += milliseconds;
+                return;
+            }
+        }
+
+        zones.push_back(ZoneTiming{zoneName, milliseconds});
+    }
+
+    void frameComplete()
+    {
+        static const std::string logTag{"ast::GpuTimings::frameComplete"};
+
+        if (++frameCount < ::timingsFrameInterval)
+        {
+            return;
+        }
+
+        // If the GPU timers aren't supported there will never be anything to report.
+        if (zones.empty())
+        {
+            frameCount = 0;
+            return;
+        }
+
+        std::string message{"GPU time per frame over " + std::to_string(frameCount) + " frames:"};
+
+        for (const auto& zone : zones)
+        {
+            message += " " + zone.name + " " + std::to_string(zone.totalMilliseconds / frameCount) + " ms,";
+        }
+
+        message.pop_back();
+        ast::log(logTag, message);
+
+        zones.clear();
+        frameCount = 0;
+    }
+};
+
+GpuTimings::GpuTimings() : internal(ast::make_internal_ptr<Internal>()) {}
+
+void GpuTimings::add(const std::string& zoneName, const double& milliseconds)
+{
+    internal->add(zoneName, milliseconds);
+}
+
+void GpuTimings::frameComplete()
+{
+    internal->frameComplete();
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "internal-ptr.hpp"
+#include <string>
+
+namespace ast
+{
+    // Gathers how long the GPU spent in each named zone of a frame, as measured by the GPU
+    // timers of the rendering backends, and periodically logs the average time of each zone.
+    struct GpuTimings
+    {
+        GpuTimings();
+
+        void add(const std::string& zoneName, const double& milliseconds);
+
+        void frameComplete();
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "headless.hpp"
+#include "log.hpp"
+#include "sdl-wrapper.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace
+{
+    std::string getVariable(const char* name)
+    {
+        const char* value{SDL_getenv(name)};
+
+        return value ? std::string{value} : std::string{};
+    }
+
+    bool readEnabled()
+    {
+        const std::string value{::getVariable("AST_HEADLESS")};
+
+        return !value.empty() && value != "0";
+    }
+
+    ast::WindowSize readFrameSize()
+    {
+        static const std::string logTag{"ast::headless::readFrameSize"};
+
+        const std::string value{::getVariable("AST_HEADLESS_SIZE")};
+        unsigned int width{0};
+        unsigned int height{0};
+
+        if (!value.empty() && std::sscanf(value.c_str(), "%ux%u", &width, &height) == 2 && width > 0 && height > 0)
+        {
+            return ast::WindowSize{width, height};
+        }
+
+        if (!value.empty())
+        {
+            ast::log(logTag, "Ignoring invalid headless frame size: " + value);
+        }
+
+        // Match the fixed window size used on desktop platforms.
+        return ast::WindowSize{640, 480};
+    }
+
+    uint32_t readFrameLimit()
+    {
+        const std::string value{::getVariable("AST_HEADLESS_FRAMES")};
+
+        return value.empty() ? 0 : static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+    }
+
+    void saveFrame(const std::string& path,
+                   const ast::WindowSize& frameSize,
+                   const uint8_t* pixels,
+                   const bool& isBottomUp)
+    {
+        static const std::string logTag{"ast::headless::saveFrame"};
+
+        SDL_Surface* surface{SDL_CreateRGBSurfaceWithFormat(0,
+                                                            static_cast<int>(frameSize.width),
+                                                            static_cast<int>(frameSize.height),
+                                                            32,
+                                                            SDL_PIXELFORMAT_RGBA32)};
+
+        if (!surface)
+        {
+            ast::log(logTag, "Could not create a surface to capture the frame into.");
+            return;
+        }
+
+        // Frames read back from OpenGL start at the bottom row, so those are flipped on the way
+        // in to make sure every captured bitmap is the right way up.
+        const size_t rowSize{static_cast<size_t>(frameSize.width) * 4};
+
+        for (uint32_t row = 0; row < frameSize.height; row++)
+        {
+            const uint32_t sourceRow{isBottomUp ? frameSize.height - 1 - row : row};
+            uint8_t* destination{static_cast<uint8_t*>(surface->pixels) + row * surface->pitch};
+
+            std::memcpy(destination, pixels + sourceRow * rowSize, rowSize);
+        }
+
+        if (SDL_SaveBMP(surface, path.c_str()) != 0)
+        {
+            ast::log(logTag, "Could not save captured frame to " + path);
+        }
+
+        SDL_FreeSurface(surface);
+    }
+} // namespace
+
+bool ast::headless::isEnabled()
+{
+    static const bool enabled{::readEnabled()};
+
+    return enabled;
+}
+
+ast::WindowSize ast::headless::getFrameSize()
+{
+    static const ast::WindowSize frameSize{::readFrameSize()};
+
+    return frameSize;
+}
+
+uint32_t ast::headless::getFrameLimit()
+{
+    static const uint32_t frameLimit{::readFrameLimit()};
+
+    return frameLimit;
+}
+
+void ast::headless::onFrameReadback(const ast::WindowSize& frameSize,
+                                    const uint8_t* pixels,
+                                    const bool& isBottomUp)
+{
+    static const std::string capturePath{::getVariable("AST_HEADLESS_CAPTURE")};
+
+    if (!capturePath.empty())
+    {
+        ::saveFrame(capturePath, frameSize, pixels, isBottomUp);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "window-size.hpp"
+#include <cstdint>
+
+namespace ast::headless
+{
+    // Headless mode renders into offscreen images instead of a window and never presents them,
+    // so the real render path can run on machines without a display. It is switched on by
+    // setting the 'AST_HEADLESS' environment variable to anything other than '0'.
+    bool isEnabled();
+
+    // The size of the offscreen frames, which can be set as 'WIDTHxHEIGHT' through the
+    // 'AST_HEADLESS_SIZE' environment variable.
+    ast::WindowSize getFrameSize();
+
+    // How many frames to render before the application quits, set through the
+    // 'AST_HEADLESS_FRAMES' environment variable. Zero means run until told to quit.
+    uint32_t getFrameLimit();
+
+    // Receives the RGBA pixels of a frame once they have been read back from the GPU. If the
+    // 'AST_HEADLESS_CAPTURE' environment variable names a file, the frame is saved to it as a
+    // bitmap, so after a run it holds the last frame that was read back.
+    void onFrameReadback(const ast::WindowSize& frameSize,
+                         const uint8_t* pixels,
+                         const bool& isBottomUp);
+} // namespace ast::headless
\ No newline at end of file
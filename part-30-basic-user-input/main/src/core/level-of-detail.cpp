@@ -0,0 +1,86 @@
+#include "level-of-detail.hpp"
+#include <algorithm>
+#include <cmath>
+
+using ast::LevelOfDetailSelector;
+
+namespace
+{
+    // How much the model matrix enlarges the mesh, which is the length of its longest axis.
+    float getMaxScale(const glm::mat4& modelMatrix)
+    {
+        float maxScale{0.0f};
+
+        for (int column = 0; column < 3; column++)
+        {
+            const glm::vec3 axis{modelMatrix[column][0], modelMatrix[column][1], modelMatrix[column][2]};
+            maxScale = std::max(maxScale, glm::length(axis));
+        }
+
+        return maxScale;
+    }
+} // namespace
+
+struct LevelOfDetailSelector::Internal
+{
+    const glm::vec3 cameraPosition;
+    const float pixelsPerUnit;
+
+    Internal(const glm::mat4& projectionMatrix, const glm::vec3& cameraPosition, const float& viewportHeight)
+        : cameraPosition(cameraPosition),
+          pixelsPerUnit(LevelOfDetailSelector::getPixelsPerUnit(projectionMatrix, viewportHeight)) {}
+
+    std::optional<uint32_t> select(const ast::BoundingBox& bounds,
+                                   const glm::mat4& modelMatrix,
+                                   const std::vector<ast::MeshLevelOfDetail>& levels) const
+    {
+        // Treat the instance as the sphere around its bounds, and measure from the nearest
+        // point of that sphere so no part of the instance is drawn with too little detail.
+        const glm::vec3 centre{(bounds.min + bounds.max) * 0.5f};
+        const float radius{glm::length(bounds.max - bounds.min) * 0.5f};
+        const float distance{glm::length(centre - cameraPosition) - radius};
+
+        if (distance <= 0.0f)
+        {
+            return 0;
+        }
+
+        const float scale{pixelsPerUnit / distance};
+
+        if (radius * 2.0f * scale < LevelOfDetailSelector::minScreenSize)
+        {
+            return std::nullopt;
+        }
+
+        // The errors of the levels grow from the first to the last, so look for the coarsest
+        // level which is still accurate enough.
+        const float errorScale{::getMaxScale(modelMatrix) * scale};
+
+        for (size_t i = levels.size(); i > 1; i--)
+        {
+            if (levels[i - 1].error * errorScale <= LevelOfDetailSelector::maxScreenError)
+            {
+                return static_cast<uint32_t>(i - 1);
+            }
+        }
+
+        return 0;
+    }
+};
+
+LevelOfDetailSelector::LevelOfDetailSelector(const glm::mat4& projectionMatrix,
+                                             const glm::vec3& cameraPosition,
+                                             const float& viewportHeight)
+    : internal(ast::make_internal_ptr<Internal>(projectionMatrix, cameraPosition, viewportHeight)) {}
+
+float LevelOfDetailSelector::getPixelsPerUnit(const glm::mat4& projectionMatrix, const float& viewportHeight)
+{
+    return projectionMatrix[1][1] * viewportHeight * 0.5f;
+}
+
+std::optional<uint32_t> LevelOfDetailSelector::select(const ast::BoundingBox& bounds,
+                                                      const glm::mat4& modelMatrix,
+                                                      const std::vector<ast::MeshLevelOfDetail>& levels) const
+{
+    return internal->select(bounds, modelMatrix, levels);
+}
\ No newline at end of file
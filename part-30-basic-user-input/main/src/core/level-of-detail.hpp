@@ -0,0 +1,41 @@
+#pragma once
+
+#include "bounding-box.hpp"
+#include "glm-wrapper.hpp"
+#include "internal-ptr.hpp"
+#include "mesh.hpp"
+#include <optional>
+#include <vector>
+
+namespace ast
+{
+    // Chooses how much detail each mesh instance needs from how large it appears on screen. An
+    // instance is drawn with its coarsest level of detail whose error would cover less than a
+    // pixel, and is not drawn at all if the whole instance would cover only a pixel or two.
+    struct LevelOfDetailSelector
+    {
+        // The largest error, in pixels, that a level of detail may show on screen.
+        static constexpr float maxScreenError{1.0f};
+
+        // Instances whose bounds span fewer pixels than this on screen are not drawn.
+        static constexpr float minScreenSize{2.0f};
+
+        LevelOfDetailSelector(const glm::mat4& projectionMatrix,
+                              const glm::vec3& cameraPosition,
+                              const float& viewportHeight);
+
+        // The number of pixels spanned by one unit of length at a distance of one unit from the
+        // camera, taken from the vertical field of view baked into the projection matrix.
+        static float getPixelsPerUnit(const glm::mat4& projectionMatrix, const float& viewportHeight);
+
+        // Returns the index of the level of detail to draw an instance with, or nothing if the
+        // instance is too small to see. The bounds are those of the instance in world space.
+        std::optional<uint32_t> select(const ast::BoundingBox& bounds,
+                                       const glm::mat4& modelMatrix,
+                                       const std::vector<ast::MeshLevelOfDetail>& levels) const;
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
@@ -0,0 +1,25 @@
+#include "mesh-adjacency.hpp"
+
+using ast::TriangleAdjacency;
+
+TriangleAdjacency::TriangleAdjacency(const std::vector<uint32_t>& indices, const size_t& numVertices)
+    : offsets(numVertices + 1, 0),
+      triangles(indices.size())
+{
+    for (const uint32_t& index : indices)
+    {
+        offsets[index + 1]++;
+    }
+
+    for (size_t i = 0; i < numVertices; i++)
+    {
+        offsets[i + 1] += offsets[i];
+    }
+
+    std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        triangles[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ast
+{
+    // The triangles that use each vertex of an indexed triangle list, stored as one flat list
+    // with an offset per vertex. The triangles of vertex 'v' are those between 'offsets[v]' and
+    // 'offsets[v + 1]'. Shared by the mesh optimizer and simplifier, which both walk from a
+    // vertex to its triangles.
+    struct TriangleAdjacency
+    {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> triangles;
+
+        TriangleAdjacency(const std::vector<uint32_t>& indices, const size_t& numVertices);
+    };
+} // namespace ast
\ No newline at end of file
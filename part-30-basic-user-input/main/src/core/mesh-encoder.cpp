@@ -0,0 +1,336 @@
+#include "mesh-encoder.hpp"
+#include "log.hpp"
+#include "sdl-wrapper.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    // The shape of a vertex in either of the compact layouts. The position has a fourth unused
+    // component because three 16 bit components are not a widely supported vertex format.
+    struct CompactVertex
+    {
+        uint16_t position[4];
+        uint16_t texCoord[2];
+    };
+
+    static_assert(sizeof(::CompactVertex) == 12, "Compact vertices must be tightly packed");
+
+    ast::VertexLayout readPreferredVertexLayout()
+    {
+        static const std::string logTag{"ast::meshes::readPreferredVertexLayout"};
+
+        const char* value{SDL_getenv("AST_VERTEX_LAYOUT")};
+        const std::string name{value ? value : ""};
+
+        if (name == "float32")
+        {
+            return ast::VertexLayout::Float32;
+        }
+
+        if (name == "half")
+        {
+            return ast::VertexLayout::Half;
+        }
+
+        if (!name.empty() && name != "snorm16")
+        {
+            ast::log(logTag, "Ignoring unknown vertex layout: " + name);
+        }
+
+        return ast::VertexLayout::Snorm16;
+    }
+
+    uint16_t toSnorm16(const float& value)
+    {
+        const float clamped{std::min(std::max(value, -1.0f), 1.0f)};
+
+        return static_cast<uint16_t>(static_cast<int16_t>(std::lround(clamped * 32767.0f)));
+    }
+
+    uint16_t toUnorm16(const float& value)
+    {
+        const float clamped{std::min(std::max(value, 0.0f), 1.0f)};
+
+        return static_cast<uint16_t>(std::lround(clamped * 65535.0f));
+    }
+
+    // Convert a float to the bits of a half float, rounding to the nearest even value.
+    uint16_t toHalf(const float& value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        const uint32_t sign{(bits >> 16) & 0x8000};
+        const int32_t exponent{static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15};
+        uint32_t mantissa{bits & 0x7fffff};
+
+        if (exponent >= 31)
+        {
+            return static_cast<uint16_t>(sign | 0x7c00);
+        }
+
+        if (exponent <= 0)
+        {
+            // Too small to be a normal half float, so it becomes a denormal or zero.
+            if (exponent < -10)
+            {
+                return static_cast<uint16_t>(sign);
+            }
+
+            mantissa |= 0x800000;
+
+            const uint32_t shift{static_cast<uint32_t>(14 - exponent)};
+            const uint32_t remainder{mantissa & ((1u << shift) - 1)};
+            const uint32_t halfway{1u << (shift - 1)};
+            uint32_t result{mantissa >> shift};
+
+            if (remainder > halfway || (remainder == halfway && (result & 1)))
+            {
+                result++;
+            }
+
+            return static_cast<uint16_t>(sign | result);
+        }
+
+        // Rounding up may carry into the exponent, which still produces the correct value.
+        const uint32_t remainder{mantissa & 0x1fff};
+        uint32_t result{(static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13)};
+
+        if (remainder > 0x1000 || (remainder == 0x1000 && (result & 1)))
+        {
+            result++;
+        }
+
+        return static_cast<uint16_t>(sign | result);
+    }
+
+    ast::VertexDequantization createIdentityDequantization()
+    {
+        return ast::VertexDequantization{
+            glm::vec4{1.0f, 1.0f, 1.0f, 1.0f},  // Position scale
+            glm::vec4{0.0f, 0.0f, 0.0f, 0.0f},  // Position offset
+            glm::vec4{1.0f, 1.0f, 0.0f, 0.0f}}; // Texture coordinate scale and offset
+    }
+
+    std::vector<char> encodeCompactVertices(const ast::Mesh& mesh,
+                                            const ast::VertexLayout& layout,
+                                            ast::VertexDequantization& dequantization)
+    {
+        const std::vector<ast::Vertex>& vertices{mesh.getVertices()};
+        const ast::BoundingBox& boundingBox{mesh.getBoundingBox()};
+
+        // Positions are stored relative to the centre of the mesh bounds and scaled so the
+        // bounds span -1 to 1 on every axis, which uses the full range of each component.
+        const glm::vec3 centre{(boundingBox.min + boundingBox.max) * 0.5f};
+        const glm::vec3 halfExtent{(boundingBox.max - boundingBox.min) * 0.5f};
+        glm::vec3 positionInverse{0.0f, 0.0f, 0.0f};
+
+        // Texture coordinates are stored relative to the range the mesh uses, so they still fit
+        // even when they repeat a texture by going outside 0 to 1.
+        glm::vec2 texCoordMin{0.0f, 0.0f};
+        glm::vec2 texCoordMax{0.0f, 0.0f};
+        glm::vec2 texCoordInverse{0.0f, 0.0f};
+
+        if (!vertices.empty())
+        {
+            texCoordMin = vertices[0].texCoord;
+            texCoordMax = vertices[0].texCoord;
+        }
+
+        for (const auto& vertex : vertices)
+        {
+            texCoordMin = glm::min(texCoordMin, vertex.texCoord);
+            texCoordMax = glm::max(texCoordMax, vertex.texCoord);
+        }
+
+        const glm::vec2 texCoordRange{texCoordMax - texCoordMin};
+
+        // A mesh which is flat along an axis has every position at the centre on that axis.
+        for (int i = 0; i < 3; i++)
+        {
+            positionInverse[i] = halfExtent[i] > 0.0f ? 1.0f / halfExtent[i] : 0.0f;
+        }
+
+        for (int i = 0; i < 2; i++)
+        {
+            texCoordInverse[i] = texCoordRange[i] > 0.0f ? 1.0f / texCoordRange[i] : 0.0f;
+        }
+
+        std::vector<char> result(vertices.size() * sizeof(::CompactVertex));
+        ::CompactVertex* output{reinterpret_cast<::CompactVertex*>(result.data())};
+
+        for (const auto& vertex : vertices)
+        {
+            const glm::vec3 position{(vertex.position - centre) * positionInverse};
+            const glm::vec2 texCoord{(vertex.texCoord - texCoordMin) * texCoordInverse};
+
+            for (int i = 0; i < 3; i++)
+            {
+                output->position[i] = layout == ast::VertexLayout::Half ? ::toHalf(position[i]) : ::toSnorm16(position[i]);
+            }
+
+            output->position[3] = 0;
+            output->texCoord[0] = ::toUnorm16(texCoord.x);
+            output->texCoord[1] = ::toUnorm16(texCoord.y);
+            output++;
+        }
+
+        dequantization = ast::VertexDequantization{
+            glm::vec4{halfExtent, 1.0f},                                                // Position scale
+            glm::vec4{centre, 0.0f},                                                    // Position offset
+            glm::vec4{texCoordRange.x, texCoordRange.y, texCoordMin.x, texCoordMin.y}}; // Texture coordinate scale and offset
+
+        return result;
+    }
+
+    std::vector<char> encodeIndices(const ast::Mesh& mesh, const ast::IndexFormat& format)
+    {
+        const std::vector<uint32_t>& indices{mesh.getIndices()};
+
+        if (format == ast::IndexFormat::Uint32)
+        {
+            std::vector<char> result(indices.size() * sizeof(uint32_t));
+            std::memcpy(result.data(), indices.data(), result.size());
+
+            return result;
+        }
+
+        std::vector<char> result(indices.size() * sizeof(uint16_t));
+        uint16_t* output{reinterpret_cast<uint16_t*>(result.data())};
+
+        for (const uint32_t& index : indices)
+        {
+            *output++ = static_cast<uint16_t>(index);
+        }
+
+        return result;
+    }
+} // namespace
+
+ast::VertexLayout ast::meshes::getPreferredVertexLayout()
+{
+    static const ast::VertexLayout layout{::readPreferredVertexLayout()};
+
+    return layout;
+}
+
+std::string ast::meshes::getVertexLayoutName(const ast::VertexLayout& layout)
+{
+    switch (layout)
+    {
+        case ast::VertexLayout::Float32:
+            return "Float32";
+        case ast::VertexLayout::Snorm16:
+            return "Snorm16";
+        case ast::VertexLayout::Half:
+            return "Half";
+    }
+
+    return "Unknown";
+}
+
+uint32_t ast::meshes::getVertexSize(const ast::VertexLayout& layout)
+{
+    return layout == ast::VertexLayout::Float32 ? sizeof(ast::Vertex) : sizeof(::CompactVertex);
+}
+
+uint32_t ast::meshes::getPositionOffset(const ast::VertexLayout& layout)
+{
+    return layout == ast::VertexLayout::Float32 ? offsetof(ast::Vertex, position) : offsetof(::CompactVertex, position);
+}
+
+uint32_t ast::meshes::getTexCoordOffset(const ast::VertexLayout& layout)
+{
+    return layout == ast::VertexLayout::Float32 ? offsetof(ast::Vertex, texCoord) : offsetof(::CompactVertex, texCoord);
+}
+
+uint32_t ast::meshes::getIndexSize(const ast::IndexFormat& format)
+{
+    return format == ast::IndexFormat::Uint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+ast::EncodedMesh ast::meshes::encode(const ast::Mesh& mesh, const ast::VertexLayout& layout)
+{
+    ast::VertexDequantization dequantization{::createIdentityDequantization()};
+    std::vector<char> vertices;
+
+    if (layout == ast::VertexLayout::Float32)
+    {
+        vertices.resize(mesh.getVertices().size() * sizeof(ast::Vertex));
+        std::memcpy(vertices.data(), mesh.getVertices().data(), vertices.size());
+    }
+    else
+    {
+        vertices = ::encodeCompactVertices(mesh, layout, dequantization);
+    }
+
+    // Every index of a mesh with fewer than 65536 vertices fits into 16 bits.
+    const ast::IndexFormat indexFormat{mesh.getNumVertices() <= std::numeric_limits<uint16_t>::max()
+                                           ? ast::IndexFormat::Uint16
+                                           : ast::IndexFormat::Uint32};
+
+    return ast::EncodedMesh{layout,
+                            indexFormat,
+                            std::move(vertices),
+                            ::encodeIndices(mesh, indexFormat),
+                            mesh.getNumIndices(),
+                            mesh.getLevels(),
+                            dequantization,
+                            mesh.getBoundingBox()};
+}
+
+ast::GeometryPoolLayout ast::meshes::createGeometryPoolLayout(const std::vector<const ast::EncodedMesh*>& meshes)
+{
+    static const std::string logTag{"ast::meshes::createGeometryPoolLayout"};
+
+    std::vector<ast::GeometryRange> ranges;
+    size_t vertexBufferSize{0};
+    size_t indexBufferSize{0};
+
+    for (const ast::EncodedMesh* mesh : meshes)
+    {
+        if (mesh->vertexLayout != meshes.front()->vertexLayout)
+        {
+            throw std::runtime_error(logTag + ": Meshes in a geometry pool must share a vertex layout.");
+        }
+
+        const size_t vertexSize{ast::meshes::getVertexSize(mesh->vertexLayout)};
+        const size_t indexSize{ast::meshes::getIndexSize(mesh->indexFormat)};
+
+        // The indices of a mesh must start on a multiple of their own size, so a mesh with 32 bit
+        // indices which follows one with an odd number of 16 bit indices skips two bytes.
+        indexBufferSize = (indexBufferSize + indexSize - 1) / indexSize * indexSize;
+
+        ranges.push_back(ast::GeometryRange{
+            static_cast<int32_t>(vertexBufferSize / vertexSize), // Vertex offset
+            static_cast<uint32_t>(indexBufferSize / indexSize),  // First index
+            mesh->numIndices});                                  // Number of indices
+
+        vertexBufferSize += mesh->vertices.size();
+        indexBufferSize += mesh->indices.size();
+    }
+
+    return ast::GeometryPoolLayout{vertexBufferSize, indexBufferSize, std::move(ranges)};
+}
+
+std::string ast::meshes::describeGeometryPoolLayout(const ast::GeometryPoolLayout& layout)
+{
+    return std::to_string(layout.ranges.size()) + " static meshes packed into " +
+           std::to_string(layout.vertexBufferSize) + " bytes of vertices and " +
+           std::to_string(layout.indexBufferSize) + " bytes of indices";
+}
+
+size_t ast::meshes::getVertexByteOffset(const ast::EncodedMesh& mesh, const ast::GeometryRange& range)
+{
+    return static_cast<size_t>(range.vertexOffset) * ast::meshes::getVertexSize(mesh.vertexLayout);
+}
+
+size_t ast::meshes::getIndexByteOffset(const ast::EncodedMesh& mesh, const ast::GeometryRange& range)
+{
+    return static_cast<size_t>(range.firstIndex) * ast::meshes::getIndexSize(mesh.indexFormat);
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "bounding-box.hpp"
+#include "glm-wrapper.hpp"
+#include "mesh.hpp"
+#include <string>
+#include <vector>
+
+namespace ast
+{
+    // How the vertices of a mesh are laid out in the buffers handed to the GPU. 'Float32' is the
+    // full precision 'ast::Vertex' layout. The compact layouts take 12 bytes per vertex instead of
+    // 20, storing each position as four 16 bit components (signed normalised or half float)
+    // relative to the bounds of the mesh, and each texture coordinate as two 16 bit unsigned
+    // normalised components relative to the range of texture coordinates the mesh uses.
+    enum class VertexLayout
+    {
+        Float32,
+        Snorm16,
+        Half
+    };
+
+    enum class IndexFormat
+    {
+        Uint16,
+        Uint32
+    };
+
+    // The per mesh transform that a vertex shader applies to recover the original attributes of
+    // an encoded vertex: position = encoded * positionScale + positionOffset, and texture
+    // coordinate = encoded * texCoordScaleOffset.xy + texCoordScaleOffset.zw. Every member is
+    // a vec4 so the structure can be handed to a shader as it is.
+    struct VertexDequantization
+    {
+        glm::vec4 positionScale;
+        glm::vec4 positionOffset;
+        glm::vec4 texCoordScaleOffset;
+    };
+
+    // The vertices and indices of a mesh encoded for the GPU, ready to be copied into buffers.
+    struct EncodedMesh
+    {
+        ast::VertexLayout vertexLayout;
+        ast::IndexFormat indexFormat;
+        std::vector<char> vertices;
+        std::vector<char> indices;
+        uint32_t numIndices;
+        std::vector<ast::MeshLevelOfDetail> levels;
+        ast::VertexDequantization dequantization;
+        ast::BoundingBox boundingBox;
+    };
+
+    // Where an encoded mesh lives within a pair of vertex and index buffers that it shares with
+    // other meshes. The vertex offset counts whole vertices and is added to every index of the
+    // mesh by the GPU, while the first index counts indices of the mesh's own index format, so
+    // meshes with 16 and 32 bit indices can be packed into the same index buffer.
+    struct GeometryRange
+    {
+        int32_t vertexOffset;
+        uint32_t firstIndex;
+        uint32_t numIndices;
+    };
+
+    // The space needed to pack a set of meshes into one shared vertex buffer and one shared
+    // index buffer, with the range each mesh occupies in them, in the order they were given.
+    struct GeometryPoolLayout
+    {
+        size_t vertexBufferSize;
+        size_t indexBufferSize;
+        std::vector<ast::GeometryRange> ranges;
+    };
+} // namespace ast
+
+namespace ast::meshes
+{
+    // The vertex layout meshes should be encoded into, which is 'Snorm16' unless the
+    // 'AST_VERTEX_LAYOUT' environment variable is set to 'float32', 'snorm16' or 'half'.
+    ast::VertexLayout getPreferredVertexLayout();
+
+    std::string getVertexLayoutName(const ast::VertexLayout& layout);
+
+    uint32_t getVertexSize(const ast::VertexLayout& layout);
+
+    uint32_t getPositionOffset(const ast::VertexLayout& layout);
+
+    uint32_t getTexCoordOffset(const ast::VertexLayout& layout);
+
+    uint32_t getIndexSize(const ast::IndexFormat& format);
+
+    // Encode the vertices of a mesh into the given layout. Meshes with fewer than 65536 vertices
+    // also have their indices narrowed to 16 bits, halving the size of their index buffer.
+    ast::EncodedMesh encode(const ast::Mesh& mesh, const ast::VertexLayout& layout);
+
+    // Lay out a set of meshes one after another in shared buffers, so they can all be drawn
+    // without binding different buffers in between. The meshes must share a vertex layout.
+    ast::GeometryPoolLayout createGeometryPoolLayout(const std::vector<const ast::EncodedMesh*>& meshes);
+
+    // Where the vertices and indices of a mesh start within the shared buffers, in bytes.
+    size_t getVertexByteOffset(const ast::EncodedMesh& mesh, const ast::GeometryRange& range);
+
+    size_t getIndexByteOffset(const ast::EncodedMesh& mesh, const ast::GeometryRange& range);
+
+    std::string describeGeometryPoolLayout(const ast::GeometryPoolLayout& layout);
+} // namespace ast::meshes
\ No newline at end of file
@@ -0,0 +1,396 @@
+#include "mesh-optimizer.hpp"
+#include "glm-wrapper.hpp"
+#include "mesh-adjacency.hpp"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t noVertex{std::numeric_limits<uint32_t>::max()};
+
+    // A FIFO vertex cache simulated with timestamps rather than a queue: a vertex is in the
+    // cache while fewer than 'cacheSize' other vertices have been added since it was.
+    struct VertexCache
+    {
+        const uint32_t cacheSize;
+        std::vector<uint32_t> timestamps;
+        uint32_t time;
+
+        VertexCache(const uint32_t& cacheSize, const uint32_t& numVertices)
+            : cacheSize(cacheSize),
+              timestamps(numVertices, 0),
+              time(cacheSize + 1) {}
+
+        bool contains(const uint32_t& vertex) const
+        {
+            return time - timestamps[vertex] <= cacheSize;
+        }
+
+        // Returns the number of vertices of the triangle which had to be transformed.
+        uint32_t addTriangle(const uint32_t* triangle)
+        {
+            uint32_t misses{0};
+
+            for (int i = 0; i < 3; i++)
+            {
+                if (!contains(triangle[i]))
+                {
+                    timestamps[triangle[i]] = time++;
+                    misses++;
+                }
+            }
+
+            return misses;
+        }
+
+        void flush()
+        {
+            time += cacheSize + 1;
+        }
+    };
+
+    // The result of reordering triangles for the vertex cache, along with the positions in the
+    // new order where the algorithm could not continue from a vertex still in the cache.
+    struct TriangleOrder
+    {
+        std::vector<uint32_t> indices;
+        std::vector<uint32_t> clusters;
+    };
+
+    uint32_t skipDeadEnd(std::vector<uint32_t>& deadEnds,
+                         const std::vector<uint32_t>& liveTriangles,
+                         uint32_t& cursor)
+    {
+        // Prefer a recently used vertex which still has triangles left to emit.
+        while (!deadEnds.empty())
+        {
+            const uint32_t vertex{deadEnds.back()};
+            deadEnds.pop_back();
+
+            if (liveTriangles[vertex] > 0)
+            {
+                return vertex;
+            }
+        }
+
+        // Otherwise move on to the next part of the mesh that has not been visited yet.
+        while (cursor < liveTriangles.size())
+        {
+            if (liveTriangles[cursor] > 0)
+            {
+                return cursor;
+            }
+
+            cursor++;
+        }
+
+        return ::noVertex;
+    }
+
+    ::TriangleOrder optimizeVertexCache(const std::vector<uint32_t>& indices,
+                                        const uint32_t& numVertices,
+                                        const uint32_t& cacheSize)
+    {
+        const uint32_t numTriangles{static_cast<uint32_t>(indices.size() / 3)};
+        const ast::TriangleAdjacency adjacency(indices, numVertices);
+
+        std::vector<uint32_t> liveTriangles(numVertices);
+        std::vector<bool> emitted(numTriangles, false);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        ::VertexCache cache(cacheSize, numVertices);
+
+        for (uint32_t i = 0; i < numVertices; i++)
+        {
+            liveTriangles[i] = adjacency.offsets[i + 1] - adjacency.offsets[i];
+        }
+
+        ::TriangleOrder result;
+        result.indices.reserve(indices.size());
+
+        uint32_t fanningVertex{numVertices > 0 ? 0 : ::noVertex};
+        uint32_t cursor{0};
+
+        while (fanningVertex != ::noVertex)
+        {
+            candidates.clear();
+
+            // Emit every remaining triangle around the current vertex.
+            for (uint32_t i = adjacency.offsets[fanningVertex]; i < adjacency.offsets[fanningVertex + 1]; i++)
+            {
+                const uint32_t triangle{adjacency.triangles[i]};
+
+                if (emitted[triangle])
+                {
+                    continue;
+                }
+
+                const uint32_t* vertices{&indices[triangle * 3]};
+
+                for (int j = 0; j < 3; j++)
+                {
+                    result.indices.push_back(vertices[j]);
+                    deadEnds.push_back(vertices[j]);
+                    candidates.push_back(vertices[j]);
+                    liveTriangles[vertices[j]]--;
+                }
+
+                cache.addTriangle(vertices);
+                emitted[triangle] = true;
+            }
+
+            // Fan around whichever vertex of those triangles will still be in the cache after
+            // emitting all of its own triangles and has been in the cache the longest.
+            uint32_t nextVertex{::noVertex};
+            int64_t bestPriority{-1};
+
+            for (const uint32_t& vertex : candidates)
+            {
+                if (liveTriangles[vertex] == 0)
+                {
+                    continue;
+                }
+
+                const int64_t age{cache.time - cache.timestamps[vertex]};
+                const int64_t priority{age + 2 * liveTriangles[vertex] <= cacheSize ? age : 0};
+
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    nextVertex = vertex;
+                }
+            }
+
+            if (nextVertex == ::noVertex)
+            {
+                nextVertex = ::skipDeadEnd(deadEnds, liveTriangles, cursor);
+
+                const uint32_t numEmitted{static_cast<uint32_t>(result.indices.size() / 3)};
+
+                if (nextVertex != ::noVertex && (result.clusters.empty() || result.clusters.back() != numEmitted))
+                {
+                    result.clusters.push_back(numEmitted);
+                }
+            }
+
+            fanningVertex = nextVertex;
+        }
+
+        // Every cluster list starts at the first triangle, which makes walking them simpler.
+        if (result.clusters.empty() || result.clusters.front() != 0)
+        {
+            result.clusters.insert(result.clusters.begin(), 0);
+        }
+
+        return result;
+    }
+
+    // Split each cluster further wherever the ACMR of the triangles since the last split is
+    // already within the threshold of the ACMR of the whole cluster. Each new cluster starts
+    // with a cold cache, because once they are sorted its neighbours will be different.
+    std::vector<uint32_t> splitClusters(const ::TriangleOrder& order,
+                                        const uint32_t& numVertices,
+                                        const uint32_t& cacheSize,
+                                        const float& threshold)
+    {
+        const uint32_t numTriangles{static_cast<uint32_t>(order.indices.size() / 3)};
+        ::VertexCache cache(cacheSize, numVertices);
+        std::vector<uint32_t> result;
+
+        for (size_t i = 0; i < order.clusters.size(); i++)
+        {
+            const uint32_t start{order.clusters[i]};
+            const uint32_t end{i + 1 < order.clusters.size() ? order.clusters[i + 1] : numTriangles};
+            uint32_t clusterMisses{0};
+
+            cache.flush();
+
+            for (uint32_t triangle = start; triangle < end; triangle++)
+            {
+                clusterMisses += cache.addTriangle(&order.indices[triangle * 3]);
+            }
+
+            const float limit{threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start)};
+            uint32_t splitStart{start};
+            uint32_t splitMisses{0};
+
+            result.push_back(start);
+            cache.flush();
+
+            for (uint32_t triangle = start; triangle < end; triangle++)
+            {
+                splitMisses += cache.addTriangle(&order.indices[triangle * 3]);
+
+                const uint32_t count{triangle + 1 - splitStart};
+
+                if (triangle + 1 < end && static_cast<float>(splitMisses) <= limit * static_cast<float>(count))
+                {
+                    result.push_back(triangle + 1);
+                    splitStart = triangle + 1;
+                    splitMisses = 0;
+                    cache.flush();
+                }
+            }
+        }
+
+        return result;
+    }
+
+    // Sort the clusters so those facing away from the centre of the mesh are drawn first. They
+    // are the most likely to be in front of the rest of the mesh from any viewpoint, so the
+    // triangles behind them will fail the depth test rather than be shaded and overwritten.
+    std::vector<uint32_t> sortClusters(const std::vector<uint32_t>& indices,
+                                       const std::vector<ast::Vertex>& vertices,
+                                       const std::vector<uint32_t>& clusters)
+    {
+        const uint32_t numTriangles{static_cast<uint32_t>(indices.size() / 3)};
+        std::vector<glm::vec3> centroids(clusters.size(), glm::vec3{0.0f, 0.0f, 0.0f});
+        std::vector<glm::vec3> normals(clusters.size(), glm::vec3{0.0f, 0.0f, 0.0f});
+        std::vector<float> areas(clusters.size(), 0.0f);
+        glm::vec3 meshCentroid{0.0f, 0.0f, 0.0f};
+        float meshArea{0.0f};
+
+        // Centroids are weighted by triangle area so densely tessellated regions don't skew them.
+        for (size_t i = 0; i < clusters.size(); i++)
+        {
+            const uint32_t end{i + 1 < clusters.size() ? clusters[i + 1] : numTriangles};
+
+            for (uint32_t triangle = clusters[i]; triangle < end; triangle++)
+            {
+                const glm::vec3& a{vertices[indices[triangle * 3]].position};
+                const glm::vec3& b{vertices[indices[triangle * 3 + 1]].position};
+                const glm::vec3& c{vertices[indices[triangle * 3 + 2]].position};
+
+                const glm::vec3 normal{glm::cross(b - a, c - a)};
+                const float area{glm::length(normal)};
+
+                centroids[i] = centroids[i] + (a + b + c) * (area / 3.0f);
+                normals[i] = normals[i] + normal;
+                areas[i] += area;
+            }
+
+            meshCentroid = meshCentroid + centroids[i];
+            meshArea += areas[i];
+        }
+
+        if (meshArea > 0.0f)
+        {
+            meshCentroid = meshCentroid / meshArea;
+        }
+
+        std::vector<float> sortKeys(clusters.size(), 0.0f);
+
+        for (size_t i = 0; i < clusters.size(); i++)
+        {
+            const float normalLength{glm::length(normals[i])};
+
+            if (areas[i] > 0.0f && normalLength > 0.0f)
+            {
+                sortKeys[i] = glm::dot(centroids[i] / areas[i] - meshCentroid, normals[i] / normalLength);
+            }
+        }
+
+        std::vector<uint32_t> order(clusters.size());
+
+        for (uint32_t i = 0; i < order.size(); i++)
+        {
+            order[i] = i;
+        }
+
+        std::stable_sort(order.begin(), order.end(), [&sortKeys](const uint32_t& a, const uint32_t& b) {
+            return sortKeys[a] > sortKeys[b];
+        });
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+
+        for (const uint32_t& cluster : order)
+        {
+            const uint32_t end{cluster + 1 < clusters.size() ? clusters[cluster + 1] : numTriangles};
+            result.insert(result.end(), indices.begin() + clusters[cluster] * 3, indices.begin() + end * 3);
+        }
+
+        return result;
+    }
+
+    // Renumber the vertices in the order the indices first use them, which also drops any
+    // vertices that no triangle uses. The levels of detail share the vertices, so the order
+    // follows the full detail level and the others fit in wherever they first appear.
+    ast::Mesh optimizeVertexFetch(std::vector<uint32_t>&& indices,
+                                  const std::vector<ast::Vertex>& vertices,
+                                  const std::vector<ast::MeshLevelOfDetail>& levels)
+    {
+        std::vector<uint32_t> remap(vertices.size(), ::noVertex);
+        std::vector<ast::Vertex> remappedVertices;
+        remappedVertices.reserve(vertices.size());
+
+        for (uint32_t& index : indices)
+        {
+            if (remap[index] == ::noVertex)
+            {
+                remap[index] = static_cast<uint32_t>(remappedVertices.size());
+                remappedVertices.push_back(vertices[index]);
+            }
+
+            index = remap[index];
+        }
+
+        return ast::Mesh{std::move(remappedVertices), std::move(indices), std::vector<ast::MeshLevelOfDetail>{levels}};
+    }
+} // namespace
+
+ast::VertexCacheStatistics ast::meshes::analyzeVertexCache(const ast::Mesh& mesh, const uint32_t& cacheSize)
+{
+    const ast::MeshLevelOfDetail& level{mesh.getLevels().front()};
+    const uint32_t* indices{mesh.getIndices().data() + level.firstIndex};
+    const uint32_t numTriangles{level.numIndices / 3};
+    ::VertexCache cache(cacheSize, mesh.getNumVertices());
+    std::vector<bool> used(mesh.getNumVertices(), false);
+    uint32_t numUsed{0};
+    uint32_t misses{0};
+
+    for (uint32_t triangle = 0; triangle < numTriangles; triangle++)
+    {
+        misses += cache.addTriangle(&indices[triangle * 3]);
+    }
+
+    for (uint32_t i = 0; i < level.numIndices; i++)
+    {
+        if (!used[indices[i]])
+        {
+            used[indices[i]] = true;
+            numUsed++;
+        }
+    }
+
+    return ast::VertexCacheStatistics{
+        numTriangles > 0 ? static_cast<float>(misses) / static_cast<float>(numTriangles) : 0.0f, // ACMR
+        numUsed > 0 ? static_cast<float>(misses) / static_cast<float>(numUsed) : 0.0f};          // ATVR
+}
+
+ast::Mesh ast::meshes::optimize(const ast::Mesh& mesh, const float& overdrawThreshold)
+{
+    const std::vector<ast::Vertex>& vertices{mesh.getVertices()};
+    std::vector<uint32_t> indices;
+    indices.reserve(mesh.getNumIndices());
+
+    // Each level of detail is drawn on its own, so each has its triangles reordered separately.
+    for (const ast::MeshLevelOfDetail& level : mesh.getLevels())
+    {
+        const std::vector<uint32_t> levelIndices(mesh.getIndices().begin() + level.firstIndex,
+                                                 mesh.getIndices().begin() + level.firstIndex + level.numIndices);
+
+        ::TriangleOrder order{::optimizeVertexCache(levelIndices, mesh.getNumVertices(), ast::meshes::vertexCacheSize)};
+
+        if (overdrawThreshold >= 1.0f)
+        {
+            const std::vector<uint32_t> clusters{::splitClusters(order, mesh.getNumVertices(), ast::meshes::vertexCacheSize, overdrawThreshold)};
+            order.indices = ::sortClusters(order.indices, vertices, clusters);
+        }
+
+        indices.insert(indices.end(), order.indices.begin(), order.indices.end());
+    }
+
+    return ::optimizeVertexFetch(std::move(indices), vertices, mesh.getLevels());
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "mesh.hpp"
+
+namespace ast
+{
+    // How well the order of a mesh's indices suits a GPU's post transform vertex cache. The
+    // average cache miss ratio (ACMR) is the number of vertices transformed per triangle, which
+    // ranges from 3 down to about 0.5 for a large regular grid. The average transform to vertex
+    // ratio (ATVR) is the number of vertices transformed per vertex in the mesh, where 1 is ideal.
+    struct VertexCacheStatistics
+    {
+        float acmr;
+        float atvr;
+    };
+} // namespace ast
+
+namespace ast::meshes
+{
+    // The number of vertices in the FIFO cache that meshes are optimised for and measured
+    // against. Most GPUs have a larger cache, but an order which suits a small cache also does
+    // well in a larger one, whereas the reverse is not true.
+    constexpr uint32_t vertexCacheSize{16};
+
+    // Trading 5% more vertex shader work for less overdraw is almost always worth it, as
+    // fragment shading costs far more than transforming a vertex.
+    constexpr float defaultOverdrawThreshold{1.05f};
+
+    // Simulate a FIFO vertex cache of the given size over the full detail indices of a mesh.
+    ast::VertexCacheStatistics analyzeVertexCache(const ast::Mesh& mesh, const uint32_t& cacheSize);
+
+    // Reorder the triangles of a mesh so neighbouring triangles share as many vertices as
+    // possible, using the 'Tipsify' algorithm from Sander, Nehab and Barczak's 'Fast Triangle
+    // Reordering for Vertex Locality and Reduced Overdraw'. The triangles are then grouped into
+    // clusters which are sorted so outward facing parts of the mesh tend to be drawn first,
+    // allowing an ACMR up to 'overdrawThreshold' times worse in exchange for less overdraw.
+    // A threshold below 1 skips the overdraw step. Finally the vertices are renumbered in the
+    // order they are first used, so the vertex shader reads through memory front to back. Each
+    // level of detail of the mesh is optimised separately.
+    ast::Mesh optimize(const ast::Mesh& mesh, const float& overdrawThreshold);
+} // namespace ast::meshes
\ No newline at end of file
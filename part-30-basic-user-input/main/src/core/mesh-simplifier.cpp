@@ -0,0 +1,398 @@
+#include "mesh-simplifier.hpp"
+#include "glm-wrapper.hpp"
+#include "mesh-adjacency.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // The most levels of detail a mesh can have, including the full detail one.
+    constexpr uint32_t maxLevels{6};
+
+    // Levels of detail with fewer triangles than this save too little to be worth drawing.
+    constexpr uint32_t minLevelTriangles{16};
+
+    // Each level of detail must remove at least this fraction of the triangles of the last one,
+    // otherwise the simplifier has run out of collapses it is allowed to make.
+    constexpr float minLevelReduction{0.2f};
+
+    // The furthest a level of detail may stray from the full detail mesh, as a fraction of the
+    // size of the mesh. Anything coarser would only ever be drawn at a few pixels across.
+    constexpr float maxRelativeError{0.1f};
+
+    // The sum of the squared distances from a point to a set of planes, stored as the ten unique
+    // coefficients of a symmetric 4x4 matrix. Each plane is weighted by the area of the
+    // triangle it came from, and the total weight is kept so the error can be normalised.
+    struct Quadric
+    {
+        double a2, b2, c2, ab, ac, bc, ad, bd, cd, d2;
+        double weight;
+    };
+
+    struct Collapse
+    {
+        double cost;
+        uint32_t from;
+        uint32_t to;
+    };
+
+    void addQuadric(::Quadric& target, const ::Quadric& source)
+    {
+        target.a2 += source.a2;
+        target.b2 += source.b2;
+        target.c2 += source.c2;
+        target.ab += source.ab;
+        target.ac += source.ac;
+        target.bc += source.bc;
+        target.ad += source.ad;
+        target.bd += source.bd;
+        target.cd += source.cd;
+        target.d2 += source.d2;
+        target.weight += source.weight;
+    }
+
+    ::Quadric createTriangleQuadric(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2)
+    {
+        const glm::vec3 cross{glm::cross(p1 - p0, p2 - p0)};
+        const double length{std::sqrt(static_cast<double>(cross.x) * cross.x +
+                                      static_cast<double>(cross.y) * cross.y +
+                                      static_cast<double>(cross.z) * cross.z)};
+
+        if (length == 0.0)
+        {
+            return ::Quadric{};
+        }
+
+        const double a{cross.x / length};
+        const double b{cross.y / length};
+        const double c{cross.z / length};
+        const double d{-(a * p0.x + b * p0.y + c * p0.z)};
+        const double area{length * 0.5};
+
+        return ::Quadric{
+            area * a * a, area * b * b, area * c * c,
+            area * a * b, area * a * c, area * b * c,
+            area * a * d, area * b * d, area * c * d,
+            area * d * d,
+            area};
+    }
+
+    // The mean squared distance from the point to the planes of the quadric.
+    double evaluateQuadric(const ::Quadric& quadric, const glm::vec3& point)
+    {
+        if (quadric.weight <= 0.0)
+        {
+            return 0.0;
+        }
+
+        const double x{point.x};
+        const double y{point.y};
+        const double z{point.z};
+
+        const double error{quadric.a2 * x * x + quadric.b2 * y * y + quadric.c2 * z * z +
+                           2.0 * (quadric.ab * x * y + quadric.ac * x * z + quadric.bc * y * z) +
+                           2.0 * (quadric.ad * x + quadric.bd * y + quadric.cd * z) +
+                           quadric.d2};
+
+        return std::max(error, 0.0) / quadric.weight;
+    }
+
+    bool isSamePosition(const glm::vec3& a, const glm::vec3& b)
+    {
+        return std::memcmp(&a, &b, sizeof(glm::vec3)) == 0;
+    }
+
+    // Map every vertex onto the first vertex which shares its position. Vertices which share a
+    // position but differ in texture coordinate lie on a texture seam.
+    std::vector<uint32_t> createPositionRemap(const std::vector<ast::Vertex>& vertices)
+    {
+        std::vector<uint32_t> order(vertices.size());
+
+        for (uint32_t i = 0; i < order.size(); i++)
+        {
+            order[i] = i;
+        }
+
+        std::sort(order.begin(), order.end(), [&vertices](const uint32_t& a, const uint32_t& b) {
+            const int comparison{std::memcmp(&vertices[a].position, &vertices[b].position, sizeof(glm::vec3))};
+            return comparison < 0 || (comparison == 0 && a < b);
+        });
+
+        std::vector<uint32_t> remap(vertices.size());
+
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            const bool isFirst{i == 0 || !::isSamePosition(vertices[order[i]].position, vertices[order[i - 1]].position)};
+            remap[order[i]] = isFirst ? order[i] : remap[order[i - 1]];
+        }
+
+        return remap;
+    }
+
+    // A vertex may only move if it is the only vertex at its position and every edge around it
+    // is shared by two triangles, so it is neither on a texture seam nor an open edge.
+    std::vector<bool> createLockedVertices(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& positionRemap)
+    {
+        const size_t numVertices{positionRemap.size()};
+        std::vector<bool> locked(numVertices, false);
+        std::vector<uint32_t> vertexCount(numVertices, 0);
+        std::vector<uint64_t> edges;
+        edges.reserve(indices.size());
+
+        for (size_t i = 0; i < numVertices; i++)
+        {
+            vertexCount[positionRemap[i]]++;
+        }
+
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (size_t j = 0; j < 3; j++)
+            {
+                const uint64_t a{positionRemap[indices[i + j]]};
+                const uint64_t b{positionRemap[indices[i + (j + 1) % 3]]};
+                edges.push_back((a << 32) | b);
+            }
+        }
+
+        std::sort(edges.begin(), edges.end());
+
+        for (const uint64_t& edge : edges)
+        {
+            const uint64_t reverse{(edge << 32) | (edge >> 32)};
+
+            if (!std::binary_search(edges.begin(), edges.end(), reverse))
+            {
+                locked[edge >> 32] = true;
+                locked[edge & 0xffffffff] = true;
+            }
+        }
+
+        for (size_t i = 0; i < numVertices; i++)
+        {
+            locked[i] = locked[positionRemap[i]] || vertexCount[positionRemap[i]] > 1;
+        }
+
+        return locked;
+    }
+
+    // Moving a vertex must not turn any of the triangles around it inside out, or rotate them
+    // so far that the shading of the surface would visibly change.
+    bool isCollapseValid(const std::vector<ast::Vertex>& vertices,
+                         const std::vector<uint32_t>& indices,
+                         const std::vector<uint32_t>& positionRemap,
+                         const ast::TriangleAdjacency& adjacency,
+                         const uint32_t& from,
+                         const uint32_t& to)
+    {
+        const glm::vec3& target{vertices[to].position};
+
+        for (uint32_t i = adjacency.offsets[from]; i < adjacency.offsets[from + 1]; i++)
+        {
+            const uint32_t* triangle{&indices[adjacency.triangles[i] * 3]};
+            glm::vec3 before[3];
+            glm::vec3 after[3];
+            bool collapses{false};
+
+            for (int j = 0; j < 3; j++)
+            {
+                collapses = collapses || positionRemap[triangle[j]] == positionRemap[to];
+                before[j] = vertices[triangle[j]].position;
+                after[j] = triangle[j] == from ? target : before[j];
+            }
+
+            // Triangles along the collapsing edge disappear, so their shape doesn't matter.
+            if (collapses)
+            {
+                continue;
+            }
+
+            const glm::vec3 normalBefore{glm::cross(before[1] - before[0], before[2] - before[0])};
+            const glm::vec3 normalAfter{glm::cross(after[1] - after[0], after[2] - after[0])};
+
+            if (glm::dot(normalBefore, normalAfter) <= 0.25f * glm::length(normalBefore) * glm::length(normalAfter))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+} // namespace
+
+std::vector<uint32_t> ast::meshes::simplify(const std::vector<ast::Vertex>& vertices,
+                                            const std::vector<uint32_t>& indices,
+                                            const uint32_t& targetIndexCount,
+                                            const float& maxError,
+                                            float& resultError)
+{
+    const std::vector<uint32_t> positionRemap{::createPositionRemap(vertices)};
+    const std::vector<bool> locked{::createLockedVertices(indices, positionRemap)};
+    const double maxCost{static_cast<double>(maxError) * maxError};
+
+    // Each position starts with the planes of all the triangles touching it.
+    std::vector<::Quadric> quadrics(vertices.size(), ::Quadric{});
+
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        const ::Quadric quadric{::createTriangleQuadric(vertices[indices[i]].position,
+                                                        vertices[indices[i + 1]].position,
+                                                        vertices[indices[i + 2]].position)};
+
+        for (size_t j = 0; j < 3; j++)
+        {
+            ::addQuadric(quadrics[positionRemap[indices[i + j]]], quadric);
+        }
+    }
+
+    std::vector<uint32_t> result{indices};
+    std::vector<::Collapse> collapses;
+    std::vector<uint32_t> collapseTargets(vertices.size());
+    std::vector<bool> touched(vertices.size());
+    double resultCost{0.0};
+
+    // Collapses are made in passes, cheapest first. Within a pass each collapse freezes the
+    // triangles around it, so every collapse is checked against the mesh it will really change.
+    while (result.size() > targetIndexCount)
+    {
+        const ast::TriangleAdjacency adjacency(result, vertices.size());
+
+        collapses.clear();
+
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (size_t j = 0; j < 3; j++)
+            {
+                const uint32_t a{result[i + j]};
+                const uint32_t b{result[i + (j + 1) % 3]};
+
+                for (const auto& [from, to] : {std::make_pair(a, b), std::make_pair(b, a)})
+                {
+                    if (!locked[from])
+                    {
+                        ::Quadric quadric{quadrics[from]};
+                        ::addQuadric(quadric, quadrics[positionRemap[to]]);
+                        collapses.push_back(::Collapse{::evaluateQuadric(quadric, vertices[to].position), from, to});
+                    }
+                }
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const ::Collapse& a, const ::Collapse& b) {
+            return a.cost < b.cost;
+        });
+
+        for (uint32_t i = 0; i < collapseTargets.size(); i++)
+        {
+            collapseTargets[i] = i;
+        }
+
+        std::fill(touched.begin(), touched.end(), false);
+
+        // Most collapses remove two triangles, so stop once enough have been made to reach the target.
+        const size_t trianglesToRemove{(result.size() - targetIndexCount + 2) / 3};
+        size_t trianglesRemoved{0};
+
+        for (const ::Collapse& collapse : collapses)
+        {
+            if (collapse.cost > maxCost || trianglesRemoved >= trianglesToRemove)
+            {
+                break;
+            }
+
+            if (touched[collapse.from] || touched[collapse.to] ||
+                !::isCollapseValid(vertices, result, positionRemap, adjacency, collapse.from, collapse.to))
+            {
+                continue;
+            }
+
+            collapseTargets[collapse.from] = collapse.to;
+            ::addQuadric(quadrics[positionRemap[collapse.to]], quadrics[collapse.from]);
+            resultCost = std::max(resultCost, collapse.cost);
+
+            for (uint32_t i = adjacency.offsets[collapse.from]; i < adjacency.offsets[collapse.from + 1]; i++)
+            {
+                const uint32_t* triangle{&result[adjacency.triangles[i] * 3]};
+                bool removed{false};
+
+                for (int j = 0; j < 3; j++)
+                {
+                    touched[triangle[j]] = true;
+                    removed = removed || positionRemap[triangle[j]] == positionRemap[collapse.to];
+                }
+
+                trianglesRemoved += removed ? 1 : 0;
+            }
+        }
+
+        if (trianglesRemoved == 0)
+        {
+            break;
+        }
+
+        // Move the collapsed vertices and drop the triangles which no longer have any area.
+        size_t write{0};
+
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            const uint32_t a{collapseTargets[result[i]]};
+            const uint32_t b{collapseTargets[result[i + 1]]};
+            const uint32_t c{collapseTargets[result[i + 2]]};
+
+            if (positionRemap[a] != positionRemap[b] &&
+                positionRemap[b] != positionRemap[c] &&
+                positionRemap[c] != positionRemap[a])
+            {
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+        }
+
+        result.resize(write);
+    }
+
+    resultError = static_cast<float>(std::sqrt(resultCost));
+
+    return result;
+}
+
+ast::Mesh ast::meshes::createLevelsOfDetail(const ast::Mesh& mesh)
+{
+    const std::vector<ast::Vertex>& vertices{mesh.getVertices()};
+    const ast::BoundingBox& boundingBox{mesh.getBoundingBox()};
+    const float maxError{glm::length(boundingBox.max - boundingBox.min) * ::maxRelativeError};
+
+    std::vector<uint32_t> indices{mesh.getIndices()};
+    std::vector<ast::MeshLevelOfDetail> levels{ast::MeshLevelOfDetail{0, mesh.getNumIndices(), 0.0f}};
+
+    while (levels.size() < ::maxLevels)
+    {
+        const ast::MeshLevelOfDetail& previous{levels.back()};
+        const uint32_t targetIndexCount{previous.numIndices / 6 * 3};
+
+        if (targetIndexCount < ::minLevelTriangles * 3)
+        {
+            break;
+        }
+
+        // Every level is simplified from the full detail mesh, so its error is measured against
+        // the real surface rather than accumulating the errors of the levels before it.
+        float error;
+        const std::vector<uint32_t> levelIndices{ast::meshes::simplify(vertices, mesh.getIndices(), targetIndexCount, maxError, error)};
+
+        if (static_cast<float>(levelIndices.size()) > static_cast<float>(previous.numIndices) * (1.0f - ::minLevelReduction))
+        {
+            break;
+        }
+
+        levels.push_back(ast::MeshLevelOfDetail{
+            static_cast<uint32_t>(indices.size()),      // First index
+            static_cast<uint32_t>(levelIndices.size()), // Index count
+            std::max(error, previous.error)});          // Error
+
+        indices.insert(indices.end(), levelIndices.begin(), levelIndices.end());
+    }
+
+    return ast::Mesh{std::vector<ast::Vertex>{vertices}, std::move(indices), std::move(levels)};
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "mesh.hpp"
+#include <vector>
+
+namespace ast::meshes
+{
+    // Simplify a list of triangles by repeatedly collapsing the edge whose removal changes the
+    // surface the least, as measured by the quadric error metric from Garland and Heckbert's
+    // 'Surface Simplification Using Quadric Error Metrics'. Each collapse moves one vertex onto
+    // a neighbour, so the returned triangles only ever use the given vertices. Vertices on the
+    // open edges of the mesh or on texture seams never move, which keeps the outline and the
+    // texture mapping intact. Simplification stops once there are no more than the target
+    // number of indices, or when the next collapse would move the surface further than the
+    // maximum error. The error of the result, in the units of the positions, is written out.
+    std::vector<uint32_t> simplify(const std::vector<ast::Vertex>& vertices,
+                                   const std::vector<uint32_t>& indices,
+                                   const uint32_t& targetIndexCount,
+                                   const float& maxError,
+                                   float& resultError);
+
+    // Build a chain of levels of detail for a mesh, each with about half the triangles of the
+    // one before, appending their indices after those of the full detail mesh.
+    ast::Mesh createLevelsOfDetail(const ast::Mesh& mesh);
+} // namespace ast::meshes
\ No newline at end of file
@@ -2,23 +2,54 @@
 
 using ast::Mesh;
 
+namespace
+{
+    std::vector<ast::MeshLevelOfDetail> createFullLevel(const std::vector<uint32_t>& indices)
+    {
+        return std::vector<ast::MeshLevelOfDetail>{
+            ast::MeshLevelOfDetail{0, static_cast<uint32_t>(indices.size()), 0.0f}};
+    }
+} // namespace
+
 struct Mesh::Internal
 {
     const std::vector<ast::Vertex> vertices;
     const uint32_t numVertices;
     const std::vector<uint32_t> indices;
     const uint32_t numIndices;
+    const std::vector<ast::MeshLevelOfDetail> levels;
+    const ast::BoundingBox boundingBox;
 
     Internal(const std::vector<ast::Vertex>& vertices, const std::vector<uint32_t>& indices)
         : vertices(vertices),
           numVertices(static_cast<uint32_t>(vertices.size())),
           indices(indices),
-          numIndices(static_cast<uint32_t>(indices.size())) {}
+          numIndices(static_cast<uint32_t>(indices.size())),
+          levels(::createFullLevel(indices)),
+          boundingBox(ast::createBoundingBox(vertices)) {}
+
+    Internal(std::vector<ast::Vertex>&& vertices,
+             std::vector<uint32_t>&& indices,
+             std::vector<ast::MeshLevelOfDetail>&& levels)
+        : vertices(std::move(vertices)),
+          numVertices(static_cast<uint32_t>(this->vertices.size())),
+          indices(std::move(indices)),
+          numIndices(static_cast<uint32_t>(this->indices.size())),
+          levels(levels.empty() ? ::createFullLevel(this->indices) : std::move(levels)),
+          boundingBox(ast::createBoundingBox(this->vertices)) {}
 };
 
 Mesh::Mesh(const std::vector<ast::Vertex>& vertices, const std::vector<uint32_t>& indices)
     : internal(ast::make_internal_ptr<Internal>(vertices, indices)) {}
 
+Mesh::Mesh(std::vector<ast::Vertex>&& vertices, std::vector<uint32_t>&& indices)
+    : internal(ast::make_internal_ptr<Internal>(std::move(vertices), std::move(indices), std::vector<ast::MeshLevelOfDetail>{})) {}
+
+Mesh::Mesh(std::vector<ast::Vertex>&& vertices,
+           std::vector<uint32_t>&& indices,
+           std::vector<ast::MeshLevelOfDetail>&& levels)
+    : internal(ast::make_internal_ptr<Internal>(std::move(vertices), std::move(indices), std::move(levels))) {}
+
 const std::vector<ast::Vertex>& Mesh::getVertices() const
 {
     return internal->vertices;
@@ -38,3 +69,13 @@ const uint32_t& Mesh::getNumIndices() const
 {
     return internal->numIndices;
 }
+
+const std::vector<ast::MeshLevelOfDetail>& Mesh::getLevels() const
+{
+    return internal->levels;
+}
+
+const ast::BoundingBox& Mesh::getBoundingBox() const
+{
+    return internal->boundingBox;
+}
@@ -1,15 +1,35 @@
 #pragma once
 
+#include "bounding-box.hpp"
 #include "internal-ptr.hpp"
 #include "vertex.hpp"
 #include <vector>
 
 namespace ast
 {
+    // A simplified version of a mesh, stored as a range of the mesh's indices which reuse its
+    // vertices. The error is how far the simplified surface strays from the full detail one,
+    // measured in the same units as the vertex positions.
+    struct MeshLevelOfDetail
+    {
+        uint32_t firstIndex;
+        uint32_t numIndices;
+        float error;
+    };
+
     struct Mesh
     {
+        // A mesh made this way has a single level of detail covering all of its indices.
         Mesh(const std::vector<ast::Vertex>& vertices, const std::vector<uint32_t>& indices);
 
+        Mesh(std::vector<ast::Vertex>&& vertices, std::vector<uint32_t>&& indices);
+
+        // The levels of detail must be ordered from the most detailed to the least. Passing no
+        // levels is the same as using the constructors above.
+        Mesh(std::vector<ast::Vertex>&& vertices,
+             std::vector<uint32_t>&& indices,
+             std::vector<ast::MeshLevelOfDetail>&& levels);
+
         const std::vector<ast::Vertex>& getVertices() const;
 
         const std::vector<uint32_t>& getIndices() const;
@@ -18,6 +38,10 @@ namespace ast
 
         const uint32_t& getNumIndices() const;
 
+        const std::vector<ast::MeshLevelOfDetail>& getLevels() const;
+
+        const ast::BoundingBox& getBoundingBox() const;
+
     private:
         struct Internal;
         ast::internal_ptr<Internal> internal;
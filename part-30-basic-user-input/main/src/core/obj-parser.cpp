@@ -0,0 +1,508 @@
+#include "obj-parser.hpp"
+#include "profiler.hpp"
+#include "thread-pool.hpp"
+#include "vertex-deduplicator.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    // Chunks smaller than this aren't worth the cost of handing to another thread.
+    constexpr size_t minChunkSize{1024 * 1024};
+
+    // Marks a face corner which has no texture coordinate.
+    constexpr uint32_t missingIndex{std::numeric_limits<uint32_t>::max()};
+
+    constexpr double powersOfTen[]{1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    // One corner of a triangle, holding the zero based indices of its position and texture
+    // coordinate within the complete lists for the whole file.
+    struct Corner
+    {
+        uint32_t position;
+        uint32_t texCoord;
+    };
+
+    // A corner of a polygon as it is being read, before it is split up into triangles.
+    struct PolygonCorner
+    {
+        ::Corner corner;
+        bool relativePosition;
+        bool relativeTexCoord;
+    };
+
+    // A distinct pairing of a position and texture coordinate seen in the faces of the file,
+    // along with the vertex it became. Pairings sharing a position are chained together.
+    struct CornerVertex
+    {
+        uint32_t texCoord;
+        uint32_t vertex;
+        uint32_t next;
+    };
+
+    // Everything found within one line aligned chunk of the file. Faces may refer to attributes
+    // relative to the end of the list so far, which isn't known for a chunk until every chunk
+    // before it has been parsed. Those corners hold an index relative to the start of their own
+    // chunk and are recorded here so they can be fixed up once the chunks are merged.
+    struct Chunk
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec2> texCoords;
+        std::vector<::Corner> corners;
+        std::vector<size_t> relativePositions;
+        std::vector<size_t> relativeTexCoords;
+    };
+
+    bool isSpace(const char& character)
+    {
+        return character == ' ' || character == '\t' || character == '\r';
+    }
+
+    bool isDigit(const char& character)
+    {
+        return character >= '0' && character <= '9';
+    }
+
+    void skipSpaces(const char*& current, const char* end)
+    {
+        while (current < end && ::isSpace(*current))
+        {
+            current++;
+        }
+    }
+
+    bool parseFloatSlow(const char* start, const char*& current, const char* end, float& result)
+    {
+        // The file data isn't null terminated, so the number must be copied out for strtof.
+        char buffer[64];
+        const size_t length{std::min(static_cast<size_t>(end - start), sizeof(buffer) - 1)};
+        std::memcpy(buffer, start, length);
+        buffer[length] = '\0';
+
+        char* parsedEnd;
+        result = std::strtof(buffer, &parsedEnd);
+        current = start + (parsedEnd - buffer);
+
+        return parsedEnd != buffer;
+    }
+
+    bool parseFloat(const char*& current, const char* end, float& result)
+    {
+        ::skipSpaces(current, end);
+
+        const char* start{current};
+        bool negative{false};
+
+        if (current < end && (*current == '-' || *current == '+'))
+        {
+            negative = *current == '-';
+            current++;
+        }
+
+        // Gather up to 19 significant digits, which is more than enough for a float and still
+        // fits in 64 bits, along with the power of ten to scale them by.
+        uint64_t mantissa{0};
+        int significantDigits{0};
+        int exponent{0};
+        bool hasDigits{false};
+
+        for (; current < end && ::isDigit(*current); current++)
+        {
+            hasDigits = true;
+
+            if (significantDigits < 19)
+            {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*current - '0');
+                significantDigits += mantissa > 0 ? 1 : 0;
+            }
+            else
+            {
+                exponent++;
+            }
+        }
+
+        if (current < end && *current == '.')
+        {
+            for (current++; current < end && ::isDigit(*current); current++)
+            {
+                hasDigits = true;
+
+                if (significantDigits < 19)
+                {
+                    mantissa = mantissa * 10 + static_cast<uint64_t>(*current - '0');
+                    significantDigits += mantissa > 0 ? 1 : 0;
+                    exponent--;
+                }
+            }
+        }
+
+        if (!hasDigits)
+        {
+            // Something like 'nan' or 'inf', which is rare enough to leave to the library.
+            return ::parseFloatSlow(start, current, end, result);
+        }
+
+        if (current < end && (*current == 'e' || *current == 'E'))
+        {
+            const char* exponentStart{current};
+            bool negativeExponent{false};
+            current++;
+
+            if (current < end && (*current == '-' || *current == '+'))
+            {
+                negativeExponent = *current == '-';
+                current++;
+            }
+
+            if (current < end && ::isDigit(*current))
+            {
+                int explicitExponent{0};
+
+                for (; current < end && ::isDigit(*current); current++)
+                {
+                    explicitExponent = std::min(explicitExponent * 10 + (*current - '0'), 100000);
+                }
+
+                exponent += negativeExponent ? -explicitExponent : explicitExponent;
+            }
+            else
+            {
+                // A lone 'e' isn't part of the number.
+                current = exponentStart;
+            }
+        }
+
+        // Exponents beyond our table can't be scaled with a single exact power of ten.
+        if (exponent < -22 || exponent > 22)
+        {
+            return ::parseFloatSlow(start, current, end, result);
+        }
+
+        double value{static_cast<double>(mantissa)};
+        value = exponent < 0 ? value / ::powersOfTen[-exponent] : value * ::powersOfTen[exponent];
+        result = static_cast<float>(negative ? -value : value);
+
+        return true;
+    }
+
+    bool parseIndex(const char*& current, const char* end, int64_t& result)
+    {
+        bool negative{false};
+
+        if (current < end && *current == '-')
+        {
+            negative = true;
+            current++;
+        }
+
+        if (current == end || !::isDigit(*current))
+        {
+            return false;
+        }
+
+        int64_t value{0};
+
+        for (; current < end && ::isDigit(*current); current++)
+        {
+            value = std::min<int64_t>(value * 10 + (*current - '0'), std::numeric_limits<uint32_t>::max());
+        }
+
+        result = negative ? -value : value;
+
+        return value != 0;
+    }
+
+    // Convert a one based .obj index into a zero based one. Negative indices count back from
+    // the end of the attributes seen so far, which we can only resolve within this chunk.
+    uint32_t resolveIndex(const int64_t& index, const size_t& chunkCount, bool& relative)
+    {
+        relative = index < 0;
+
+        // Relative indices may refer back into an earlier chunk, which wraps around here and
+        // then back again once the chunk's offset is added, as unsigned arithmetic is modular.
+        return static_cast<uint32_t>(relative ? static_cast<int64_t>(chunkCount) + index : index - 1);
+    }
+
+    void parsePosition(const char* current, const char* end, ::Chunk& chunk)
+    {
+        glm::vec3 position;
+
+        if (!::parseFloat(current, end, position.x) ||
+            !::parseFloat(current, end, position.y) ||
+            !::parseFloat(current, end, position.z))
+        {
+            throw std::runtime_error("ast::obj::parse: Invalid vertex position");
+        }
+
+        chunk.positions.push_back(position);
+    }
+
+    void parseTexCoord(const char* current, const char* end, ::Chunk& chunk)
+    {
+        glm::vec2 texCoord{0.0f, 0.0f};
+
+        if (!::parseFloat(current, end, texCoord.x))
+        {
+            throw std::runtime_error("ast::obj::parse: Invalid texture coordinate");
+        }
+
+        // The second component is optional and defaults to zero.
+        if (!::parseFloat(current, end, texCoord.y))
+        {
+            texCoord.y = 0.0f;
+        }
+
+        chunk.texCoords.push_back(texCoord);
+    }
+
+    void parseFace(const char* current, const char* end, ::Chunk& chunk, std::vector<::PolygonCorner>& polygon)
+    {
+        polygon.clear();
+
+        while (true)
+        {
+            ::skipSpaces(current, end);
+
+            // A face may be followed by a comment on the same line.
+            if (current == end || *current == '#')
+            {
+                break;
+            }
+
+            // Each corner is written as 'p', 'p/t', 'p//n' or 'p/t/n' - we have no use for normals.
+            ::PolygonCorner polygonCorner{::Corner{0, ::missingIndex}, false, false};
+            int64_t index;
+
+            if (!::parseIndex(current, end, index))
+            {
+                throw std::runtime_error("ast::obj::parse: Invalid face");
+            }
+
+            polygonCorner.corner.position = ::resolveIndex(index, chunk.positions.size(), polygonCorner.relativePosition);
+
+            if (current < end && *current == '/')
+            {
+                current++;
+
+                if (current < end && *current != '/')
+                {
+                    if (!::parseIndex(current, end, index))
+                    {
+                        throw std::runtime_error("ast::obj::parse: Invalid face");
+                    }
+
+                    polygonCorner.corner.texCoord = ::resolveIndex(index, chunk.texCoords.size(), polygonCorner.relativeTexCoord);
+                }
+
+                while (current < end && !::isSpace(*current))
+                {
+                    current++;
+                }
+            }
+
+            polygon.push_back(polygonCorner);
+        }
+
+        if (polygon.size() < 3)
+        {
+            throw std::runtime_error("ast::obj::parse: Face has fewer than three corners");
+        }
+
+        // Split the polygon into a fan of triangles around its first corner.
+        for (size_t i = 2; i < polygon.size(); i++)
+        {
+            for (const ::PolygonCorner* polygonCorner : {&polygon[0], &polygon[i - 1], &polygon[i]})
+            {
+                if (polygonCorner->relativePosition)
+                {
+                    chunk.relativePositions.push_back(chunk.corners.size());
+                }
+
+                if (polygonCorner->relativeTexCoord)
+                {
+                    chunk.relativeTexCoords.push_back(chunk.corners.size());
+                }
+
+                chunk.corners.push_back(polygonCorner->corner);
+            }
+        }
+    }
+
+    ::Chunk parseChunk(const char* current, const char* end)
+    {
+        AST_PROFILE_ZONE("obj::parseChunk");
+
+        ::Chunk chunk;
+        std::vector<::PolygonCorner> polygon;
+
+        while (current < end)
+        {
+            const char* lineEnd{static_cast<const char*>(std::memchr(current, '\n', end - current))};
+            lineEnd = lineEnd ? lineEnd : end;
+
+            ::skipSpaces(current, lineEnd);
+
+            // Only the lines that make up the geometry matter to us, anything else including
+            // comments, groups and materials is skipped over.
+            if (lineEnd - current > 2 && current[0] == 'v' && current[1] == 't' && ::isSpace(current[2]))
+            {
+                ::parseTexCoord(current + 2, lineEnd, chunk);
+            }
+            else if (lineEnd - current > 1 && current[0] == 'v' && ::isSpace(current[1]))
+            {
+                ::parsePosition(current + 1, lineEnd, chunk);
+            }
+            else if (lineEnd - current > 1 && current[0] == 'f' && ::isSpace(current[1]))
+            {
+                ::parseFace(current + 1, lineEnd, chunk, polygon);
+            }
+
+            current = lineEnd + 1;
+        }
+
+        return chunk;
+    }
+
+    std::vector<::Chunk> parseChunks(const char* data, const size_t& size)
+    {
+        const size_t maxChunks{size / ::minChunkSize};
+
+        // Small files are parsed on the calling thread, as starting up workers would cost more
+        // than it saves. Otherwise we use a pool of our own rather than a shared one - this is
+        // usually called from a job on a shared pool, and waiting on other jobs there from
+        // inside one of its own workers could deadlock.
+        if (maxChunks < 2)
+        {
+            return std::vector<::Chunk>{::parseChunk(data, data + size)};
+        }
+
+        ast::ThreadPool workerPool;
+        const size_t numChunks{std::min(maxChunks, workerPool.getNumThreads())};
+
+        if (numChunks < 2)
+        {
+            return std::vector<::Chunk>{::parseChunk(data, data + size)};
+        }
+
+        // Split the file into roughly equal chunks, moving each split forward to the start of
+        // the next line so no line is ever divided between two chunks.
+        const char* end{data + size};
+        const char* chunkStart{data};
+        std::vector<std::future<::Chunk>> jobs;
+
+        for (size_t i = 1; i <= numChunks && chunkStart < end; i++)
+        {
+            const char* chunkEnd{std::max(chunkStart, data + size * i / numChunks)};
+
+            if (i == numChunks)
+            {
+                chunkEnd = end;
+            }
+            else if (chunkEnd < end)
+            {
+                const char* newline{static_cast<const char*>(std::memchr(chunkEnd, '\n', end - chunkEnd))};
+                chunkEnd = newline ? newline + 1 : end;
+            }
+
+            jobs.push_back(workerPool.submit([chunkStart, chunkEnd]() { return ::parseChunk(chunkStart, chunkEnd); }));
+            chunkStart = chunkEnd;
+        }
+
+        std::vector<::Chunk> chunks;
+        chunks.reserve(jobs.size());
+
+        for (auto& job : jobs)
+        {
+            chunks.push_back(job.get());
+        }
+
+        return chunks;
+    }
+} // namespace
+
+ast::Mesh ast::obj::parse(const char* data, const size_t& size)
+{
+    AST_PROFILE_ZONE("obj::parse");
+
+    std::vector<::Chunk> chunks{::parseChunks(data, size)};
+
+    // Merge the attributes of every chunk, fixing up the corners that were relative to the
+    // start of their own chunk now that we know where each chunk begins.
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texCoords;
+    size_t numCorners{0};
+
+    for (auto& chunk : chunks)
+    {
+        for (const size_t& corner : chunk.relativePositions)
+        {
+            chunk.corners[corner].position += static_cast<uint32_t>(positions.size());
+        }
+
+        for (const size_t& corner : chunk.relativeTexCoords)
+        {
+            chunk.corners[corner].texCoord += static_cast<uint32_t>(texCoords.size());
+        }
+
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+        numCorners += chunk.corners.size();
+    }
+
+    std::vector<ast::Vertex> vertices;
+    std::vector<uint32_t> indices;
+    indices.reserve(numCorners);
+
+    // Most vertices in a typical mesh are shared by several faces, so the number of distinct
+    // vertices is usually close to the number of distinct positions or texture coordinates.
+    const size_t expectedVertices{std::max(positions.size(), texCoords.size())};
+    ast::VertexDeduplicator uniqueVertices(vertices, expectedVertices);
+
+    // Every face that shares a corner refers to it by the same pair of indices, so we remember
+    // the vertex made from each pair and only deduplicate the vertex itself the first time a
+    // pair is seen. Looking pairs up by position keeps these accesses in the same order as the
+    // file, which is far kinder to the cache than hashing every single corner.
+    std::vector<uint32_t> firstCornerVertex(positions.size(), ::missingIndex);
+    std::vector<::CornerVertex> cornerVertices;
+    cornerVertices.reserve(expectedVertices);
+
+    for (const auto& chunk : chunks)
+    {
+        for (const auto& corner : chunk.corners)
+        {
+            if (corner.position >= positions.size() ||
+                (corner.texCoord != ::missingIndex && corner.texCoord >= texCoords.size()))
+            {
+                throw std::runtime_error("ast::obj::parse: Face refers to a missing vertex attribute");
+            }
+
+            uint32_t cornerVertex{firstCornerVertex[corner.position]};
+
+            while (cornerVertex != ::missingIndex && cornerVertices[cornerVertex].texCoord != corner.texCoord)
+            {
+                cornerVertex = cornerVertices[cornerVertex].next;
+            }
+
+            if (cornerVertex == ::missingIndex)
+            {
+                // Texture coordinates are flipped vertically to match the orientation of our images.
+                const glm::vec2 texCoord{corner.texCoord == ::missingIndex ? glm::vec2{0.0f, 0.0f} : texCoords[corner.texCoord]};
+                const ast::Vertex vertex{positions[corner.position], glm::vec2{texCoord.x, 1.0f - texCoord.y}};
+
+                cornerVertex = static_cast<uint32_t>(cornerVertices.size());
+                cornerVertices.push_back(::CornerVertex{corner.texCoord, uniqueVertices.add(vertex), firstCornerVertex[corner.position]});
+                firstCornerVertex[corner.position] = cornerVertex;
+            }
+
+            indices.push_back(cornerVertices[cornerVertex].vertex);
+        }
+    }
+
+    return ast::Mesh{std::move(vertices), std::move(indices)};
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "mesh.hpp"
+#include <cstddef>
+
+namespace ast::obj
+{
+    // Parse the text of a Wavefront .obj file straight out of memory into a mesh, keeping only
+    // the positions and texture coordinates and triangulating any larger polygons. Large files
+    // are split into line aligned chunks which are parsed in parallel on worker threads, then
+    // merged before the vertices are deduplicated.
+    ast::Mesh parse(const char* data, const size_t& size);
+} // namespace ast::obj
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "profiler.hpp"
+#include "log.hpp"
+#include "sdl-wrapper.hpp"
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using ast::profiler::Zone;
+
+namespace
+{
+    struct ZoneRecord
+    {
+        const char* name;
+        int64_t start;
+        int64_t duration;
+    };
+
+    // Every thread records into its own buffer so zones on different threads never contend
+    // with each other. The buffer's mutex is only ever contended while the trace is written.
+    struct ThreadBuffer
+    {
+        std::mutex mutex;
+        std::vector<ZoneRecord> zones;
+        uint32_t threadId{0};
+        std::string threadName;
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        uint32_t nextThreadId{1};
+    };
+
+    Registry& getRegistry()
+    {
+        static Registry registry;
+
+        return registry;
+    }
+
+    std::string getTracePath()
+    {
+        const char* value{SDL_getenv("AST_PROFILE")};
+
+        return value ? std::string{value} : std::string{};
+    }
+
+    const std::string& getTracePathOnce()
+    {
+        static const std::string tracePath{::getTracePath()};
+
+        return tracePath;
+    }
+
+    int64_t getNanoseconds()
+    {
+        // All zones are timed relative to the first time the profiler is used, so the trace
+        // starts at zero.
+        static const std::chrono::steady_clock::time_point epoch{std::chrono::steady_clock::now()};
+
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    ThreadBuffer& getThreadBuffer()
+    {
+        // The registry shares ownership of each buffer so the zones of a thread which has since
+        // exited are still written into the trace.
+        thread_local std::shared_ptr<ThreadBuffer> threadBuffer;
+
+        if (!threadBuffer)
+        {
+            threadBuffer = std::make_shared<ThreadBuffer>();
+
+            Registry& registry{::getRegistry()};
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            threadBuffer->threadId = registry.nextThreadId++;
+            registry.buffers.push_back(threadBuffer);
+        }
+
+        return *threadBuffer;
+    }
+
+    void record(const char* name, const int64_t& start, const int64_t& end)
+    {
+        ThreadBuffer& buffer{::getThreadBuffer()};
+
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.zones.push_back(ZoneRecord{name, start, end - start});
+    }
+
+    void writeMicroseconds(std::ofstream& output, const int64_t& nanoseconds)
+    {
+        // Chrome traces are measured in microseconds but allow fractions of them.
+        output << nanoseconds / 1000 << '.' << std::to_string(1000 + nanoseconds % 1000).substr(1);
+    }
+} // namespace
+
+Zone::Zone(const char* name)
+    : name(name),
+      start(ast::profiler::isRecording() ? ::getNanoseconds() : -1) {}
+
+Zone::~Zone()
+{
+    if (start >= 0)
+    {
+        ::record(name, start, ::getNanoseconds());
+    }
+}
+
+bool ast::profiler::isRecording()
+{
+    static const bool recording{!::getTracePathOnce().empty()};
+
+    return recording;
+}
+
+void ast::profiler::setThreadName(const std::string& name)
+{
+    if (!ast::profiler::isRecording())
+    {
+        return;
+    }
+
+    ThreadBuffer& buffer{::getThreadBuffer()};
+
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.threadName = name;
+}
+
+void ast::profiler::writeTrace()
+{
+    static const std::string logTag{"ast::profiler::writeTrace"};
+
+    if (!ast::profiler::isRecording())
+    {
+        return;
+    }
+
+    const std::string& tracePath{::getTracePathOnce()};
+    std::ofstream output(tracePath, std::ios::out | std::ios::trunc);
+
+    if (!output)
+    {
+        ast::log(logTag, "Could not open " + tracePath + " to write the trace into.");
+        return;
+    }
+
+    Registry& registry{::getRegistry()};
+    std::lock_guard<std::mutex> registryLock(registry.mutex);
+
+    size_t zoneCount{0};
+    bool isFirstEvent{true};
+
+    output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for (const auto& buffer : registry.buffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+
+        if (!buffer->threadName.empty())
+        {
+            output << (isFirstEvent ? "\n" : ",\n")
+                   << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+                   << ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+
+            isFirstEvent = false;
+        }
+
+        for (const auto& zone : buffer->zones)
+        {
+            output << (isFirstEvent ? "\n" : ",\n")
+                   << "{\"name\":\"" << zone.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":";
+            ::writeMicroseconds(output, zone.start);
+            output << ",\"dur\":";
+            ::writeMicroseconds(output, zone.duration);
+            output << "}";
+
+            isFirstEvent = false;
+        }
+
+        zoneCount += buffer->zones.size();
+    }
+
+    output << "\n]}\n";
+
+    ast::log(logTag, "Wrote " + std::to_string(zoneCount) + " profiler zones to " + tracePath);
+}
\ No newline at end of file
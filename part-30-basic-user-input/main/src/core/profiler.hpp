@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Profiling zones are compiled in unless 'AST_PROFILER_DISABLED' is defined, in which case every
+// zone macro expands to nothing and the profiler costs nothing at all. When compiled in, zones
+// are only recorded if the 'AST_PROFILE' environment variable names a file to write the trace
+// to, otherwise each zone costs a single check of whether the profiler is recording.
+#ifdef AST_PROFILER_DISABLED
+#define AST_PROFILE_ZONE(name)
+#define AST_PROFILE_THREAD(name)
+#else
+#define AST_PROFILE_CONCAT_INNER(a, b) a##b
+#define AST_PROFILE_CONCAT(a, b) AST_PROFILE_CONCAT_INNER(a, b)
+#define AST_PROFILE_ZONE(name) const ast::profiler::Zone AST_PROFILE_CONCAT(profilerZone, __LINE__)(name)
+#define AST_PROFILE_THREAD(name) ast::profiler::setThreadName(name)
+#endif
+
+namespace ast::profiler
+{
+    // Measures the time from its construction until it goes out of scope. It deliberately holds
+    // its state inline rather than behind an internal pointer, so a zone never allocates. The
+    // name must be a string literal, as only the pointer to it is kept.
+    struct Zone
+    {
+        Zone(const char* name);
+
+        ~Zone();
+
+    private:
+        const char* const name;
+        const int64_t start;
+    };
+
+    bool isRecording();
+
+    // Names the calling thread in the trace.
+    void setThreadName(const std::string& name);
+
+    // Writes every zone recorded so far by all threads as a Chrome trace JSON file, which can
+    // be opened with chrome://tracing or the Perfetto UI.
+    void writeTrace();
+} // namespace ast::profiler
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "render-queue.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <optional>
+#include <string>
+
+using ast::RenderQueue;
+
+namespace
+{
+    struct SortItem
+    {
+        uint64_t key;
+        const glm::mat4* transform;
+    };
+
+    // Pack the state an instance needs into a single integer, with the most expensive state to
+    // change in the highest bits so that sorting by the key minimises the number of changes.
+    uint64_t createSortKey(const ast::assets::Pipeline& pipeline,
+                           const ast::assets::Texture& texture,
+                           const ast::assets::StaticMesh& mesh,
+                           const uint32_t& level)
+    {
+        return (static_cast<uint64_t>(pipeline) << 48) |
+               (static_cast<uint64_t>(texture) << 32) |
+               (static_cast<uint64_t>(mesh) << 16) |
+               static_cast<uint64_t>(level & 0xffff);
+    }
+
+    bool isSameStatistics(const ast::RenderQueueStatistics& a, const ast::RenderQueueStatistics& b)
+    {
+        return a.instanceCount == b.instanceCount &&
+               a.batchCount == b.batchCount &&
+               a.bindsIssued == b.bindsIssued &&
+               a.bindsSkipped == b.bindsSkipped;
+    }
+
+    template <typename T>
+    bool bindState(std::optional<T>& current, const T& desired, ast::RenderQueueStatistics& statistics)
+    {
+        if (current == desired)
+        {
+            statistics.bindsSkipped++;
+            return false;
+        }
+
+        current = desired;
+        statistics.bindsIssued++;
+        return true;
+    }
+} // namespace
+
+struct RenderQueue::Internal
+{
+    std::vector<::SortItem> items;
+    std::vector<ast::RenderBatch> batches;
+    std::vector<glm::mat4> transforms;
+    std::optional<ast::assets::Pipeline> currentPipeline;
+    std::optional<ast::assets::Texture> currentTexture;
+    std::optional<ast::assets::StaticMesh> currentMesh;
+    ast::RenderQueueStatistics statistics{};
+    ast::RenderQueueStatistics previousStatistics{};
+
+    Internal() {}
+
+    void add(const ast::assets::Pipeline& pipeline,
+             const ast::StaticMeshInstanceStore& staticMeshInstances,
+             const std::vector<uint32_t>& instanceIndices,
+             const std::vector<uint32_t>& instanceLevels)
+    {
+        const std::vector<ast::assets::StaticMesh>& meshes{staticMeshInstances.getMeshes()};
+        const std::vector<ast::assets::Texture>& textures{staticMeshInstances.getTextures()};
+        const ast::TransformBatch& instanceTransforms{staticMeshInstances.getTransforms()};
+
+        for (size_t i = 0; i < instanceIndices.size(); i++)
+        {
+            const uint32_t index{instanceIndices[i]};
+
+            items.push_back(::SortItem{
+                ::createSortKey(pipeline, textures[index], meshes[index], instanceLevels[i]),
+                &instanceTransforms.getTransformMatrix(index)});
+        }
+    }
+
+    void sort()
+    {
+        std::sort(items.begin(), items.end(), [](const ::SortItem& a, const ::SortItem& b) {
+            return a.key < b.key;
+        });
+
+        batches.clear();
+        transforms.clear();
+        transforms.reserve(items.size());
+
+        // Walk the sorted items, starting a new batch whenever the sort key changes.
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            const ::SortItem& item{items[i]};
+
+            if (i == 0 || item.key != items[i - 1].key)
+            {
+                batches.push_back(ast::RenderBatch{
+                    static_cast<ast::assets::Pipeline>(item.key >> 48),
+                    static_cast<ast::assets::StaticMesh>((item.key >> 16) & 0xffff),
+                    static_cast<uint32_t>(item.key & 0xffff),
+                    static_cast<ast::assets::Texture>((item.key >> 32) & 0xffff),
+                    static_cast<uint32_t>(i),
+                    0});
+            }
+
+            // Gather the transforms into sorted order so they can be uploaded in one go.
+            batches.back().instanceCount++;
+            transforms.push_back(*item.transform);
+        }
+
+        statistics.instanceCount = static_cast<uint32_t>(transforms.size());
+        statistics.batchCount = static_cast<uint32_t>(batches.size());
+    }
+
+    bool bindPipeline(const ast::assets::Pipeline& pipeline)
+    {
+        if (!::bindState(currentPipeline, pipeline, statistics))
+        {
+            return false;
+        }
+
+        // A new pipeline may interpret bound textures and buffers differently, so they
+        // will need to be bound again.
+        currentTexture.reset();
+        currentMesh.reset();
+
+        return true;
+    }
+
+    bool bindTexture(const ast::assets::Texture& texture)
+    {
+        return ::bindState(currentTexture, texture, statistics);
+    }
+
+    bool bindMesh(const ast::assets::StaticMesh& mesh)
+    {
+        return ::bindState(currentMesh, mesh, statistics);
+    }
+
+    void reset()
+    {
+        static const std::string logTag{"ast::RenderQueue::reset"};
+
+        // Only report the frame statistics when they change, otherwise we would log every frame.
+        if (!::isSameStatistics(statistics, previousStatistics))
+        {
+            ast::log(logTag, "Instances: " + std::to_string(statistics.instanceCount) +
+                                 ", batches: " + std::to_string(statistics.batchCount) +
+                                 ", binds issued: " + std::to_string(statistics.bindsIssued) +
+                                 ", binds skipped: " + std::to_string(statistics.bindsSkipped));
+        }
+
+        previousStatistics = statistics;
+        statistics = ast::RenderQueueStatistics{};
+
+        items.clear();
+        batches.clear();
+        transforms.clear();
+        currentPipeline.reset();
+        currentTexture.reset();
+        currentMesh.reset();
+    }
+};
+
+RenderQueue::RenderQueue() : internal(ast::make_internal_ptr<Internal>()) {}
+
+void RenderQueue::add(const ast::assets::Pipeline& pipeline,
+                      const ast::StaticMeshInstanceStore& staticMeshInstances,
+                      const std::vector<uint32_t>& instanceIndices,
+                      const std::vector<uint32_t>& instanceLevels)
+{
+    internal->add(pipeline, staticMeshInstances, instanceIndices, instanceLevels);
+}
+
+void RenderQueue::sort()
+{
+    internal->sort();
+}
+
+const std::vector<ast::RenderBatch>& RenderQueue::getBatches() const
+{
+    return internal->batches;
+}
+
+const std::vector<glm::mat4>& RenderQueue::getTransforms() const
+{
+    return internal->transforms;
+}
+
+bool RenderQueue::bindPipeline(const ast::assets::Pipeline& pipeline)
+{
+    return internal->bindPipeline(pipeline);
+}
+
+bool RenderQueue::bindTexture(const ast::assets::Texture& texture)
+{
+    return internal->bindTexture(texture);
+}
+
+bool RenderQueue::bindMesh(const ast::assets::StaticMesh& mesh)
+{
+    return internal->bindMesh(mesh);
+}
+
+const ast::RenderQueueStatistics& RenderQueue::getStatistics() const
+{
+    return internal->statistics;
+}
+
+void RenderQueue::reset()
+{
+    internal->reset();
+}
\ No newline at end of file
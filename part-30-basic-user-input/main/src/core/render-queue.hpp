@@ -0,0 +1,71 @@
+#pragma once
+
+#include "asset-inventory.hpp"
+#include "internal-ptr.hpp"
+#include "glm-wrapper.hpp"
+#include "static-mesh-instance-store.hpp"
+#include <vector>
+
+namespace ast
+{
+    // A run of sorted instances which all share the same pipeline, mesh, level of detail and
+    // texture, and can therefore be drawn without changing any state between them.
+    struct RenderBatch
+    {
+        ast::assets::Pipeline pipeline;
+        ast::assets::StaticMesh mesh;
+        uint32_t level;
+        ast::assets::Texture texture;
+        uint32_t firstInstance;
+        uint32_t instanceCount;
+    };
+
+    struct RenderQueueStatistics
+    {
+        uint32_t instanceCount;
+        uint32_t batchCount;
+        uint32_t bindsIssued;
+        uint32_t bindsSkipped;
+    };
+
+    // The render queue collects the mesh instances submitted during a frame and sorts them by
+    // the state they need (pipeline, then texture, then mesh, then level of detail) so instances
+    // sharing state end up next to each other. The levels of detail of a mesh share its buffers,
+    // so moving between them needs no state change, only a different range of indices. While
+    // the sorted batches are being drawn the queue also tracks what is currently bound, so
+    // renderers only issue the state changes that actually differ.
+    // Note that the queue holds pointers into the submitted instance stores, so they must stay
+    // alive and unchanged until the queue has been sorted.
+    struct RenderQueue
+    {
+        RenderQueue();
+
+        void add(const ast::assets::Pipeline& pipeline,
+                 const ast::StaticMeshInstanceStore& staticMeshInstances,
+                 const std::vector<uint32_t>& instanceIndices,
+                 const std::vector<uint32_t>& instanceLevels);
+
+        void sort();
+
+        const std::vector<ast::RenderBatch>& getBatches() const;
+
+        // The MVP matrices of all the queued instances, in sorted order.
+        const std::vector<glm::mat4>& getTransforms() const;
+
+        // Each of the following returns true if the given state is not already bound, in which
+        // case the caller must bind it. Changing pipeline forgets the bound texture and mesh.
+        bool bindPipeline(const ast::assets::Pipeline& pipeline);
+
+        bool bindTexture(const ast::assets::Texture& texture);
+
+        bool bindMesh(const ast::assets::StaticMesh& mesh);
+
+        const ast::RenderQueueStatistics& getStatistics() const;
+
+        void reset();
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
@@ -1,15 +1,44 @@
 #pragma once
 
 #include "asset-inventory.hpp"
-#include "static-mesh-instance.hpp"
+#include "bounding-box.hpp"
+#include "glm-wrapper.hpp"
+#include "mesh.hpp"
+#include "static-mesh-instance-store.hpp"
 #include <vector>
 
 namespace ast
 {
+    // The camera a frame is rendered from, with everything needed to work out which instances
+    // it can see and how much detail each of them needs.
+    struct RenderView
+    {
+        glm::mat4 projectionMatrix;
+        glm::mat4 viewMatrix;
+        glm::vec3 cameraPosition;
+        float viewportHeight;
+    };
+
     struct Renderer
     {
+        virtual const ast::BoundingBox& getStaticMeshBounds(const ast::assets::StaticMesh& staticMesh) const = 0;
+
+        virtual const std::vector<ast::MeshLevelOfDetail>& getStaticMeshLevels(const ast::assets::StaticMesh& staticMesh) const = 0;
+
+        // Renders the instances at the given dense indices of the instance store, each with the
+        // level of detail of its mesh at the same position in the list of levels.
         virtual void render(
             const ast::assets::Pipeline& pipeline,
-            const std::vector<ast::StaticMeshInstance>& staticMeshInstances) = 0;
+            const ast::StaticMeshInstanceStore& staticMeshInstances,
+            const std::vector<uint32_t>& instanceIndices,
+            const std::vector<uint32_t>& instanceLevels) = 0;
+
+        // Renders every instance in the store which can be seen from the view, each with the
+        // level of detail its size on screen calls for. Renderers which are able to cull on the
+        // GPU do so there, without the CPU visiting the instances one by one.
+        virtual void renderVisible(
+            const ast::assets::Pipeline& pipeline,
+            const ast::StaticMeshInstanceStore& staticMeshInstances,
+            const ast::RenderView& view) = 0;
     };
 } // namespace ast
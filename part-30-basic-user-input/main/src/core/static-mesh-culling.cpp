@@ -0,0 +1,41 @@
+#include "static-mesh-culling.hpp"
+#include "frustum.hpp"
+#include "level-of-detail.hpp"
+#include "profiler.hpp"
+
+void ast::cullStaticMeshInstances(const ast::Renderer& renderer,
+                                  const ast::StaticMeshInstanceStore& staticMeshInstances,
+                                  const ast::RenderView& view,
+                                  std::vector<uint32_t>& instanceIndices,
+                                  std::vector<uint32_t>& instanceLevels)
+{
+    AST_PROFILE_ZONE("ast::cullStaticMeshInstances");
+
+    const ast::Frustum frustum{view.projectionMatrix * view.viewMatrix};
+    const ast::LevelOfDetailSelector levelSelector{view.projectionMatrix, view.cameraPosition, view.viewportHeight};
+
+    const std::vector<ast::assets::StaticMesh>& meshes{staticMeshInstances.getMeshes()};
+    const ast::TransformBatch& transforms{staticMeshInstances.getTransforms()};
+
+    instanceIndices.clear();
+    instanceLevels.clear();
+
+    for (uint32_t i = 0; i < staticMeshInstances.getSize(); i++)
+    {
+        const glm::mat4& modelMatrix{transforms.getModelMatrix(i)};
+        const ast::BoundingBox bounds{ast::transformBoundingBox(renderer.getStaticMeshBounds(meshes[i]), modelMatrix)};
+
+        if (!frustum.isVisible(bounds))
+        {
+            continue;
+        }
+
+        const std::optional<uint32_t> level{levelSelector.select(bounds, modelMatrix, renderer.getStaticMeshLevels(meshes[i]))};
+
+        if (level)
+        {
+            instanceIndices.push_back(i);
+            instanceLevels.push_back(*level);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "renderer.hpp"
+#include "static-mesh-instance-store.hpp"
+#include <vector>
+
+namespace ast
+{
+    // Collects the dense indices of the instances in the store which are inside the frustum of
+    // the view and large enough on screen to see, along with the level of detail each of them
+    // needs. Both lists are cleared first, so they can be reused from one frame to the next.
+    void cullStaticMeshInstances(const ast::Renderer& renderer,
+                                 const ast::StaticMeshInstanceStore& staticMeshInstances,
+                                 const ast::RenderView& view,
+                                 std::vector<uint32_t>& instanceIndices,
+                                 std::vector<uint32_t>& instanceLevels);
+} // namespace ast
\ No newline at end of file
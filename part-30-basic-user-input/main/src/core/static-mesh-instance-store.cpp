@@ -0,0 +1,153 @@
+#include "static-mesh-instance-store.hpp"
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+using ast::StaticMeshInstanceStore;
+
+namespace
+{
+    constexpr uint32_t invalidIndex{std::numeric_limits<uint32_t>::max()};
+
+    uint64_t nextLayoutVersion()
+    {
+        static std::atomic<uint64_t> layoutVersion{0};
+
+        return ++layoutVersion;
+    }
+} // namespace
+
+struct StaticMeshInstanceStore::Internal
+{
+    ast::TransformBatch transforms;
+    std::vector<ast::assets::StaticMesh> meshes;
+    std::vector<ast::assets::Texture> textures;
+
+    // Maps each dense index to the id of the instance stored there, and each id back to its
+    // dense index. Ids of removed instances are recycled for new ones.
+    std::vector<ast::StaticMeshInstanceId> indexToId;
+    std::vector<uint32_t> idToIndex;
+    std::vector<ast::StaticMeshInstanceId> freeIds;
+    uint64_t layoutVersion;
+
+    Internal() : layoutVersion(::nextLayoutVersion()) {}
+
+    ast::StaticMeshInstanceId add(const ast::assets::StaticMesh& staticMesh,
+                                  const ast::assets::Texture& texture,
+                                  const glm::vec3& position,
+                                  const glm::vec3& scale,
+                                  const glm::vec3& rotationAxis,
+                                  const float& rotationDegrees)
+    {
+        ast::StaticMeshInstanceId id;
+
+        if (freeIds.empty())
+        {
+            id = static_cast<ast::StaticMeshInstanceId>(idToIndex.size());
+            idToIndex.push_back(::invalidIndex);
+        }
+        else
+        {
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+
+        idToIndex[id] = transforms.add(position, scale, rotationAxis, rotationDegrees);
+        meshes.push_back(staticMesh);
+        textures.push_back(texture);
+        indexToId.push_back(id);
+        layoutVersion = ::nextLayoutVersion();
+
+        return id;
+    }
+
+    uint32_t getIndex(const ast::StaticMeshInstanceId& id) const
+    {
+        static const std::string logTag{"ast::StaticMeshInstanceStore::getIndex"};
+
+        if (id >= idToIndex.size() || idToIndex[id] == ::invalidIndex)
+        {
+            throw std::runtime_error(logTag + ": Unknown static mesh instance id " + std::to_string(id));
+        }
+
+        return idToIndex[id];
+    }
+
+    void remove(const ast::StaticMeshInstanceId& id)
+    {
+        const uint32_t index{getIndex(id)};
+        const ast::StaticMeshInstanceId lastId{indexToId.back()};
+
+        // Move the last instance into the slot being vacated to keep every array packed.
+        transforms.remove(index);
+        meshes[index] = meshes.back();
+        meshes.pop_back();
+        textures[index] = textures.back();
+        textures.pop_back();
+        indexToId[index] = lastId;
+        indexToId.pop_back();
+
+        idToIndex[lastId] = index;
+        idToIndex[id] = ::invalidIndex;
+        freeIds.push_back(id);
+        layoutVersion = ::nextLayoutVersion();
+    }
+};
+
+StaticMeshInstanceStore::StaticMeshInstanceStore() : internal(ast::make_internal_ptr<Internal>()) {}
+
+ast::StaticMeshInstanceId StaticMeshInstanceStore::add(const ast::assets::StaticMesh& staticMesh,
+                                                       const ast::assets::Texture& texture,
+                                                       const glm::vec3& position,
+                                                       const glm::vec3& scale,
+                                                       const glm::vec3& rotationAxis,
+                                                       const float& rotationDegrees)
+{
+    return internal->add(staticMesh, texture, position, scale, rotationAxis, rotationDegrees);
+}
+
+void StaticMeshInstanceStore::remove(const ast::StaticMeshInstanceId& id)
+{
+    internal->remove(id);
+}
+
+uint32_t StaticMeshInstanceStore::getIndex(const ast::StaticMeshInstanceId& id) const
+{
+    return internal->getIndex(id);
+}
+
+uint32_t StaticMeshInstanceStore::getSize() const
+{
+    return internal->transforms.getSize();
+}
+
+void StaticMeshInstanceStore::update(const glm::mat4& projectionViewMatrix)
+{
+    internal->transforms.update(projectionViewMatrix);
+}
+
+ast::TransformBatch& StaticMeshInstanceStore::getTransforms()
+{
+    return internal->transforms;
+}
+
+const ast::TransformBatch& StaticMeshInstanceStore::getTransforms() const
+{
+    return internal->transforms;
+}
+
+const std::vector<ast::assets::StaticMesh>& StaticMeshInstanceStore::getMeshes() const
+{
+    return internal->meshes;
+}
+
+const std::vector<ast::assets::Texture>& StaticMeshInstanceStore::getTextures() const
+{
+    return internal->textures;
+}
+
+uint64_t StaticMeshInstanceStore::getLayoutVersion() const
+{
+    return internal->layoutVersion;
+}
\ No newline at end of file
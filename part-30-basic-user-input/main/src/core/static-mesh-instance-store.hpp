@@ -0,0 +1,55 @@
+#pragma once
+
+#include "asset-inventory.hpp"
+#include "glm-wrapper.hpp"
+#include "internal-ptr.hpp"
+#include "transform-batch.hpp"
+#include <vector>
+
+namespace ast
+{
+    // A stable handle to an instance in a static mesh instance store, which stays valid even as
+    // other instances are added or removed.
+    using StaticMeshInstanceId = uint32_t;
+
+    // The static mesh instance store holds every instance as packed component arrays, so that
+    // systems can walk the components of all instances contiguously rather than visiting each
+    // instance as a separate object. Instances are identified externally by their id, which is
+    // mapped onto the dense index that the component arrays are addressed by. Removing an
+    // instance moves the last instance into its slot, so dense indices are not stable.
+    struct StaticMeshInstanceStore
+    {
+        StaticMeshInstanceStore();
+
+        ast::StaticMeshInstanceId add(const ast::assets::StaticMesh& staticMesh,
+                                      const ast::assets::Texture& texture,
+                                      const glm::vec3& position = glm::vec3{0.0f, 0.0f, 0.0f},
+                                      const glm::vec3& scale = glm::vec3{1.0f, 1.0f, 1.0f},
+                                      const glm::vec3& rotationAxis = glm::vec3{0.0f, 1.0f, 0.0f},
+                                      const float& rotationDegrees = 0.0f);
+
+        void remove(const ast::StaticMeshInstanceId& id);
+
+        uint32_t getIndex(const ast::StaticMeshInstanceId& id) const;
+
+        uint32_t getSize() const;
+
+        void update(const glm::mat4& projectionViewMatrix);
+
+        ast::TransformBatch& getTransforms();
+
+        const ast::TransformBatch& getTransforms() const;
+
+        const std::vector<ast::assets::StaticMesh>& getMeshes() const;
+
+        const std::vector<ast::assets::Texture>& getTextures() const;
+
+        // Changes whenever an instance is added or removed. Versions come from a counter shared
+        // by every store, so no two stores ever report the same one.
+        uint64_t getLayoutVersion() const;
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
@@ -12,6 +12,7 @@ struct StaticMeshInstance::Internal
     glm::vec3 scale;
     glm::vec3 rotationAxis;
     float rotationDegrees;
+    glm::mat4 modelMatrix;
     glm::mat4 transformMatrix;
 
     Internal(const ast::assets::StaticMesh& mesh,
@@ -27,14 +28,16 @@ struct StaticMeshInstance::Internal
           scale(scale),
           rotationAxis(rotationAxis),
           rotationDegrees(rotationDegrees),
+          modelMatrix(identity),
           transformMatrix(identity) {}
 
     void update(const glm::mat4& projectionViewMatrix)
     {
-        transformMatrix = projectionViewMatrix *
-                          glm::translate(identity, position) *
-                          glm::rotate(identity, glm::radians(rotationDegrees), rotationAxis) *
-                          glm::scale(identity, scale);
+        modelMatrix = glm::translate(identity, position) *
+                      glm::rotate(identity, glm::radians(rotationDegrees), rotationAxis) *
+                      glm::scale(identity, scale);
+
+        transformMatrix = projectionViewMatrix * modelMatrix;
     }
 
     void rotateBy(const float& degrees)
@@ -87,6 +90,11 @@ ast::assets::Texture StaticMeshInstance::getTexture() const
     return internal->texture;
 }
 
+glm::mat4 StaticMeshInstance::getModelMatrix() const
+{
+    return internal->modelMatrix;
+}
+
 glm::mat4 StaticMeshInstance::getTransformMatrix() const
 {
     return internal->transformMatrix;
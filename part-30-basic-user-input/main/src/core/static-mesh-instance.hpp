@@ -23,6 +23,8 @@ namespace ast
 
         ast::assets::Texture getTexture() const;
 
+        glm::mat4 getModelMatrix() const;
+
         glm::mat4 getTransformMatrix() const;
 
     private:
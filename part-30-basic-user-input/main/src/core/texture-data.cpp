@@ -0,0 +1,52 @@
+#include "texture-data.hpp"
+
+using ast::TextureData;
+
+struct TextureData::Internal
+{
+    const ast::TextureFormat format;
+    const std::vector<ast::TextureMipLevel> mipLevels;
+    const std::vector<char> data;
+
+    Internal(const ast::TextureFormat& format,
+             std::vector<ast::TextureMipLevel> mipLevels,
+             std::vector<char> data)
+        : format(format),
+          mipLevels(std::move(mipLevels)),
+          data(std::move(data)) {}
+};
+
+TextureData::TextureData(const ast::TextureFormat& format,
+                         std::vector<ast::TextureMipLevel> mipLevels,
+                         std::vector<char> data)
+    : internal(ast::make_internal_ptr<Internal>(format, std::move(mipLevels), std::move(data))) {}
+
+const ast::TextureFormat& TextureData::getFormat() const
+{
+    return internal->format;
+}
+
+uint32_t TextureData::getWidth() const
+{
+    return internal->mipLevels[0].width;
+}
+
+uint32_t TextureData::getHeight() const
+{
+    return internal->mipLevels[0].height;
+}
+
+const std::vector<ast::TextureMipLevel>& TextureData::getMipLevels() const
+{
+    return internal->mipLevels;
+}
+
+const char* TextureData::getData() const
+{
+    return internal->data.data();
+}
+
+size_t TextureData::getSize() const
+{
+    return internal->data.size();
+}
\ No newline at end of file
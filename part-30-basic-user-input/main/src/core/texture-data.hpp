@@ -0,0 +1,56 @@
+#pragma once
+
+#include "internal-ptr.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ast
+{
+    // The layouts a texture can be stored in. The block compressed formats encode each 4x4
+    // block of pixels into a fixed number of bytes (8 for BC1 and ETC2RGB8, 16 for BC3 and
+    // ETC2RGBA8) which the GPU decodes as it samples, so they stay compressed in memory.
+    enum class TextureFormat
+    {
+        RGBA8,
+        BC1,
+        BC3,
+        ETC2RGB8,
+        ETC2RGBA8
+    };
+
+    // Where to find one mip level within the data of a texture.
+    struct TextureMipLevel
+    {
+        uint32_t width;
+        uint32_t height;
+        size_t offset;
+        size_t size;
+    };
+
+    // Texture data holds a complete chain of mip levels in a single format, ready to be handed
+    // to the GPU as is. Level 0 is always the full size image, with each following level half
+    // the size of the one before it down to 1x1.
+    struct TextureData
+    {
+        TextureData(const ast::TextureFormat& format,
+                    std::vector<ast::TextureMipLevel> mipLevels,
+                    std::vector<char> data);
+
+        const ast::TextureFormat& getFormat() const;
+
+        uint32_t getWidth() const;
+
+        uint32_t getHeight() const;
+
+        const std::vector<ast::TextureMipLevel>& getMipLevels() const;
+
+        const char* getData() const;
+
+        size_t getSize() const;
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
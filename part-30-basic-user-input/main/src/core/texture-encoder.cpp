@@ -0,0 +1,726 @@
+#include "texture-encoder.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    // An uncompressed RGBA image, 4 bytes per pixel with no padding between rows.
+    struct Image
+    {
+        uint32_t width;
+        uint32_t height;
+        std::vector<uint8_t> pixels;
+    };
+
+    // The 16 pixels of a 4x4 block in row major order, 4 channels each.
+    using Block = std::array<std::array<uint8_t, 4>, 16>;
+
+    // The ETC1 intensity modifier tables - the base colour of a sub block is offset by one of
+    // these four values, selected per pixel by its 2 bit index.
+    constexpr int etcModifiers[8][4]{
+        {2, 8, -2, -8},
+        {5, 17, -5, -17},
+        {9, 29, -9, -29},
+        {13, 42, -13, -42},
+        {18, 60, -18, -60},
+        {24, 80, -24, -80},
+        {33, 106, -33, -106},
+        {47, 183, -47, -183}};
+
+    // The EAC alpha modifier tables, scaled by the multiplier stored in each block.
+    constexpr int eacModifiers[16][8]{
+        {-3, -6, -9, -15, 2, 5, 8, 14},
+        {-3, -7, -10, -13, 2, 6, 9, 12},
+        {-2, -5, -8, -13, 1, 4, 7, 12},
+        {-2, -4, -6, -13, 1, 3, 5, 12},
+        {-3, -6, -8, -12, 2, 5, 7, 11},
+        {-3, -7, -9, -11, 2, 6, 8, 10},
+        {-4, -7, -8, -11, 3, 6, 7, 10},
+        {-3, -5, -8, -11, 2, 4, 7, 10},
+        {-2, -6, -8, -10, 1, 5, 7, 9},
+        {-2, -5, -8, -10, 1, 4, 7, 9},
+        {-2, -4, -8, -10, 1, 3, 7, 9},
+        {-2, -5, -7, -10, 1, 4, 6, 9},
+        {-3, -4, -7, -10, 2, 3, 6, 9},
+        {-1, -2, -3, -10, 0, 1, 2, 9},
+        {-4, -6, -8, -9, 3, 5, 7, 8},
+        {-3, -5, -7, -9, 2, 4, 6, 8}};
+
+    size_t getBlockSize(const ast::TextureFormat& format)
+    {
+        switch (format)
+        {
+            case ast::TextureFormat::BC1:
+            case ast::TextureFormat::ETC2RGB8:
+                return 8;
+            case ast::TextureFormat::BC3:
+            case ast::TextureFormat::ETC2RGBA8:
+                return 16;
+            default:
+                return 0;
+        }
+    }
+
+    uint8_t clampByte(const int& value)
+    {
+        return static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+    }
+
+    int squaredDistance(const std::array<uint8_t, 4>& pixel, const int& r, const int& g, const int& b)
+    {
+        const int dr{pixel[0] - r};
+        const int dg{pixel[1] - g};
+        const int db{pixel[2] - b};
+
+        return dr * dr + dg * dg + db * db;
+    }
+
+    ::Image createImage(const ast::Bitmap& bitmap)
+    {
+        const uint32_t width{bitmap.getWidth()};
+        const uint32_t height{bitmap.getHeight()};
+
+        ::Image image{width, height, std::vector<uint8_t>(width * height * 4)};
+        bitmap.copyPixelsTo(image.pixels.data());
+
+        return image;
+    }
+
+    ::Image downsample(const ::Image& source)
+    {
+        const uint32_t width{std::max(source.width / 2, static_cast<uint32_t>(1))};
+        const uint32_t height{std::max(source.height / 2, static_cast<uint32_t>(1))};
+
+        ::Image result{width, height, std::vector<uint8_t>(width * height * 4)};
+
+        for (uint32_t y = 0; y < height; y++)
+        {
+            // Clamp to the last row or column when a dimension has already reached 1.
+            const uint32_t y0{std::min(y * 2, source.height - 1)};
+            const uint32_t y1{std::min(y * 2 + 1, source.height - 1)};
+
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint32_t x0{std::min(x * 2, source.width - 1)};
+                const uint32_t x1{std::min(x * 2 + 1, source.width - 1)};
+
+                for (uint32_t channel = 0; channel < 4; channel++)
+                {
+                    const int sum{source.pixels[(y0 * source.width + x0) * 4 + channel] +
+                                  source.pixels[(y0 * source.width + x1) * 4 + channel] +
+                                  source.pixels[(y1 * source.width + x0) * 4 + channel] +
+                                  source.pixels[(y1 * source.width + x1) * 4 + channel]};
+
+                    result.pixels[(y * width + x) * 4 + channel] = static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    ::Block readBlock(const ::Image& image, const uint32_t& blockX, const uint32_t& blockY)
+    {
+        ::Block block;
+
+        // Blocks hanging over the edge of a small mip level repeat its last row or column.
+        for (uint32_t y = 0; y < 4; y++)
+        {
+            const uint32_t sourceY{std::min(blockY * 4 + y, image.height - 1)};
+
+            for (uint32_t x = 0; x < 4; x++)
+            {
+                const uint32_t sourceX{std::min(blockX * 4 + x, image.width - 1)};
+
+                std::memcpy(block[y * 4 + x].data(), &image.pixels[(sourceY * image.width + sourceX) * 4], 4);
+            }
+        }
+
+        return block;
+    }
+
+    uint16_t packRGB565(const float& r, const float& g, const float& b)
+    {
+        const auto quantize = [](const float& value, const int& maximum) {
+            return std::min(std::max(static_cast<int>(std::lround(value * maximum / 255.0f)), 0), maximum);
+        };
+
+        return static_cast<uint16_t>((quantize(r, 31) << 11) | (quantize(g, 63) << 5) | quantize(b, 31));
+    }
+
+    std::array<int, 3> unpackRGB565(const uint16_t& color)
+    {
+        const int r{(color >> 11) & 31};
+        const int g{(color >> 5) & 63};
+        const int b{color & 31};
+
+        return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+    }
+
+    void writeLittleEndian(char* output, const uint64_t& value, const size_t& numBytes)
+    {
+        for (size_t i = 0; i < numBytes; i++)
+        {
+            output[i] = static_cast<char>((value >> (i * 8)) & 0xff);
+        }
+    }
+
+    void writeBigEndian(char* output, const uint64_t& value)
+    {
+        for (size_t i = 0; i < 8; i++)
+        {
+            output[i] = static_cast<char>((value >> ((7 - i) * 8)) & 0xff);
+        }
+    }
+
+    // BC1 stores two RGB565 end points and a 2 bit index per pixel choosing between the end
+    // points and two colours interpolated between them. We take the end points from the
+    // extremes of the block along its principal axis, which follows the spread of the colours
+    // far better than the corners of their bounding box.
+    void encodeBC1Block(const ::Block& block, char* output)
+    {
+        float mean[3]{0.0f, 0.0f, 0.0f};
+
+        for (const auto& pixel : block)
+        {
+            for (size_t channel = 0; channel < 3; channel++)
+            {
+                mean[channel] += pixel[channel] / 16.0f;
+            }
+        }
+
+        float covariance[6]{0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
+        for (const auto& pixel : block)
+        {
+            const float r{pixel[0] - mean[0]};
+            const float g{pixel[1] - mean[1]};
+            const float b{pixel[2] - mean[2]};
+
+            covariance[0] += r * r;
+            covariance[1] += r * g;
+            covariance[2] += r * b;
+            covariance[3] += g * g;
+            covariance[4] += g * b;
+            covariance[5] += b * b;
+        }
+
+        // A few rounds of power iteration are plenty to find the dominant axis of 16 colours.
+        float axis[3]{1.0f, 1.0f, 1.0f};
+
+        for (int iteration = 0; iteration < 4; iteration++)
+        {
+            const float r{axis[0] * covariance[0] + axis[1] * covariance[1] + axis[2] * covariance[2]};
+            const float g{axis[0] * covariance[1] + axis[1] * covariance[3] + axis[2] * covariance[4]};
+            const float b{axis[0] * covariance[2] + axis[1] * covariance[4] + axis[2] * covariance[5]};
+            const float length{std::max(std::max(std::fabs(r), std::fabs(g)), std::fabs(b))};
+
+            if (length == 0.0f)
+            {
+                break;
+            }
+
+            axis[0] = r / length;
+            axis[1] = g / length;
+            axis[2] = b / length;
+        }
+
+        size_t minPixel{0};
+        size_t maxPixel{0};
+        float minProjection{std::numeric_limits<float>::max()};
+        float maxProjection{std::numeric_limits<float>::lowest()};
+
+        for (size_t i = 0; i < block.size(); i++)
+        {
+            const float projection{block[i][0] * axis[0] + block[i][1] * axis[1] + block[i][2] * axis[2]};
+
+            if (projection < minProjection)
+            {
+                minProjection = projection;
+                minPixel = i;
+            }
+
+            if (projection > maxProjection)
+            {
+                maxProjection = projection;
+                maxPixel = i;
+            }
+        }
+
+        uint16_t color0{::packRGB565(block[maxPixel][0], block[maxPixel][1], block[maxPixel][2])};
+        uint16_t color1{::packRGB565(block[minPixel][0], block[minPixel][1], block[minPixel][2])};
+
+        // The first end point must be the larger one to select the four colour mode. If both
+        // end points are the same the block is a single colour and every index stays at zero.
+        if (color0 < color1)
+        {
+            std::swap(color0, color1);
+        }
+
+        uint32_t indices{0};
+
+        if (color0 != color1)
+        {
+            const std::array<int, 3> end0{::unpackRGB565(color0)};
+            const std::array<int, 3> end1{::unpackRGB565(color1)};
+            std::array<std::array<int, 3>, 4> palette;
+
+            for (size_t channel = 0; channel < 3; channel++)
+            {
+                palette[0][channel] = end0[channel];
+                palette[1][channel] = end1[channel];
+                palette[2][channel] = (2 * end0[channel] + end1[channel]) / 3;
+                palette[3][channel] = (end0[channel] + 2 * end1[channel]) / 3;
+            }
+
+            for (size_t i = 0; i < block.size(); i++)
+            {
+                uint32_t bestIndex{0};
+                int bestError{std::numeric_limits<int>::max()};
+
+                for (uint32_t index = 0; index < 4; index++)
+                {
+                    const int error{::squaredDistance(block[i], palette[index][0], palette[index][1], palette[index][2])};
+
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        bestIndex = index;
+                    }
+                }
+
+                indices |= bestIndex << (i * 2);
+            }
+        }
+
+        ::writeLittleEndian(output, color0, 2);
+        ::writeLittleEndian(output + 2, color1, 2);
+        ::writeLittleEndian(output + 4, indices, 4);
+    }
+
+    // The BC3 alpha block stores two 8 bit end points and a 3 bit index per pixel selecting
+    // one of eight values spread evenly between them.
+    void encodeBC3AlphaBlock(const ::Block& block, char* output)
+    {
+        int alpha0{0};
+        int alpha1{255};
+
+        for (const auto& pixel : block)
+        {
+            alpha0 = std::max(alpha0, static_cast<int>(pixel[3]));
+            alpha1 = std::min(alpha1, static_cast<int>(pixel[3]));
+        }
+
+        uint64_t indices{0};
+
+        if (alpha0 != alpha1)
+        {
+            int palette[8]{alpha0, alpha1};
+
+            for (int index = 2; index < 8; index++)
+            {
+                palette[index] = ((8 - index) * alpha0 + (index - 1) * alpha1) / 7;
+            }
+
+            for (size_t i = 0; i < block.size(); i++)
+            {
+                uint64_t bestIndex{0};
+                int bestError{std::numeric_limits<int>::max()};
+
+                for (uint64_t index = 0; index < 8; index++)
+                {
+                    const int error{std::abs(block[i][3] - palette[index])};
+
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        bestIndex = index;
+                    }
+                }
+
+                indices |= bestIndex << (i * 3);
+            }
+        }
+
+        output[0] = static_cast<char>(alpha0);
+        output[1] = static_cast<char>(alpha1);
+        ::writeLittleEndian(output + 2, indices, 6);
+    }
+
+    // Choose the best modifier table and per pixel modifiers for one ETC sub block around the
+    // given base colour, returning the total error. The pixels are chosen by the flip mode,
+    // either the left and right 2x4 halves or the top and bottom 4x2 halves of the block.
+    int encodeETCSubBlock(const ::Block& block,
+                          const bool& flip,
+                          const uint32_t& subBlock,
+                          const std::array<int, 3>& base,
+                          uint32_t& table,
+                          uint32_t (&selectors)[16])
+    {
+        int bestTableError{std::numeric_limits<int>::max()};
+
+        for (uint32_t candidate = 0; candidate < 8; candidate++)
+        {
+            int tableError{0};
+            uint32_t candidateSelectors[16];
+
+            for (uint32_t y = 0; y < 4; y++)
+            {
+                for (uint32_t x = 0; x < 4; x++)
+                {
+                    if ((flip ? y / 2 : x / 2) != subBlock)
+                    {
+                        continue;
+                    }
+
+                    int bestError{std::numeric_limits<int>::max()};
+
+                    for (uint32_t selector = 0; selector < 4; selector++)
+                    {
+                        const int modifier{::etcModifiers[candidate][selector]};
+                        const int error{::squaredDistance(block[y * 4 + x],
+                                                          ::clampByte(base[0] + modifier),
+                                                          ::clampByte(base[1] + modifier),
+                                                          ::clampByte(base[2] + modifier))};
+
+                        if (error < bestError)
+                        {
+                            bestError = error;
+                            candidateSelectors[y * 4 + x] = selector;
+                        }
+                    }
+
+                    tableError += bestError;
+                }
+            }
+
+            if (tableError < bestTableError)
+            {
+                bestTableError = tableError;
+                table = candidate;
+
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    if ((flip ? (i / 4) / 2 : (i % 4) / 2) == subBlock)
+                    {
+                        selectors[i] = candidateSelectors[i];
+                    }
+                }
+            }
+        }
+
+        return bestTableError;
+    }
+
+    // Encode a block of ETC2 RGB8 using only the 'individual' and 'differential' modes it
+    // shares with ETC1, so the result can also be sampled as ETC1 by devices that only have
+    // that. Each half of the block gets its own base colour, either as two 444 colours or as
+    // a 555 colour plus a small 333 signed offset for the second half.
+    void encodeETC2RGBBlock(const ::Block& block, char* output)
+    {
+        uint64_t bestBits{0};
+        int bestError{std::numeric_limits<int>::max()};
+
+        for (const bool flip : {false, true})
+        {
+            float averages[2][3]{{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}};
+
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                const uint32_t subBlock{flip ? (i / 4) / 2 : (i % 4) / 2};
+
+                for (size_t channel = 0; channel < 3; channel++)
+                {
+                    averages[subBlock][channel] += block[i][channel] / 8.0f;
+                }
+            }
+
+            int quantized5[2][3];
+
+            for (size_t subBlock = 0; subBlock < 2; subBlock++)
+            {
+                for (size_t channel = 0; channel < 3; channel++)
+                {
+                    quantized5[subBlock][channel] = static_cast<int>(std::lround(averages[subBlock][channel] * 31.0f / 255.0f));
+                }
+            }
+
+            const bool differential{
+                quantized5[1][0] - quantized5[0][0] >= -4 && quantized5[1][0] - quantized5[0][0] <= 3 &&
+                quantized5[1][1] - quantized5[0][1] >= -4 && quantized5[1][1] - quantized5[0][1] <= 3 &&
+                quantized5[1][2] - quantized5[0][2] >= -4 && quantized5[1][2] - quantized5[0][2] <= 3};
+
+            uint64_t bits{0};
+            std::array<std::array<int, 3>, 2> bases;
+
+            if (differential)
+            {
+                for (size_t channel = 0; channel < 3; channel++)
+                {
+                    const int base{quantized5[0][channel]};
+                    const int delta{quantized5[1][channel] - base};
+
+                    bits |= static_cast<uint64_t>(base) << (59 - channel * 8);
+                    bits |= static_cast<uint64_t>(delta & 7) << (56 - channel * 8);
+
+                    bases[0][channel] = (base << 3) | (base >> 2);
+                    bases[1][channel] = (quantized5[1][channel] << 3) | (quantized5[1][channel] >> 2);
+                }
+            }
+            else
+            {
+                for (size_t subBlock = 0; subBlock < 2; subBlock++)
+                {
+                    for (size_t channel = 0; channel < 3; channel++)
+                    {
+                        const int base{static_cast<int>(std::lround(averages[subBlock][channel] * 15.0f / 255.0f))};
+
+                        bits |= static_cast<uint64_t>(base) << (60 - channel * 8 - subBlock * 4);
+                        bases[subBlock][channel] = (base << 4) | base;
+                    }
+                }
+            }
+
+            uint32_t tables[2];
+            uint32_t selectors[16];
+            int error{0};
+
+            for (uint32_t subBlock = 0; subBlock < 2; subBlock++)
+            {
+                error += ::encodeETCSubBlock(block, flip, subBlock, bases[subBlock], tables[subBlock], selectors);
+            }
+
+            if (error >= bestError)
+            {
+                continue;
+            }
+
+            bits |= static_cast<uint64_t>(tables[0]) << 37;
+            bits |= static_cast<uint64_t>(tables[1]) << 34;
+            bits |= static_cast<uint64_t>(differential ? 1 : 0) << 33;
+            bits |= static_cast<uint64_t>(flip ? 1 : 0) << 32;
+
+            // The selectors are stored in column major order, with the high bits of all
+            // sixteen selectors in the upper half and the low bits in the lower half.
+            for (uint32_t x = 0; x < 4; x++)
+            {
+                for (uint32_t y = 0; y < 4; y++)
+                {
+                    const uint32_t selector{selectors[y * 4 + x]};
+                    const uint32_t position{x * 4 + y};
+
+                    bits |= static_cast<uint64_t>(selector >> 1) << (16 + position);
+                    bits |= static_cast<uint64_t>(selector & 1) << position;
+                }
+            }
+
+            bestError = error;
+            bestBits = bits;
+        }
+
+        ::writeBigEndian(output, bestBits);
+    }
+
+    // The EAC alpha block stores an 8 bit base value, a multiplier and one of sixteen modifier
+    // tables, with a 3 bit index per pixel choosing a modifier. We try every table with the
+    // multipliers and base values that would stretch it over the range of the block.
+    void encodeEACAlphaBlock(const ::Block& block, char* output)
+    {
+        int minAlpha{255};
+        int maxAlpha{0};
+
+        for (const auto& pixel : block)
+        {
+            minAlpha = std::min(minAlpha, static_cast<int>(pixel[3]));
+            maxAlpha = std::max(maxAlpha, static_cast<int>(pixel[3]));
+        }
+
+        uint64_t bestBits{0};
+        int bestError{std::numeric_limits<int>::max()};
+
+        for (uint32_t table = 0; table < 16 && bestError > 0; table++)
+        {
+            const int minModifier{::eacModifiers[table][3]};
+            const int maxModifier{::eacModifiers[table][7]};
+            const int multiplier{static_cast<int>(std::lround(static_cast<float>(maxAlpha - minAlpha) / (maxModifier - minModifier)))};
+
+            for (int candidateMultiplier = multiplier - 1; candidateMultiplier <= multiplier + 1; candidateMultiplier++)
+            {
+                if (candidateMultiplier < 1 || candidateMultiplier > 15)
+                {
+                    continue;
+                }
+
+                const int center{static_cast<int>(std::lround((minAlpha + maxAlpha) / 2.0f -
+                                                              (minModifier + maxModifier) * candidateMultiplier / 2.0f))};
+
+                for (int base = center - 1; base <= center + 1; base++)
+                {
+                    if (base < 0 || base > 255)
+                    {
+                        continue;
+                    }
+
+                    uint64_t bits{static_cast<uint64_t>(base) << 56 |
+                                  static_cast<uint64_t>(candidateMultiplier) << 52 |
+                                  static_cast<uint64_t>(table) << 48};
+                    int error{0};
+
+                    for (uint32_t x = 0; x < 4; x++)
+                    {
+                        for (uint32_t y = 0; y < 4; y++)
+                        {
+                            const int alpha{block[y * 4 + x][3]};
+                            uint64_t bestIndex{0};
+                            int bestPixelError{std::numeric_limits<int>::max()};
+
+                            for (uint64_t index = 0; index < 8; index++)
+                            {
+                                const int decoded{::clampByte(base + ::eacModifiers[table][index] * candidateMultiplier)};
+                                const int pixelError{(alpha - decoded) * (alpha - decoded)};
+
+                                if (pixelError < bestPixelError)
+                                {
+                                    bestPixelError = pixelError;
+                                    bestIndex = index;
+                                }
+                            }
+
+                            // Like ETC, the indices are stored in column major order.
+                            bits |= bestIndex << (45 - (x * 4 + y) * 3);
+                            error += bestPixelError;
+                        }
+                    }
+
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        bestBits = bits;
+                    }
+                }
+            }
+        }
+
+        ::writeBigEndian(output, bestBits);
+    }
+
+    void encodeBlock(const ast::TextureFormat& format, const ::Block& block, char* output)
+    {
+        switch (format)
+        {
+            case ast::TextureFormat::BC1:
+                return ::encodeBC1Block(block, output);
+            case ast::TextureFormat::BC3:
+                ::encodeBC3AlphaBlock(block, output);
+                return ::encodeBC1Block(block, output + 8);
+            case ast::TextureFormat::ETC2RGB8:
+                return ::encodeETC2RGBBlock(block, output);
+            case ast::TextureFormat::ETC2RGBA8:
+                ::encodeEACAlphaBlock(block, output);
+                return ::encodeETC2RGBBlock(block, output + 8);
+            default:
+                throw std::runtime_error("ast::textures::encodeBlock: Format is not block compressed.");
+        }
+    }
+
+    void encodeImage(const ::Image& image, const ast::TextureFormat& format, char* output)
+    {
+        if (format == ast::TextureFormat::RGBA8)
+        {
+            std::memcpy(output, image.pixels.data(), image.pixels.size());
+            return;
+        }
+
+        const size_t blockSize{::getBlockSize(format)};
+        const uint32_t blocksWide{(image.width + 3) / 4};
+        const uint32_t blocksHigh{(image.height + 3) / 4};
+
+        for (uint32_t blockY = 0; blockY < blocksHigh; blockY++)
+        {
+            for (uint32_t blockX = 0; blockX < blocksWide; blockX++)
+            {
+                ::encodeBlock(format,
+                              ::readBlock(image, blockX, blockY),
+                              output + (blockY * blocksWide + blockX) * blockSize);
+            }
+        }
+    }
+} // namespace
+
+std::string ast::textures::getFormatName(const ast::TextureFormat& format)
+{
+    switch (format)
+    {
+        case ast::TextureFormat::RGBA8:
+            return "RGBA8";
+        case ast::TextureFormat::BC1:
+            return "BC1";
+        case ast::TextureFormat::BC3:
+            return "BC3";
+        case ast::TextureFormat::ETC2RGB8:
+            return "ETC2 RGB8";
+        case ast::TextureFormat::ETC2RGBA8:
+            return "ETC2 RGBA8";
+    }
+}
+
+size_t ast::textures::getMipLevelSize(const ast::TextureFormat& format, const uint32_t& width, const uint32_t& height)
+{
+    if (format == ast::TextureFormat::RGBA8)
+    {
+        return static_cast<size_t>(width) * height * 4;
+    }
+
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * ::getBlockSize(format);
+}
+
+bool ast::textures::hasTransparency(const ast::Bitmap& bitmap)
+{
+    const ::Image image{::createImage(bitmap)};
+    const size_t numPixels{static_cast<size_t>(image.width) * image.height};
+
+    for (size_t i = 0; i < numPixels; i++)
+    {
+        if (image.pixels[i * 4 + 3] != 255)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+ast::TextureData ast::textures::encode(const ast::Bitmap& bitmap, const ast::TextureFormat& format)
+{
+    std::vector<::Image> images;
+    images.push_back(::createImage(bitmap));
+
+    while (images.back().width > 1 || images.back().height > 1)
+    {
+        images.push_back(::downsample(images.back()));
+    }
+
+    std::vector<ast::TextureMipLevel> mipLevels;
+    size_t dataSize{0};
+
+    for (const auto& image : images)
+    {
+        const size_t size{ast::textures::getMipLevelSize(format, image.width, image.height)};
+
+        mipLevels.push_back(ast::TextureMipLevel{image.width, image.height, dataSize, size});
+        dataSize += size;
+    }
+
+    std::vector<char> data(dataSize);
+
+    for (size_t level = 0; level < images.size(); level++)
+    {
+        ::encodeImage(images[level], format, data.data() + mipLevels[level].offset);
+    }
+
+    return ast::TextureData(format, std::move(mipLevels), std::move(data));
+}
\ No newline at end of file
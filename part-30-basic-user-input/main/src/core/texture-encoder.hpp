@@ -0,0 +1,19 @@
+#pragma once
+
+#include "bitmap.hpp"
+#include "texture-data.hpp"
+#include <string>
+
+namespace ast::textures
+{
+    std::string getFormatName(const ast::TextureFormat& format);
+
+    size_t getMipLevelSize(const ast::TextureFormat& format, const uint32_t& width, const uint32_t& height);
+
+    bool hasTransparency(const ast::Bitmap& bitmap);
+
+    // Build the full mip chain of an RGBA bitmap, halving it each level with a box filter,
+    // then encode every level into the given format. Encoding into the block compressed
+    // formats is slow so this is intended to be done offline by the asset baker.
+    ast::TextureData encode(const ast::Bitmap& bitmap, const ast::TextureFormat& format);
+} // namespace ast::textures
\ No newline at end of file
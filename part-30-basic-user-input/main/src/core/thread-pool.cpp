@@ -0,0 +1,115 @@
+#include "thread-pool.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define AST_THREAD_POOL_INLINE
+#endif
+
+using ast::ThreadPool;
+
+namespace
+{
+    size_t getDefaultNumThreads()
+    {
+        // Leave one hardware thread free for the main thread which is typically still busy
+        // doing other work while the pool is running, but always have at least one worker.
+        const size_t hardwareThreads{static_cast<size_t>(std::thread::hardware_concurrency())};
+
+        return std::max(hardwareThreads, static_cast<size_t>(2)) - 1;
+    }
+} // namespace
+
+struct ThreadPool::Internal
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::queue<std::function<void()>> jobs;
+    std::vector<std::thread> workers;
+    bool stopping;
+
+    Internal(const size_t& numThreads) : stopping(false)
+    {
+#ifndef AST_THREAD_POOL_INLINE
+        for (size_t i = 0; i < numThreads; i++)
+        {
+            workers.emplace_back([this]() { work(); });
+        }
+#endif
+    }
+
+    void enqueue(std::function<void()> job)
+    {
+#ifdef AST_THREAD_POOL_INLINE
+        job();
+#else
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push(std::move(job));
+        }
+
+        condition.notify_one();
+#endif
+    }
+
+    void work()
+    {
+        AST_PROFILE_THREAD("Worker");
+
+        while (true)
+        {
+            std::function<void()> job;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+                // Only stop once there is nothing left to do, so no queued job is ever abandoned.
+                if (stopping && jobs.empty())
+                {
+                    return;
+                }
+
+                job = std::move(jobs.front());
+                jobs.pop();
+            }
+
+            AST_PROFILE_ZONE("ThreadPool::job");
+            job();
+        }
+    }
+
+    ~Internal()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+
+        condition.notify_all();
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+};
+
+ThreadPool::ThreadPool() : internal(ast::make_internal_ptr<Internal>(::getDefaultNumThreads())) {}
+
+ThreadPool::ThreadPool(const size_t& numThreads) : internal(ast::make_internal_ptr<Internal>(numThreads)) {}
+
+size_t ThreadPool::getNumThreads() const
+{
+    return internal->workers.size();
+}
+
+void ThreadPool::enqueue(std::function<void()> job) const
+{
+    internal->enqueue(std::move(job));
+}
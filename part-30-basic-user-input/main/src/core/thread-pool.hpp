@@ -0,0 +1,42 @@
+#pragma once
+
+#include "internal-ptr.hpp"
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace ast
+{
+    // A simple pool of worker threads which can execute jobs in the background. Each submitted
+    // job hands back a future which can be used to wait for and collect the result of the job.
+    // On platforms without threading support (Emscripten) jobs are executed immediately on the
+    // calling thread, so the returned future is always ready.
+    struct ThreadPool
+    {
+        ThreadPool();
+
+        ThreadPool(const size_t& numThreads);
+
+        size_t getNumThreads() const;
+
+        template <typename Job>
+        auto submit(Job job) -> std::future<decltype(job())>
+        {
+            using Result = decltype(job());
+
+            // A packaged task isn't copyable so we share it with the queued function.
+            auto task{std::make_shared<std::packaged_task<Result()>>(std::move(job))};
+            std::future<Result> result{task->get_future()};
+
+            enqueue([task]() { (*task)(); });
+
+            return result;
+        }
+
+    private:
+        void enqueue(std::function<void()> job) const;
+
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
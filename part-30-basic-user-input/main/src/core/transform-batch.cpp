@@ -0,0 +1,283 @@
+#include "transform-batch.hpp"
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define AST_TRANSFORM_BATCH_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AST_TRANSFORM_BATCH_NEON
+#include <arm_neon.h>
+#endif
+
+using ast::TransformBatch;
+
+namespace
+{
+    constexpr float degreesToRadians{3.14159265358979323846f / 180.0f};
+
+    template <typename T>
+    void removeAt(std::vector<T>& values, const uint32_t& index)
+    {
+        values[index] = values.back();
+        values.pop_back();
+    }
+
+#if defined(AST_TRANSFORM_BATCH_SSE)
+    using MatrixColumn = __m128;
+
+    MatrixColumn loadColumn(const float* source)
+    {
+        return _mm_loadu_ps(source);
+    }
+
+    // Multiply the projection view matrix by a single column of a model matrix.
+    void multiplyColumn(const MatrixColumn (&matrix)[4], const float* column, float* destination)
+    {
+        __m128 result{_mm_mul_ps(matrix[0], _mm_set1_ps(column[0]))};
+        result = _mm_add_ps(result, _mm_mul_ps(matrix[1], _mm_set1_ps(column[1])));
+        result = _mm_add_ps(result, _mm_mul_ps(matrix[2], _mm_set1_ps(column[2])));
+        result = _mm_add_ps(result, _mm_mul_ps(matrix[3], _mm_set1_ps(column[3])));
+
+        _mm_storeu_ps(destination, result);
+    }
+#elif defined(AST_TRANSFORM_BATCH_NEON)
+    using MatrixColumn = float32x4_t;
+
+    MatrixColumn loadColumn(const float* source)
+    {
+        return vld1q_f32(source);
+    }
+
+    // Multiply the projection view matrix by a single column of a model matrix.
+    void multiplyColumn(const MatrixColumn (&matrix)[4], const float* column, float* destination)
+    {
+        float32x4_t result{vmulq_n_f32(matrix[0], column[0])};
+        result = vmlaq_n_f32(result, matrix[1], column[1]);
+        result = vmlaq_n_f32(result, matrix[2], column[2]);
+        result = vmlaq_n_f32(result, matrix[3], column[3]);
+
+        vst1q_f32(destination, result);
+    }
+#else
+    struct MatrixColumn
+    {
+        float values[4];
+    };
+
+    MatrixColumn loadColumn(const float* source)
+    {
+        return MatrixColumn{{source[0], source[1], source[2], source[3]}};
+    }
+
+    // Multiply the projection view matrix by a single column of a model matrix.
+    void multiplyColumn(const MatrixColumn (&matrix)[4], const float* column, float* destination)
+    {
+        for (int row = 0; row < 4; row++)
+        {
+            destination[row] = matrix[0].values[row] * column[0] +
+                               matrix[1].values[row] * column[1] +
+                               matrix[2].values[row] * column[2] +
+                               matrix[3].values[row] * column[3];
+        }
+    }
+#endif
+} // namespace
+
+struct TransformBatch::Internal
+{
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+    std::vector<float> scaleX;
+    std::vector<float> scaleY;
+    std::vector<float> scaleZ;
+    std::vector<float> axisX;
+    std::vector<float> axisY;
+    std::vector<float> axisZ;
+    std::vector<float> rotationDegrees;
+    std::vector<glm::mat4> modelMatrices;
+    std::vector<glm::mat4> transformMatrices;
+
+    // Set when a transform changes, and turned into a new model version by the next update
+    // once the model matrices really do reflect the change.
+    bool modelsChanged;
+    uint64_t modelVersion;
+
+    Internal() : modelsChanged(false), modelVersion(0) {}
+
+    uint32_t add(const glm::vec3& position,
+                 const glm::vec3& scale,
+                 const glm::vec3& rotationAxis,
+                 const float& degrees)
+    {
+        // The rotation axis is normalised up front so the update doesn't need to.
+        const float axisLength{std::sqrt(rotationAxis.x * rotationAxis.x +
+                                         rotationAxis.y * rotationAxis.y +
+                                         rotationAxis.z * rotationAxis.z)};
+
+        positionX.push_back(position.x);
+        positionY.push_back(position.y);
+        positionZ.push_back(position.z);
+        scaleX.push_back(scale.x);
+        scaleY.push_back(scale.y);
+        scaleZ.push_back(scale.z);
+        axisX.push_back(rotationAxis.x / axisLength);
+        axisY.push_back(rotationAxis.y / axisLength);
+        axisZ.push_back(rotationAxis.z / axisLength);
+        rotationDegrees.push_back(degrees);
+        modelMatrices.push_back(glm::mat4{1.0f});
+        transformMatrices.push_back(glm::mat4{1.0f});
+        modelsChanged = true;
+
+        return static_cast<uint32_t>(positionX.size() - 1);
+    }
+
+    void remove(const uint32_t& index)
+    {
+        ::removeAt(positionX, index);
+        ::removeAt(positionY, index);
+        ::removeAt(positionZ, index);
+        ::removeAt(scaleX, index);
+        ::removeAt(scaleY, index);
+        ::removeAt(scaleZ, index);
+        ::removeAt(axisX, index);
+        ::removeAt(axisY, index);
+        ::removeAt(axisZ, index);
+        ::removeAt(rotationDegrees, index);
+        ::removeAt(modelMatrices, index);
+        ::removeAt(transformMatrices, index);
+
+        // The last model matrix is moved along with its transform, so the change is immediate.
+        modelVersion++;
+    }
+
+    void rotateBy(const uint32_t& index, const float& degrees)
+    {
+        float& rotation{rotationDegrees[index]};
+
+        rotation += degrees;
+
+        if (rotation > 360.0f)
+        {
+            rotation -= 360.0f;
+        }
+        else if (rotation < -360.0f)
+        {
+            rotation += 360.0f;
+        }
+
+        modelsChanged = true;
+    }
+
+    void update(const glm::mat4& projectionViewMatrix)
+    {
+        const float* projectionView{&projectionViewMatrix[0][0]};
+
+        const ::MatrixColumn projectionViewColumns[4]{
+            ::loadColumn(projectionView),
+            ::loadColumn(projectionView + 4),
+            ::loadColumn(projectionView + 8),
+            ::loadColumn(projectionView + 12)};
+
+        const size_t count{positionX.size()};
+
+        if (modelsChanged)
+        {
+            modelVersion++;
+            modelsChanged = false;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const float radians{rotationDegrees[i] * ::degreesToRadians};
+            const float c{std::cos(radians)};
+            const float s{std::sin(radians)};
+            const float t{1.0f - c};
+            const float x{axisX[i]};
+            const float y{axisY[i]};
+            const float z{axisZ[i]};
+
+            // This is the translate * rotate * scale matrix written out column by column, using
+            // the same axis angle rotation as 'glm::rotate' with each rotation column multiplied
+            // by its scale and the translation placed into the last column.
+            float* model{&modelMatrices[i][0][0]};
+
+            model[0] = (c + t * x * x) * scaleX[i];
+            model[1] = (t * x * y + s * z) * scaleX[i];
+            model[2] = (t * x * z - s * y) * scaleX[i];
+            model[3] = 0.0f;
+
+            model[4] = (t * y * x - s * z) * scaleY[i];
+            model[5] = (c + t * y * y) * scaleY[i];
+            model[6] = (t * y * z + s * x) * scaleY[i];
+            model[7] = 0.0f;
+
+            model[8] = (t * z * x + s * y) * scaleZ[i];
+            model[9] = (t * z * y - s * x) * scaleZ[i];
+            model[10] = (c + t * z * z) * scaleZ[i];
+            model[11] = 0.0f;
+
+            model[12] = positionX[i];
+            model[13] = positionY[i];
+            model[14] = positionZ[i];
+            model[15] = 1.0f;
+
+            float* transform{&transformMatrices[i][0][0]};
+
+            ::multiplyColumn(projectionViewColumns, model, transform);
+            ::multiplyColumn(projectionViewColumns, model + 4, transform + 4);
+            ::multiplyColumn(projectionViewColumns, model + 8, transform + 8);
+            ::multiplyColumn(projectionViewColumns, model + 12, transform + 12);
+        }
+    }
+};
+
+TransformBatch::TransformBatch() : internal(ast::make_internal_ptr<Internal>()) {}
+
+uint32_t TransformBatch::add(const glm::vec3& position,
+                             const glm::vec3& scale,
+                             const glm::vec3& rotationAxis,
+                             const float& rotationDegrees)
+{
+    return internal->add(position, scale, rotationAxis, rotationDegrees);
+}
+
+void TransformBatch::remove(const uint32_t& index)
+{
+    internal->remove(index);
+}
+
+void TransformBatch::rotateBy(const uint32_t& index, const float& degrees)
+{
+    internal->rotateBy(index, degrees);
+}
+
+void TransformBatch::update(const glm::mat4& projectionViewMatrix)
+{
+    internal->update(projectionViewMatrix);
+}
+
+uint32_t TransformBatch::getSize() const
+{
+    return static_cast<uint32_t>(internal->positionX.size());
+}
+
+const glm::mat4& TransformBatch::getModelMatrix(const uint32_t& index) const
+{
+    return internal->modelMatrices[index];
+}
+
+const glm::mat4& TransformBatch::getTransformMatrix(const uint32_t& index) const
+{
+    return internal->transformMatrices[index];
+}
+
+const std::vector<glm::mat4>& TransformBatch::getTransformMatrices() const
+{
+    return internal->transformMatrices;
+}
+
+uint64_t TransformBatch::getModelVersion() const
+{
+    return internal->modelVersion;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "glm-wrapper.hpp"
+#include "internal-ptr.hpp"
+#include <vector>
+
+namespace ast
+{
+    // A transform batch stores the position, scale and rotation of many objects as a structure
+    // of arrays and computes all of their model and MVP matrices in a single pass. The model
+    // matrix is assembled directly from its parts rather than multiplying separate translation,
+    // rotation and scale matrices together, and the projection view multiply is vectorised with
+    // SSE or NEON where the target supports it.
+    struct TransformBatch
+    {
+        TransformBatch();
+
+        uint32_t add(const glm::vec3& position,
+                     const glm::vec3& scale,
+                     const glm::vec3& rotationAxis,
+                     const float& rotationDegrees);
+
+        // Removes the transform at the given index by moving the last transform into its place.
+        void remove(const uint32_t& index);
+
+        void rotateBy(const uint32_t& index, const float& degrees);
+
+        void update(const glm::mat4& projectionViewMatrix);
+
+        uint32_t getSize() const;
+
+        const glm::mat4& getModelMatrix(const uint32_t& index) const;
+
+        const glm::mat4& getTransformMatrix(const uint32_t& index) const;
+
+        const std::vector<glm::mat4>& getTransformMatrices() const;
+
+        // Changes whenever the model matrices may have changed, so anything holding a copy of
+        // them can tell when it has to be refreshed rather than copying them every frame.
+        uint64_t getModelVersion() const;
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
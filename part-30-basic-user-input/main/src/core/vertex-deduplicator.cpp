@@ -0,0 +1,106 @@
+#include "vertex-deduplicator.hpp"
+#include <limits>
+
+using ast::VertexDeduplicator;
+
+namespace
+{
+    struct Slot
+    {
+        uint32_t hash;
+        uint32_t index;
+    };
+
+    constexpr uint32_t emptySlot{std::numeric_limits<uint32_t>::max()};
+
+    size_t getCapacity(const size_t& expectedVertices)
+    {
+        // Keep the table at most half full so probe sequences stay short.
+        size_t capacity{16};
+
+        while (capacity < expectedVertices * 2)
+        {
+            capacity *= 2;
+        }
+
+        return capacity;
+    }
+} // namespace
+
+struct VertexDeduplicator::Internal
+{
+    std::vector<ast::Vertex>& vertices;
+    std::vector<::Slot> slots;
+    size_t mask;
+
+    Internal(std::vector<ast::Vertex>& vertices, const size_t& expectedVertices)
+        : vertices(vertices),
+          slots(::getCapacity(expectedVertices), ::Slot{0, ::emptySlot}),
+          mask(slots.size() - 1)
+    {
+        vertices.reserve(vertices.size() + expectedVertices);
+    }
+
+    uint32_t add(const ast::Vertex& vertex)
+    {
+        const uint32_t hash{static_cast<uint32_t>(std::hash<ast::Vertex>()(vertex))};
+
+        // Linear probing - the stored hash lets us skip most non matching slots without
+        // having to touch the vertex they refer to.
+        for (size_t position = hash & mask;; position = (position + 1) & mask)
+        {
+            ::Slot& slot{slots[position]};
+
+            if (slot.index == ::emptySlot)
+            {
+                const uint32_t index{static_cast<uint32_t>(vertices.size())};
+
+                slot = ::Slot{hash, index};
+                vertices.push_back(vertex);
+
+                if (vertices.size() * 2 > slots.size())
+                {
+                    grow();
+                }
+
+                return index;
+            }
+
+            if (slot.hash == hash && vertices[slot.index] == vertex)
+            {
+                return slot.index;
+            }
+        }
+    }
+
+    void grow()
+    {
+        std::vector<::Slot> previousSlots(slots.size() * 2, ::Slot{0, ::emptySlot});
+        previousSlots.swap(slots);
+        mask = slots.size() - 1;
+
+        // The hashes were kept in the slots, so nothing needs to be hashed again.
+        for (const auto& slot : previousSlots)
+        {
+            if (slot.index != ::emptySlot)
+            {
+                size_t position{slot.hash & mask};
+
+                while (slots[position].index != ::emptySlot)
+                {
+                    position = (position + 1) & mask;
+                }
+
+                slots[position] = slot;
+            }
+        }
+    }
+};
+
+VertexDeduplicator::VertexDeduplicator(std::vector<ast::Vertex>& vertices, const size_t& expectedVertices)
+    : internal(ast::make_internal_ptr<Internal>(vertices, expectedVertices)) {}
+
+uint32_t VertexDeduplicator::add(const ast::Vertex& vertex)
+{
+    return internal->add(vertex);
+}
\ No newline at end of file
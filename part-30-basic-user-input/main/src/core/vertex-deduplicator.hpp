@@ -0,0 +1,23 @@
+#pragma once
+
+#include "internal-ptr.hpp"
+#include "vertex.hpp"
+#include <vector>
+
+namespace ast
+{
+    // A vertex deduplicator assigns an index to each distinct vertex added to it, appending
+    // any vertex it has not seen before to the given list of vertices. It is built on a flat
+    // open addressing hash table which holds only indices into that list along with their
+    // hashes, so each vertex costs exactly one probe sequence and no node allocations.
+    struct VertexDeduplicator
+    {
+        VertexDeduplicator(std::vector<ast::Vertex>& vertices, const size_t& expectedVertices);
+
+        uint32_t add(const ast::Vertex& vertex);
+
+    private:
+        struct Internal;
+        ast::internal_ptr<Internal> internal;
+    };
+} // namespace ast
\ No newline at end of file
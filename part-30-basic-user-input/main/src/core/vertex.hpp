@@ -1,6 +1,8 @@
 #pragma once
 
 #include "glm-wrapper.hpp"
+#include <cstdint>
+#include <cstring>
 
 namespace ast
 {
@@ -20,7 +22,31 @@ namespace std
     {
         size_t operator()(const ast::Vertex& vertex) const
         {
-            return ((hash<glm::vec3>()(vertex.position) ^ (hash<glm::vec2>()(vertex.texCoord) << 1)) >> 1);
+            const float components[5]{vertex.position.x, vertex.position.y, vertex.position.z,
+                                      vertex.texCoord.x, vertex.texCoord.y};
+
+            // Fold the bits of each component into the hash with a multiply and shift, so that
+            // neighbouring values (as found all over grid-like meshes) still end up far apart.
+            uint64_t result{0x9e3779b97f4a7c15};
+
+            for (const float component : components)
+            {
+                // Negative and positive zero compare as equal so they must hash the same too.
+                uint32_t bits{0};
+
+                if (component != 0.0f)
+                {
+                    std::memcpy(&bits, &component, sizeof(bits));
+                }
+
+                result = (result ^ bits) * 0xff51afd7ed558ccd;
+                result ^= result >> 32;
+            }
+
+            result *= 0xc4ceb9fe1a85ec53;
+            result ^= result >> 29;
+
+            return static_cast<size_t>(result);
         }
     };
 } // namespace std
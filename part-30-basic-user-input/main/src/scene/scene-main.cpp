@@ -1,7 +1,8 @@
 #include "scene-main.hpp"
 #include "../core/perspective-camera.hpp"
+#include "../core/profiler.hpp"
 #include "../core/sdl-wrapper.hpp"
-#include "../core/static-mesh-instance.hpp"
+#include "../core/static-mesh-instance-store.hpp"
 #include "player.hpp"
 
 using ast::SceneMain;
@@ -21,12 +22,14 @@ namespace
 struct SceneMain::Internal
 {
     ast::PerspectiveCamera camera;
-    std::vector<ast::StaticMeshInstance> staticMeshes;
+    float viewportHeight;
+    ast::StaticMeshInstanceStore staticMeshes;
     ast::Player player;
     const uint8_t* keyboardState;
 
     Internal(const ast::WindowSize& size)
         : camera(::createCamera(size)),
+          viewportHeight(static_cast<float>(size.height)),
           player(ast::Player(glm::vec3{0.0f, 0.0f, 2.0f})),
           keyboardState(SDL_GetKeyboardState(nullptr)) {}
 
@@ -40,37 +43,37 @@ struct SceneMain::Internal
 
     void prepare()
     {
-        staticMeshes.push_back(ast::StaticMeshInstance{
+        staticMeshes.add(
             StaticMesh::Crate,           // Mesh
             Texture::Crate,              // Texture
             glm::vec3{0.4f, 0.6f, 0.0f}, // Position
             glm::vec3{0.6f, 0.6f, 0.6f}, // Scale
             glm::vec3{0.0f, 0.4f, 0.9f}, // Rotation axis
-            0.0f});                      // Initial rotation
+            0.0f);                       // Initial rotation
 
-        staticMeshes.push_back(ast::StaticMeshInstance{
+        staticMeshes.add(
             StaticMesh::Torus,            // Mesh
             Texture::RedCrossHatch,       // Texture
             glm::vec3{-0.6f, 0.4f, 0.0f}, // Position
             glm::vec3{0.4f, 0.4f, 0.4f},  // Scale
             glm::vec3{0.2f, 1.0f, 0.4f},  // Rotation axis
-            0.0f});                       // Initial rotation
+            0.0f);                        // Initial rotation
 
-        staticMeshes.push_back(ast::StaticMeshInstance{
+        staticMeshes.add(
             StaticMesh::Crate,             // Mesh
             Texture::Crate,                // Texture
             glm::vec3{-0.5f, -0.5f, 0.0f}, // Position
             glm::vec3{0.7f, 0.3f, 0.3f},   // Scale
             glm::vec3{0.2f, 0.6f, 0.1f},   // Rotation axis
-            90.0f});                       // Initial rotation
+            90.0f);                        // Initial rotation
 
-        staticMeshes.push_back(ast::StaticMeshInstance{
+        staticMeshes.add(
             StaticMesh::Torus,            // Mesh
             Texture::RedCrossHatch,       // Texture
             glm::vec3{0.6f, -0.4f, 0.0f}, // Position
             glm::vec3{0.4f, 0.4f, 0.4f},  // Scale
             glm::vec3{0.6f, 0.3f, 0.1f},  // Rotation axis
-            50.0f});                      // Initial rotation
+            50.0f);                       // Initial rotation
     }
 
     void processInput(const float& delta)
@@ -108,27 +111,43 @@ struct SceneMain::Internal
 
     void update(const float& delta)
     {
+        AST_PROFILE_ZONE("SceneMain::update");
+
         processInput(delta);
 
         camera.configure(player.getPosition(), player.getDirection());
 
         const glm::mat4 cameraMatrix{camera.getProjectionMatrix() * camera.getViewMatrix()};
 
-        for (auto& staticMesh : staticMeshes)
+        ast::TransformBatch& transforms{staticMeshes.getTransforms()};
+
+        for (uint32_t i = 0; i < transforms.getSize(); i++)
         {
-            staticMesh.rotateBy(delta * 45.0f);
-            staticMesh.update(cameraMatrix);
+            transforms.rotateBy(i, delta * 45.0f);
         }
+
+        staticMeshes.update(cameraMatrix);
     }
 
     void render(ast::Renderer& renderer)
     {
-        renderer.render(Pipeline::Default, staticMeshes);
+        AST_PROFILE_ZONE("SceneMain::render");
+
+        // The renderer works out which mesh instances the camera can see, and how much detail
+        // each of them needs, either on the CPU or on the GPU if it is able to.
+        const ast::RenderView view{
+            camera.getProjectionMatrix(), // Projection matrix
+            camera.getViewMatrix(),       // View matrix
+            player.getPosition(),         // Camera position
+            viewportHeight};              // Viewport height
+
+        renderer.renderVisible(Pipeline::Default, staticMeshes, view);
     }
 
     void onWindowResized(const ast::WindowSize& size)
     {
         camera = ::createCamera(size);
+        viewportHeight = static_cast<float>(size.height);
     }
 };
 
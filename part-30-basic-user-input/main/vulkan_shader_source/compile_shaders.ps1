@@ -8,9 +8,9 @@ if (!(Test-Path "vulkan")) {
 }
 Pop-Location
 
-# Grab all the files in the current directory ending with 'vert' or 'frag'
+# Grab all the files in the current directory ending with 'vert', 'frag' or 'comp'
 # and iterate them one at a time, invoking the Vulkan shader compiler for each.
-Get-ChildItem -Name -Include *.vert,*.frag | Foreach-Object {
+Get-ChildItem -Name -Include *.vert,*.frag,*.comp | Foreach-Object {
     $outputFileName = "..\assets\shaders\vulkan\" + $_
     Write-Host "Compiling Vulkan shader file"$_"..."
 
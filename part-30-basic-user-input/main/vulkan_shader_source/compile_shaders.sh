@@ -9,9 +9,9 @@ pushd ../assets/shaders
     fi
 popd
 
-# Grab all the files in the current directory ending with 'vert' or 'frag'
+# Grab all the files in the current directory ending with 'vert', 'frag' or 'comp'
 # and iterate them one at a time, invoking the Vulkan shader compiler for each.
-for FILE_PATH in *.vert *.frag; do
+for FILE_PATH in *.vert *.frag *.comp; do
     FILE_NAME=$(basename $FILE_PATH)
 
     echo "Compiling Vulkan shader: ${FILE_NAME}"
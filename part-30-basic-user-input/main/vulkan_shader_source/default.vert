@@ -1,16 +1,24 @@
 #version 460
 
-layout(push_constant) uniform PushConstants {
-    mat4 mvp;
-} pushConstants;
-
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec2 inTexCoord;
 
+// Per instance MVP matrix, fed from the instance vertex buffer and spanning locations 2 to 5.
+layout(location = 2) in mat4 inMvp;
+
+// Per mesh transform which recovers the original position and texture coordinate of a vertex
+// from the compact form it is stored in, or an identity transform for full precision vertices.
+layout(push_constant) uniform Dequantization {
+    vec4 positionScale;
+    vec4 positionOffset;
+    vec4 texCoordScaleOffset;
+} dequantization;
+
 layout(location = 0) out vec2 outTexCoord;
 
 void main() {
-    gl_Position = pushConstants.mvp * vec4(inPosition, 1.0f);
+    vec3 position = inPosition * dequantization.positionScale.xyz + dequantization.positionOffset.xyz;
+    gl_Position = inMvp * vec4(position, 1.0f);
 
     // The following two lines account for Vulkan having a different
     // coordinate system to OpenGL. See this link for a nice explanation:
@@ -18,5 +26,5 @@ void main() {
     gl_Position.y = -gl_Position.y;
     gl_Position.z = (gl_Position.z + gl_Position.w) / 2.0f;
     
-    outTexCoord = inTexCoord;
+    outTexCoord = inTexCoord * dequantization.texCoordScaleOffset.xy + dequantization.texCoordScaleOffset.zw;
 }